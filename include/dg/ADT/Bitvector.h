@@ -1,6 +1,7 @@
 #ifndef DG_SPARSE_BITVECTOR_H_
 #define DG_SPARSE_BITVECTOR_H_
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 
@@ -43,6 +44,14 @@ class SparseBitvectorImpl {
         _bits.emplace(sft, BitsT{1} << (i - sft));
     }
 
+    // the bits [from, to) of a bucket
+    static BitsT _mask(size_t from, size_t to) {
+        BitsT mask = ~BitsT{0};
+        if (to < BITS_IN_BUCKET)
+            mask = (BitsT{1} << to) - 1;
+        return mask & ~((BitsT{1} << from) - 1);
+    }
+
   public:
     SparseBitvectorImpl() = default;
     SparseBitvectorImpl(IndexT i) { _addBit(i); } // singleton ctor
@@ -70,6 +79,20 @@ class SparseBitvectorImpl {
         return (it->second & (BitsT{1} << (i - sft)));
     }
 
+    // is any of the bits [first, last) set?
+    bool any(IndexT first, IndexT last) const {
+        while (first < last) {
+            auto sft = _shift(first);
+            auto end = std::min<IndexT>(last, sft + BITS_IN_BUCKET);
+            auto it = _bits.find(sft);
+            if (it != _bits.end() &&
+                (it->second & _mask(first - sft, end - sft)))
+                return true;
+            first = end;
+        }
+        return false;
+    }
+
     // returns the previous value of the i-th bit
     bool set(IndexT i) {
         auto sft = _shift(i);
@@ -119,6 +142,30 @@ class SparseBitvectorImpl {
         return true;
     }
 
+    // unset the bits [first, last), return true if any of them was set
+    bool unset(IndexT first, IndexT last) {
+        bool changed = false;
+        while (first < last) {
+            auto sft = _shift(first);
+            auto end = std::min<IndexT>(last, sft + BITS_IN_BUCKET);
+            auto it = _bits.find(sft);
+            if (it != _bits.end()) {
+                auto mask = _mask(first - sft, end - sft);
+                if (it->second & mask) {
+                    changed = true;
+                    auto res = it->second & ~mask;
+                    if (res == 0)
+                        _bits.erase(it);
+                    else
+                        _bits[sft] = res;
+                }
+            }
+            first = end;
+        }
+
+        return changed;
+    }
+
     // FIXME: track the number of elements
     // in a variable, to avoid this search...
     size_t size() const {
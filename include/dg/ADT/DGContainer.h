@@ -4,6 +4,9 @@
 #include <algorithm>
 #include <cassert>
 #include <set>
+#include <type_traits>
+
+#include "dg/ADT/SmallFlatSet.h"
 
 namespace dg {
 
@@ -12,13 +15,18 @@ namespace dg {
 //
 //   This is basically just a wrapper for real container, so that
 //   we have the container defined on one place for all edges.
-//   It may have more implementations depending on available features
+//   The elements are kept in a sorted array that stores
+//   EXPECTED_ELEMENTS_NUM elements inline (most nodes have just a few
+//   edges, so they never allocate). EXPECTED_ELEMENTS_NUM == 0 selects
+//   the std::set. Note that with the sorted array, inserting and erasing
+//   invalidates iterators.
 /// ------------------------------------------------------------------
 template <typename ValueT, unsigned int EXPECTED_ELEMENTS_NUM = 8>
 class DGContainer {
   public:
-    // XXX use llvm ADTs when available, or BDDs?
-    using ContainerT = typename std::set<ValueT>;
+    using ContainerT = typename std::conditional<
+            EXPECTED_ELEMENTS_NUM == 0, std::set<ValueT>,
+            ADT::SmallFlatSet<ValueT, EXPECTED_ELEMENTS_NUM>>::type;
     using iterator = typename ContainerT::iterator;
     using const_iterator = typename ContainerT::const_iterator;
     using size_type = typename ContainerT::size_type;
@@ -38,7 +46,7 @@ class DGContainer {
 
     void clear() { container.clear(); }
 
-    bool empty() { return container.empty(); }
+    bool empty() const { return container.empty(); }
 
     void swap(DGContainer<ValueT, EXPECTED_ELEMENTS_NUM> &oth) {
         container.swap(oth.container);
@@ -47,10 +55,16 @@ class DGContainer {
     void intersect(const DGContainer<ValueT, EXPECTED_ELEMENTS_NUM> &oth) {
         DGContainer<ValueT, EXPECTED_ELEMENTS_NUM> tmp;
 
-        std::set_intersection(
-                container.begin(), container.end(), oth.container.begin(),
-                oth.container.end(),
-                std::inserter(tmp.container, tmp.container.begin()));
+        // both containers are sorted
+        auto snd = oth.container.begin();
+        for (const auto &val : container) {
+            while (snd != oth.container.end() && *snd < val)
+                ++snd;
+            if (snd == oth.container.end())
+                break;
+            if (!(val < *snd))
+                tmp.container.insert(val);
+        }
 
         // swap containers
         container.swap(tmp.container);
@@ -62,8 +76,8 @@ class DGContainer {
             return false;
 
         // the sets are ordered, so this will work
-        iterator snd = oth.container.begin();
-        for (iterator fst = container.begin(), efst = container.end();
+        const_iterator snd = oth.container.begin();
+        for (const_iterator fst = container.begin(), efst = container.end();
              fst != efst; ++fst, ++snd)
             if (*fst != *snd)
                 return false;
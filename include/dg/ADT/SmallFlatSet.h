@@ -0,0 +1,178 @@
+#ifndef DG_SMALL_FLAT_SET_H_
+#define DG_SMALL_FLAT_SET_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace dg {
+namespace ADT {
+
+///
+// A set stored as a sorted array. The first N elements are stored
+// inline (in the object itself), so small sets do not allocate at all.
+// Larger sets are stored in a heap-allocated array that grows
+// geometrically. The interface mimics std::set, but inserting and erasing
+// invalidates iterators (as with std::vector). The elements must be
+// trivially copyable (pointers, numbers, small PODs), because they
+// are moved around with memmove.
+template <typename ValueT, unsigned int N>
+class SmallFlatSet {
+    static_assert(N > 0, "The inline capacity must be positive");
+    static_assert(std::is_trivially_copyable<ValueT>::value,
+                  "SmallFlatSet supports only trivially copyable elements");
+
+    using StorageT = typename std::aligned_storage<sizeof(ValueT),
+                                                   alignof(ValueT)>::type;
+
+    ValueT *_data;
+    uint32_t _size{0};
+    uint32_t _capacity{N};
+    StorageT _inline[N];
+
+    bool isInline() const {
+        return _data == reinterpret_cast<const ValueT *>(_inline);
+    }
+
+    ValueT *inlineData() { return reinterpret_cast<ValueT *>(_inline); }
+
+    static ValueT *allocate(uint32_t capacity) {
+        return static_cast<ValueT *>(::operator new(capacity * sizeof(ValueT)));
+    }
+
+    void release() {
+        if (!isInline())
+            ::operator delete(_data);
+        _data = inlineData();
+        _capacity = N;
+    }
+
+    void grow() {
+        uint32_t newCapacity = 2 * _capacity;
+        ValueT *newData = allocate(newCapacity);
+        std::memcpy(newData, _data, _size * sizeof(ValueT));
+        if (!isInline())
+            ::operator delete(_data);
+        _data = newData;
+        _capacity = newCapacity;
+    }
+
+    void assign(const SmallFlatSet &oth) {
+        if (oth._size > _capacity) {
+            release();
+            _data = allocate(oth._size);
+            _capacity = oth._size;
+        }
+        std::memcpy(_data, oth._data, oth._size * sizeof(ValueT));
+        _size = oth._size;
+    }
+
+    // take the elements of 'oth' and leave it empty
+    void steal(SmallFlatSet &oth) {
+        if (oth.isInline()) {
+            std::memcpy(inlineData(), oth._data, oth._size * sizeof(ValueT));
+            _data = inlineData();
+            _capacity = N;
+        } else {
+            _data = oth._data;
+            _capacity = oth._capacity;
+            oth._data = oth.inlineData();
+            oth._capacity = N;
+        }
+        _size = oth._size;
+        oth._size = 0;
+    }
+
+  public:
+    using value_type = ValueT;
+    using size_type = size_t;
+    // like in std::set, the elements cannot be modified through iterators
+    using iterator = const ValueT *;
+    using const_iterator = const ValueT *;
+
+    SmallFlatSet() : _data(inlineData()) {}
+    SmallFlatSet(const SmallFlatSet &oth) : _data(inlineData()) {
+        assign(oth);
+    }
+    SmallFlatSet(SmallFlatSet &&oth) noexcept : _data(inlineData()) {
+        steal(oth);
+    }
+
+    SmallFlatSet &operator=(const SmallFlatSet &oth) {
+        if (this != &oth)
+            assign(oth);
+        return *this;
+    }
+
+    SmallFlatSet &operator=(SmallFlatSet &&oth) noexcept {
+        if (this != &oth) {
+            release();
+            steal(oth);
+        }
+        return *this;
+    }
+
+    ~SmallFlatSet() { release(); }
+
+    const_iterator begin() const { return _data; }
+    const_iterator end() const { return _data + _size; }
+
+    size_type size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    const_iterator find(const ValueT &val) const {
+        auto it = std::lower_bound(begin(), end(), val);
+        if (it != end() && !(val < *it))
+            return it;
+        return end();
+    }
+
+    size_type count(const ValueT &val) const { return find(val) != end(); }
+
+    std::pair<iterator, bool> insert(const ValueT &val) {
+        auto *it = const_cast<ValueT *>(std::lower_bound(begin(), end(), val));
+        if (it != end() && !(val < *it))
+            return {it, false};
+
+        auto pos = it - _data;
+        if (_size == _capacity)
+            grow();
+
+        it = _data + pos;
+        std::memmove(it + 1, it, (_size - pos) * sizeof(ValueT));
+        new (it) ValueT(val);
+        ++_size;
+
+        return {it, true};
+    }
+
+    size_type erase(const ValueT &val) {
+        auto it = find(val);
+        if (it == end())
+            return 0;
+
+        auto pos = it - _data;
+        std::memmove(_data + pos, _data + pos + 1,
+                     (_size - pos - 1) * sizeof(ValueT));
+        --_size;
+        return 1;
+    }
+
+    // remove the elements, but keep the allocated memory
+    void clear() { _size = 0; }
+
+    void swap(SmallFlatSet &oth) {
+        SmallFlatSet tmp(std::move(oth));
+        oth = std::move(*this);
+        *this = std::move(tmp);
+    }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_SMALL_FLAT_SET_H_
@@ -114,7 +114,7 @@ class BBlock {
         if (nextBBs.size() < 2)
             return true;
 
-        typename SuccContainerT::const_iterator start, iter, end;
+        typename SuccContainerT::const_iterator iter, end;
         iter = nextBBs.begin();
         end = nextBBs.end();
 
@@ -147,24 +147,27 @@ class BBlock {
             // and create new edges to all successors. The new edges
             // will have the same label as the found one
             DGContainer<BBlockEdge> new_edges;
-            for (auto I = pred->nextBBs.begin(), E = pred->nextBBs.end();
-                 I != E;) {
-                auto cur = I++;
-                if (cur->target == this) {
-                    // create edges that will go from the predecessor
-                    // to every successor of this node
-                    for (const BBlockEdge &succ : nextBBs) {
-                        // we cannot create an edge to this bblock (we're
-                        // isolating _this_ bblock), that would be incorrect. It
-                        // can occur when we're isolatin a bblock with self-loop
-                        if (succ.target != this)
-                            new_edges.insert(
-                                    BBlockEdge(succ.target, cur->label));
-                    }
-
-                    // remove the edge from predecessor
-                    pred->nextBBs.erase(*cur);
+            // gather the edges first, erasing them while iterating
+            // over the successors would invalidate the iterators
+            DGContainer<BBlockEdge> old_edges;
+            for (const BBlockEdge &edge : pred->nextBBs) {
+                if (edge.target == this)
+                    old_edges.insert(edge);
+            }
+
+            for (const BBlockEdge &edge : old_edges) {
+                // create edges that will go from the predecessor
+                // to every successor of this node
+                for (const BBlockEdge &succ : nextBBs) {
+                    // we cannot create an edge to this bblock (we're
+                    // isolating _this_ bblock), that would be incorrect. It
+                    // can occur when we're isolatin a bblock with self-loop
+                    if (succ.target != this)
+                        new_edges.insert(BBlockEdge(succ.target, edge.label));
                 }
+
+                // remove the edge from predecessor
+                pred->nextBBs.erase(edge);
             }
 
             // add newly created edges to predecessor
@@ -1,13 +1,15 @@
 #ifndef DG_BBLOCK_BASE_H_
 #define DG_BBLOCK_BASE_H_
 
+#include <atomic>
 #include <list>
 #include <vector>
 
 namespace dg {
 
 class ElemId {
-    static unsigned idcnt;
+    // shared by all graphs, atomic so that graphs can be built in parallel
+    static std::atomic<unsigned> idcnt;
     unsigned id;
 
   public:
@@ -11,6 +11,7 @@ struct ControlDependenceAnalysisOptions : AnalysisOptions {
         STANDARD,
         NTSCD_LEGACY,
         NTSCD2,
+        NTSCD3,
         NTSCD_RANGANATH,      // fixed version of Ranganath's alg.
         NTSCD_RANGANATH_ORIG, // original (wrong) version of Ranaganath's alg.
         NTSCD,
@@ -27,6 +28,7 @@ struct ControlDependenceAnalysisOptions : AnalysisOptions {
     bool standardCD() const { return algorithm == CDAlgorithm::STANDARD; }
     bool ntscdCD() const { return algorithm == CDAlgorithm::NTSCD; }
     bool ntscd2CD() const { return algorithm == CDAlgorithm::NTSCD2; }
+    bool ntscd3CD() const { return algorithm == CDAlgorithm::NTSCD3; }
     bool ntscdRanganathCD() const {
         return algorithm == CDAlgorithm::NTSCD_RANGANATH;
     }
@@ -34,7 +34,7 @@ struct Indent {
     friend std::ostream &operator<<(std::ostream &os, const Indent &ind);
 };
 
-std::ostream &operator<<(std::ostream &os, const Indent &ind) {
+inline std::ostream &operator<<(std::ostream &os, const Indent &ind) {
     for (int i = 0; i < ind.ind; ++i)
         os << "\t";
 
@@ -62,6 +62,8 @@ class DG2Dot {
 
     void setSlicingCriteria(const std::set<NodeT *> &crit) { criteria = crit; }
 
+    DependenceGraph<NodeT> *getDG() const { return dg; }
+
     bool open(const char *new_file) {
         if (out.is_open()) {
             std::cerr << "File already opened (" << file << ")" << std::endl;
@@ -59,6 +59,8 @@ class DataDependenceAnalysis {
         return _impl->getDefinitions(use);
     }
 
+    size_t getNumOfPhis() const { return _impl->getNumOfPhis(); }
+
     const DataDependenceAnalysisOptions &getOptions() const { return _options; }
 
     DataDependenceAnalysisImpl *getImpl() { return _impl.get(); }
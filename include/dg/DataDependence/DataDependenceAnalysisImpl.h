@@ -52,6 +52,9 @@ class DataDependenceAnalysisImpl {
     // return reaching definitions of a node that represents
     // the given use
     virtual std::vector<RWNode *> getDefinitions(RWNode *use) = 0;
+
+    // the number of phi nodes created by the analysis
+    virtual size_t getNumOfPhis() const { return 0; }
 };
 
 } // namespace dda
@@ -251,6 +251,8 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
 
     std::vector<RWNode *> getDefinitions(RWNode *use) override;
 
+    size_t getNumOfPhis() const override { return _phis.size(); }
+
     const Definitions *getDefinitions(RWBBlock *b) const {
         const auto *bi = getBBlockInfo(b);
         return bi ? &bi->getDefinitions() : nullptr;
@@ -2,6 +2,7 @@
 #define DG_POINTER_ANALYSIS_H_
 
 #include <cassert>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -87,6 +88,8 @@ class PointerAnalysis {
     bool iteration() {
         assert(changed.empty());
 
+        ++_iterations;
+        _processedNodes += to_process.size();
         for (PSNode *cur : to_process) {
             bool enq = false;
             enq |= beforeProcessed(cur);
@@ -158,7 +161,37 @@ class PointerAnalysis {
     // we do not need to pass this to the LLVM part...
     virtual bool handleJoin(PSNode * /*unused*/) { return false; }
 
+    // has the object exceeded the field-sensitivity budget?
+    bool isCollapsed(const PSNode *target) const {
+        auto it = _objectOffsets.find(target);
+        return it != _objectOffsets.end() && it->second.collapsed;
+    }
+
+    size_t getNumOfCollapsedObjects() const { return _collapsedNum; }
+
+    // the number of iterations of the analysis and the number
+    // of nodes processed in all the iterations
+    size_t getNumOfIterations() const { return _iterations; }
+    size_t getNumOfProcessedNodes() const { return _processedNodes; }
+
   private:
+    // the offsets of pointers to an object that were created during
+    // the analysis, used for the field-sensitivity budget
+    struct ObjectOffsets {
+        std::vector<Offset::type> offsets; // sorted
+        bool collapsed{false};
+    };
+
+    std::unordered_map<const PSNode *, ObjectOffsets> _objectOffsets;
+    size_t _collapsedNum{0};
+
+    size_t _iterations{0};
+    size_t _processedNodes{0};
+
+    // return the offset that the new pointer to the target should have
+    // (the unknown offset if the target is over the budget)
+    Offset cropOffset(const PSNode *target, Offset off);
+
     // check the sanity of results of pointer analysis
     void sanityCheck();
 
@@ -1,6 +1,8 @@
 #ifndef DG_POINTER_ANALYSIS_OPTIONS_H_
 #define DG_POINTER_ANALYSIS_OPTIONS_H_
 
+#include <cstddef>
+
 #include "dg/AnalysisOptions.h"
 
 namespace dg {
@@ -27,6 +29,29 @@ struct PointerAnalysisOptions : AnalysisOptions {
         return *this;
     }
 
+    // Track at most this number of different offsets of pointers
+    // to one object. When an object exceeds the budget, it is collapsed:
+    // all new pointers to the object get the unknown offset
+    // (the other objects keep the field-sensitivity).
+    // 0 means that there is no budget.
+    size_t fieldSensitivityBudget{0};
+
+    PointerAnalysisOptions &setFieldSensitivityBudget(size_t b) {
+        fieldSensitivityBudget = b;
+        return *this;
+    }
+
+    // Reserve blocks of pointer IDs for objects, so that the pointers
+    // to one object share the words of bitvectors in points-to sets
+    // (see PointerIDLookupTable). The unused IDs of the blocks make
+    // the sets sparser, so it is off by default.
+    bool reservePointerIDBlocks{false};
+
+    PointerAnalysisOptions &setReservePointerIDBlocks(bool b) {
+        reservePointerIDBlocks = b;
+        return *this;
+    }
+
     // Perform maximally this number of iterations.
     // If exceeded, the analysis is terminated and points-to sets
     // of the unprocessed nodes are set to {}.
@@ -5,6 +5,7 @@
 #include "dg/BFS.h"
 #include "dg/CallGraph/CallGraph.h"
 #include "dg/PointerAnalysis/PSNode.h"
+#include "dg/PointerAnalysis/PointsToSets/LookupTable.h"
 #include "dg/SCC.h"
 #include "dg/SubgraphNode.h"
 #include "dg/util/debug.h"
@@ -105,6 +106,12 @@ class PointerGraph {
     using GlobalNodesT = std::vector<PSNode *>;
     using SubgraphsT = std::vector<std::unique_ptr<PointerSubgraph>>;
 
+    // IDs of pointers for the points-to sets of this graph
+    // (declared before the nodes, so it outlives their points-to sets).
+    // The sets point to the table, so it must not move with the graph.
+    std::unique_ptr<PointerIDLookupTable> _lookupTable{
+            new PointerIDLookupTable()};
+
     NodesT nodes;
     SubgraphsT _subgraphs;
 
@@ -185,6 +192,8 @@ class PointerGraph {
 
     template <PSNodeType Type, typename... Args>
     PSNode *create(Args &&...args) {
+        // the points-to set of the node uses the lookup table of this graph
+        PointerIDLookupTable::Scope scope(*_lookupTable);
         PSNode *n = nodeFactory<Type>(std::forward<Args>(args)...);
         nodes.emplace_back(n); // C++17 returns a referece
         assert(n->getID() == nodes.size() - 1);
@@ -205,6 +214,17 @@ class PointerGraph {
 
     bool registerCall(PSNode *a, PSNode *b) { return callGraph.addCall(a, b); }
 
+    PointerIDLookupTable &getLookupTable() { return *_lookupTable; }
+    const PointerIDLookupTable &getLookupTable() const {
+        return *_lookupTable;
+    }
+
+    // Reserve the IDs of pointers for all allocations in the graph
+    // in the order of nodes, so that the allocations from one function
+    // (that often appear together in points-to sets) have neighbouring IDs.
+    // Does nothing unless the lookup table reserves blocks of IDs.
+    void reservePointerIDs();
+
     GenericCallGraph<PSNode *> &getCallGraph() { return callGraph; }
     const GenericCallGraph<PSNode *> &getCallGraph() const { return callGraph; }
     const SubgraphsT &getSubgraphs() const { return _subgraphs; }
@@ -1,6 +1,9 @@
 #ifndef DG_POINTER_SUBGRAPH_OPTIMIZATIONS_H_
 #define DG_POINTER_SUBGRAPH_OPTIMIZATIONS_H_
 
+#include <set>
+#include <vector>
+
 #include "PointsToMapping.h"
 
 namespace dg {
@@ -73,6 +76,68 @@ class PSEquivalentNodesMerger {
     unsigned merged_nodes_num;
 };
 
+///
+// Offline variable substitution: find the nodes that must have
+// the same points-to sets and merge them before running the analysis.
+// Uses hash-based value numbering with unions (HVN/HU): every node gets
+// a label such that the nodes with the same label have the same
+// points-to sets, e.g., a cast gets the label of its operand, two GEPs
+// with the same offset from nodes with the same label get the same label
+// and a phi node gets the label of the set of labels of its operands.
+// Cycles of casts and phi nodes get the label of the union
+// of the labels that come into the cycle.
+// A GEP with zero offset is not a copy of its operand: the analysis
+// makes the offsets that are out of the object unknown,
+// so it is labeled as any other GEP. GEPs on loops of the control flow
+// get a label of their own, because the flow-insensitive analysis
+// makes their offsets unknown.
+// Loads are not labeled by their operands: the analyses process
+// the loads in the order of the control flow, so two loads from
+// the same pointer may end up with different points-to sets.
+// A node is replaced by a node with the same label that dominates it
+// (or by a global node), because the analysis propagates the changes
+// of points-to sets along the control flow.
+//
+// The merged nodes are only disconnected from the graph (not deleted),
+// because the builder of the graph may still refer to them.
+// Use the mapping to find the node that replaced a merged node.
+class PSPointerEquivalenceMerger {
+  public:
+    using MappingT = PointsToMapping<PSNode *>;
+
+    PSPointerEquivalenceMerger(PointerGraph *g) : G(g) {}
+
+    // Mark a node whose operands may change during the analysis
+    // (e.g., a formal argument that gets new operands when a call via
+    // a function pointer is resolved). Such a node is never merged.
+    void addOpenNode(PSNode *nd) { openNodes.insert(nd); }
+
+    MappingT &getMapping() { return mapping; }
+    const MappingT &getMapping() const { return mapping; }
+
+    unsigned getNumOfMergedNodes() const { return merged_nodes_num; }
+    // the number of classes of equivalent nodes that had
+    // at least one node merged
+    unsigned getNumOfClasses() const { return classes_num; }
+
+    unsigned run();
+
+  private:
+    PointerGraph *G;
+    std::set<PSNode *> openNodes;
+    std::set<PSNode *> globals;
+    std::set<PSNode *> loopGeps;
+
+    MappingT mapping;
+    unsigned merged_nodes_num{0};
+    unsigned classes_num{0};
+
+    bool isCopy(PSNode *nd) const;
+    bool isLabeledByOperands(PSNode *nd) const;
+    bool canBeMerged(PSNode *nd) const;
+    void merge(PSNode *node, PSNode *rep);
+};
+
 class PointerGraphOptimizer {
     using MappingT = PointsToMapping<PSNode *>;
 
@@ -1,6 +1,7 @@
 #ifndef DG_ALIGNEDBITVECTORPOINTSTOSET_H
 #define DG_ALIGNEDBITVECTORPOINTSTOSET_H
 
+#include "LookupTable.h"
 #include "dg/ADT/Bitvector.h"
 #include "dg/PointerAnalysis/Pointer.h"
 #include "dg/util/iterators.h"
@@ -8,6 +9,7 @@
 #include <cassert>
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 namespace dg {
@@ -20,20 +22,17 @@ class AlignedPointerIdPointsToSet {
 
     ADT::SparseBitvector pointers;
     std::set<Pointer> overflowSet;
-    static std::map<Pointer, size_t> ids; // pointers are numbered 1, 2, ...
-    static std::vector<Pointer>
-            idVector; // starts from 0 (pointer = idVector[id - 1])
+    // the table that assigns IDs to the pointers in this set
+    PointerIDLookupTable *_table{PointerIDLookupTable::getCurrent()};
 
     // if the pointer doesn't have ID, it's assigned one
-    static size_t getPointerID(const Pointer &ptr) {
-        auto it = ids.find(ptr);
-        if (it != ids.end()) {
-            return it->second;
-        }
-        idVector.push_back(ptr);
-        return ids.emplace_hint(it, ptr, ids.size() + 1)->second;
+    size_t getPointerID(const Pointer &ptr) const {
+        return _table->getOrCreate(ptr);
     }
 
+    // get the ID of the pointer or 0 if it has none
+    size_t findPointerID(const Pointer &ptr) const { return _table->get(ptr); }
+
     bool addWithUnknownOffset(PSNode *node) {
         removeAny(node);
         return !pointers.set(getPointerID({node, Offset::UNKNOWN}));
@@ -65,6 +64,17 @@ class AlignedPointerIdPointsToSet {
     }
 
     bool add(const AlignedPointerIdPointsToSet &S) {
+        if (S._table != _table) {
+            if (!pointers.empty()) {
+                // the IDs come from different tables
+                bool changed = false;
+                for (const auto &ptr : S)
+                    changed |= add(ptr);
+                return changed;
+            }
+            _table = S._table;
+        }
+
         bool changed = pointers.set(S.pointers);
         for (const auto &ptr : S.overflowSet) {
             changed |= overflowSet.insert(ptr).second;
@@ -74,7 +84,8 @@ class AlignedPointerIdPointsToSet {
 
     bool remove(const Pointer &ptr) {
         if (isOffsetValid(ptr.offset)) {
-            return pointers.unset(getPointerID(ptr));
+            auto ptrID = findPointerID(ptr);
+            return ptrID != 0 && pointers.unset(ptrID);
         }
         return overflowSet.erase(ptr) != 0;
     }
@@ -84,16 +95,11 @@ class AlignedPointerIdPointsToSet {
     }
 
     bool removeAny(PSNode *target) {
-        std::vector<size_t> toRemove;
-        for (const auto &ptrID : pointers) {
-            if (idVector[ptrID - 1].target == target) {
-                toRemove.push_back(ptrID);
-            }
-        }
-
-        for (auto ptrID : toRemove) {
-            pointers.unset(ptrID);
-        }
+        // all pointers to the target have IDs in a few ranges
+        bool removed = false;
+        _table->forEachIDRange(target, [&](size_t first, size_t last) {
+            removed |= pointers.unset(first, last);
+        });
 
         bool changed = false;
         auto it = overflowSet.begin();
@@ -106,7 +112,7 @@ class AlignedPointerIdPointsToSet {
                 it++;
             }
         }
-        return changed || !toRemove.empty();
+        return changed || removed;
     }
 
     void clear() {
@@ -116,7 +122,8 @@ class AlignedPointerIdPointsToSet {
 
     bool pointsTo(const Pointer &ptr) const {
         if (isOffsetValid(ptr.offset)) {
-            return pointers.get(getPointerID(ptr));
+            auto ptrID = findPointerID(ptr);
+            return ptrID != 0 && pointers.get(ptrID);
         }
         return overflowSet.find(ptr) != overflowSet.end();
     }
@@ -131,12 +138,11 @@ class AlignedPointerIdPointsToSet {
     }
 
     bool pointsToTarget(PSNode *target) const {
-        for (const auto &kv : ids) {
-            if (kv.first.target == target && pointers.get(kv.second)) {
-                return true;
-            }
-        }
-        return dg::any_of(overflowSet, [target](const Pointer &ptr) {
+        bool found = false;
+        _table->forEachIDRange(target, [&](size_t first, size_t last) {
+            found = found || pointers.any(first, last);
+        });
+        return found || dg::any_of(overflowSet, [target](const Pointer &ptr) {
             return ptr.target == target;
         });
     }
@@ -163,6 +169,7 @@ class AlignedPointerIdPointsToSet {
     void swap(AlignedPointerIdPointsToSet &rhs) {
         pointers.swap(rhs.pointers);
         overflowSet.swap(rhs.overflowSet);
+        std::swap(_table, rhs._table);
     }
 
     size_t overflowSetSize() const { return overflowSet.size(); }
@@ -173,13 +180,15 @@ class AlignedPointerIdPointsToSet {
         typename ADT::SparseBitvector::const_iterator bitvector_it;
         typename ADT::SparseBitvector::const_iterator bitvector_end;
         typename std::set<Pointer>::const_iterator set_it;
+        const PointerIDLookupTable *table;
         bool secondContainer;
 
         const_iterator(const ADT::SparseBitvector &pointers,
-                       const std::set<Pointer> &overflow, bool end = false)
+                       const std::set<Pointer> &overflow,
+                       const PointerIDLookupTable *table, bool end = false)
                 : bitvector_it(end ? pointers.end() : pointers.begin()),
                   bitvector_end(pointers.end()),
-                  set_it(end ? overflow.end() : overflow.begin()),
+                  set_it(end ? overflow.end() : overflow.begin()), table(table),
                   secondContainer(end) {
             if (bitvector_it == bitvector_end) {
                 secondContainer = true;
@@ -207,7 +216,7 @@ class AlignedPointerIdPointsToSet {
 
         Pointer operator*() const {
             if (!secondContainer) {
-                return {idVector[*bitvector_it - 1]};
+                return {table->get(*bitvector_it)};
             }
             return *set_it;
         }
@@ -223,9 +232,9 @@ class AlignedPointerIdPointsToSet {
         friend class AlignedPointerIdPointsToSet;
     };
 
-    const_iterator begin() const { return {pointers, overflowSet}; }
+    const_iterator begin() const { return {pointers, overflowSet, _table}; }
     const_iterator end() const {
-        return {pointers, overflowSet, true /* end */};
+        return {pointers, overflowSet, _table, true /* end */};
     }
 
     friend class const_iterator;
@@ -1,127 +1,372 @@
 #ifndef DG_PTSETS_LOOKUPTABLE_H_
 #define DG_PTSETS_LOOKUPTABLE_H_
 
-#include <map>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
-#if defined(HAVE_TSL_HOPSCOTCH) || (__clang__)
-#include "dg/ADT/HashMap.h"
-#else
-#include "dg/ADT/Map.h"
-#endif
-
 #include "dg/Offset.h"
 #include "dg/PointerAnalysis/Pointer.h"
 
 namespace dg {
 
-class PointerIDLookupTable {
+///
+// Open-addressing hash table that maps pointers to their IDs.
+// The pointers are stored directly in the slots, so a lookup
+// is one hash computation and (usually) a single memory access.
+class PointerIDMap {
   public:
     using IDTy = size_t;
     using Pointer = pta::Pointer;
-    using PSNode = pta::PSNode;
-#if defined(HAVE_TSL_HOPSCOTCH) || (__clang__)
-    using PtrToIDMap = dg::HashMap<PSNode *, dg::HashMap<dg::Offset, IDTy>>;
-#else
-    // we create the lookup table statically and there is a bug in GCC
-    // that breaks statically created std::unordered_map.
-    // So if we have not Hopscotch map, use std::map instead.
-    using PtrToIDMap = dg::Map<PSNode *, dg::Map<dg::Offset, IDTy>>;
-#endif
 
-    // this will get a new ID for the pointer if not present
-    IDTy getOrCreate(const Pointer &ptr) {
-        auto res = get(ptr);
-        if (res != 0)
-            return res;
+  private:
+    struct Slot {
+        pta::PSNode *target{nullptr};
+        Offset::type offset{0};
+        IDTy id{0}; // 0 means that the slot is empty
+    };
 
-        _idToPtr.push_back(ptr);
-        res = _idToPtr.size();
-#ifndef NDEBUG
-        bool r =
-#endif
-                _ptrToID[ptr.target].put(ptr.offset, res);
+    std::vector<Slot> _slots;
+    size_t _size{0};
 
-        assert(r && "Duplicated ID!");
-        assert(get(res) == ptr);
-        assert(res == get(ptr));
-        assert(res > 0 && "ID must always be greater than 0");
-        return res;
-    }
+    size_t _mask() const { return _slots.size() - 1; }
 
-    IDTy get(const Pointer &ptr) const {
-        auto it = _ptrToID.find(ptr.target);
-        if (it == _ptrToID.end()) {
-            return 0; // invalid ID
+    void _grow() {
+        std::vector<Slot> old(_slots.empty() ? 16 : 2 * _slots.size());
+        old.swap(_slots);
+        for (const auto &slot : old) {
+            if (slot.id == 0)
+                continue;
+            size_t i = hash({slot.target, slot.offset}) & _mask();
+            while (_slots[i].id != 0)
+                i = (i + 1) & _mask();
+            _slots[i] = slot;
         }
-        auto it2 = it->second.find(ptr.offset);
-        if (it2 == it->second.end())
+    }
+
+  public:
+    static size_t hash(const Pointer &ptr) {
+        auto h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr.target));
+        h = (h ^ (h >> 4)) * 0x9e3779b97f4a7c15ULL;
+        h ^= (*ptr.offset + 0x632be59bd9b4e019ULL) * 0xc2b2ae3d27d4eb4fULL;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    // return 0 if the pointer has no ID
+    IDTy get(const Pointer &ptr, size_t h) const {
+        if (_slots.empty())
             return 0;
-        return it2->second;
+        for (size_t i = h & _mask();; i = (i + 1) & _mask()) {
+            const auto &slot = _slots[i];
+            if (slot.id == 0)
+                return 0;
+            if (slot.target == ptr.target && slot.offset == *ptr.offset)
+                return slot.id;
+        }
     }
 
-    const Pointer &get(IDTy id) const {
-        assert(id - 1 < _idToPtr.size());
-        return _idToPtr[id - 1];
+    // the pointer must not be in the map yet
+    void put(const Pointer &ptr, size_t h, IDTy id) {
+        assert(id > 0 && "ID must always be greater than 0");
+        assert(get(ptr, h) == 0 && "Duplicated ID!");
+        // keep the load factor under 1/2
+        if (2 * (_size + 1) > _slots.size())
+            _grow();
+        size_t i = h & _mask();
+        while (_slots[i].id != 0)
+            i = (i + 1) & _mask();
+        _slots[i] = {ptr.target, *ptr.offset, id};
+        ++_size;
     }
 
-  private:
-    // PSNode -> (Offset -> id)
-    // Not space efficient, but we need mainly the time efficiency here...
-    // NOTE: unfortunately, atm, we cannot use the id of the target for hashing
-    // because it would break repeated runs of the analysis
-    // as multiple graphs will contain nodes with the same id
-    // (and resetting the state is really painful, I tried that,
-    // but just didn't succeed).
-    PtrToIDMap _ptrToID;
-    std::vector<Pointer> _idToPtr; // starts from 0 (pointer = idVector[id - 1])
+    size_t size() const { return _size; }
 };
 
-/*
+///
+// Assigns IDs (1, 2, ...) to pointers for the points-to sets
+// that are represented as bitvectors of pointer IDs.
+// Every analysis owns its table (the graph has one), so the IDs
+// are not shared among analyses and the table is freed with the graph.
+//
+// The IDs are dense by default, a new pointer gets the next ID.
+// The consecutive IDs of one target form a range (see forEachIDRange()).
+// With setReserveBlocks(true), the pointers to one target (allocation)
+// get their IDs from blocks of consecutive IDs that are reserved for
+// the target. Thus the pointers to different offsets of an object share
+// the words of bitvectors and all IDs of a target are in a few ranges.
+// The blocks are reserved in the order in which the targets are seen,
+// or in the order given by reserve() (see PointerGraph::reservePointerIDs()).
+// The IDs of a block that are never used make the sets sparser, so it
+// is not the default.
+//
+// The table with one shard can be used only by one thread at a time.
+// A table with more shards is safe to use from several threads:
+// the targets are split into the shards by their hash and every shard
+// has its own lock, so the threads contend only when they hit
+// the same shard.
 class PointerIDLookupTable {
-public:
+  public:
     using IDTy = size_t;
     using Pointer = pta::Pointer;
+    using PSNode = pta::PSNode;
 
-    // this will get a new ID for the pointer if not present
-    IDTy getOrCreate(const Pointer& ptr) {
-        auto it = _ptrToID.find(ptr);
-        if (it != _ptrToID.end()) {
-            return it->second;
+  private:
+    // the first block of a target, the next blocks are twice as big
+    // up to MAX_BLOCK_SIZE IDs (the number of bits in a bitvector word)
+    static const size_t FIRST_BLOCK_SIZE = 4;
+    static const size_t MAX_BLOCK_SIZE = 64;
+    // the IDs of shard i start at (i << SHARD_SHIFT) + 1
+    static const unsigned SHARD_SHIFT = 40;
+
+    // the positions of IDs reserved for a target,
+    // the positions [ranges[i].first, ranges[i].second)
+    struct TargetIDs {
+        std::vector<std::pair<size_t, size_t>> ranges;
+        size_t next{0}; // the next free position in the last range
+    };
+
+    struct Shard {
+        PointerIDMap ptrToID;
+        std::unordered_map<const PSNode *, TargetIDs> targets;
+        // std::deque does not move the elements when growing,
+        // so the references returned from get(id) stay valid.
+        // The reserved positions that are not used yet hold Pointer().
+        std::deque<Pointer> idToPtr;
+        size_t used{0};
+        mutable std::mutex lock;
+    };
+
+    std::unique_ptr<Shard[]> _shards;
+    const unsigned _shardsNum;
+    bool _reserveBlocks{false};
+
+    static size_t _hashTarget(const PSNode *target) {
+        auto h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(target));
+        h = (h ^ (h >> 4)) * 0x9e3779b97f4a7c15ULL;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    unsigned _shardOf(const PSNode *target) const {
+        if (_shardsNum == 1)
+            return 0;
+        // all pointers to one target must be in the same shard
+        return static_cast<unsigned>(_hashTarget(target) % _shardsNum);
+    }
+
+    static IDTy _toID(unsigned idx, size_t pos) {
+        return (static_cast<IDTy>(idx) << SHARD_SHIFT) + pos + 1;
+    }
+
+    void _reserveBlock(Shard &shard, TargetIDs &ids) {
+        auto first = shard.idToPtr.size();
+        if (!_reserveBlocks) {
+            shard.idToPtr.resize(first + 1);
+            // extend the last range of the target if the ID follows it
+            if (!ids.ranges.empty() && ids.ranges.back().second == first)
+                ++ids.ranges.back().second;
+            else
+                ids.ranges.emplace_back(first, first + 1);
+            ids.next = first;
+            return;
         }
-        auto res = _ptrToID.size() + 1;
-        assert(_idToPtr.size() == res - 1);
 
-        _idToPtr.push_back(ptr);
-        _ptrToID.emplace(ptr, _ptrToID.size() + 1);
+        size_t size = FIRST_BLOCK_SIZE;
+        if (!ids.ranges.empty()) {
+            const auto &last = ids.ranges.back();
+            size = 2 * (last.second - last.first);
+            // do not pass MAX_BLOCK_SIZE to std::min, it takes a reference
+            // and the constant has no definition (before C++17)
+            if (size > MAX_BLOCK_SIZE)
+                size = MAX_BLOCK_SIZE;
+        }
+        shard.idToPtr.resize(first + size);
+        ids.ranges.emplace_back(first, first + size);
+        ids.next = first;
+    }
+
+    IDTy _getOrCreate(Shard &shard, unsigned idx, const Pointer &ptr,
+                      size_t h) {
+        auto res = shard.ptrToID.get(ptr, h);
+        if (res != 0)
+            return res;
+
+        auto &ids = shard.targets[ptr.target];
+        if (ids.ranges.empty() || ids.next == ids.ranges.back().second)
+            _reserveBlock(shard, ids);
 
-        assert(get(res) == ptr);
-        assert(res == get(ptr));
+        auto pos = ids.next++;
+        shard.idToPtr[pos] = ptr;
+        ++shard.used;
+
+        res = _toID(idx, pos);
+        shard.ptrToID.put(ptr, h, res);
         return res;
+    }
+
+    void _reserve(Shard &shard, PSNode *target) {
+        auto &ids = shard.targets[target];
+        if (ids.ranges.empty())
+            _reserveBlock(shard, ids);
+    }
+
+  public:
+    explicit PointerIDLookupTable(unsigned shards = 1)
+            : _shards(new Shard[shards == 0 ? 1 : shards]),
+              _shardsNum(shards == 0 ? 1 : shards) {
+        assert(_shardsNum < (1U << (64 - SHARD_SHIFT)) && "Too many shards");
+    }
+
+    PointerIDLookupTable(const PointerIDLookupTable &) = delete;
+    PointerIDLookupTable &operator=(const PointerIDLookupTable &) = delete;
+
+    bool isConcurrent() const { return _shardsNum > 1; }
+
+    ///
+    // Reserve blocks of IDs for targets (see above). Must be set
+    // before the table is used by several threads.
+    void setReserveBlocks(bool b) { _reserveBlocks = b; }
+    bool reservesBlocks() const { return _reserveBlocks; }
+
+    // this will get a new ID for the pointer if not present
+    IDTy getOrCreate(const Pointer &ptr) {
+        auto h = PointerIDMap::hash(ptr);
+        auto idx = _shardOf(ptr.target);
+        auto &shard = _shards[idx];
+        if (!isConcurrent())
+            return _getOrCreate(shard, idx, ptr, h);
+
+        std::lock_guard<std::mutex> guard(shard.lock);
+        return _getOrCreate(shard, idx, ptr, h);
+    }
+
+    // return 0 (invalid ID) if the pointer has no ID
+    IDTy get(const Pointer &ptr) const {
+        auto h = PointerIDMap::hash(ptr);
+        const auto &shard = _shards[_shardOf(ptr.target)];
+        if (!isConcurrent())
+            return shard.ptrToID.get(ptr, h);
 
-       //bool r = _ptrToID.put(ptr, ids.size() + 1);
-       //assert(r && "Duplicated ID!");
-       //return ids.size() + 1;
+        std::lock_guard<std::mutex> guard(shard.lock);
+        return shard.ptrToID.get(ptr, h);
     }
 
-    IDTy get(const Pointer& ptr) const {
-        auto it = _ptrToID.find(ptr);
-        if (it != _ptrToID.end()) {
-            return it->second;
+    const Pointer &get(IDTy id) const {
+        assert(id > 0 && "Invalid ID");
+        const auto &shard = _shards[id >> SHARD_SHIFT];
+        auto pos = (id & ((IDTy{1} << SHARD_SHIFT) - 1)) - 1;
+        if (!isConcurrent()) {
+            assert(pos < shard.idToPtr.size());
+            assert(shard.idToPtr[pos].target && "Unused ID");
+            return shard.idToPtr[pos];
+        }
+
+        std::lock_guard<std::mutex> guard(shard.lock);
+        assert(pos < shard.idToPtr.size());
+        assert(shard.idToPtr[pos].target && "Unused ID");
+        return shard.idToPtr[pos];
+    }
+
+    ///
+    // Reserve a block of IDs for the target if it has none yet.
+    // The targets that are reserved one after another get
+    // neighbouring IDs. Does nothing unless the table reserves blocks.
+    void reserve(PSNode *target) {
+        if (!_reserveBlocks)
+            return;
+
+        auto &shard = _shards[_shardOf(target)];
+        if (!isConcurrent()) {
+            _reserve(shard, target);
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(shard.lock);
+        _reserve(shard, target);
+    }
+
+    ///
+    // Call fun(first, last) for the ranges of IDs [first, last)
+    // that are reserved for the target. All pointers to the target
+    // have their IDs in these ranges.
+    template <typename FunT>
+    void forEachIDRange(const PSNode *target, FunT fun) const {
+        const auto idx = _shardOf(target);
+        const auto &shard = _shards[idx];
+        std::unique_lock<std::mutex> guard(shard.lock, std::defer_lock);
+        if (isConcurrent())
+            guard.lock();
+
+        auto it = shard.targets.find(target);
+        if (it == shard.targets.end())
+            return;
+        for (const auto &range : it->second.ranges)
+            fun(_toID(idx, range.first), _toID(idx, range.second));
+    }
+
+    // the number of pointers that have an ID
+    size_t size() const {
+        size_t num = 0;
+        for (unsigned i = 0; i < _shardsNum; ++i) {
+            const auto &shard = _shards[i];
+            if (!isConcurrent()) {
+                num += shard.used;
+                continue;
+            }
+
+            std::lock_guard<std::mutex> guard(shard.lock);
+            num += shard.used;
         }
-        return 0; // invalid ID
+        return num;
     }
 
-    const Pointer& get(IDTy id) const {
-        assert(id - 1 < _idToPtr.size());
-        return _idToPtr[id - 1];
+    // the number of IDs that were handed out or reserved,
+    // it is size() unless the table reserves blocks
+    size_t reserved() const {
+        size_t num = 0;
+        for (unsigned i = 0; i < _shardsNum; ++i) {
+            const auto &shard = _shards[i];
+            if (!isConcurrent()) {
+                num += shard.idToPtr.size();
+                continue;
+            }
+
+            std::lock_guard<std::mutex> guard(shard.lock);
+            num += shard.idToPtr.size();
+        }
+        return num;
     }
 
-private:
-    std::map<Pointer, IDTy> _ptrToID;
-    std::vector<Pointer> _idToPtr; //starts from 0 (pointer = idVector[id - 1])
+    ///
+    // The table used by the points-to sets that are created
+    // outside of any analysis (and by the sets created in other
+    // threads than the one that runs the analysis).
+    // It is shared by the whole process, so it is concurrent.
+    static PointerIDLookupTable &getDefault();
+
+    // The table used by the points-to sets that are created
+    // in this thread now, see Scope
+    static PointerIDLookupTable *getCurrent();
+
+    ///
+    // Make the given table current in this thread for the lifetime
+    // of the Scope object, i.e., the points-to sets created meanwhile
+    // will use this table.
+    class Scope {
+        PointerIDLookupTable *_prev;
+
+      public:
+        explicit Scope(PointerIDLookupTable &table);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
 };
-*/
 
 } // namespace dg
 
@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <map>
+#include <utility>
 #include <vector>
 
 #include "LookupTable.h"
@@ -15,21 +16,25 @@ namespace pta {
 class PSNode;
 
 class PointerIdPointsToSet {
-    static PointerIDLookupTable lookupTable;
-
 #if defined(HAVE_TSL_HOPSCOTCH) || (__clang__)
     using PointersT = ADT::SparseBitvectorHashImpl;
 #else
     using PointersT = ADT::SparseBitvector;
 #endif
     PointersT pointers;
+    // the table that assigns IDs to the pointers in this set
+    PointerIDLookupTable *_table{PointerIDLookupTable::getCurrent()};
 
     // if the pointer doesn't have ID, it's assigned one
-    static size_t getPointerID(const Pointer &ptr) {
-        return lookupTable.getOrCreate(ptr);
+    size_t getPointerID(const Pointer &ptr) const {
+        return _table->getOrCreate(ptr);
     }
 
-    static const Pointer &getPointer(size_t id) { return lookupTable.get(id); }
+    // get the ID of the pointer or 0 if it has none
+    // (and so it cannot be in any set)
+    size_t findPointerID(const Pointer &ptr) const { return _table->get(ptr); }
+
+    const Pointer &getPointer(size_t id) const { return _table->get(id); }
 
     bool addWithUnknownOffset(PSNode *node) {
         auto ptrid = getPointerID({node, Offset::UNKNOWN});
@@ -66,10 +71,24 @@ class PointerIdPointsToSet {
         return changed;
     }
 
-    bool add(const PointerIdPointsToSet &S) { return pointers.set(S.pointers); }
+    bool add(const PointerIdPointsToSet &S) {
+        if (S._table == _table)
+            return pointers.set(S.pointers);
+        // the set has no IDs yet, it can switch to the table of S
+        if (pointers.empty()) {
+            _table = S._table;
+            return pointers.set(S.pointers);
+        }
+        // the sets come from different analyses, the IDs do not match
+        bool changed = false;
+        for (const auto &ptr : S)
+            changed |= add(ptr);
+        return changed;
+    }
 
     bool remove(const Pointer &ptr) {
-        return pointers.unset(getPointerID(ptr));
+        auto ptrid = findPointerID(ptr);
+        return ptrid != 0 && pointers.unset(ptrid);
     }
 
     bool remove(PSNode *target, Offset offset) {
@@ -77,26 +96,19 @@ class PointerIdPointsToSet {
     }
 
     bool removeAny(PSNode *target) {
-        decltype(pointers) tmp;
-        tmp.reserve(pointers.size());
+        // all pointers to the target have IDs in a few ranges
         bool removed = false;
-        for (const auto &ptrID : pointers) {
-            if (lookupTable.get(ptrID).target != target) {
-                tmp.set(ptrID);
-            } else {
-                removed = true;
-            }
-        }
-
-        tmp.swap(pointers);
-
+        _table->forEachIDRange(target, [&](size_t first, size_t last) {
+            removed |= pointers.unset(first, last);
+        });
         return removed;
     }
 
     void clear() { pointers.reset(); }
 
     bool pointsTo(const Pointer &ptr) const {
-        return pointers.get(getPointerID(ptr));
+        auto ptrid = findPointerID(ptr);
+        return ptrid != 0 && pointers.get(ptrid);
     }
 
     bool mayPointTo(const Pointer &ptr) const {
@@ -109,13 +121,11 @@ class PointerIdPointsToSet {
     }
 
     bool pointsToTarget(PSNode *target) const {
-        for (auto ptrid : pointers) {
-            const auto &ptr = getPointer(ptrid);
-            if (ptr.target == target) {
-                return true;
-            }
-        }
-        return false;
+        bool found = false;
+        _table->forEachIDRange(target, [&](size_t first, size_t last) {
+            found = found || pointers.any(first, last);
+        });
+        return found;
     }
 
     bool isSingleton() const { return pointers.size() == 1; }
@@ -145,13 +155,21 @@ class PointerIdPointsToSet {
 
     size_t size() const { return pointers.size(); }
 
-    void swap(PointerIdPointsToSet &rhs) { pointers.swap(rhs.pointers); }
+    void swap(PointerIdPointsToSet &rhs) {
+        pointers.swap(rhs.pointers);
+        std::swap(_table, rhs._table);
+    }
+
+    const PointerIDLookupTable *getLookupTable() const { return _table; }
 
     class const_iterator {
         typename PointersT::const_iterator container_it;
+        const PointerIDLookupTable *table;
 
-        const_iterator(const PointersT &pointers, bool end = false)
-                : container_it(end ? pointers.end() : pointers.begin()) {}
+        const_iterator(const PointersT &pointers,
+                       const PointerIDLookupTable *table, bool end = false)
+                : container_it(end ? pointers.end() : pointers.begin()),
+                  table(table) {}
 
       public:
         const_iterator &operator++() {
@@ -165,7 +183,7 @@ class PointerIdPointsToSet {
             return tmp;
         }
 
-        Pointer operator*() const { return {lookupTable.get(*container_it)}; }
+        Pointer operator*() const { return {table->get(*container_it)}; }
 
         bool operator==(const const_iterator &rhs) const {
             return container_it == rhs.container_it;
@@ -178,8 +196,8 @@ class PointerIdPointsToSet {
         friend class PointerIdPointsToSet;
     };
 
-    const_iterator begin() const { return {pointers}; }
-    const_iterator end() const { return {pointers, true /* end */}; }
+    const_iterator begin() const { return {pointers, _table}; }
+    const_iterator end() const { return {pointers, _table, true /* end */}; }
 
     friend class const_iterator;
 };
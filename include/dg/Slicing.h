@@ -1,7 +1,12 @@
 #ifndef DG_SLICING_H_
 #define DG_SLICING_H_
 
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "dg/ADT/Queue.h"
 #include "dg/DependenceGraph.h"
@@ -126,6 +131,316 @@ class WalkAndMark
     }
 };
 
+///
+// The size of a slice before it is actually sliced: the number of nodes,
+// basic blocks and graphs (functions) that are marked as being in the slice.
+// SlicerStatistics counts what was removed, the difference is
+// what the slice keeps.
+struct SliceSize {
+    uint64_t nodes{0};
+    uint64_t blocks{0};
+    uint64_t graphs{0};
+};
+
+///
+// Mark the (backward) slices of up to N slicing criteria at once.
+// Instead of walking the graph once per criterion, every node gets
+// a bitmask whose i-th bit says that the node is in the slice of
+// the i-th criterion. The masks are OR-ed along the reverse edges
+// and a node is processed again only when its mask grows, so all
+// the slices are computed in (almost) one traversal of the graph.
+// The edges that are followed are the same as in WalkAndMark.
+template <typename NodeT, size_t N = 64>
+class BatchWalkAndMark {
+  public:
+    using MaskT = std::bitset<N>;
+    using DependenceGraphT = DependenceGraph<NodeT>;
+
+    static constexpr size_t maxCriteria() { return N; }
+
+    ///
+    // Mark the slices of the given criteria. The i-th set
+    // in 'criteria' contains the nodes of the i-th criterion.
+    void mark(const std::vector<std::set<NodeT *>> &criteria) {
+        assert(criteria.size() <= N && "Too many criteria for one batch");
+
+        for (size_t i = 0; i < criteria.size(); ++i) {
+            MaskT m;
+            m.set(i);
+            for (NodeT *nd : criteria[i])
+                propagate(nd, m);
+        }
+
+        while (!queue.empty()) {
+            NodeT *n = queue.pop();
+            auto &info = nodes[n];
+            info.queued = false;
+            // copy the mask, it may grow while we process the edges
+            // (the node is queued again in that case)
+            const MaskT m = info.mask;
+
+            markContainers(n, m);
+
+            for (auto it = n->rev_control_begin(), et = n->rev_control_end();
+                 it != et; ++it)
+                propagate(*it, m);
+            for (auto it = n->rev_data_begin(), et = n->rev_data_end();
+                 it != et; ++it)
+                propagate(*it, m);
+            for (auto it = n->user_begin(), et = n->user_end(); it != et;
+                 ++it)
+                propagate(*it, m);
+            for (auto it = n->interference_begin(),
+                      et = n->interference_end();
+                 it != et; ++it)
+                propagate(*it, m);
+            for (auto it = n->rev_interference_begin(),
+                      et = n->rev_interference_end();
+                 it != et; ++it)
+                propagate(*it, m);
+
+#ifdef ENABLE_CFG
+            // control dependencies stored in basic blocks
+            if (BBlock<NodeT> *B = n->getBBlock()) {
+                for (BBlock<NodeT> *CD : B->revControlDependence())
+                    propagate(CD->getLastNode(), m);
+            }
+#endif
+        }
+    }
+
+    // get the slices mask of a node (empty mask if it is in no slice)
+    MaskT getMask(NodeT *n) const {
+        auto it = nodes.find(n);
+        return it == nodes.end() ? MaskT() : it->second.mask;
+    }
+
+    bool inSlice(NodeT *n, size_t idx) const { return getMask(n).test(idx); }
+
+    // number of nodes in the slice of the idx-th criterion
+    size_t getSliceSize(size_t idx) const {
+        size_t num = 0;
+        for (const auto &it : nodes)
+            if (it.second.mask.test(idx))
+                ++num;
+        return num;
+    }
+
+    ///
+    // The sizes of the slices of the first 'num' criteria, computed
+    // in one pass over the marked nodes, blocks and graphs.
+    std::vector<SliceSize> getSliceSizes(size_t num) const {
+        assert(num <= N);
+        std::vector<SliceSize> sizes(num);
+        for (const auto &it : nodes)
+            for (size_t i = 0; i < num; ++i)
+                sizes[i].nodes += it.second.mask.test(i);
+#ifdef ENABLE_CFG
+        for (const auto &it : blocks)
+            for (size_t i = 0; i < num; ++i)
+                sizes[i].blocks += it.second.test(i);
+#endif
+        for (const auto &it : graphs)
+            for (size_t i = 0; i < num; ++i)
+                sizes[i].graphs += it.second.test(i);
+
+        return sizes;
+    }
+
+    // call f(node, mask) for every node that is in some slice
+    template <typename F>
+    void forEachMarked(F f) const {
+        for (const auto &it : nodes)
+            if (it.second.mask.any())
+                f(it.first, it.second.mask);
+    }
+
+    ///
+    // Set 'slice_id' to all the nodes, blocks and graphs that are
+    // in the slice of the idx-th criterion, so that the slice can be
+    // processed by the Slicer as if it was marked by WalkAndMark.
+    void setSlice(size_t idx, uint32_t slice_id) const {
+        for (const auto &it : nodes)
+            if (it.second.mask.test(idx))
+                it.first->setSlice(slice_id);
+#ifdef ENABLE_CFG
+        for (const auto &it : blocks)
+            if (it.second.test(idx))
+                it.first->setSlice(slice_id);
+#endif
+        for (const auto &it : graphs)
+            if (it.second.test(idx))
+                it.first->setSlice(slice_id);
+    }
+
+  private:
+    struct NodeInfo {
+        MaskT mask;
+        bool queued{false};
+    };
+
+    std::unordered_map<NodeT *, NodeInfo> nodes;
+#ifdef ENABLE_CFG
+    std::unordered_map<BBlock<NodeT> *, MaskT> blocks;
+#endif
+    std::unordered_map<DependenceGraphT *, MaskT> graphs;
+    dg::ADT::QueueFIFO<NodeT *> queue;
+
+    void propagate(NodeT *n, const MaskT &m) {
+        auto &info = nodes[n];
+        const MaskT newmask = info.mask | m;
+        if (newmask == info.mask)
+            return;
+
+        info.mask = newmask;
+        if (!info.queued) {
+            info.queued = true;
+            queue.push(n);
+        }
+    }
+
+    // the same as markSlice in WalkAndMark: keep the block and the
+    // graph of the node and the entry of the graph (call-sites
+    // are control dependent on it)
+    void markContainers(NodeT *n, const MaskT &m) {
+#ifdef ENABLE_CFG
+        if (BBlock<NodeT> *B = n->getBBlock())
+            blocks[B] |= m;
+#endif
+        if (DependenceGraphT *dg = n->getDG()) {
+            auto &gm = graphs[dg];
+            if ((gm | m) == gm)
+                return;
+            gm |= m;
+
+            NodeT *entry = dg->getEntry();
+            assert(entry && "No entry node in dg");
+            propagate(entry, m);
+        }
+    }
+};
+
+///
+// The overlaps of slices marked by (possibly several) BatchWalkAndMark.
+// Every slice is turned into a bit-vector over the marked nodes, so the
+// size of the intersection of two slices is a popcount of the AND
+// of their vectors and no traversal of the graph is needed.
+// The slices are numbered in the order in which they were added.
+template <typename NodeT, size_t N = 64>
+class SliceOverlaps {
+    using WordT = uint64_t;
+    static constexpr size_t WORD_BITS = 64;
+
+    // the index of a marked node in the bit-vectors
+    std::unordered_map<NodeT *, size_t> _ids;
+    // the bit-vectors of the slices, a vector may be shorter
+    // than the others (the missing words are zero)
+    std::vector<std::vector<WordT>> _slices;
+    std::vector<size_t> _sizes;
+
+    size_t getID(NodeT *n) {
+        auto it = _ids.find(n);
+        if (it != _ids.end())
+            return it->second;
+        auto id = _ids.size();
+        _ids.emplace(n, id);
+        return id;
+    }
+
+  public:
+    ///
+    // Add the slices of the first 'num' criteria of the marker.
+    void add(const BatchWalkAndMark<NodeT, N> &marker, size_t num) {
+        assert(num <= N);
+        const size_t first = _slices.size();
+        _slices.resize(first + num);
+        _sizes.resize(first + num, 0);
+
+        marker.forEachMarked([&](NodeT *n, const std::bitset<N> &mask) {
+            const size_t id = getID(n);
+            for (size_t i = 0; i < num; ++i) {
+                if (!mask.test(i))
+                    continue;
+                auto &bits = _slices[first + i];
+                if (bits.size() <= id / WORD_BITS)
+                    bits.resize(id / WORD_BITS + 1, 0);
+                bits[id / WORD_BITS] |= WordT(1) << (id % WORD_BITS);
+                ++_sizes[first + i];
+            }
+        });
+    }
+
+    size_t size() const { return _slices.size(); }
+
+    // the number of nodes in the slice
+    size_t getSliceSize(size_t idx) const {
+        assert(idx < size());
+        return _sizes[idx];
+    }
+
+    // the number of nodes that are in both slices
+    size_t getOverlap(size_t i, size_t j) const {
+        assert(i < size() && j < size());
+        const auto &a = _slices[i];
+        const auto &b = _slices[j];
+        size_t num = 0;
+        for (size_t w = 0, e = std::min(a.size(), b.size()); w < e; ++w)
+            num += std::bitset<WORD_BITS>(a[w] & b[w]).count();
+        return num;
+    }
+
+    // the Jaccard similarity of the slices (the size of the intersection
+    // divided by the size of the union), 0 if both slices are empty
+    double getSimilarity(size_t i, size_t j) const {
+        const size_t common = getOverlap(i, j);
+        const size_t all = _sizes[i] + _sizes[j] - common;
+        return all == 0 ? 0.0 : static_cast<double>(common) / all;
+    }
+
+    ///
+    // Group the slices so that the slices in a group have the similarity
+    // at least 'threshold' with the first (the largest) slice
+    // of the group. The slices are taken from the largest one and
+    // a slice joins the group with the most similar first slice
+    // (or starts a new group). Empty slices are never grouped.
+    // The groups are sorted by their smallest index, the indices
+    // in a group are sorted too.
+    std::vector<std::vector<size_t>> group(double threshold) const {
+        std::vector<size_t> order(size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(),
+                         [this](size_t a, size_t b) {
+                             return _sizes[a] > _sizes[b];
+                         });
+
+        std::vector<std::vector<size_t>> groups;
+        for (size_t idx : order) {
+            std::vector<size_t> *best = nullptr;
+            double bestSim = 0.0;
+            if (_sizes[idx] > 0) {
+                for (auto &grp : groups) {
+                    const double sim = getSimilarity(grp[0], idx);
+                    if (sim >= threshold && sim > bestSim) {
+                        best = &grp;
+                        bestSim = sim;
+                    }
+                }
+            }
+
+            if (best)
+                best->push_back(idx);
+            else
+                groups.push_back({idx});
+        }
+
+        for (auto &grp : groups)
+            std::sort(grp.begin(), grp.end());
+        std::sort(groups.begin(), groups.end());
+        return groups;
+    }
+};
+
 struct SlicerStatistics {
     SlicerStatistics() = default;
 
@@ -1,6 +1,8 @@
 #ifndef DG_LEGACY_NODES_WALK_H_
 #define DG_LEGACY_NODES_WALK_H_
 
+#include <atomic>
+
 #include "dg/DGParameters.h"
 #include "dg/legacy/Analysis.h"
 
@@ -42,13 +44,15 @@ class NodesWalkBase : public Analysis<NodeT> {
   protected:
     // this counter will increase each time we run
     // NodesWalk, so it can be used as an indicator
-    // that we queued a node in a particular run or not
-    static unsigned int walk_run_counter;
+    // that we queued a node in a particular run or not.
+    // It is atomic, so that walks of different graphs on different
+    // threads get different ids
+    static std::atomic<unsigned int> walk_run_counter;
 };
 
 // counter definition
 template <typename NodeT>
-unsigned int NodesWalkBase<NodeT>::walk_run_counter = 0;
+std::atomic<unsigned int> NodesWalkBase<NodeT>::walk_run_counter{0};
 
 template <typename NodeT, typename QueueT>
 class NodesWalk : public NodesWalkBase<NodeT> {
@@ -247,12 +251,13 @@ class BBlockWalkBase : public BBlockAnalysis<NodeT> {
     // this counter will increase each time we run
     // NodesWalk, so it can be used as an indicator
     // that we queued a node in a particular run or not
-    static unsigned int walk_run_counter;
+    // (atomic for the same reason as in NodesWalkBase)
+    static std::atomic<unsigned int> walk_run_counter;
 };
 
 // counter definition
 template <typename NodeT>
-unsigned int BBlockWalkBase<NodeT>::walk_run_counter = 0;
+std::atomic<unsigned int> BBlockWalkBase<NodeT>::walk_run_counter{0};
 
 #ifdef ENABLE_CFG
 template <typename NodeT, typename QueueT>
@@ -1,6 +1,7 @@
 #ifndef DG_LLVM_CALLGRAPH_H_
 #define DG_LLVM_CALLGRAPH_H_
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -566,8 +567,398 @@ class LazyLLVMCallGraph : public CallGraphImpl {
     }
 };
 
+///
+/// \brief The CallGraphCSR class
+///
+/// A frozen call graph for the analyses that traverse the call graph many
+/// times. The functions are numbered densely (0 ... size() - 1) and the
+/// callees, callers, call-sites and the functions called by every call-site
+/// are packed into arrays (compressed sparse rows), so the analyses can keep
+/// their data in plain vectors indexed by the IDs of functions.
+/// The graph is also condensed into strongly connected components that are
+/// numbered in the bottom-up order: a function calls only functions from its
+/// own SCC or from SCCs with smaller numbers.
+///
+/// With pointer analysis, the graph contains the functions reachable from
+/// the entry function and calls via function pointers are resolved using the
+/// pointer analysis. Without it, the graph contains all defined functions and
+/// a call via a function pointer may call any compatible function that has
+/// its address taken (like in LazyLLVMCallGraph). Called declarations are
+/// in the graph too (they just do not call anything).
+/// The graph must be built again if the module changes.
+class CallGraphCSR : public CallGraphImpl {
+  public:
+    using FunID = unsigned;
+    using FuncVec = CallGraphImpl::FuncVec;
+
+    template <typename T>
+    struct Range {
+        const T *_begin;
+        const T *_end;
+
+        const T *begin() const { return _begin; }
+        const T *end() const { return _end; }
+        size_t size() const { return _end - _begin; }
+        bool empty() const { return _begin == _end; }
+    };
+
+  private:
+    const llvm::Module *_module;
+    LLVMPointerAnalysis *_pta;
+
+    std::vector<const llvm::Function *> _funs;
+    dg::HashMap<const llvm::Function *, FunID> _ids;
+
+    // offsets[id] is the start of the data of the function 'id',
+    // the data end at offsets[id + 1]
+    std::vector<unsigned> _calleeOffsets;
+    std::vector<FunID> _callees;
+    std::vector<unsigned> _callerOffsets;
+    std::vector<FunID> _callers;
+    // call-sites in the functions and the calls of the functions
+    std::vector<unsigned> _callSiteOffsets;
+    std::vector<const llvm::CallInst *> _callSites;
+    std::vector<unsigned> _callsOfOffsets;
+    std::vector<const llvm::CallInst *> _callsOf;
+    // functions called by the call-sites (indexed by the position
+    // of the call-site in _callSites)
+    dg::HashMap<const llvm::CallInst *, unsigned> _callSiteIdx;
+    std::vector<unsigned> _targetOffsets;
+    std::vector<const llvm::Function *> _targets;
+
+    // SCCs, the members of SCC 'scc' are
+    // _bottomUp[_sccOffsets[scc] ... _sccOffsets[scc + 1]]
+    std::vector<unsigned> _scc;
+    std::vector<unsigned> _sccOffsets;
+    std::vector<bool> _recursive;
+    std::vector<FunID> _bottomUp;
+    std::vector<FunID> _topDown;
+
+    std::vector<const llvm::Function *> _addressTaken;
+    bool _addressTakenInitialized{false};
+
+    template <typename T>
+    static Range<T> _range(const std::vector<unsigned> &offsets,
+                           const std::vector<T> &data, unsigned idx) {
+        return {data.data() + offsets[idx], data.data() + offsets[idx + 1]};
+    }
+
+    FunID _getOrCreateID(const llvm::Function *F) {
+        auto it = _ids.emplace(F, static_cast<FunID>(_funs.size()));
+        if (it.second)
+            _funs.push_back(F);
+        return it.first->second;
+    }
+
+    const FuncVec &_getAddressTaken() {
+        if (!_addressTakenInitialized) {
+            _addressTakenInitialized = true;
+            for (const auto &F : *_module) {
+                if (!F.isDeclaration() && funHasAddressTaken(&F))
+                    _addressTaken.push_back(&F);
+            }
+        }
+        return _addressTaken;
+    }
+
+    void _resolve(const llvm::CallInst *C, FuncVec &ret) {
+#if LLVM_VERSION_MAJOR >= 8
+        const auto *val = C->getCalledOperand()->stripPointerCasts();
+#else
+        const auto *val = C->getCalledValue()->stripPointerCasts();
+#endif
+        if (const auto *F = llvm::dyn_cast<llvm::Function>(val)) {
+            ret.push_back(F);
+            return;
+        }
+
+        if (_pta) {
+            for (const auto &ptr : _pta->getLLVMPointsTo(val)) {
+                const auto *F = llvm::dyn_cast<llvm::Function>(ptr.value);
+                if (F && callIsCompatible(F, C))
+                    ret.push_back(F);
+            }
+        } else {
+            for (const auto *F : _getAddressTaken()) {
+                if (callIsCompatible(F, C))
+                    ret.push_back(F);
+            }
+        }
+
+        std::sort(ret.begin(), ret.end());
+        ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+    }
+
+    // find the functions and the call-sites, the functions are processed
+    // in the order of their IDs, so every function that we find
+    // is processed later in the loop
+    void _buildCallSites() {
+        if (_pta) {
+            const auto *entry =
+                    _module->getFunction(_pta->getOptions().entryFunction);
+            assert(entry && "Entry function not found");
+            _getOrCreateID(entry);
+        } else {
+            for (const auto &F : *_module) {
+                if (!F.isDeclaration())
+                    _getOrCreateID(&F);
+            }
+        }
+
+        _callSiteOffsets.push_back(0);
+        _targetOffsets.push_back(0);
+        FuncVec targets;
+        for (FunID id = 0; id < _funs.size(); ++id) {
+            for (const auto &B : *_funs[id]) {
+                for (const auto &I : B) {
+                    const auto *C = llvm::dyn_cast<llvm::CallInst>(&I);
+                    if (!C)
+                        continue;
+
+                    targets.clear();
+                    _resolve(C, targets);
+                    _callSiteIdx.emplace(C, _callSites.size());
+                    _callSites.push_back(C);
+                    for (const auto *F : targets) {
+                        _getOrCreateID(F);
+                        _targets.push_back(F);
+                    }
+                    _targetOffsets.push_back(_targets.size());
+                }
+            }
+            _callSiteOffsets.push_back(_callSites.size());
+        }
+    }
+
+    void _buildEdges() {
+        const auto n = size();
+        std::vector<unsigned> callersNum(n + 1, 0);
+        std::vector<unsigned> callsOfNum(n + 1, 0);
+
+        _calleeOffsets.reserve(n + 1);
+        _calleeOffsets.push_back(0);
+        for (FunID id = 0; id < n; ++id) {
+            auto start = _callees.size();
+            for (auto c = _callSiteOffsets[id]; c < _callSiteOffsets[id + 1];
+                 ++c) {
+                for (const auto *F : _range(_targetOffsets, _targets, c)) {
+                    auto callee = _ids.find(F)->second;
+                    _callees.push_back(callee);
+                    ++callsOfNum[callee + 1];
+                }
+            }
+            std::sort(_callees.begin() + start, _callees.end());
+            _callees.erase(
+                    std::unique(_callees.begin() + start, _callees.end()),
+                    _callees.end());
+            for (auto i = start; i < _callees.size(); ++i)
+                ++callersNum[_callees[i] + 1];
+            _calleeOffsets.push_back(_callees.size());
+        }
+
+        // the reverse edges, callers are sorted by their IDs
+        for (FunID id = 0; id < n; ++id) {
+            callersNum[id + 1] += callersNum[id];
+            callsOfNum[id + 1] += callsOfNum[id];
+        }
+        _callerOffsets = callersNum;
+        _callsOfOffsets = callsOfNum;
+        _callers.resize(_callees.size());
+        _callsOf.resize(_targets.size());
+        for (FunID id = 0; id < n; ++id) {
+            for (auto callee : callees(id))
+                _callers[callersNum[callee]++] = id;
+        }
+        for (unsigned c = 0; c < _callSites.size(); ++c) {
+            for (const auto *F : _range(_targetOffsets, _targets, c))
+                _callsOf[callsOfNum[_ids.find(F)->second]++] = _callSites[c];
+        }
+    }
+
+    // Tarjan's algorithm (without recursion, the call graphs may be deep).
+    // It finishes an SCC only after all SCCs reachable from it are finished,
+    // so the SCCs get numbered in the bottom-up order.
+    void _computeSCCs() {
+        const auto n = size();
+        const unsigned unvisited = ~0U;
+        std::vector<unsigned> index(n, unvisited);
+        std::vector<unsigned> lowlink(n, 0);
+        std::vector<bool> onStack(n, false);
+        std::vector<FunID> stack;
+        // the DFS stack: (function, the position of the next callee)
+        std::vector<std::pair<FunID, unsigned>> dfs;
+        unsigned nextIndex = 0;
+
+        _scc.resize(n);
+        _bottomUp.reserve(n);
+        _sccOffsets.push_back(0);
+
+        auto visit = [&](FunID id) {
+            index[id] = lowlink[id] = nextIndex++;
+            stack.push_back(id);
+            onStack[id] = true;
+            dfs.emplace_back(id, _calleeOffsets[id]);
+        };
+
+        for (FunID root = 0; root < n; ++root) {
+            if (index[root] != unvisited)
+                continue;
+
+            visit(root);
+            while (!dfs.empty()) {
+                auto id = dfs.back().first;
+                auto &next = dfs.back().second;
+                if (next < _calleeOffsets[id + 1]) {
+                    auto callee = _callees[next++];
+                    if (index[callee] == unvisited) {
+                        visit(callee);
+                    } else if (onStack[callee]) {
+                        lowlink[id] = std::min(lowlink[id], index[callee]);
+                    }
+                    continue;
+                }
+
+                dfs.pop_back();
+                if (!dfs.empty()) {
+                    auto caller = dfs.back().first;
+                    lowlink[caller] = std::min(lowlink[caller], lowlink[id]);
+                }
+
+                if (lowlink[id] != index[id])
+                    continue;
+
+                auto scc = static_cast<unsigned>(_sccOffsets.size() - 1);
+                auto start = _bottomUp.size();
+                FunID member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = false;
+                    _scc[member] = scc;
+                    _bottomUp.push_back(member);
+                } while (member != id);
+                std::sort(_bottomUp.begin() + start, _bottomUp.end());
+                _sccOffsets.push_back(_bottomUp.size());
+                _recursive.push_back(_bottomUp.size() - start > 1 ||
+                                     calls(id, id));
+            }
+        }
+
+        _topDown.assign(_bottomUp.rbegin(), _bottomUp.rend());
+    }
+
+  public:
+    CallGraphCSR(const llvm::Module *m, LLVMPointerAnalysis *pta = nullptr)
+            : _module(m), _pta(pta) {
+        _buildCallSites();
+        _buildEdges();
+        _computeSCCs();
+    }
+
+    // the number of functions, their IDs are 0 ... size() - 1
+    size_t size() const { return _funs.size(); }
+
+    bool hasFunction(const llvm::Function *F) const {
+        return _ids.find(F) != _ids.end();
+    }
+
+    FunID getID(const llvm::Function *F) const {
+        auto it = _ids.find(F);
+        assert(it != _ids.end() && "Function is not in the call graph");
+        return it->second;
+    }
+
+    const llvm::Function *getFunction(FunID id) const {
+        assert(id < size());
+        return _funs[id];
+    }
+
+    Range<FunID> callees(FunID id) const {
+        assert(id < size());
+        return _range(_calleeOffsets, _callees, id);
+    }
+
+    Range<FunID> callers(FunID id) const {
+        assert(id < size());
+        return _range(_callerOffsets, _callers, id);
+    }
+
+    bool calls(FunID id, FunID what) const {
+        auto cs = callees(id);
+        return std::binary_search(cs.begin(), cs.end(), what);
+    }
+
+    // the call-sites in the function
+    Range<const llvm::CallInst *> callSites(FunID id) const {
+        assert(id < size());
+        return _range(_callSiteOffsets, _callSites, id);
+    }
+
+    // the call-sites that may call the function
+    Range<const llvm::CallInst *> getCallsOf(FunID id) const {
+        assert(id < size());
+        return _range(_callsOfOffsets, _callsOf, id);
+    }
+
+    // the functions that may be called by the call-site, empty
+    // if the call-site is not in any function of the graph
+    Range<const llvm::Function *>
+    getCalledFunctions(const llvm::CallInst *C) const {
+        auto it = _callSiteIdx.find(C);
+        if (it == _callSiteIdx.end())
+            return {nullptr, nullptr};
+        return _range(_targetOffsets, _targets, it->second);
+    }
+
+    /// SCCs of the call graph, numbered 0 ... sccsNum() - 1
+    /// in the bottom-up order
+    size_t sccsNum() const { return _sccOffsets.size() - 1; }
+    unsigned getSCC(FunID id) const { return _scc[id]; }
+    Range<FunID> sccMembers(unsigned scc) const {
+        return _range(_sccOffsets, _bottomUp, scc);
+    }
+    // does the SCC contain a recursive call?
+    bool isRecursive(unsigned scc) const { return _recursive[scc]; }
+
+    // the functions ordered so that the callees precede their callers
+    // (except for the callees from the same SCC)
+    const std::vector<FunID> &bottomUp() const { return _bottomUp; }
+    // the functions ordered so that the callers precede their callees
+    // (except for the callers from the same SCC)
+    const std::vector<FunID> &topDown() const { return _topDown; }
+
+    FuncVec functions() const override { return _funs; }
+
+    FuncVec callers(const llvm::Function *F) override {
+        FuncVec ret;
+        if (hasFunction(F)) {
+            for (auto id : callers(getID(F)))
+                ret.push_back(_funs[id]);
+        }
+        return ret;
+    }
+
+    FuncVec callees(const llvm::Function *F) override {
+        FuncVec ret;
+        if (hasFunction(F)) {
+            for (auto id : callees(getID(F)))
+                ret.push_back(_funs[id]);
+        }
+        return ret;
+    }
+
+    bool calls(const llvm::Function *F, const llvm::Function *what) override {
+        return hasFunction(F) && hasFunction(what) &&
+               calls(getID(F), getID(what));
+    }
+};
+
 class CallGraph {
     std::unique_ptr<CallGraphImpl> _impl;
+    // set if this is a frozen call graph
+    const CallGraphCSR *_frozen{nullptr};
+
+    CallGraph(CallGraphCSR *cg) : _impl(cg), _frozen(cg) {}
 
   public:
     using FuncVec = CallGraphImpl::FuncVec;
@@ -581,6 +972,19 @@ class CallGraph {
                                    new LLVMPTACallGraphImpl(m, pta))) {}
     CallGraph(const llvm::Module *m) : _impl(new LazyLLVMCallGraph(m)) {}
 
+    ///
+    /// Build the frozen call graph (see CallGraphCSR) at once
+    ///
+    static CallGraph frozen(const llvm::Module *m,
+                            LLVMPointerAnalysis *pta = nullptr) {
+        return CallGraph(new CallGraphCSR(m, pta));
+    }
+
+    ///
+    /// Get the frozen call graph or nullptr if this call graph is not frozen
+    ///
+    const CallGraphCSR *getFrozen() const { return _frozen; }
+
     ///
     /// Get all functions in this call graph
     ///
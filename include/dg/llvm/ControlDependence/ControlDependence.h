@@ -89,6 +89,13 @@ class LLVMControlDependenceAnalysis {
             _interprocImpl->compute(F);
     }
 
+    // Compute control dependencies for the given functions beforehand
+    // (in parallel if the options allow it). The interprocedural
+    // dependencies are still computed on demand.
+    void computeFunctions(const std::vector<const llvm::Function *> &funs) {
+        _impl->computeFunctions(funs);
+    }
+
     ValVec getDependencies(const llvm::Instruction *v) {
         return _getDependencies(v);
     }
@@ -3,6 +3,7 @@
 
 #include <set>
 #include <utility>
+#include <vector>
 
 #include "dg/llvm/ControlDependence/LLVMControlDependenceAnalysisOptions.h"
 
@@ -50,6 +51,15 @@ class LLVMControlDependenceAnalysisImpl {
     //  on demand)
     virtual void compute(const llvm::Function *F = nullptr) = 0;
 
+    // Eagerly compute control dependencies for the given functions.
+    // The analyses that compute the functions independently of each
+    // other run the computation on getOptions().jobs() threads.
+    virtual void
+    computeFunctions(const std::vector<const llvm::Function *> &funs) {
+        for (const auto *F : funs)
+            compute(F);
+    }
+
     /// Getters of dependencies for a value
     virtual ValVec getDependencies(const llvm::Instruction *) = 0;
     virtual ValVec getDependent(const llvm::Instruction *) = 0;
@@ -10,10 +10,15 @@ struct LLVMControlDependenceAnalysisOptions : public LLVMAnalysisOptions,
                                               ControlDependenceAnalysisOptions {
     bool _nodePerInstruction{false};
     bool _icfg{false};
+    // the number of threads that compute dependencies of different
+    // functions in parallel (0 = the number of hardware threads)
+    unsigned _jobs{1};
 
     void setNodePerInstruction(bool b) { _nodePerInstruction = b; }
     bool nodePerInstruction() const { return _nodePerInstruction; }
     bool ICFG() const { return _icfg; }
+    void setJobs(unsigned j) { _jobs = j; }
+    unsigned jobs() const { return _jobs; }
 };
 
 } // namespace dg
@@ -60,6 +60,7 @@ class LLVMDataDependenceAnalysis {
     }
 
     ReadWriteGraph *getGraph() { return DDA->getGraph(); }
+    size_t getNumOfPhis() const { return DDA ? DDA->getNumOfPhis() : 0; }
     RWNode *getNode(const llvm::Value *val);
     const RWNode *getNode(const llvm::Value *val) const;
     const llvm::Value *getValue(const RWNode *node) const;
@@ -173,8 +173,8 @@ class LLVMDG2Dot : public debug::DG2Dot<LLVMNode> {
         if (!ensureFile(new_file))
             return false;
 
-        const std::map<llvm::Value *, LLVMDependenceGraph *> &CF =
-                getConstructedFunctions();
+        const auto &CF = static_cast<LLVMDependenceGraph *>(getDG())
+                                 ->getConstructedFunctions();
 
         start();
 
@@ -232,8 +232,8 @@ class LLVMDGDumpBlocks : public debug::DG2Dot<LLVMNode> {
         if (!ensureFile(new_file))
             return false;
 
-        const std::map<llvm::Value *, LLVMDependenceGraph *> &CF =
-                getConstructedFunctions();
+        const auto &CF = static_cast<LLVMDependenceGraph *>(getDG())
+                                 ->getConstructedFunctions();
 
         start();
 
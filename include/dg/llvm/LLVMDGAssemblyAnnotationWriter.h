@@ -43,11 +43,20 @@ class LLVMDGAssemblyAnnotationWriter : public llvm::AssemblyAnnotationWriter {
     };
 
   private:
+    const LLVMDependenceGraph *dg;
     AnnotationOptsT opts;
     LLVMPointerAnalysis *PTA;
     LLVMDataDependenceAnalysis *DDA;
     const std::set<LLVMNode *> *criteria;
     std::string module_comment{};
+    bool module_comment_emitted{false};
+
+    // the graph of the function (nullptr if it was not constructed)
+    LLVMDependenceGraph *getFunctionGraph(const llvm::Function *F) const {
+        const auto &CF = dg->getConstructedFunctions();
+        auto it = CF.find(const_cast<llvm::Function *>(F));
+        return it == CF.end() ? nullptr : it->second;
+    }
 
     static void printValue(const llvm::Value *val,
                            llvm::formatted_raw_ostream &os, bool nl = false) {
@@ -243,11 +252,11 @@ class LLVMDGAssemblyAnnotationWriter : public llvm::AssemblyAnnotationWriter {
 
   public:
     LLVMDGAssemblyAnnotationWriter(
-            AnnotationOptsT o = ANNOTATE_SLICE,
+            const LLVMDependenceGraph *dg, AnnotationOptsT o = ANNOTATE_SLICE,
             LLVMPointerAnalysis *pta = nullptr,
             LLVMDataDependenceAnalysis *dda = nullptr,
             const std::set<LLVMNode *> *criteria = nullptr)
-            : opts(o), PTA(pta), DDA(dda), criteria(criteria) {
+            : dg(dg), opts(o), PTA(pta), DDA(dda), criteria(criteria) {
         assert(!(opts & ANNOTATE_PTR) || PTA);
         assert(!(opts & ANNOTATE_DEF) || DDA);
     }
@@ -264,9 +273,8 @@ class LLVMDGAssemblyAnnotationWriter : public llvm::AssemblyAnnotationWriter {
                            llvm::formatted_raw_ostream &os) override {
         // dump the slicer's setting to the file
         // for easier comprehension
-        static bool didit = false;
-        if (!didit) {
-            didit = true;
+        if (!module_comment_emitted) {
+            module_comment_emitted = true;
             os << module_comment;
         }
     }
@@ -276,13 +284,11 @@ class LLVMDGAssemblyAnnotationWriter : public llvm::AssemblyAnnotationWriter {
         if (opts == 0)
             return;
 
+        // look only into the graph of the function, searching all
+        // the graphs for every instruction is quadratic
         LLVMNode *node = nullptr;
-        for (const auto &it : getConstructedFunctions()) {
-            LLVMDependenceGraph *sub = it.second;
+        if (auto *sub = getFunctionGraph(I->getParent()->getParent()))
             node = sub->getNode(const_cast<llvm::Instruction *>(I));
-            if (node)
-                break;
-        }
 
         if (!node) {
             if (opts & ANNOTATE_SLICE)
@@ -298,8 +304,7 @@ class LLVMDGAssemblyAnnotationWriter : public llvm::AssemblyAnnotationWriter {
         if (opts == 0)
             return;
 
-        for (const auto &it : getConstructedFunctions()) {
-            LLVMDependenceGraph *sub = it.second;
+        if (auto *sub = getFunctionGraph(B->getParent())) {
             auto &cb = sub->getBlocks();
             auto I = cb.find(const_cast<llvm::BasicBlock *>(B));
             if (I != cb.end()) {
@@ -0,0 +1,247 @@
+#ifndef LLVM_DG_BINARY_H_
+#define LLVM_DG_BINARY_H_
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace llvm {
+class Module;
+class Value;
+} // namespace llvm
+
+namespace dg {
+
+class LLVMDependenceGraph;
+
+namespace llvmdg {
+
+///
+// Dense numbering of the values of a module that the nodes of a dependence
+// graph may refer to: global variables, functions and then the arguments
+// and instructions of every defined function (all in the order in which
+// they are in the module). The same module gives always the same numbering,
+// so the numbers can be stored in a file instead of pointers.
+// The hash summarizes the shape of the module (the kinds of the values),
+// it is used to check that a stored graph belongs to the module.
+class ModuleValueNumbering {
+    std::vector<const llvm::Value *> _values;
+    std::unordered_map<const llvm::Value *, uint32_t> _ids;
+    uint32_t _hash{2166136261U};
+
+  public:
+    static const uint32_t NONE = ~static_cast<uint32_t>(0);
+
+    ModuleValueNumbering(const llvm::Module &M);
+
+    size_t size() const { return _values.size(); }
+    uint32_t getHash() const { return _hash; }
+
+    // NONE if the value is not numbered (e.g., a constant)
+    uint32_t getID(const llvm::Value *val) const {
+        auto it = _ids.find(val);
+        return it == _ids.end() ? NONE : it->second;
+    }
+
+    const llvm::Value *getValue(uint32_t id) const {
+        assert(id < size());
+        return _values[id];
+    }
+};
+
+namespace dgbin {
+
+// The binary format of a dependence graph. All numbers are 32-bit in the
+// byte order of the machine that wrote the file (the file has a marker
+// to detect the other byte order). The file starts with the Header that
+// contains offsets of the other sections:
+//
+//  - the array of Node records (Header::nodesNum records),
+//  - for every kind of edges two sections with compressed sparse rows:
+//    the dependencies of nodes (the nodes that a node depends on)
+//    and the dependent nodes. A section is an array of nodesNum + 1 offsets
+//    followed by the array of node IDs (sorted for every node), the edges
+//    of the node 'n' are targets[offsets[n] ... offsets[n + 1]].
+//
+// The sections are aligned to 8 bytes, so the file can be used
+// right from the memory (see MappedLLVMDependenceGraph).
+
+static const char MAGIC[8] = {'D', 'G', 'L', 'L', 'V', 'M', 'D', 'G'};
+static const uint32_t VERSION = 1;
+static const uint32_t ORDER_MARK = 0x01020304;
+
+enum EdgeKind : uint32_t {
+    USE = 0,
+    MEMORY,
+    CONTROL,
+    INTERFERENCE,
+    SUMMARY,
+    EDGE_KINDS_NUM
+};
+
+enum NodeKind : uint32_t {
+    INSTRUCTION = 0,
+    ARGUMENT,
+    GLOBAL,
+    FUNCTION_ENTRY,
+    FUNCTION_EXIT,
+    FORMAL_IN,
+    FORMAL_OUT,
+    ACTUAL_IN,
+    ACTUAL_OUT,
+    FORMAL_NORETURN,
+    ACTUAL_NORETURN,
+    // a node without a value in the module
+    ARTIFICIAL
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nodesNum;
+    // the size and hash of ModuleValueNumbering of the module
+    uint32_t valuesNum;
+    uint32_t moduleHash;
+    uint32_t reserved;
+    uint64_t fileSize;
+    uint64_t nodesOffset;
+    // offsets of the sections with dependencies [0]
+    // and dependent nodes [1] for every kind of edges
+    uint64_t edgesOffset[EDGE_KINDS_NUM][2];
+};
+
+struct Node {
+    uint32_t kind;
+    // the value of the node in ModuleValueNumbering (or NONE).
+    // For parameters, it is the value that the parameter represents
+    uint32_t value;
+    // the ID of the entry node of the function that contains the node
+    // (or NONE), the slices that contain the node contain also the entry
+    uint32_t entry;
+    // the value of the call instruction for actual parameters (or NONE)
+    uint32_t callSite;
+};
+
+} // namespace dgbin
+
+///
+// Store the dependence graph (all the graphs of the constructed functions)
+// in the binary format. The USE, MEMORY and INTERFERENCE edges are the
+// use, data and interference dependencies of the nodes. The CONTROL edges
+// are the control dependencies of nodes together with the control
+// dependencies of basic blocks (every node of a block depends on the last
+// nodes of the blocks that the block depends on). The graph has no summary
+// edges, so the SUMMARY sections are empty.
+// Returns false and sets 'error' on failure.
+bool writeLLVMDependenceGraph(LLVMDependenceGraph &dg, const llvm::Module &M,
+                              const std::string &path, std::string &error);
+
+///
+// A dependence graph stored in the binary format and mapped to the memory.
+// Opening the graph checks all the sections in one linear pass (the file
+// is rejected if it refers to nodes or values that do not exist), then
+// the edges are read right from the mapped file. The nodes can be
+// re-associated with the values of the module that the graph was built
+// for by attach().
+class MappedLLVMDependenceGraph {
+  public:
+    using NodeID = uint32_t;
+
+    struct Range {
+        const NodeID *_begin;
+        const NodeID *_end;
+
+        const NodeID *begin() const { return _begin; }
+        const NodeID *end() const { return _end; }
+        size_t size() const { return _end - _begin; }
+        bool empty() const { return _begin == _end; }
+    };
+
+  private:
+    void *_data{nullptr};
+    size_t _size{0};
+    const dgbin::Header *_header{nullptr};
+    const dgbin::Node *_nodes{nullptr};
+
+    std::unique_ptr<ModuleValueNumbering> _numbering{};
+    // the node of every value (for the values that have a node,
+    // formal parameters are not taken into account)
+    std::unordered_map<const llvm::Value *, NodeID> _valueNodes;
+
+    MappedLLVMDependenceGraph() = default;
+
+    const uint32_t *_section(dgbin::EdgeKind kind, unsigned dir) const {
+        return reinterpret_cast<const uint32_t *>(
+                static_cast<const char *>(_data) +
+                _header->edgesOffset[kind][dir]);
+    }
+
+    Range _range(dgbin::EdgeKind kind, unsigned dir, NodeID id) const {
+        assert(id < size());
+        const auto *offsets = _section(kind, dir);
+        const auto *targets = offsets + size() + 1;
+        return {targets + offsets[id], targets + offsets[id + 1]};
+    }
+
+  public:
+    ~MappedLLVMDependenceGraph();
+
+    MappedLLVMDependenceGraph(const MappedLLVMDependenceGraph &) = delete;
+    MappedLLVMDependenceGraph &
+    operator=(const MappedLLVMDependenceGraph &) = delete;
+
+    // map and check the file, returns nullptr and sets 'error' on failure
+    static std::unique_ptr<MappedLLVMDependenceGraph>
+    open(const std::string &path, std::string &error);
+
+    size_t size() const { return _header->nodesNum; }
+    size_t edgesNum(dgbin::EdgeKind kind) const {
+        return _section(kind, 0)[size()];
+    }
+
+    const dgbin::Node &getNode(NodeID id) const {
+        assert(id < size());
+        return _nodes[id];
+    }
+
+    // the nodes that the node 'id' depends on
+    Range dependencies(NodeID id, dgbin::EdgeKind kind) const {
+        return _range(kind, 0, id);
+    }
+
+    // the nodes that depend on the node 'id'
+    Range dependent(NodeID id, dgbin::EdgeKind kind) const {
+        return _range(kind, 1, id);
+    }
+
+    ///
+    // Re-associate the nodes with the values of the module
+    // (that is, number the values of the module). Returns false
+    // if the graph was built for a different module.
+    bool attach(const llvm::Module &M);
+
+    // the value of the node or nullptr (must be attached)
+    const llvm::Value *getValue(NodeID id) const;
+    // the node of the value or NONE (must be attached)
+    NodeID getNodeID(const llvm::Value *val) const {
+        auto it = _valueNodes.find(val);
+        return it == _valueNodes.end() ? ModuleValueNumbering::NONE
+                                       : it->second;
+    }
+
+    ///
+    // Compute the backward slice of the given nodes, following the same
+    // edges as the slicer: the dependencies of all kinds, the interference
+    // edges in both directions and the entry nodes of functions.
+    // Returns the membership of every node in the slice.
+    std::vector<bool> backwardSlice(const std::vector<NodeID> &start) const;
+};
+
+} // namespace llvmdg
+} // namespace dg
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef DG_LLVMDG_DOT_WRITER_H_
+#define DG_LLVMDG_DOT_WRITER_H_
+
+#include <functional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/DG2Dot.h"
+#include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/LLVMNode.h"
+
+namespace llvm {
+class Function;
+class raw_ostream;
+} // namespace llvm
+
+namespace dg {
+
+namespace llvmdg {
+class ModuleValueNumbering;
+} // namespace llvmdg
+
+namespace debug {
+
+///
+// Write the dependence graph to graphviz format without building
+// the whole output in the memory. Unlike LLVMDG2Dot, the graph is written
+// function by function: the text of every function (a chunk with its
+// nodes, blocks and the edges from its nodes) is generated separately,
+// so the chunks can be generated in parallel and only a few of them
+// are in the memory at once. The chunks are written in the order
+// of the module and the nodes are named by their order in the module,
+// so the output does not depend on the number of threads (or addresses).
+//
+//   LLVMDGDotWriter::Options opts;
+//   opts.onlySlice = true;
+//   opts.threads = 4;
+//   LLVMDGDotWriter writer(dg, opts);
+//   writer.write(out);
+//
+class LLVMDGDotWriter {
+  public:
+    struct Options {
+        // what edges to print (dg2dot_options), PRINT_CFG prints
+        // also the basic blocks as clusters
+        uint32_t edges{PRINT_CFG | PRINT_DD | PRINT_CD | PRINT_USE |
+                       PRINT_ID};
+        // print only the nodes that are in a slice
+        bool onlySlice{false};
+        // print only these functions (all functions if empty)
+        std::set<std::string> functions{};
+        // print only the nodes for which this returns true (if set)
+        std::function<bool(const LLVMNode *)> nodeFilter{};
+        // the number of threads that generate the chunks
+        unsigned threads{1};
+        // the number of chunks that are generated before they
+        // are written out (0 means 4 chunks per thread)
+        unsigned window{0};
+    };
+
+    LLVMDGDotWriter(LLVMDependenceGraph *dg) : LLVMDGDotWriter(dg, Options()) {}
+    LLVMDGDotWriter(LLVMDependenceGraph *dg, Options opts)
+            : dg(dg), options(std::move(opts)) {}
+
+    void setSlicingCriteria(const std::set<LLVMNode *> &crit) {
+        criteria = crit;
+    }
+
+    // write the whole graph
+    void write(llvm::raw_ostream &out);
+
+  private:
+    // a node of the output and the prefix of its label
+    struct NodeInfo {
+        LLVMNode *node;
+        const char *prefix;
+    };
+
+    // a chunk of the output: the nodes [begin, end) of a function
+    // (or of the global nodes if 'fun' is null)
+    struct Chunk {
+        const llvm::Function *fun;
+        LLVMDependenceGraph *graph;
+        size_t begin;
+        size_t end;
+    };
+
+    LLVMDependenceGraph *dg;
+    Options options;
+    std::set<LLVMNode *> criteria;
+
+    // the nodes that are printed in the order of the module,
+    // the index of a node is its name in the output
+    std::vector<NodeInfo> nodes;
+    std::unordered_map<const LLVMNode *, size_t> ids;
+    std::vector<Chunk> chunks;
+    // the labels of the nodes [labelsBegin, labelsBegin + labels.size())
+    // of the chunks that are being generated
+    std::vector<std::string> labels;
+    size_t labelsBegin{0};
+
+    bool isShown(LLVMNode *nd) const;
+    void addNode(LLVMNode *nd, const char *prefix = nullptr);
+    void addParameters(LLVMDGParameters *params, bool formal,
+                       const llvmdg::ModuleValueNumbering &numbering);
+    void addFunction(const llvm::Function &F, LLVMDependenceGraph *graph,
+                     const llvmdg::ModuleValueNumbering &numbering);
+    void numberNodes();
+    // print the labels of the nodes of the chunks [first, first + num)
+    void labelNodes(size_t first, size_t num);
+
+    std::string generateChunk(size_t idx) const;
+};
+
+} // namespace debug
+} // namespace dg
+
+#endif // DG_LLVMDG_DOT_WRITER_H_
@@ -1,8 +1,12 @@
 #ifndef LLVM_DEPENDENCE_GRAPH_H_
 #define LLVM_DEPENDENCE_GRAPH_H_
 
+#include <cstddef>
+#include <iterator>
 #include <map>
+#include <memory>
 #include <unordered_map>
+#include <utility>
 
 #include "dg/llvm/ControlDependence/LLVMControlDependenceAnalysisOptions.h"
 #include "dg/llvm/ThreadRegions/ControlFlowGraph.h"
@@ -21,6 +25,10 @@ namespace dg {
 
 class LLVMPointerAnalysis;
 
+namespace llvmdg {
+class CallGraph;
+}
+
 // namespace llvmdg {
 // class LLVMControlDependenceAnalysis;
 //}
@@ -37,14 +45,103 @@ using dda::LLVMDataDependenceAnalysis;
 
 using LLVMBBlock = dg::BBlock<LLVMNode>;
 
+class LLVMDependenceGraph;
+
+///
+// The graphs of the constructed functions. A graph is looked up by hashing,
+// but the iteration goes over the functions in the order in which they are
+// in the module, so that everything that iterates over the graphs (dumps,
+// annotations, call-sites, ...) gives the same results in every run.
+class LLVMConstructedFunctions {
+  public:
+    using value_type = std::pair<llvm::Value *const, LLVMDependenceGraph *>;
+
+  private:
+    // the graphs ordered by the position of the function in the module
+    using OrderedT = std::map<unsigned, value_type>;
+    OrderedT _graphs;
+    std::unordered_map<const llvm::Value *, OrderedT::iterator> _index;
+    // positions of the functions in the module (filled on the first use)
+    std::unordered_map<const llvm::Value *, unsigned> _positions;
+
+    unsigned _position(llvm::Value *fun);
+
+  public:
+    class const_iterator {
+        OrderedT::const_iterator _it;
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = LLVMConstructedFunctions::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+
+        const_iterator() = default;
+        explicit const_iterator(OrderedT::const_iterator it) : _it(it) {}
+
+        reference operator*() const { return _it->second; }
+        pointer operator->() const { return &_it->second; }
+
+        const_iterator &operator++() {
+            ++_it;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            ++_it;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator &rhs) const {
+            return _it == rhs._it;
+        }
+        bool operator!=(const const_iterator &rhs) const {
+            return _it != rhs._it;
+        }
+    };
+
+    const_iterator begin() const { return const_iterator(_graphs.begin()); }
+    const_iterator end() const { return const_iterator(_graphs.end()); }
+
+    const_iterator find(const llvm::Value *fun) const {
+        auto it = _index.find(fun);
+        return it == _index.end() ? end() : const_iterator(it->second);
+    }
+
+    size_t count(const llvm::Value *fun) const { return _index.count(fun); }
+    size_t size() const { return _index.size(); }
+    bool empty() const { return _index.empty(); }
+
+    // the graph of 'fun', creates an empty (null) entry if there is none
+    LLVMDependenceGraph *&operator[](llvm::Value *fun);
+
+    // add the graph of the function if the function has no graph yet
+    void insert(const std::pair<llvm::Value *, LLVMDependenceGraph *> &val) {
+        auto &graph = (*this)[val.first];
+        if (!graph)
+            graph = val.second;
+    }
+};
+
 /// ------------------------------------------------------------------
 //  -- LLVMDependenceGraph
 /// ------------------------------------------------------------------
 class LLVMDependenceGraph : public DependenceGraph<LLVMNode> {
+  public:
+    // graphs of the functions that were constructed so far
+    using ConstructedFunctionsT = LLVMConstructedFunctions;
+
+  private:
     // our artificial unified exit block
     std::unique_ptr<LLVMBBlock> unifiedExitBB{};
     llvm::Function *entryFunction{nullptr};
 
+    // the map is shared by the graph and all its subgraphs,
+    // so different graphs (e.g., of different modules) are independent
+    std::shared_ptr<ConstructedFunctionsT> constructedFunctions{
+            std::make_shared<ConstructedFunctionsT>()};
+
   public:
     LLVMDependenceGraph(bool threads = false) : threads(threads) {}
 
@@ -78,6 +175,12 @@ class LLVMDependenceGraph : public DependenceGraph<LLVMNode> {
 
     llvm::Module *getModule() const { return module; }
 
+    // graphs of all the functions that are reachable from the entry
+    // function (shared with subgraphs)
+    const ConstructedFunctionsT &getConstructedFunctions() const {
+        return *constructedFunctions;
+    }
+
     // if we want to slice according some call-site(s),
     // we can gather the relevant call-sites while building
     // graph and do not need to recursively find in the graph
@@ -94,10 +197,9 @@ class LLVMDependenceGraph : public DependenceGraph<LLVMNode> {
     // FIXME: can implement via getCallNodes
     bool getCallSites(const char *name, std::set<LLVMNode *> *callsites);
     // this method takes NULL-terminated array of names
-    static bool getCallSites(const char *names[],
-                             std::set<LLVMNode *> *callsites);
-    static bool getCallSites(const std::vector<std::string> &names,
-                             std::set<LLVMNode *> *callsites);
+    bool getCallSites(const char *names[], std::set<LLVMNode *> *callsites);
+    bool getCallSites(const std::vector<std::string> &names,
+                      std::set<LLVMNode *> *callsites);
 
     // FIXME we need remove the callsite from here if we slice away
     // the callsite
@@ -113,11 +215,15 @@ class LLVMDependenceGraph : public DependenceGraph<LLVMNode> {
     void addSubgraphGlobalParameters(LLVMDependenceGraph *subgraph);
 
     static void addNoreturnDependencies(LLVMNode *noret, LLVMBBlock *from);
+    // the call graph is optional, without it only direct calls
+    // are taken into account
     void
-    addNoreturnDependencies(const LLVMControlDependenceAnalysisOptions &opts);
+    addNoreturnDependencies(const LLVMControlDependenceAnalysisOptions &opts,
+                            llvmdg::CallGraph *cg = nullptr);
 
-    void computeControlDependencies(
-            const LLVMControlDependenceAnalysisOptions &opts);
+    void
+    computeControlDependencies(const LLVMControlDependenceAnalysisOptions &opts,
+                               llvmdg::CallGraph *cg = nullptr);
 
     bool verify() const;
 
@@ -141,8 +247,8 @@ class LLVMDependenceGraph : public DependenceGraph<LLVMNode> {
 
     void addDefUseEdges(bool preserveDbg = true);
     void computeInterferenceDependentEdges(ControlFlowGraph *controlFlowGraph);
-    static void computeForkJoinDependencies(ControlFlowGraph *controlFlowGraph);
-    static void computeCriticalSections(ControlFlowGraph *controlFlowGraph);
+    void computeForkJoinDependencies(ControlFlowGraph *controlFlowGraph);
+    void computeCriticalSections(ControlFlowGraph *controlFlowGraph);
 
   private:
     void computePostDominators(bool addPostDomFrontiers = false);
@@ -202,10 +308,8 @@ class LLVMDependenceGraph : public DependenceGraph<LLVMNode> {
     friend class LLVMDGVerifier;
 };
 
-const std::map<llvm::Value *, LLVMDependenceGraph *> &getConstructedFunctions();
-
 LLVMNode *findInstruction(llvm::Instruction *instruction,
-                          const std::map<llvm::Value *, LLVMDependenceGraph *>
+                          const LLVMDependenceGraph::ConstructedFunctionsT
                                   &constructedFunctions);
 
 llvm::Instruction *castToLLVMInstruction(const llvm::Value *value);
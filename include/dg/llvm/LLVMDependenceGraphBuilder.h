@@ -6,6 +6,7 @@
 
 #include <llvm/IR/Module.h>
 
+#include "dg/llvm/CallGraph/CallGraph.h"
 #include "dg/llvm/ControlDependence/ControlDependence.h"
 #include "dg/llvm/ControlDependence/LLVMControlDependenceAnalysisOptions.h"
 #include "dg/llvm/DataDependence/DataDependence.h"
@@ -24,6 +25,7 @@
 #include "dg/PointerAnalysis/PointerAnalysisFSInv.h"
 
 #include "dg/llvm/ThreadRegions/ControlFlowGraph.h"
+#include "dg/util/Profiler.h"
 
 namespace llvm {
 class Module;
@@ -54,6 +56,9 @@ class LLVMDependenceGraphBuilder {
     llvm::Module *_M;
     const LLVMDependenceGraphOptions _options;
     std::unique_ptr<LLVMPointerAnalysis> _PTA{};
+    // the call graph is built once after the pointer analysis
+    // if some analysis needs it (see _needsCallGraph())
+    std::unique_ptr<CallGraph> _callGraph{};
     std::unique_ptr<LLVMDataDependenceAnalysis> _DDA{nullptr};
     std::unique_ptr<LLVMControlDependenceAnalysis> _CDA{nullptr};
     std::unique_ptr<LLVMDependenceGraph> _dg{};
@@ -76,42 +81,94 @@ class LLVMDependenceGraphBuilder {
     void _runPointerAnalysis() {
         assert(_PTA && "BUG: No PTA");
 
+        debug::Profiler::Scope phase("pointer analysis");
         _timerStart();
         _PTA->run();
         _statistics.ptaTime = _timerEnd();
+
+        if (!_options.PTAOptions.isSVF()) {
+            const auto *PA =
+                    static_cast<DGLLVMPointerAnalysis *>(_PTA.get())->getPTA();
+            debug::Profiler::count("iterations", PA->getNumOfIterations());
+            debug::Profiler::count("processed nodes",
+                                   PA->getNumOfProcessedNodes());
+        }
+    }
+
+    // only the no-return analysis of the interprocedural NTSCD
+    // uses the call graph (see LLVMDependenceGraph::addNoreturnDependencies)
+    bool _needsCallGraph() const {
+        const auto &opts = _options.CDAOptions;
+        return opts.interproceduralCD() &&
+               (opts.ntscdCD() || opts.ntscd2CD() || opts.ntscd3CD() ||
+                opts.ntscdLegacyCD());
+    }
+
+    void _buildCallGraph() {
+        if (!_needsCallGraph())
+            return;
+
+        debug::Profiler::Scope phase("call graph");
+        _callGraph.reset(new CallGraph(CallGraph::frozen(_M, _PTA.get())));
+        const auto *CG = _callGraph->getFrozen();
+        debug::Profiler::count("functions", CG->size());
+        debug::Profiler::count("SCCs", CG->sccsNum());
     }
 
     void _runDataDependenceAnalysis() {
         assert(_DDA && "BUG: No RD");
 
+        debug::Profiler::Scope phase("data dependence analysis");
         _timerStart();
         _DDA->run();
         _statistics.rdaTime = _timerEnd();
+        debug::Profiler::count("phis", _DDA->getNumOfPhis());
+    }
+
+    void _buildGraph() {
+        debug::Profiler::Scope phase("build graph");
+        _dg->build(_M, _PTA.get(), _DDA.get(), _entryFunction);
+        debug::Profiler::count("functions",
+                               _dg->getConstructedFunctions().size());
+    }
+
+    void _addDefUseEdges() {
+        // the memory SSA creates the phi nodes on demand
+        // while searching the definitions for the edges
+        debug::Profiler::Scope phase("def-use edges");
+        auto phis = _DDA->getNumOfPhis();
+        _dg->addDefUseEdges(_options.preserveDbg);
+        debug::Profiler::count("phis", _DDA->getNumOfPhis() - phis);
     }
 
     void _runControlDependenceAnalysis() {
+        debug::Profiler::Scope phase("control dependence analysis");
         _timerStart();
         //_CDA->run();
         // FIXME: until we get rid of the legacy code,
         // use the old way of inserting CD edges directly
         // into the dg
-        _dg->computeControlDependencies(_options.CDAOptions);
+        _dg->computeControlDependencies(_options.CDAOptions,
+                                        _callGraph.get());
         _statistics.cdaTime = _timerEnd();
     }
 
     void _runInterferenceDependenceAnalysis() {
+        debug::Profiler::Scope phase("interference dependence analysis");
         _timerStart();
         _dg->computeInterferenceDependentEdges(_controlFlowGraph.get());
         _statistics.inferaTime = _timerEnd();
     }
 
     void _runForkJoinAnalysis() {
+        debug::Profiler::Scope phase("fork-join analysis");
         _timerStart();
         _dg->computeForkJoinDependencies(_controlFlowGraph.get());
         _statistics.joinsTime = _timerEnd();
     }
 
     void _runCriticalSectionAnalysis() {
+        debug::Profiler::Scope phase("critical sections analysis");
         _timerStart();
         _dg->computeCriticalSections(_controlFlowGraph.get());
         _statistics.critsecTime = _timerEnd();
@@ -152,6 +209,9 @@ class LLVMDependenceGraphBuilder {
 
     LLVMPointerAnalysis *getPTA() { return _PTA.get(); }
     LLVMDataDependenceAnalysis *getDDA() { return _DDA.get(); }
+    // available after the pointer analysis has run,
+    // nullptr if the control dependencies do not need it
+    CallGraph *getCallGraph() { return _callGraph.get(); }
 
     const Statistics &getStatistics() const { return _statistics; }
 
@@ -159,13 +219,14 @@ class LLVMDependenceGraphBuilder {
     std::unique_ptr<LLVMDependenceGraph> &&build() {
         // compute data dependencies
         _runPointerAnalysis();
+        _buildCallGraph();
         _runDataDependenceAnalysis();
 
         // build the graph itself (the nodes, but without edges)
-        _dg->build(_M, _PTA.get(), _DDA.get(), _entryFunction);
+        _buildGraph();
 
         // insert the data dependencies edges
-        _dg->addDefUseEdges(_options.preserveDbg);
+        _addDefUseEdges();
 
         // compute and fill-in control dependencies
         _runControlDependenceAnalysis();
@@ -200,9 +261,10 @@ class LLVMDependenceGraphBuilder {
     std::unique_ptr<LLVMDependenceGraph> &&constructCFGOnly() {
         // data dependencies
         _runPointerAnalysis();
+        _buildCallGraph();
 
         // build the graph itself
-        _dg->build(_M, _PTA.get(), _DDA.get(), _entryFunction);
+        _buildGraph();
 
         if (_options.threads) {
             _controlFlowGraph->buildFunction(_entryFunction);
@@ -229,7 +291,7 @@ class LLVMDependenceGraphBuilder {
 
         // data-dependence edges
         _runDataDependenceAnalysis();
-        _dg->addDefUseEdges(_options.preserveDbg);
+        _addDefUseEdges();
 
         // fill-in control dependencies
         _runControlDependenceAnalysis();
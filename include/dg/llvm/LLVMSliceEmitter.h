@@ -0,0 +1,104 @@
+#ifndef LLVM_DG_SLICE_EMITTER_H_
+#define LLVM_DG_SLICE_EMITTER_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/Module.h>
+
+#include "dg/Slicing.h"
+#include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/LLVMNode.h"
+
+namespace dg {
+namespace llvmdg {
+
+///
+// Create a sliced copy of the module without modifying the module
+// and the dependence graph (unlike LLVMSlicer that slices in place).
+// The new module contains only the marked functions, blocks and
+// instructions and its CFG is reconnected in the same way
+// as LLVMSlicer reconnects the CFG of the sliced module, so both
+// give the same slice. Since the analysed module and the graph stay
+// intact, the emitter can be used repeatedly with different slices:
+//
+//   LLVMSliceEmitter emitter(dg);
+//   auto M1 = emitter.emit(slice_id1);
+//   auto M2 = emitter.emit(slice_id2);
+//
+class LLVMSliceEmitter {
+  public:
+    LLVMSliceEmitter(LLVMDependenceGraph *dg) : dg(dg) {}
+
+    // do not slice the bodies of these functions
+    void keepFunctionUntouched(const std::string &name) {
+        dont_touch.insert(name);
+    }
+
+    // create a new module that contains only the nodes
+    // (and their blocks and functions) that are marked with 'sl_id'
+    std::unique_ptr<llvm::Module> emit(uint32_t sl_id);
+
+    // statistics of the last emit()
+    const SlicerStatistics &getStatistics() const { return statistics; }
+
+  private:
+    using EdgeT = LLVMBBlock::BBlockEdge;
+
+    // The CFG of one sliced function. It mirrors the block edges
+    // of the dependence graph, so that we can reconnect the blocks
+    // without touching the graph.
+    struct FunctionCFG {
+        std::map<LLVMBBlock *, std::set<EdgeT>> successors;
+        std::map<LLVMBBlock *, std::set<LLVMBBlock *>> predecessors;
+        // blocks of the new module
+        std::map<LLVMBBlock *, llvm::BasicBlock *> blocks;
+        // blocks that we created (the new exit blocks)
+        std::vector<std::unique_ptr<LLVMBBlock>> newBlocks;
+
+        void addSuccessor(LLVMBBlock *B, const EdgeT &edge) {
+            successors[B].insert(edge);
+            predecessors[edge.target].insert(B);
+        }
+
+        void removeSuccessors(LLVMBBlock *B) {
+            for (const auto &succ : successors[B])
+                predecessors[succ.target].erase(B);
+            successors[B].clear();
+        }
+
+        void isolate(LLVMBBlock *B);
+        bool successorsAreSame(LLVMBBlock *B);
+        bool hasSuccessor(LLVMBBlock *B, LLVMBBlock *target);
+        void removeSuccessorsTarget(LLVMBBlock *B, LLVMBBlock *target);
+    };
+
+    void sliceFunction(LLVMDependenceGraph *graph, llvm::Function *F,
+                       uint32_t sl_id);
+    void adjustBBlocksSucessors(LLVMDependenceGraph *graph,
+                                FunctionCFG &cfg, llvm::Function *F,
+                                uint32_t sl_id);
+    static LLVMBBlock *createNewExitBB(FunctionCFG &cfg, llvm::Function *F);
+    static void reconnectBBlock(FunctionCFG &cfg, LLVMBBlock *BB,
+                                llvm::BasicBlock *llvmBB);
+    static void ensureEntryBlock(llvm::Function *F);
+
+    bool dontTouch(const llvm::StringRef &r) const {
+        return dont_touch.count(r.str()) > 0;
+    }
+
+    LLVMDependenceGraph *dg;
+    std::set<std::string> dont_touch;
+    // mapping of the values from the analysed module to the new module
+    std::map<const llvm::Value *, llvm::Value *> newValues;
+    SlicerStatistics statistics;
+};
+
+} // namespace llvmdg
+} // namespace dg
+
+#endif
@@ -23,9 +23,6 @@ namespace dg {
 
 class LLVMNode;
 
-extern std::map<const llvm::Value *, LLVMDependenceGraph *>
-        constructedFunctions;
-
 namespace llvmdg {
 
 template <typename Val>
@@ -121,6 +118,7 @@ class LLVMSlicer : public Slicer<LLVMNode> {
         if (start)
             sl_id = mark(start, sl_id);
 
+        const auto &constructedFunctions = dg->getConstructedFunctions();
         std::vector<llvm::Function *> to_erase;
         for (auto &F : *dg->getModule()) {
             if (dontTouch(F.getName()))
@@ -147,32 +145,7 @@ class LLVMSlicer : public Slicer<LLVMNode> {
         return sl_id;
     }
 
-  private:
-    /*
-void sliceCallNode(LLVMNode *callNode,
-                   LLVMDependenceGraph *graph, uint32_t slice_id)
-{
-    LLVMDGParameters *actualparams = callNode->getParameters();
-    LLVMDGParameters *formalparams = graph->getParameters();
-
-    if (!actualparams) {
-        assert(!formalparams && "Have only one of params");
-        return; // no params - nothing to do
-    }
-
-    assert(formalparams && "Have only one of params");
-    assert(formalparams->size() == actualparams->size());
-
-    // FIXME slice arguments away
-}
-
-void sliceCallNode(LLVMNode *callNode, uint32_t slice_id)
-{
-    for (LLVMDependenceGraph *subgraph : callNode->getSubgraphs())
-        sliceCallNode(callNode, subgraph, slice_id);
-}
-    */
-
+    // helpers shared with LLVMSliceEmitter
     static void adjustPhiNodes(llvm::BasicBlock *pred, llvm::BasicBlock *blk) {
         using namespace llvm;
 
@@ -217,6 +190,32 @@ void sliceCallNode(LLVMNode *callNode, uint32_t slice_id)
         }
     }
 
+  private:
+    /*
+void sliceCallNode(LLVMNode *callNode,
+                   LLVMDependenceGraph *graph, uint32_t slice_id)
+{
+    LLVMDGParameters *actualparams = callNode->getParameters();
+    LLVMDGParameters *formalparams = graph->getParameters();
+
+    if (!actualparams) {
+        assert(!formalparams && "Have only one of params");
+        return; // no params - nothing to do
+    }
+
+    assert(formalparams && "Have only one of params");
+    assert(formalparams->size() == actualparams->size());
+
+    // FIXME slice arguments away
+}
+
+void sliceCallNode(LLVMNode *callNode, uint32_t slice_id)
+{
+    for (LLVMDependenceGraph *subgraph : callNode->getSubgraphs())
+        sliceCallNode(callNode, subgraph, slice_id);
+}
+    */
+
     static LLVMBBlock *createNewExitBB(LLVMDependenceGraph *graph) {
         using namespace llvm;
 
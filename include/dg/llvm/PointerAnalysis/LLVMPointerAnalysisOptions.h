@@ -11,6 +11,18 @@ struct LLVMPointerAnalysisOptions : public LLVMAnalysisOptions,
     enum class AnalysisType { fi, fs, inv, svf } analysisType{AnalysisType::fi};
 
     bool threads{false};
+    // build the subgraphs of functions called directly only when
+    // the analysis reaches the call (the same way as with calls via
+    // pointers), so that we do not build the functions that are
+    // never called from the entry function
+    bool lazyBuilding{false};
+    // merge the nodes of the pointer graph that must have the same
+    // points-to sets before running the analysis
+    // (see PSPointerEquivalenceMerger). Used only with the flow-insensitive
+    // analysis: the strong updates of the flow-sensitive analyses depend
+    // on the order in which the nodes are processed, so a different
+    // graph may give them different results.
+    bool mergeEquivalentNodes{false};
 
     bool isFS() const { return analysisType == AnalysisType::fs; }
     bool isFSInv() const { return analysisType == AnalysisType::inv; }
@@ -176,6 +176,10 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
     PointerGraph *PS = nullptr;
     std::unique_ptr<pta::PointerAnalysis> PTA{}; // dg pointer analysis object
     std::unique_ptr<LLVMPointerGraphBuilder> _builder;
+    // the nodes that were merged into equivalent nodes
+    // (see LLVMPointerAnalysisOptions::mergeEquivalentNodes)
+    pta::PointsToMapping<PSNode *> _mergedNodes;
+    unsigned _mergedClasses{0};
 
     static LLVMPointerAnalysisOptions createOptions(const char *entry_func,
                                                     uint64_t field_sensitivity,
@@ -281,6 +285,15 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
     LLVMPointerGraphBuilder *getBuilder() { return _builder.get(); }
     const LLVMPointerGraphBuilder *getBuilder() const { return _builder.get(); }
 
+    // return the node that the given node was merged into
+    // or nullptr if the node was not merged
+    PSNode *getMergedInto(PSNode *node) const {
+        return _mergedNodes.get(node);
+    }
+
+    size_t getNumOfMergedNodes() const { return _mergedNodes.size(); }
+    unsigned getNumOfMergedClasses() const { return _mergedClasses; }
+
     void buildSubgraph() {
         // run the analysis itself
         assert(_builder && "Incorrectly constructed PTA, missing builder");
@@ -291,6 +304,9 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
             abort();
         }
 
+        if (options.mergeEquivalentNodes && options.isFI())
+            mergeEquivalentNodes();
+
         /*
         pta::PointerGraphOptimizer optimizer(PS);
         optimizer.run();
@@ -303,6 +319,19 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
         */
     }
 
+    void mergeEquivalentNodes() {
+        pta::PSPointerEquivalenceMerger merger(PS);
+        for (auto *nd : _builder->getOpenNodes())
+            merger.addOpenNode(nd);
+
+        if (merger.run() == 0)
+            return;
+
+        _mergedNodes = merger.getMapping();
+        _mergedClasses = merger.getNumOfClasses();
+        _builder->composeMapping(std::move(merger.getMapping()));
+    }
+
     void initialize() {
         if (options.isFSInv())
             _builder->setInvalidateNodesFlag(true);
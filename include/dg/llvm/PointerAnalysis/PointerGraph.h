@@ -125,6 +125,9 @@ class LLVMPointerGraphBuilder {
         // instructions)
         std::map<const llvm::BasicBlock *, PSNodesBlock> llvmBlocks{};
         bool has_structure{false};
+        // calls of functions that are built lazily (when the analysis
+        // reaches the call)
+        std::vector<PSNode *> lazyCalls{};
 
         FuncGraph() = default;
         FuncGraph(const FuncGraph &) = delete;
@@ -216,9 +219,6 @@ class LLVMPointerGraphBuilder {
 
     void setAdHocBuilding(bool adHoc) { ad_hoc_building = adHoc; }
 
-    PSNodesSeq &createFuncptrCall(const llvm::CallInst *CInst,
-                                  const llvm::Function *F);
-
     static bool callIsCompatible(PSNode *call, PSNode *func);
 
     // Insert a call of a function into an already existing graph.
@@ -273,9 +273,18 @@ class LLVMPointerGraphBuilder {
     }
 
     void composeMapping(PointsToMapping<PSNode *> &&rhs) {
+        // the values whose nodes were replaced by other nodes
+        for (auto &it : nodes_map) {
+            if (auto *nd = rhs.get(it.second.getRepresentant()))
+                mapping.set(it.first, nd);
+        }
         mapping.compose(std::move(rhs));
     }
 
+    // the nodes that may get new operands while the analysis runs
+    // (formal arguments get operands when calls via pointers are resolved)
+    std::vector<PSNode *> getOpenNodes();
+
     PointerSubgraph *getSubgraph(const llvm::Function * /*F*/);
 
   private:
@@ -90,9 +90,6 @@ static std::ostream &operator<<(std::ostream &os, const sdg::DGElement &nd) {
 class SDG2Dot {
     SystemDependenceGraph *_llvmsdg;
 
-    // keep track of dumped nodes for checking that we dumped all
-    mutable std::set<sdg::DGNode *> dumpedNodes;
-
     void dumpNode(std::ostream &out, sdg::DGNode &nd,
                   const llvm::Value *v = nullptr,
                   const char *descr = nullptr) const {
@@ -120,7 +117,6 @@ class SDG2Dot {
         out << "      label=\"" << name << " (input)\"\n";
         for (auto &param : params) {
             auto &nd = param.getInputArgument();
-            dumpedNodes.insert(&nd);
             dumpNode(out, nd, _llvmsdg->getValue(&param));
         }
         out << "    }\n";
@@ -130,15 +126,12 @@ class SDG2Dot {
         out << "      label=\"" << name << " (output)\"\n";
         for (auto &param : params) {
             auto &nd = param.getOutputArgument();
-            dumpedNodes.insert(&nd);
             dumpNode(out, nd, _llvmsdg->getValue(&param));
         }
         if (auto *noret = params.getNoReturn()) {
-            dumpedNodes.insert(noret);
             dumpNode(out, *noret, nullptr, "noret");
         }
         if (auto *ret = params.getReturn()) {
-            dumpedNodes.insert(ret);
             dumpNode(out, *ret, nullptr, "ret");
         }
         out << "    }\n";
@@ -224,7 +217,6 @@ class SDG2Dot {
                     << blk->getID() << " {\n";
                 out << "      label=\"bblock #" << blk->getID() << "\"\n";
                 for (auto *nd : blk->getNodes()) {
-                    dumpedNodes.insert(nd);
                     dumpNode(out, *nd);
 
                     if (auto *C = sdg::DGNodeCall::get(nd)) {
@@ -271,8 +263,6 @@ class SDG2Dot {
 
             // formal parameters edges
             dumpParamEdges(out, dg->getParameters());
-
-            dumpedNodes.clear();
         }
 
         ////
@@ -1,6 +1,7 @@
 #ifndef THREADREGION_H
 #define THREADREGION_H
 
+#include <atomic>
 #include <iosfwd>
 #include <set>
 
@@ -18,7 +19,8 @@ class ThreadRegion {
     std::set<ThreadRegion *> predecessors_;
     std::set<ThreadRegion *> successors_;
 
-    static int lastId;
+    // shared by all graphs, atomic so that graphs can be built in parallel
+    static std::atomic<int> lastId;
 
   public:
     ThreadRegion(Node *node);
@@ -0,0 +1,54 @@
+#ifndef DG_UTIL_PARALLEL_FOR_H_
+#define DG_UTIL_PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace dg {
+namespace util {
+
+// The number of threads to use when the user asks for 'jobs' threads
+// (0 means as many threads as the hardware supports).
+inline unsigned getJobsNum(unsigned jobs) {
+    if (jobs == 0)
+        jobs = std::thread::hardware_concurrency();
+    return jobs == 0 ? 1 : jobs;
+}
+
+///
+// Call 'fun(i)' for every 'i' in [0, n) using at most 'jobs' threads.
+// The threads take the indices one by one, so the tasks can be of very
+// different size. The calls must be independent of each other,
+// the order in which they run is arbitrary. With one job (or one task)
+// everything runs in the calling thread.
+template <typename FunT>
+void parallelFor(size_t n, unsigned jobs, FunT fun) {
+    jobs = std::min<size_t>(getJobsNum(jobs), n);
+    if (jobs <= 1) {
+        for (size_t i = 0; i < n; ++i)
+            fun(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < n; i = next++)
+            fun(i);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(jobs - 1);
+    for (unsigned j = 1; j < jobs; ++j)
+        threads.emplace_back(worker);
+    worker();
+
+    for (auto &thr : threads)
+        thr.join();
+}
+
+} // namespace util
+} // namespace dg
+
+#endif
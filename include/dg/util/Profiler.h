@@ -0,0 +1,279 @@
+#ifndef DG_UTIL_PROFILER_H_
+#define DG_UTIL_PROFILER_H_
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace dg {
+namespace debug {
+
+///
+// A process-wide profiler of nested phases. Every phase records
+// its wall time, CPU time, the growth of the peak resident set size,
+// the number of allocations (if the program counts them, see
+// allocations()) and arbitrary counters (e.g., the number of iterations
+// of an analysis). Repeated phases with the same name and parent are
+// summed up into one phase.
+//
+// The profiler is disabled by default and then starting a phase
+// is just a check of a flag. Every thread has its own stack of running
+// phases (the first phase started by a thread is a top-level phase),
+// the tree of phases and the counters are shared and guarded by a lock.
+//
+//   {
+//     Profiler::Scope phase("pointer analysis");
+//     ...
+//     Profiler::count("iterations", n);
+//   }
+//   ...
+//   Profiler::get().dumpJSON(out);
+class Profiler {
+  public:
+    struct Phase {
+        std::string name;
+        unsigned calls{0};
+        double wallTime{0}; // in seconds
+        double cpuTime{0};  // in seconds
+        long peakRSSGrowth{0}; // in kB
+        uint64_t allocations{0};
+        std::map<std::string, uint64_t> counters;
+        std::vector<std::unique_ptr<Phase>> children;
+
+        Phase(std::string n = "") : name(std::move(n)) {}
+
+        Phase *getChild(const std::string &n) {
+            for (auto &child : children) {
+                if (child->name == n)
+                    return child.get();
+            }
+            children.emplace_back(new Phase(n));
+            return children.back().get();
+        }
+    };
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Measurement {
+        Clock::time_point wall;
+        std::clock_t cpu;
+        long peakRSS;
+        uint64_t allocations;
+
+        static Measurement now() {
+            return {Clock::now(), std::clock(), getPeakRSS(),
+                    Profiler::allocations().load(std::memory_order_relaxed)};
+        }
+    };
+
+    struct Running {
+        Phase *phase;
+        Measurement start;
+    };
+
+    std::atomic<bool> _enabled{false};
+    Phase _root;
+    Measurement _start{};
+    // guards _root and its descendants
+    std::mutex _lock;
+
+    // the phases running in the calling thread
+    static std::vector<Running> &_running() {
+        static thread_local std::vector<Running> running;
+        return running;
+    }
+
+    Phase *_current() {
+        auto &running = _running();
+        return running.empty() ? &_root : running.back().phase;
+    }
+
+    static void _writeString(std::ostream &out, const std::string &str) {
+        out << '"';
+        for (char c : str) {
+            if (c == '"' || c == '\\')
+                out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+
+    void _writePhase(std::ostream &out, const Phase &phase,
+                     const std::string &indent) const {
+        out << indent << "{\"name\": ";
+        _writeString(out, phase.name);
+        out << ", \"calls\": " << phase.calls
+            << ", \"wall_time\": " << phase.wallTime
+            << ", \"cpu_time\": " << phase.cpuTime
+            << ", \"peak_rss_growth_kb\": " << phase.peakRSSGrowth;
+        if (countsAllocations())
+            out << ", \"allocations\": " << phase.allocations;
+        _writeCounters(out, phase);
+        _writeChildren(out, phase, indent);
+        out << "}";
+    }
+
+    static void _writeCounters(std::ostream &out, const Phase &phase) {
+        out << ", \"counters\": {";
+        bool first = true;
+        for (const auto &it : phase.counters) {
+            if (!first)
+                out << ", ";
+            first = false;
+            _writeString(out, it.first);
+            out << ": " << it.second;
+        }
+        out << "}";
+    }
+
+    void _writeChildren(std::ostream &out, const Phase &phase,
+                        const std::string &indent) const {
+        out << ", \"phases\": [";
+        if (phase.children.empty()) {
+            out << "]";
+            return;
+        }
+        out << "\n";
+        for (size_t i = 0; i < phase.children.size(); ++i) {
+            _writePhase(out, *phase.children[i], indent + "  ");
+            out << (i + 1 < phase.children.size() ? ",\n" : "\n");
+        }
+        out << indent << "]";
+    }
+
+  public:
+    static Profiler &get() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    ///
+    // The number of allocations done by the program. The profiler
+    // does not count the allocations itself, the program must do it
+    // (e.g., by replacing operator new) and set countsAllocations().
+    static std::atomic<uint64_t> &allocations() {
+        static std::atomic<uint64_t> num{0};
+        return num;
+    }
+
+    static bool &countsAllocations() {
+        static bool counts = false;
+        return counts;
+    }
+
+    // the peak resident set size of the process in kB (0 if unknown)
+    static long getPeakRSS() {
+#if defined(__unix__) || defined(__APPLE__)
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024; // in bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    // must be called before any other thread uses the profiler
+    void enable() {
+        _start = Measurement::now();
+        _enabled.store(true, std::memory_order_release);
+    }
+
+    bool isEnabled() const {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    void startPhase(const std::string &name) {
+        if (!isEnabled())
+            return;
+        Phase *phase;
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            phase = _current()->getChild(name);
+        }
+        _running().push_back({phase, Measurement::now()});
+    }
+
+    void endPhase() {
+        if (!isEnabled())
+            return;
+        auto &running = _running();
+        assert(!running.empty() && "No phase is running");
+
+        const auto end = Measurement::now();
+        const auto &start = running.back().start;
+        auto *phase = running.back().phase;
+        std::lock_guard<std::mutex> guard(_lock);
+        ++phase->calls;
+        phase->wallTime +=
+                std::chrono::duration<double>(end.wall - start.wall).count();
+        phase->cpuTime += double(end.cpu - start.cpu) / CLOCKS_PER_SEC;
+        phase->peakRSSGrowth += end.peakRSS - start.peakRSS;
+        phase->allocations += end.allocations - start.allocations;
+        running.pop_back();
+    }
+
+    // add 'num' to the counter of the phase running in the calling thread
+    static void count(const std::string &counter, uint64_t num) {
+        auto &profiler = get();
+        if (!profiler.isEnabled())
+            return;
+        std::lock_guard<std::mutex> guard(profiler._lock);
+        profiler._current()->counters[counter] += num;
+    }
+
+    // must not run concurrently with the phases of other threads
+    void dumpJSON(std::ostream &out) const {
+        const auto end = Measurement::now();
+        out << "{\"wall_time\": "
+            << std::chrono::duration<double>(end.wall - _start.wall).count()
+            << ", \"cpu_time\": " << double(end.cpu) / CLOCKS_PER_SEC
+            << ", \"peak_rss_kb\": " << end.peakRSS;
+        if (countsAllocations())
+            out << ", \"allocations\": " << end.allocations;
+        _writeCounters(out, _root);
+        _writeChildren(out, _root, "");
+        out << "}\n";
+    }
+
+    ///
+    // Measure the phase for the lifetime of this object.
+    class Scope {
+        bool _started;
+
+      public:
+        Scope(const std::string &name) : _started(get().isEnabled()) {
+            get().startPhase(name);
+        }
+
+        ~Scope() {
+            if (_started)
+                get().endPhase();
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+};
+
+} // namespace debug
+} // namespace dg
+
+#endif // DG_UTIL_PROFILER_H_
@@ -13,7 +13,7 @@ namespace debug {
 #ifdef DEBUG_ENABLED
 
 extern unsigned _debug_lvl;
-extern unsigned _ind;
+extern thread_local unsigned _ind;
 
 namespace {
 inline unsigned &_getDebugLvl() { return _debug_lvl; }
@@ -2,6 +2,6 @@
 
 namespace dg {
 
-unsigned ElemId::idcnt = 0;
+std::atomic<unsigned> ElemId::idcnt{0};
 
 }
@@ -0,0 +1,138 @@
+#ifndef DG_CDGRAPH_CSR_H_
+#define DG_CDGRAPH_CSR_H_
+
+#include <cassert>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "CDGraph.h"
+#include "dg/ADT/Bitvector.h"
+
+namespace dg {
+
+/////
+/// CDGraphCSR - a frozen copy of CDGraph for the algorithms that need to
+/// traverse the graph many times. The successors and predecessors of all
+/// nodes are packed into two arrays (compressed sparse rows) and the nodes
+/// are referred to by their IDs from CDGraph (1 ... size()), so the
+/// algorithms can keep their data in plain vectors indexed by the IDs.
+/// The graph must not be changed while its frozen copy is used.
+/////
+class CDGraphCSR {
+  public:
+    using NodeID = unsigned;
+
+    struct Range {
+        const NodeID *_begin;
+        const NodeID *_end;
+
+        const NodeID *begin() const { return _begin; }
+        const NodeID *end() const { return _end; }
+        size_t size() const { return _end - _begin; }
+        bool empty() const { return _begin == _end; }
+    };
+
+  private:
+    // offsets[id] is the start of the edges of the node 'id',
+    // the edges end at offsets[id + 1] (the index 0 is unused)
+    std::vector<unsigned> _succOffsets;
+    std::vector<NodeID> _succs;
+    std::vector<unsigned> _predOffsets;
+    std::vector<NodeID> _preds;
+
+    std::vector<CDNode *> _nodes;
+    std::vector<bool> _isPredicate;
+    std::vector<NodeID> _predicates;
+
+    static Range _range(const std::vector<unsigned> &offsets,
+                        const std::vector<NodeID> &edges, NodeID id) {
+        return {edges.data() + offsets[id], edges.data() + offsets[id + 1]};
+    }
+
+  public:
+    CDGraphCSR(CDGraph &graph) {
+        const auto n = graph.size();
+        _nodes.reserve(n + 1);
+        _nodes.push_back(nullptr);
+        _succOffsets.reserve(n + 2);
+        _predOffsets.reserve(n + 2);
+        _succOffsets.push_back(0);
+        _predOffsets.push_back(0);
+        _isPredicate.resize(n + 1, false);
+
+        for (auto *nd : graph) {
+            assert(nd->getID() == _nodes.size() && "Unexpected ID of a node");
+            _nodes.push_back(nd);
+
+            _succOffsets.push_back(_succs.size());
+            for (auto *succ : nd->successors())
+                _succs.push_back(succ->getID());
+            _predOffsets.push_back(_preds.size());
+            for (auto *pred : nd->predecessors())
+                _preds.push_back(pred->getID());
+
+            if (graph.isPredicate(*nd)) {
+                _isPredicate[nd->getID()] = true;
+                _predicates.push_back(nd->getID());
+            }
+        }
+
+        _succOffsets.push_back(_succs.size());
+        _predOffsets.push_back(_preds.size());
+    }
+
+    // the number of nodes, the IDs of nodes are 1 ... size()
+    size_t size() const { return _nodes.size() - 1; }
+
+    Range successors(NodeID id) const {
+        assert(id > 0 && id <= size());
+        return _range(_succOffsets, _succs, id);
+    }
+
+    Range predecessors(NodeID id) const {
+        assert(id > 0 && id <= size());
+        return _range(_predOffsets, _preds, id);
+    }
+
+    bool isPredicate(NodeID id) const { return _isPredicate[id]; }
+    // the predicates ordered by their IDs
+    const std::vector<NodeID> &predicates() const { return _predicates; }
+
+    CDNode *getNode(NodeID id) const {
+        assert(id > 0 && id <= size());
+        return _nodes[id];
+    }
+};
+
+/// The control dependencies computed on CDGraphCSR. For every node ID,
+/// there is the set of IDs of the nodes that the node depends on.
+using CDResultDense = std::vector<ADT::SparseBitvector>;
+
+/// Translate dense results to the control dependencies and reverse
+/// control dependencies between the nodes of the (not frozen) graph.
+inline std::pair<std::map<CDNode *, std::set<CDNode *>>,
+                 std::map<CDNode *, std::set<CDNode *>>>
+getCDMaps(const CDGraphCSR &graph, const CDResultDense &result) {
+    std::map<CDNode *, std::set<CDNode *>> CD;
+    std::map<CDNode *, std::set<CDNode *>> revCD;
+
+    for (CDGraphCSR::NodeID id = 1; id < result.size(); ++id) {
+        if (result[id].empty())
+            continue;
+
+        auto *nd = graph.getNode(id);
+        auto &deps = CD[nd];
+        for (auto depid : result[id]) {
+            auto *dep = graph.getNode(depid);
+            deps.insert(dep);
+            revCD[dep].insert(nd);
+        }
+    }
+
+    return {std::move(CD), std::move(revCD)};
+}
+
+} // namespace dg
+
+#endif
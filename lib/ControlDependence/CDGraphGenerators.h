@@ -0,0 +1,111 @@
+#ifndef DG_CDGRAPH_GENERATORS_H_
+#define DG_CDGRAPH_GENERATORS_H_
+
+#include <cassert>
+#include <random>
+#include <vector>
+
+#include "CDGraph.h"
+
+namespace dg {
+
+// Generate a graph with Vnum nodes and (at most) Enum random edges such that
+// every node has at most two successors. The graph is the same for the same
+// seed.
+inline void generateRandomGraph(CDGraph &G, unsigned Vnum, unsigned Enum,
+                                unsigned seed) {
+    if (Enum == 0 || Enum > 2 * Vnum)
+        Enum = Vnum;
+
+    std::vector<CDNode *> nodes;
+    nodes.push_back(nullptr);
+    nodes.reserve(Vnum + 1);
+    for (unsigned i = 0; i < Vnum; ++i) {
+        auto &nd = G.createNode();
+        nodes.push_back(&nd);
+        assert(nodes.size() - 1 == nd.getID());
+    }
+    // create random edges
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<std::mt19937::result_type> ids(1, Vnum);
+
+    unsigned n = 0;
+    while (Enum > 0 && ++n < 10 * Enum) {
+        auto id1 = ids(rng);
+        if (nodes[id1]->successors().size() > 1)
+            continue;
+        auto id2 = ids(rng);
+        G.addNodeSuccessor(*nodes[id1], *nodes[id2]);
+        --Enum;
+    }
+}
+
+// Generate a CFG that is a sequence of regions where a region is
+// a single node, an if-then-else, a loop with two entries (p -> a, p -> b,
+// a -> b, b -> a, b -> exit) or the same loop without the exit (these are
+// the loops where DOD arises). Then some nodes get an edge to a random node,
+// which creates more irreducible cycles. The graph is the same for the same
+// seed, so that the runs are comparable.
+inline void generateIrreducibleGraph(CDGraph &G, unsigned size,
+                                     unsigned seed) {
+    std::mt19937 rng(seed);
+    auto *last = &G.createNode();
+    while (G.size() < size) {
+        switch (rng() % 4) {
+        case 0: {
+            auto &a = G.createNode();
+            auto &b = G.createNode();
+            auto &exit = G.createNode();
+            G.addNodeSuccessor(*last, a);
+            G.addNodeSuccessor(*last, b);
+            G.addNodeSuccessor(a, b);
+            G.addNodeSuccessor(b, a);
+            G.addNodeSuccessor(b, exit);
+            last = &exit;
+            break;
+        }
+        case 1: {
+            auto &p = G.createNode();
+            auto &a = G.createNode();
+            auto &b = G.createNode();
+            auto &next = G.createNode();
+            G.addNodeSuccessor(*last, p);
+            G.addNodeSuccessor(*last, next);
+            G.addNodeSuccessor(p, a);
+            G.addNodeSuccessor(p, b);
+            G.addNodeSuccessor(a, b);
+            G.addNodeSuccessor(b, a);
+            last = &next;
+            break;
+        }
+        case 2: {
+            auto &t = G.createNode();
+            auto &e = G.createNode();
+            auto &join = G.createNode();
+            G.addNodeSuccessor(*last, t);
+            G.addNodeSuccessor(*last, e);
+            G.addNodeSuccessor(t, join);
+            G.addNodeSuccessor(e, join);
+            last = &join;
+            break;
+        }
+        default: {
+            auto &n = G.createNode();
+            G.addNodeSuccessor(*last, n);
+            last = &n;
+        }
+        }
+    }
+
+    std::vector<CDNode *> nodes(G.begin(), G.end());
+    std::uniform_int_distribution<size_t> dist(0, nodes.size() - 1);
+    for (auto *nd : nodes) {
+        if (nd->successors().size() == 1 && rng() % 8 == 0) {
+            G.addNodeSuccessor(*nd, *nodes[dist(rng)]);
+        }
+    }
+}
+
+} // namespace dg
+
+#endif
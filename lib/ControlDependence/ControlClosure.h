@@ -5,132 +5,165 @@
 #include <vector>
 
 #include "CDGraph.h"
+#include "CDGraphCSR.h"
 
 #include "dg/ADT/Queue.h"
-#include "dg/ADT/SetQueue.h"
 
 namespace dg {
 
 class StrongControlClosure {
+    using NodeID = CDGraphCSR::NodeID;
+
+    // the nodes visited by the current search have here
+    // the number of the search
+    std::vector<unsigned> visited;
+    unsigned search{0};
+
+    bool visit(NodeID nd) {
+        if (visited[nd] == search)
+            return false;
+        visited[nd] = search;
+        return true;
+    }
+
     // this is basically the \Theta function from the paper
-    template <typename Nodes, typename FunT>
-    void foreachFirstReachable(const Nodes &nodes, CDNode *from,
+    template <typename FunT>
+    void foreachFirstReachable(const CDGraphCSR &graph,
+                               const std::vector<bool> &nodes, NodeID from,
                                const FunT &fun) {
-        ADT::SetQueue<ADT::QueueLIFO<CDNode *>> queue;
-        for (auto *s : from->successors()) {
-            queue.push(s);
+        ++search;
+        ADT::QueueLIFO<NodeID> queue;
+        for (auto s : graph.successors(from)) {
+            if (visit(s))
+                queue.push(s);
         }
 
         while (!queue.empty()) {
-            auto *cur = queue.pop();
-            if (nodes.count(cur) > 0) { // the node is from Ap?
-                fun(cur);
+            auto cur = queue.pop();
+            if (nodes[cur]) { // the node is from Ap?
+                if (!fun(cur))
+                    return;
             } else {
-                for (auto *s : cur->successors()) {
-                    queue.push(s);
+                for (auto s : graph.successors(cur)) {
+                    if (visit(s))
+                        queue.push(s);
                 }
             }
         }
     }
 
     // this is the \Gamma function from the paper
-    // (a bit different implementation)
-    static std::set<CDNode *> gamma(CDGraph &graph,
-                                    const std::set<CDNode *> &targets) {
-        struct Info {
-            unsigned colored{false};
-            unsigned short counter;
-        };
-
-        std::unordered_map<CDNode *, Info> data;
-        data.reserve(graph.size());
-        ADT::QueueLIFO<CDNode *> queue;
+    // (a bit different implementation). Returns the nodes
+    // from which we can avoid the targets ('true' in the vector).
+    static std::vector<bool> gamma(const CDGraphCSR &graph,
+                                   const std::vector<bool> &targets) {
+        std::vector<bool> colored(graph.size() + 1, false);
+        std::vector<unsigned> counter(graph.size() + 1);
+        ADT::QueueLIFO<NodeID> queue;
 
         // initialize nodes
-        for (auto *nd : graph) {
-            auto &D = data[nd];
-            D.colored = false;
-            D.counter = nd->successors().size();
+        for (NodeID nd = 1; nd <= graph.size(); ++nd) {
+            counter[nd] = graph.successors(nd).size();
         }
 
         // initialize the search
-        for (auto *target : targets) {
-            data[target].colored = true;
-            queue.push(target);
+        for (NodeID target = 1; target <= graph.size(); ++target) {
+            if (targets[target]) {
+                colored[target] = true;
+                queue.push(target);
+            }
         }
 
         // search!
         while (!queue.empty()) {
-            auto *node = queue.pop();
-            assert(data[node].colored && "A non-colored node in queue");
-
-            for (auto *pred : node->predecessors()) {
-                auto &D = data[pred];
-                --D.counter;
-                if (D.counter == 0) {
-                    D.colored = true;
+            auto node = queue.pop();
+            assert(colored[node] && "A non-colored node in queue");
+
+            for (auto pred : graph.predecessors(node)) {
+                if (--counter[pred] == 0) {
+                    colored[pred] = true;
                     queue.push(pred);
                 }
             }
         }
 
-        std::set<CDNode *> retval;
-        for (auto *n : graph) {
-            if (!data[n].colored) {
-                retval.insert(n);
-            }
-        }
-        return retval;
+        colored.flip();
+        colored[0] = false;
+        return colored;
     }
 
-    std::set<CDNode *> theta(const std::set<CDNode *> &X, CDNode *n) {
-        std::set<CDNode *> retval;
-        if (X.count(n) > 0) {
-            retval.insert(n);
-            return retval;
+    // the size of theta(X, n), but we need to know only whether
+    // it is 0, 1 or more, so we stop at 2
+    unsigned thetaSize(const CDGraphCSR &graph, const std::vector<bool> &X,
+                       NodeID n) {
+        if (X[n]) {
+            return 1;
         }
-        foreachFirstReachable(X, n, [&](CDNode *cur) { retval.insert(cur); });
-        return retval;
+        unsigned size = 0;
+        foreachFirstReachable(graph, X, n, [&](NodeID) { return ++size < 2; });
+        return size;
     }
 
   public:
     using ValVecT = std::vector<CDNode *>;
 
     void closeSet(CDGraph &G, std::set<CDNode *> &X) {
+        CDGraphCSR graph(G);
+        visited.assign(graph.size() + 1, 0);
+        search = 0;
+
+        std::vector<bool> inX(graph.size() + 1, false);
+        for (auto *n : X) {
+            inX[n->getID()] = true;
+        }
+
         while (true) {
-            ADT::SetQueue<ADT::QueueLIFO<CDNode *>> queue;
-            for (auto *n : X) {
-                for (auto *s : n->successors()) {
-                    queue.push(s);
+            // X does not change during one iteration,
+            // so gamma needs to be computed only once
+            std::vector<bool> gam;
+            bool haveGamma = false;
+
+            // the 'visited' vector is used by the theta function,
+            // so use a separate one here
+            std::vector<bool> queued(graph.size() + 1, false);
+            ADT::QueueLIFO<NodeID> queue;
+            for (NodeID n = 1; n <= graph.size(); ++n) {
+                if (!inX[n])
+                    continue;
+                for (auto s : graph.successors(n)) {
+                    if (!queued[s]) {
+                        queued[s] = true;
+                        queue.push(s);
+                    }
                 }
             }
 
-            CDNode *toadd = nullptr;
+            NodeID toadd = 0;
             while (!queue.empty()) {
-                assert(toadd == nullptr);
-                auto *p = queue.pop();
-                assert(p && "popped nullptr");
-                for (auto *r : p->successors()) {
-                    assert(toadd == nullptr);
-                    // DBG(cda, "Checking edge " << p->getID() << "->" <<
-                    // r->getID());
+                assert(toadd == 0);
+                auto p = queue.pop();
+                for (auto r : graph.successors(p)) {
+                    assert(toadd == 0);
+                    // DBG(cda, "Checking edge " << p << "->" << r);
                     // (a)
-                    if (theta(X, r).size() != 1)
+                    if (thetaSize(graph, inX, r) != 1)
                         continue;
 
                     // (b)
-                    auto gam = gamma(G, X);
-                    if (gam.count(r) > 0)
+                    if (!haveGamma) {
+                        gam = gamma(graph, inX);
+                        haveGamma = true;
+                    }
+                    if (gam[r])
                         continue;
 
                     // (c)
-                    if (theta(X, p).size() < 2 && gam.count(p) == 0)
+                    if (thetaSize(graph, inX, p) < 2 && !gam[p])
                         continue;
 
                     // all conditions met, we got our edge
-                    // DBG(cda, "Found edge " << p->getID() << "->" <<
-                    // r->getID());
-                    assert(toadd == nullptr);
+                    // DBG(cda, "Found edge " << p << "->" << r);
+                    assert(toadd == 0);
                     toadd = p;
                     break;
                 }
@@ -138,14 +171,18 @@ class StrongControlClosure {
                 if (toadd)
                     break;
 
-                for (auto *s : p->successors()) {
-                    queue.push(s);
+                for (auto s : graph.successors(p)) {
+                    if (!queued[s]) {
+                        queued[s] = true;
+                        queue.push(s);
+                    }
                 }
             }
 
             if (toadd) {
-                // DBG(cda, "Adding " << toadd->getID() << " to closure");
-                X.insert(toadd);
+                // DBG(cda, "Adding " << toadd << " to closure");
+                X.insert(graph.getNode(toadd));
+                inX[toadd] = true;
                 continue;
             } // no other edge to process
             break;
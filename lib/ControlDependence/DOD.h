@@ -1,16 +1,16 @@
 #ifndef DG_DOD_H_
 #define DG_DOD_H_
 
-#include <functional>
 #include <map>
 #include <set>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <dg/ADT/Bitvector.h>
 #include <dg/ADT/Queue.h>
-#include <dg/ADT/SetQueue.h>
 
 #include "CDGraph.h"
+#include "CDGraphCSR.h"
 
 namespace dg {
 
@@ -22,35 +22,33 @@ class AllMaxPath {
     using ResultT = std::map<CDNode *, const ADT::SparseBitvector &>;
 
   private:
-    struct Info {
-        ADT::SparseBitvector colors;
-        unsigned short counter;
-    };
-
-    std::unordered_map<CDNode *, Info> data;
+    using NodeID = CDGraphCSR::NodeID;
 
-    void compute(CDGraph &graph, CDNode *target) {
-        // initialize nodes
-        for (auto *nd : graph) {
-            data[nd].counter = nd->successors().size();
-        }
+    std::vector<ADT::SparseBitvector> colors;
+    // the counter of a node is valid only if stamp == current target
+    std::vector<NodeID> stamp;
+    std::vector<unsigned> counter;
 
+    void compute(const CDGraphCSR &graph, NodeID target) {
         // initialize the search
-        data[target].colors.set(target->getID());
-        ADT::QueueLIFO<CDNode *> queue;
+        colors[target].set(target);
+        ADT::QueueLIFO<NodeID> queue;
         queue.push(target);
 
         // search!
         while (!queue.empty()) {
-            auto *node = queue.pop();
-            assert(data[node].colors.get(target->getID()) &&
-                   "A non-colored node in queue");
-
-            for (auto *pred : node->predecessors()) {
-                auto &D = data[pred];
-                --D.counter;
-                if (D.counter == 0) {
-                    D.colors.set(target->getID());
+            auto node = queue.pop();
+            assert(colors[node].get(target) && "A non-colored node in queue");
+
+            for (auto pred : graph.predecessors(node)) {
+                if (stamp[pred] != target) {
+                    stamp[pred] = target;
+                    counter[pred] = graph.successors(pred).size();
+                }
+                // the target is colored from the beginning, do not push
+                // it again (its predecessors would be decremented twice)
+                if (--counter[pred] == 0 && pred != target) {
+                    colors[pred].set(target);
                     queue.push(pred);
                 }
             }
@@ -58,16 +56,31 @@ class AllMaxPath {
     }
 
   public:
+    // returns for every node the set of IDs of the nodes that lie on all max
+    // paths from the node
+    const std::vector<ADT::SparseBitvector> &
+    computeDense(const CDGraphCSR &graph) {
+        colors.clear();
+        colors.resize(graph.size() + 1);
+        stamp.assign(graph.size() + 1, 0);
+        counter.assign(graph.size() + 1, 0);
+
+        for (NodeID nd = 1; nd <= graph.size(); ++nd) {
+            compute(graph, nd);
+        }
+
+        return colors;
+    }
+
     // returns mapping CDNode -> Set of CDNodes (where the set is implemented as
     // a bitvector)
     ResultT compute(CDGraph &graph) {
         ResultT res;
 
-        data.reserve(graph.size());
-
-        for (auto *nd : graph) {
-            compute(graph, nd);
-            res.emplace(nd, data[nd].colors);
+        CDGraphCSR csr(graph);
+        computeDense(csr);
+        for (NodeID nd = 1; nd <= csr.size(); ++nd) {
+            res.emplace(csr.getNode(nd), colors[nd]);
         }
 
         return res;
@@ -84,235 +97,135 @@ class DOD {
     // is usually small. There is a flag that computes the relation
     // as ternary.
     using ResultT = std::map<CDNode *, std::set<CDNode *>>;
-    using ColoringT = ADT::SparseBitvector;
 
-  private:
-    struct ColoredAp {
-        CDGraph Ap;
-        ColoringT blues;
-        ColoringT reds;
-
-        // mapping G -> Ap
-        std::unordered_map<CDNode *, CDNode *> _mapping{};
-        // mapping Ap -> G
-        std::unordered_map<CDNode *, CDNode *> _rev_mapping{};
-
-        CDNode *createNode(CDNode *gnode) {
-            auto *nd = &Ap.createNode();
-            _mapping[gnode] = nd;
-            _rev_mapping[nd] = gnode;
-            return nd;
-        }
-
-        CDNode *getNode(CDNode *gnode) {
-            auto it = _mapping.find(gnode);
-            return it == _mapping.end() ? nullptr : it->second;
-        }
+  protected:
+    using NodeID = CDGraphCSR::NodeID;
+    using AllPathsT = std::vector<ADT::SparseBitvector>;
 
-        CDNode *getGNode(CDNode *apnode) {
-            auto it = _rev_mapping.find(apnode);
-            return it == _rev_mapping.end() ? nullptr : it->second;
+  private:
+    // The Ap graph of the current predicate p. Ap contains the nodes that
+    // lie on all max paths from p and it has an edge n -> m if m is the first
+    // node from Ap that is reachable from n. The data are indexed by the IDs
+    // of nodes and are valid only if the stamp of the node is p, so we
+    // do not need to clear them for every predicate.
+    std::vector<NodeID> inAp;
+    // the unique successor of a node in Ap (if any)
+    std::vector<NodeID> apSucc;
+    std::vector<NodeID> blue;
+    std::vector<NodeID> red;
+
+    // stamps of the searches for the first reachable nodes from Ap
+    std::vector<unsigned> visited;
+    unsigned search{0};
+    std::vector<NodeID> stack;
+
+    bool isInAp(NodeID n, NodeID p) const { return inAp[n] == p; }
+    bool isBlue(NodeID n, NodeID p) const { return blue[n] == p; }
+    bool isRed(NodeID n, NodeID p) const { return red[n] == p; }
+
+    void newSearch() {
+        if (++search == 0) {
+            // we ran out of stamps, start again
+            std::fill(visited.begin(), visited.end(), 0);
+            search = 1;
         }
+    }
 
-        ColoredAp() = default;
-        ColoredAp(CDGraph &&g, ColoringT &&b, ColoringT &&r)
-                : Ap(std::move(g)), blues(std::move(b)), reds(std::move(r)) {}
-        ColoredAp(ColoredAp &&) = default;
-        ColoredAp(const ColoredAp &) = delete;
-
-        bool isBlue(CDNode *n) const { return blues.get(n->getID()); }
-        bool isRed(CDNode *n) const { return reds.get(n->getID()); }
-    };
-
-    template <typename Nodes, typename FunT>
-    void foreachFirstReachable(const Nodes &nodes, CDNode *from,
+    // call fun on every node from Ap that is reachable from 'from'
+    // without going through other nodes from Ap. Stop the search
+    // if fun returns false. Returns false if the search was stopped.
+    template <typename FunT>
+    bool foreachFirstReachable(const CDGraphCSR &graph, NodeID p, NodeID from,
                                const FunT &fun) {
-        // FIXME: this breaks the complexity (it uses std::set)
-        ADT::SetQueue<ADT::QueueLIFO<CDNode *>> queue;
-        for (auto *s : from->successors()) {
-            queue.push(s);
+        newSearch();
+        stack.clear();
+        for (auto s : graph.successors(from)) {
+            if (visited[s] != search) {
+                visited[s] = search;
+                stack.push_back(s);
+            }
         }
 
-        while (!queue.empty()) {
-            auto *cur = queue.pop();
-            if (nodes.get(cur->getID())) { // the node is from Ap?
-                fun(cur);
-            } else {
-                for (auto *s : cur->successors()) {
-                    queue.push(s);
+        while (!stack.empty()) {
+            auto cur = stack.back();
+            stack.pop_back();
+            if (isInAp(cur, p)) {
+                if (!fun(cur))
+                    return false;
+                continue;
+            }
+            for (auto s : graph.successors(cur)) {
+                if (visited[s] != search) {
+                    visited[s] = search;
+                    stack.push_back(s);
                 }
             }
         }
+        return true;
     }
 
-    // Create the Ap graph (nodes and edges)
-    ColoredAp createAp(const ADT::SparseBitvector &nodes, CDGraph &graph,
-                       CDNode *node) {
-        ColoredAp CAp;
-        CDGraph &Ap = CAp.Ap;
-
-        // create nodes of graph
-        for (auto *n : graph) {
-            if (nodes.get(n->getID())) {
-                CAp.createNode(n);
-                // DBG(cda, "  - Ap has node " << n->getID() << " (which is " <<
-                // nd->getID() << " in Ap)");
-            }
-        }
-
-        assert(CAp.getNode(node) != nullptr);
-
-        if (CAp.Ap.size() < 3) {
-            return {}; // no DOD possible, bail out early
-        }
-
-        // Add edges. FIXME: we can use a better implementation
-        for (auto *n : Ap) {
-            auto *gn = CAp.getGNode(n);
-
-            foreachFirstReachable(nodes, gn, [&](CDNode *cur) {
-                auto *apn = CAp.getNode(cur);
-                assert(apn);
-                n->addSuccessor(apn);
-                // DBG(cda, "  - Ap edge " << gn->getID() << " -> " <<
-                // cur->getID());
-            });
-        }
+    // Color the first nodes from Ap that are reachable from the successor
+    // 'succ' of p. Returns false if some of them has been already colored
+    // by the other color or if it is p itself.
+    bool color(const CDGraphCSR &graph, NodeID p, NodeID succ,
+               std::vector<NodeID> &colors,
+               const std::vector<NodeID> &othercolors) {
+        auto colorNode = [&](NodeID n) {
+            if (n == p || othercolors[n] == p)
+                return false;
+            colors[n] = p;
+            return true;
+        };
 
-        assert(CAp.getNode(node) && "node is not in Ap");
-        if (CAp.getNode(node)->successors().size() < 2) {
-            return {}; // no DOD possible, skip the rest of building colored Ap
+        if (isInAp(succ, p)) {
+            return colorNode(succ);
         }
-
-        return CAp;
+        return foreachFirstReachable(graph, p, succ, colorNode);
     }
 
-    // create the Ap graph (calls createAp) and color the nodes in the Ap graph
-    ColoredAp createColoredAp(AllMaxPath::ResultT &allpaths, CDGraph &graph,
-                              CDNode *node) {
-        auto it = allpaths.find(node);
-        if (it == allpaths.end()) {
-            return {};
-        }
-        const auto &nodes = it->second;
-
-        ColoredAp CAp = createAp(nodes, graph, node);
-        if (CAp.Ap.empty()) {
-            return {};
-        }
-
-        // initialize the colors
-        assert(node->successors().size() == 2 &&
-               "Node is not the right predicate");
-
-        // FIXME: refactor...
-        // color nodes
-        const auto &succs = node->successors();
-        auto sit = succs.begin();
-        CDNode *bluesucc = *sit;
-        CDNode *redsucc = *(++sit);
-        // DBG(cda, "Blue successor: " << bluesucc->getID());
-        // DBG(cda, "Red successor: " << redsucc->getID());
-        assert(++sit == succs.end());
-
-        if (nodes.get(bluesucc->getID())) { // is blue successor in Ap?
-            auto *apn = CAp.getNode(bluesucc);
-            assert(apn);
-            CAp.blues.set(apn->getID());
-            // DBG(cda, "  - Ap blue: " << apn->getID() << " ("
-            //                         << bluesucc->getID() << " in original)");
-        } else {
-            foreachFirstReachable(nodes, bluesucc, [&](CDNode *cur) {
-                auto *apn = CAp.getNode(cur);
-                assert(apn);
-                CAp.blues.set(apn->getID());
-                // DBG(cda, "  - Ap blue: " << apn->getID() << " ("
-                //                         << cur->getID() << " in original)");
+    // Create the edges of Ap. If there is a DOD for p, every node of Ap
+    // except p has exactly one successor and these nodes form a cycle.
+    // Bail out (return false) as soon as we find out that this is not
+    // the case.
+    bool createApEdges(const CDGraphCSR &graph, NodeID p,
+                       const ADT::SparseBitvector &nodes) {
+        for (auto n : nodes) {
+            if (n == p)
+                continue;
+
+            apSucc[n] = 0;
+            bool unique = foreachFirstReachable(graph, p, n, [&](NodeID cur) {
+                if (apSucc[n] != 0)
+                    return false;
+                apSucc[n] = cur;
+                return true;
             });
-        }
 
-        bool twocolors = false;
-        if (nodes.get(redsucc->getID())) { // is red successor in Ap?
-            auto *apn = CAp.getNode(redsucc);
-            assert(apn);
-            if (CAp.blues.get(apn->getID())) {
-                twocolors = true;
+            if (!unique || apSucc[n] == 0 || apSucc[n] == n ||
+                apSucc[n] == p) {
+                return false;
             }
-            CAp.reds.set(apn->getID());
-            // DBG(cda, "  - Ap red: " << redsucc->getID());
-        } else {
-            foreachFirstReachable(nodes, redsucc, [&](CDNode *cur) {
-                auto *apn = CAp.getNode(cur);
-                assert(apn);
-                CAp.reds.set(apn->getID());
-                if (CAp.blues.get(apn->getID())) {
-                    twocolors = true;
-                }
-                // DBG(cda, "  - Ap red: " << apn->getID() << " ("
-                //                        << cur->getID() << " in original)");
-            });
         }
 
-        if (twocolors) {
-            return {};
-        }
-
-        return CAp;
+        return true;
     }
 
-    static bool checkAp(CDGraph &Ap) {
-        // for (auto *nd : CAp.Ap) {
-        //      DBG(tmp, ">> Ap: " << nd->getID() << " b: " <<
-        //      CAp.blues.get(nd->getID())
-        //                                        << " r: " <<
-        //                                        CAp.reds.get(nd->getID()));
-        //}
-        // for (auto *nd : CAp.Ap) {
-        //    for (auto *succ: nd->successors()) {
-        //      DBG(tmp, ">> Ap:   " << nd->getID() << " -> " << succ->getID());
-        //    }
-        //}
-
-        // we can have only a single node with multiple successors
-        CDNode *p = nullptr;
-        for (auto *n : Ap) {
-            if (p) {
-                assert(n->successors().size() == 1);
-                assert(n->getSingleSuccessor() != n);
-            } else {
-                if (n->successors().size() > 1) {
-                    p = n;
-                }
-            }
+    // check that the nodes of Ap except p form a single cycle
+    bool isCycle(NodeID start, size_t length) const {
+        NodeID cur = start;
+        for (size_t i = 0; i < length; ++i) {
+            cur = apSucc[cur];
+            if (cur == start)
+                return i + 1 == length;
         }
-        assert(p && "No entry node of Ap");
-
-        // from the p node there are edges that go into a cycle
-        // that contains the rest of the nodes
-        std::set<CDNode *> visited;
-        auto *n = *(p->successors().begin());
-        auto *cur = n;
-        do {
-            assert(cur != p);
-
-            bool notseen = visited.insert(cur).second;
-            assert(notseen && "Visited a node twice");
-            (void) notseen; // c++17 TODO: replace with [[maybe_unused]]
-
-            cur = cur->getSingleSuccessor();
-            assert(cur && "Node on the cycle does not have a unique successor");
-        } while (cur != n);
-
-        assert(visited.size() == Ap.size() - 1 &&
-               "Cycle does not contain all the nodes except p");
-        return true;
+        return false;
     }
 
     template <typename Pred1, typename Pred2>
-    std::pair<CDNode *, CDNode *> find(CDNode *start, CDNode *end,
-                                       const Pred1 &P1, const Pred2 &P2) {
-        CDNode *n1 = nullptr, *n2 = nullptr;
-        CDNode *n = start;
+    std::pair<NodeID, NodeID> find(NodeID start, NodeID end, const Pred1 &P1,
+                                   const Pred2 &P2) const {
+        NodeID n1 = 0, n2 = 0;
+        NodeID n = start;
         do {
             if (P1(n)) {
                 n1 = n;
@@ -321,161 +234,174 @@ class DOD {
                 n2 = n;
                 break;
             }
-            n = n->getSingleSuccessor();
+            n = apSucc[n];
             assert(n && "A node on the cycle has not a single successor");
         } while (n != end);
 
         return {n1, n2};
     }
 
-    void computeDOD(ColoredAp &CAp, CDNode *p, ResultT &CD, ResultT &revCD,
-                    bool asTernary = false) {
-        assert(checkAp(CAp.Ap)); // sanity check
-
-        CDNode *b1 = nullptr, *b2 = nullptr, *b3 = nullptr;
-        CDNode *r1 = nullptr, *r2 = nullptr;
-
-        // get some blue node to have a starting point
-        auto bid = *(CAp.blues.begin());
-        // DBG(tmp, "Blue node with id " << bid);
-        b1 = CAp.Ap.getNode(bid);
-        assert(b1 && "The blue node is not on Ap");
-        // DBG(tmp, "Starting from blue: " << b1->getID());
-        assert(CAp.isBlue(b1));
-
-        auto isblue = [&](CDNode *x) -> bool { return CAp.isBlue(x); };
-        auto isred = [&](CDNode *x) -> bool { return CAp.isRed(x); };
-
-        std::tie(b2, r1) = find(b1, b1, isblue, isred);
-        std::tie(r2, b3) = find(r1, b1, isred, isblue);
-        if (b3 != nullptr) {
-            if (find(b3, b1, isred, isred).first != nullptr) {
-                // there is another red, no DOD
-                return;
-            }
-        } else {
-            b3 = b1;
-        }
-
-        assert(b1);
-        assert(b2);
-        assert(b3);
-        assert(r1);
-        assert(r2);
-
-        if (asTernary) {
-            constructTernaryRelation(CAp, p, CD, revCD, b2, b3, r1, r2);
-        } else { // break into binary relation
-            constructBinaryRelation(CAp, p, CD, revCD, b2, b3, r1, r2);
-        }
+    bool isColored(NodeID n, NodeID p) const {
+        return isBlue(n, p) || isRed(n, p);
     }
 
-    static void constructTernaryRelation(ColoredAp &CAp, CDNode *p, ResultT &CD,
-                                         ResultT &revCD, CDNode *b2, CDNode *b3,
-                                         CDNode *r1, CDNode *r2) {
-        auto *cur = b2;
+    void constructTernaryRelation(NodeID p, CDResultDense &CD, NodeID b2,
+                                  NodeID b3, NodeID r1, NodeID r2) const {
+        auto cur = b2;
         do {
-            auto *gcur = CAp.getGNode(cur);
-            assert(gcur);
-
-            auto *ncur = r2;
+            auto ncur = r2;
             do {
-                auto *gncur = CAp.getGNode(ncur);
-                assert(gncur);
-                // DBG(cda, p->getID() << " - dod -> {" << gcur->getID() << ", "
-                //                                     << gncur->getID() <<
-                //                                     "}");
-
-                CD[gcur].insert(p);
-                CD[gncur].insert(p);
-                revCD[p].insert(gcur);
-                revCD[p].insert(gncur);
-
-                ncur = ncur->getSingleSuccessor();
-            } while (!(CAp.isBlue(ncur) || CAp.isRed(ncur)));
+                CD[cur].set(p);
+                CD[ncur].set(p);
+                ncur = apSucc[ncur];
+            } while (!isColored(ncur, p));
             assert(ncur == b3);
             (void) b3;
 
-            cur = cur->getSingleSuccessor();
-        } while (!(CAp.isBlue(cur) || CAp.isRed(cur)));
+            cur = apSucc[cur];
+        } while (!isColored(cur, p));
         assert(cur == r1);
         (void) r1;
     }
 
-    static void constructBinaryRelation(ColoredAp &CAp, CDNode *p, ResultT &CD,
-                                        ResultT &revCD, CDNode *b2, CDNode *b3,
-                                        CDNode *r1, CDNode *r2) {
-        auto *cur = b2;
+    void constructBinaryRelation(NodeID p, CDResultDense &CD, NodeID b2,
+                                 NodeID b3, NodeID r1, NodeID r2) const {
+        auto cur = b2;
         do {
-            auto *gcur = CAp.getGNode(cur);
-            assert(gcur);
-            CD[gcur].insert(p);
-            revCD[p].insert(gcur);
-            // DBG(cda, p->getID() << " - dod -> " << gcur->getID());
-            cur = cur->getSingleSuccessor();
-        } while (!(CAp.isBlue(cur) || CAp.isRed(cur)));
+            CD[cur].set(p);
+            cur = apSucc[cur];
+        } while (!isColored(cur, p));
         assert(cur == r1);
         (void) r1;
 
         cur = r2;
         do {
-            auto *gcur = CAp.getGNode(cur);
-            assert(gcur);
-            CD[gcur].insert(p);
-            revCD[p].insert(gcur);
-            // DBG(cda, p->getID() << " - dod -> " << gcur->getID());
-            cur = cur->getSingleSuccessor();
-        } while (!(CAp.isBlue(cur) || CAp.isRed(cur)));
+            CD[cur].set(p);
+            cur = apSucc[cur];
+        } while (!isColored(cur, p));
         assert(cur == b3);
         (void) b3;
     }
 
   protected:
-    // make this public, so that we can use it in NTSCD+DOD algorithm
-    template <typename OnAllPaths>
-    void computeDOD(CDNode *p, CDGraph &graph, OnAllPaths &allpaths,
-                    ResultT &CD, ResultT &revCD) {
-        assert(p->successors().size() == 2 &&
-               "We work with at most 2 successors");
-
-        DBG_SECTION_BEGIN(cda, "Creating Ap graph for fun " << graph.getName()
-                                                            << " node "
-                                                            << p->getID());
-        auto res = createColoredAp(allpaths, graph, p);
-        DBG_SECTION_END(cda, "Done creating Ap graph");
-        if (res.Ap.empty()) {
-            DBG(cda, "No DOD in the Ap are possible");
-            // no DOD possible
+    void initialize(const CDGraphCSR &graph) {
+        inAp.assign(graph.size() + 1, 0);
+        apSucc.assign(graph.size() + 1, 0);
+        blue.assign(graph.size() + 1, 0);
+        red.assign(graph.size() + 1, 0);
+        visited.assign(graph.size() + 1, 0);
+        search = 0;
+    }
+
+    // compute DOD for the predicate p, the graph must be initialized
+    void computeDOD(const CDGraphCSR &graph, NodeID p,
+                    const AllPathsT &allpaths, CDResultDense &CD,
+                    bool asTernary = false) {
+        const auto &succs = graph.successors(p);
+        if (succs.size() != 2) {
+            // the algorithm works only with binary branching
+            DBG(cda, "Skipping DOD for node " << p << " with " << succs.size()
+                                              << " successors");
             return;
         }
 
-        DBG(cda, "Computing DOD from the Ap");
-        computeDOD(res, p, CD, revCD);
+        // create nodes of Ap
+        const auto &nodes = allpaths[p];
+        size_t apsize = 0;
+        for (auto n : nodes) {
+            inAp[n] = p;
+            ++apsize;
+        }
+        assert(isInAp(p, p) && "p is not in Ap");
+
+        if (apsize < 3) {
+            return; // no DOD possible, bail out early
+        }
+
+        // color nodes
+        auto bluesucc = *succs.begin();
+        auto redsucc = *(succs.begin() + 1);
+        if (!color(graph, p, bluesucc, blue, red) ||
+            !color(graph, p, redsucc, red, blue)) {
+            return; // no DOD possible
+        }
+
+        if (!createApEdges(graph, p, nodes)) {
+            return; // no DOD possible
+        }
+
+        // get some blue node to have a starting point
+        NodeID b1 = 0;
+        for (auto n : nodes) {
+            if (isBlue(n, p)) {
+                b1 = n;
+                break;
+            }
+        }
+        assert(b1 && "Did not find any blue node");
+
+        if (!isCycle(b1, apsize - 1)) {
+            return; // no DOD possible
+        }
+
+        NodeID b2 = 0, b3 = 0;
+        NodeID r1 = 0, r2 = 0;
+
+        auto isblue = [&](NodeID x) -> bool { return isBlue(x, p); };
+        auto isred = [&](NodeID x) -> bool { return isRed(x, p); };
+
+        std::tie(b2, r1) = find(b1, b1, isblue, isred);
+        std::tie(r2, b3) = find(r1, b1, isred, isblue);
+        if (b3 != 0) {
+            if (find(b3, b1, isred, isred).first != 0) {
+                // there is another red, no DOD
+                return;
+            }
+        } else {
+            b3 = b1;
+        }
+
+        assert(b1);
+        assert(b2);
+        assert(b3);
+        assert(r1);
+        assert(r2);
+
+        if (asTernary) {
+            constructTernaryRelation(p, CD, b2, b3, r1, r2);
+        } else { // break into binary relation
+            constructBinaryRelation(p, CD, b2, b3, r1, r2);
+        }
     }
 
   public:
-    std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+    // returns the control dependencies for every node
+    CDResultDense computeDense(const CDGraphCSR &graph) {
+        CDResultDense CD(graph.size() + 1);
 
         DBG_SECTION_BEGIN(cda, "Computing DOD for all predicates");
 
         AllMaxPath allmaxpath;
-        DBG_SECTION_BEGIN(
-                cda,
-                "Coputing nodes that are on all max paths from nodes for fun "
-                        << graph.getName());
-        auto allpaths = allmaxpath.compute(graph);
+        DBG_SECTION_BEGIN(cda, "Computing nodes that are on all max paths "
+                               "from nodes");
+        const auto &allpaths = allmaxpath.computeDense(graph);
         DBG_SECTION_END(
                 cda,
                 "Done computing nodes that are on all max paths from nodes");
 
-        for (auto *p : graph.predicates()) {
-            computeDOD(p, graph, allpaths, CD, revCD);
+        initialize(graph);
+        for (auto p : graph.predicates()) {
+            computeDOD(graph, p, allpaths, CD);
         }
 
         DBG_SECTION_END(cda, "Finished computing DOD for all predicates");
-        return {CD, revCD};
+        return CD;
+    }
+
+    std::pair<ResultT, ResultT> compute(CDGraph &graph) {
+        DBG(cda, "Computing DOD for fun " << graph.getName());
+        CDGraphCSR csr(graph);
+        return getCDMaps(csr, computeDense(csr));
     }
 };
 
@@ -486,154 +412,140 @@ class DODRanganath {
     // by breaking a->(b, c) to (a, b) and (a, c). It is less precise,
     // but our API is not prepared for the ternary relation.
     using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using NodeID = CDGraphCSR::NodeID;
     enum class Color { WHITE, BLACK, UNCOLORED };
 
-    struct Info {
-        Color color{Color::UNCOLORED};
-    };
+    std::vector<Color> colors;
+    // a node is visited if visited == current search
+    std::vector<unsigned> visited;
+    unsigned search{0};
 
-    std::unordered_map<CDNode *, Info> data;
+    struct StackItem {
+        NodeID node;
+        // the index of the next successor to process
+        unsigned next;
+    };
+    std::vector<StackItem> stack;
 
-    void coloredDAG(CDGraph &graph, CDNode *n, std::set<CDNode *> &visited) {
-        if (visited.insert(n).second) {
-            const auto &successors = n->successors();
-            if (successors.empty())
-                return;
+    void newSearch() {
+        if (++search == 0) {
+            std::fill(visited.begin(), visited.end(), 0);
+            search = 1;
+        }
+    }
 
-            for (auto *q : successors) {
-                coloredDAG(graph, q, visited);
+    // color the nodes reachable from n: a node gets the color of its
+    // successors if they all have the same color. This is the recursive
+    // algorithm from the paper, but with an explicit stack.
+    void coloredDAG(const CDGraphCSR &graph, NodeID n) {
+        if (visited[n] == search)
+            return;
+        visited[n] = search;
+        colors[n] = Color::UNCOLORED;
+        stack.clear();
+        stack.push_back({n, 0});
+
+        while (!stack.empty()) {
+            auto &item = stack.back();
+            const auto &successors = graph.successors(item.node);
+            if (item.next < successors.size()) {
+                auto q = *(successors.begin() + item.next);
+                ++item.next;
+                if (visited[q] != search) {
+                    visited[q] = search;
+                    colors[q] = Color::UNCOLORED;
+                    // NOTE: invalidates 'item'
+                    stack.push_back({q, 0});
+                }
+                continue;
             }
-            auto *s = *(successors.begin());
-            auto c = data[s].color;
-            for (auto *q : successors) {
-                if (data[q].color != c) {
-                    c = Color::UNCOLORED;
-                    break;
+
+            // all successors are processed
+            if (!successors.empty()) {
+                auto c = colors[*successors.begin()];
+                for (auto q : successors) {
+                    if (colors[q] != c) {
+                        c = Color::UNCOLORED;
+                        break;
+                    }
                 }
+                colors[item.node] = c;
             }
-            data[n].color = c;
+            stack.pop_back();
         }
     }
 
-    bool dependence(CDNode *n, CDNode *m, CDNode *p, CDGraph &G) {
-        for (auto *n : G) {
-            data[n].color = Color::UNCOLORED;
-        }
-        data[m].color = Color::WHITE;
-        data[p].color = Color::BLACK;
-
-        std::set<CDNode *> visited;
-        visited.insert(m);
-        visited.insert(p);
+    bool dependence(const CDGraphCSR &graph, NodeID n, NodeID m, NodeID p) {
+        // the colors of nodes are reset when visiting them
+        newSearch();
+        colors[m] = Color::WHITE;
+        colors[p] = Color::BLACK;
+        visited[m] = search;
+        visited[p] = search;
 
-        coloredDAG(G, n, visited);
+        coloredDAG(graph, n);
 
         bool whiteChild = false;
         bool blackChild = false;
 
-        for (auto *q : n->successors()) {
-            if (data[q].color == Color::WHITE)
+        for (auto q : graph.successors(n)) {
+            // n may be m or p, then its successors were not visited
+            if (visited[q] != search)
+                continue;
+            if (colors[q] == Color::WHITE)
                 whiteChild = true;
-            if (data[q].color == Color::BLACK)
+            if (colors[q] == Color::BLACK)
                 blackChild = true;
         }
 
         return whiteChild && blackChild;
     }
 
-    // the paper uses 'reachable', but it is wrong
-    // Keep the method for now anyway.
-    static bool reachable(CDNode *from, CDNode *n) {
-        ADT::SetQueue<ADT::QueueLIFO<CDNode *>> queue;
-        queue.push(from);
-
-        while (!queue.empty()) {
-            auto *cur = queue.pop();
-            if (n == cur) {
-                return true;
-            }
+  public:
+    // returns the control dependencies for every node
+    CDResultDense computeDense(const CDGraphCSR &graph) {
+        CDResultDense CD(graph.size() + 1);
 
-            for (auto *s : cur->successors()) {
-                queue.push(s);
+        // onallpaths(m, p) from the paper holds iff p is in allpaths[m],
+        // so we compute it for all nodes at once
+        AllMaxPath allmaxpath;
+        const auto &allpaths = allmaxpath.computeDense(graph);
+
+        // the pairs of different nodes that lie on all max paths
+        // from each other. The relation is symmetric, so keep
+        // just the pairs where m < p.
+        std::vector<std::pair<NodeID, NodeID>> pairs;
+        for (NodeID m = 1; m <= graph.size(); ++m) {
+            for (auto p : allpaths[m]) {
+                if (m < p && allpaths[p].get(m)) {
+                    pairs.emplace_back(m, p);
+                }
             }
         }
-        return false;
-    }
 
-    static bool onallpaths(CDNode *from, CDNode *n, CDGraph &G) {
-        if (from == n) // fast path
-            return true;
-
-        struct NodeInf {
-            bool onstack{false};
-            bool visited{false};
-        };
-        std::unordered_map<CDNode *, NodeInf> data;
-
-        data.reserve(G.size());
-
-        const std::function<bool(CDNode *, CDNode *)> onallpths =
-                [&](CDNode *node, CDNode *target) -> bool {
-            if (node == target)
-                return true;
-
-            data[node].visited = true;
-
-            if (!node->hasSuccessors())
-                return false;
-
-            for (auto *s : node->successors()) {
-                if (data[s].onstack)
-                    return false;
-                if (!data[s].visited) {
-                    data[s].onstack = true;
-                    if (!onallpths(s, target))
-                        return false;
-                    data[s].onstack = false;
+        colors.assign(graph.size() + 1, Color::UNCOLORED);
+        visited.assign(graph.size() + 1, 0);
+        search = 0;
+
+        for (auto n : graph.predicates()) {
+            for (const auto &mp : pairs) {
+                if (dependence(graph, n, mp.second, mp.first)) {
+                    // DBG(cda, "DOD: " << n << " -> {"
+                    //                 << mp.first << ", " << mp.second
+                    //                 << "}");
+                    CD[mp.first].set(n);
+                    CD[mp.second].set(n);
                 }
             }
-            // if we have successors and got here,
-            // then all successors reach target
-            return true;
-        };
+        }
 
-        data[from].onstack = true;
-        // DBG(tmp, "on all paths:" << from->getID() << ", " << n->getID() << ":
-        // " << r );
-        return onallpths(from, n);
+        return CD;
     }
 
-  public:
     std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
-
         DBG(cda, "Computing DOD (Ranganath)");
-
-        data.reserve(graph.size());
-
-        for (auto *n : graph.predicates()) {
-            for (auto *m : graph) {
-                for (auto *p : graph) {
-                    if (p == m) {
-                        continue;
-                    }
-
-                    if (onallpaths(m, p, graph) && onallpaths(p, m, graph) &&
-                        dependence(n, p, m, graph)) {
-                        // DBG(cda, "DOD: " << n->getID() << " -> {"
-                        //                 << p->getID() << ", " << m->getID()
-                        //                 << "}");
-                        CD[m].insert(n);
-                        CD[p].insert(n);
-                        revCD[n].insert(m);
-                        revCD[n].insert(n);
-                    }
-                }
-            }
-        }
-
-        return {CD, revCD};
+        CDGraphCSR csr(graph);
+        return getCDMaps(csr, computeDense(csr));
     }
 };
 
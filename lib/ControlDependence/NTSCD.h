@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "CDGraph.h"
+#include "CDGraphCSR.h"
 #include "dg/ADT/Queue.h"
 #include "dg/ADT/SetQueue.h"
 
@@ -14,22 +15,32 @@ namespace dg {
 
 class NTSCD {
     using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using NodeID = CDGraphCSR::NodeID;
+
+    // the ID of the target that colored the node
+    std::vector<NodeID> color;
+    // the nodes that are in the frontier of the current round
+    // have here the number of the round
+    std::vector<unsigned> inFrontier;
+    unsigned round{0};
+
+    void addToFrontier(std::vector<NodeID> &frontier, NodeID id) {
+        if (inFrontier[id] != round) {
+            inFrontier[id] = round;
+            frontier.push_back(id);
+        }
+    }
 
-    struct Info {
-        unsigned color{0};
-    };
-
-    std::unordered_map<CDNode *, Info> data;
-
-    void compute(CDGraph &graph, CDNode *target, ResultT &CD, ResultT &revCD) {
-        std::set<CDNode *> frontier;
-        std::set<CDNode *> new_frontier;
+    void compute(const CDGraphCSR &graph, NodeID target, CDResultDense &CD) {
+        std::vector<NodeID> frontier;
+        std::vector<NodeID> new_frontier;
 
         // color the target node
-        data[target].color = target->getID();
-        for (auto *pred : target->predecessors()) {
-            if (data[pred].color != target->getID()) {
-                frontier.insert(pred);
+        ++round;
+        color[target] = target;
+        for (auto pred : graph.predecessors(target)) {
+            if (color[pred] != target) {
+                addToFrontier(frontier, pred);
             }
         }
 
@@ -37,13 +48,14 @@ class NTSCD {
         do {
             progress = false;
             new_frontier.clear();
+            ++round;
 
-            for (auto *nd : frontier) {
-                assert(!nd->successors().empty());
+            for (auto nd : frontier) {
+                assert(!graph.successors(nd).empty());
                 // do all successors have the right color?
                 bool colorit = true;
-                for (auto *succ : nd->successors()) {
-                    if (data[succ].color != target->getID()) {
+                for (auto succ : graph.successors(nd)) {
+                    if (color[succ] != target) {
                         colorit = false;
                         break;
                     }
@@ -51,16 +63,16 @@ class NTSCD {
 
                 // color the node and enqueue its predecessors
                 if (colorit) {
-                    data[nd].color = target->getID();
-                    for (auto *pred : nd->predecessors()) {
-                        if (data[pred].color != target->getID()) {
-                            new_frontier.insert(pred);
+                    color[nd] = target;
+                    for (auto pred : graph.predecessors(nd)) {
+                        if (color[pred] != target) {
+                            addToFrontier(new_frontier, pred);
                         }
                     }
                     progress = true;
                 } else {
                     // re-queue the node as nothing happend
-                    new_frontier.insert(nd);
+                    addToFrontier(new_frontier, nd);
                 }
             }
 
@@ -70,74 +82,76 @@ class NTSCD {
         // iterate over frontier set, not over predicates -- only
         // the predicates that are in the frontier set may have colored
         // and uncolored successors
-        for (auto *predicate : frontier) {
-            if (!graph.isPredicate(*predicate))
+        for (auto predicate : frontier) {
+            if (!graph.isPredicate(predicate))
                 continue;
             bool has_colored = false;
             bool has_uncolored = false;
-            for (auto *succ : predicate->successors()) {
-                if (data[succ].color == target->getID())
+            for (auto succ : graph.successors(predicate)) {
+                if (color[succ] == target)
                     has_colored = true;
-                if (data[succ].color != target->getID())
+                if (color[succ] != target)
                     has_uncolored = true;
             }
 
             if (has_colored && has_uncolored) {
-                CD[target].insert(predicate);
-                revCD[predicate].insert(target);
+                CD[target].set(predicate);
             }
         }
     }
 
   public:
-    // returns control dependencies and reverse control dependencies
-    std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+    // returns the control dependencies for every node
+    CDResultDense computeDense(const CDGraphCSR &graph) {
+        CDResultDense CD(graph.size() + 1);
 
-        data.reserve(graph.size());
+        color.assign(graph.size() + 1, 0);
+        inFrontier.assign(graph.size() + 1, 0);
+        round = 0;
 
-        for (auto *nd : graph) {
-            compute(graph, nd, CD, revCD);
+        for (NodeID nd = 1; nd <= graph.size(); ++nd) {
+            compute(graph, nd, CD);
         }
 
-        return {CD, revCD};
+        return CD;
+    }
+
+    // returns control dependencies and reverse control dependencies
+    std::pair<ResultT, ResultT> compute(CDGraph &graph) {
+        CDGraphCSR csr(graph);
+        return getCDMaps(csr, computeDense(csr));
     }
 };
 
 class NTSCD2 {
     using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using NodeID = CDGraphCSR::NodeID;
 
-    struct Info {
-        unsigned colored{false};
-        unsigned short counter;
-    };
+    std::vector<bool> colored;
+    std::vector<unsigned> counter;
 
-    std::unordered_map<CDNode *, Info> data;
-
-    void compute(CDGraph &graph, CDNode *target) {
+    void compute(const CDGraphCSR &graph, NodeID target) {
         // initialize nodes
-        for (auto *nd : graph) {
-            auto &D = data[nd];
-            D.colored = false;
-            D.counter = nd->successors().size();
+        for (NodeID nd = 1; nd <= graph.size(); ++nd) {
+            colored[nd] = false;
+            counter[nd] = graph.successors(nd).size();
         }
 
         // initialize the search
-        data[target].colored = true;
-        ADT::QueueLIFO<CDNode *> queue;
+        colored[target] = true;
+        ADT::QueueLIFO<NodeID> queue;
         queue.push(target);
 
         // search!
         while (!queue.empty()) {
-            auto *node = queue.pop();
-            assert(data[node].colored && "A non-colored node in queue");
-
-            for (auto *pred : node->predecessors()) {
-                auto &D = data[pred];
-                --D.counter;
-                if (D.counter == 0) {
-                    D.colored = true;
+            auto node = queue.pop();
+            assert(colored[node] && "A non-colored node in queue");
+
+            for (auto pred : graph.predecessors(node)) {
+                // the target may be its own predecessor, do not queue
+                // it again (that would decrement the counters twice)
+                if (--counter[pred] == 0 && !colored[pred]) {
+                    colored[pred] = true;
                     queue.push(pred);
                 }
             }
@@ -145,34 +159,206 @@ class NTSCD2 {
     }
 
   public:
-    // returns control dependencies and reverse control dependencies
-    std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+    // returns the control dependencies for every node
+    CDResultDense computeDense(const CDGraphCSR &graph) {
+        CDResultDense CD(graph.size() + 1);
 
-        data.reserve(graph.size());
+        colored.resize(graph.size() + 1);
+        counter.resize(graph.size() + 1);
 
-        for (auto *nd : graph) {
+        for (NodeID nd = 1; nd <= graph.size(); ++nd) {
             compute(graph, nd);
 
-            for (auto *predicate : graph.predicates()) {
+            for (auto predicate : graph.predicates()) {
                 bool has_colored = false;
                 bool has_uncolored = false;
-                for (auto *succ : predicate->successors()) {
-                    if (data[succ].colored)
+                for (auto succ : graph.successors(predicate)) {
+                    if (colored[succ])
                         has_colored = true;
-                    if (!data[succ].colored)
+                    if (!colored[succ])
                         has_uncolored = true;
                 }
 
                 if (has_colored && has_uncolored) {
-                    CD[nd].insert(predicate);
-                    revCD[predicate].insert(nd);
+                    CD[nd].set(predicate);
                 }
             }
         }
 
-        return {CD, revCD};
+        return CD;
+    }
+
+    // returns control dependencies and reverse control dependencies
+    std::pair<ResultT, ResultT> compute(CDGraph &graph) {
+        CDGraphCSR csr(graph);
+        return getCDMaps(csr, computeDense(csr));
+    }
+};
+
+/// NTSCD computed from the max-path post-dominance. A node n max-path
+/// post-dominates a node m if n is on every maximal path from m
+/// (i.e., m gets colored in the search from n in NTSCD2). The nodes that
+/// max-path post-dominate a node form a chain (of any two of them, one
+/// post-dominates the other), so the relation is kept as one pointer per
+/// node to its immediate post-dominator. The nodes on a cycle without
+/// an exit post-dominate each other and their pointers form a cycle.
+///
+/// The pointers are the least fixpoint of
+///
+///   MP(m) = {m} + intersection of MP(s) for all successors s of m
+///
+/// that is computed iteratively in the style of the dominators algorithm
+/// of Cooper, Harvey and Kennedy, starting with MP(m) = {m}. A node n
+/// then depends on a predicate p iff n post-dominates some successor
+/// of p, but not all of them, so we report the nodes on the chains
+/// of the successors of p until the chains meet. Once the pointers are
+/// computed, the cost is proportional to the number of the dependencies
+/// instead of searching the graph from every node. The results are the
+/// same as those of NTSCD2 (including the self-dependencies of predicates
+/// on cycles that NTSCD does not report).
+class NTSCD3 {
+    using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using NodeID = CDGraphCSR::NodeID;
+
+    // IDs of nodes start from 1
+    static constexpr NodeID NONE = 0;
+
+    // the immediate max-path post-dominator of every node (or NONE)
+    std::vector<NodeID> ipdom;
+    // stamps of the nodes marked (visited) by the last markChain()
+    // (firstMarked()), valid if equal to mark (visit)
+    std::vector<unsigned> marked;
+    std::vector<unsigned> visited;
+    unsigned mark{0};
+    unsigned visit{0};
+
+    // mark all nodes that post-dominate 'nd' (including 'nd')
+    void markChain(NodeID nd) {
+        ++mark;
+        for (; nd != NONE && marked[nd] != mark; nd = ipdom[nd])
+            marked[nd] = mark;
+    }
+
+    // the first node on the chain of 'nd' that was marked by markChain()
+    NodeID firstMarked(NodeID nd) {
+        ++visit;
+        for (; nd != NONE && visited[nd] != visit; nd = ipdom[nd]) {
+            if (marked[nd] == mark)
+                return nd;
+            visited[nd] = visit;
+        }
+        return NONE;
+    }
+
+    // the node whose chain is the intersection of the chains
+    // of the successors of 'nd' (NONE if the intersection is empty)
+    NodeID meet(const CDGraphCSR &graph, NodeID nd) {
+        auto succs = graph.successors(nd);
+        assert(!succs.empty());
+        NodeID cur = *succs.begin();
+        for (auto succ : succs) {
+            if (cur == NONE)
+                break;
+            markChain(cur);
+            cur = firstMarked(succ);
+        }
+        return cur;
+    }
+
+    // the nodes in the order in which all successors of a node
+    // go before the node (except for back edges)
+    static std::vector<NodeID> postorder(const CDGraphCSR &graph) {
+        std::vector<NodeID> order;
+        order.reserve(graph.size());
+        std::vector<bool> seen(graph.size() + 1, false);
+        // the node and the index of its next successor to visit
+        std::vector<std::pair<NodeID, unsigned>> stack;
+
+        for (NodeID root = 1; root <= graph.size(); ++root) {
+            if (seen[root])
+                continue;
+            seen[root] = true;
+            stack.emplace_back(root, 0);
+            while (!stack.empty()) {
+                auto &top = stack.back();
+                auto succs = graph.successors(top.first);
+                if (top.second < succs.size()) {
+                    auto succ = succs.begin()[top.second++];
+                    if (!seen[succ]) {
+                        seen[succ] = true;
+                        stack.emplace_back(succ, 0);
+                    }
+                    continue;
+                }
+                order.push_back(top.first);
+                stack.pop_back();
+            }
+        }
+        return order;
+    }
+
+    void computePostDominators(const CDGraphCSR &graph) {
+        const auto order = postorder(graph);
+        bool changed;
+        do {
+            changed = false;
+            for (auto nd : order) {
+                if (graph.successors(nd).empty())
+                    continue;
+
+                auto dom = meet(graph, nd);
+                if (dom == NONE || dom == ipdom[nd])
+                    continue;
+                // the chains only grow, so if 'dom' is already on the chain
+                // of 'nd', the chain stays the same
+                markChain(nd);
+                if (marked[dom] == mark)
+                    continue;
+
+                ipdom[nd] = dom;
+                changed = true;
+            }
+        } while (changed);
+    }
+
+  public:
+    // returns the control dependencies for every node
+    CDResultDense computeDense(const CDGraphCSR &graph) {
+        CDResultDense CD(graph.size() + 1);
+
+        ipdom.assign(graph.size() + 1, NodeID{NONE});
+        marked.assign(graph.size() + 1, 0);
+        visited.assign(graph.size() + 1, 0);
+        mark = visit = 0;
+
+        computePostDominators(graph);
+
+        for (auto predicate : graph.predicates()) {
+            // the nodes that post-dominate all successors
+            auto common = meet(graph, predicate);
+            ++mark;
+            for (auto nd = common; nd != NONE && marked[nd] != mark;
+                 nd = ipdom[nd])
+                marked[nd] = mark;
+
+            for (auto succ : graph.successors(predicate)) {
+                ++visit;
+                for (auto nd = succ; nd != NONE && marked[nd] != mark &&
+                                     visited[nd] != visit;
+                     nd = ipdom[nd]) {
+                    visited[nd] = visit;
+                    CD[nd].set(predicate);
+                }
+            }
+        }
+
+        return CD;
+    }
+
+    // returns control dependencies and reverse control dependencies
+    std::pair<ResultT, ResultT> compute(CDGraph &graph) {
+        CDGraphCSR csr(graph);
+        return getCDMaps(csr, computeDense(csr));
     }
 };
 
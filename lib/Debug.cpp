@@ -3,7 +3,8 @@ namespace dg {
 namespace debug {
 
 unsigned _debug_lvl = 0;
-unsigned _ind = 0;
+// the indentation of sections is per thread
+thread_local unsigned _ind = 0;
 
 } // namespace debug
 } // namespace dg
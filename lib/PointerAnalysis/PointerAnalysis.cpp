@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "dg/PointerAnalysis/PointerAnalysis.h"
 #include "dg/PointerAnalysis/Pointer.h"
 #include "dg/PointerAnalysis/PointsToSet.h"
@@ -255,6 +257,7 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *> &srcObjects,
                             changed |= destO->addPointsTo(Offset::UNKNOWN,
                                                           src.second);
                         } else {
+                            newOff = cropOffset(destO->node, newOff);
                             changed |= destO->addPointsTo(newOff, src.second);
                         }
                     } else {
@@ -269,6 +272,34 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *> &srcObjects,
     return changed;
 }
 
+Offset PointerAnalysis::cropOffset(const PSNode *target, Offset off) {
+    const auto budget = options.fieldSensitivityBudget;
+    if (budget == 0 || off.isUnknown())
+        return off;
+
+    auto &info = _objectOffsets[target];
+    auto &offsets = info.offsets;
+    auto it = std::lower_bound(offsets.begin(), offsets.end(), *off);
+    // the pointers that were created before the object got collapsed
+    // stay in the points-to sets, keep creating them the same way
+    if (it != offsets.end() && *it == *off)
+        return off;
+
+    if (info.collapsed)
+        return Offset::UNKNOWN;
+
+    if (offsets.size() >= budget) {
+        DBG(pta, "Object " << target->getID() << " exceeded the budget of "
+                           << budget << " offsets, collapsing it");
+        info.collapsed = true;
+        ++_collapsedNum;
+        return Offset::UNKNOWN;
+    }
+
+    offsets.insert(it, *off);
+    return off;
+}
+
 bool PointerAnalysis::processGep(PSNode *node) {
     bool changed = false;
 
@@ -288,7 +319,8 @@ bool PointerAnalysis::processGep(PSNode *node) {
         // to the begining of the memory - therefore make 0 exception
         if ((new_offset == 0 || new_offset < ptr.target->getSize()) &&
             new_offset < *options.fieldSensitivity)
-            changed |= node->addPointsTo(ptr.target, new_offset);
+            changed |= node->addPointsTo(ptr.target,
+                                         cropOffset(ptr.target, new_offset));
         else
             changed |= node->addPointsTo(ptr.target, Offset::UNKNOWN);
     }
@@ -488,6 +520,14 @@ static void setToEmpty(std::vector<PSNode *> &nodes) {
 bool PointerAnalysis::run() {
     DBG_SECTION_BEGIN(pta, "Running pointer analysis");
 
+    // the points-to sets created by the analysis
+    // (e.g., in memory objects) use the IDs of the graph
+    PointerIDLookupTable::Scope scope(PG->getLookupTable());
+    if (options.reservePointerIDBlocks) {
+        PG->getLookupTable().setReserveBlocks(true);
+        PG->reservePointerIDs();
+    }
+
     preprocess();
 
     // check that the current state of pointer analysis makes sense
@@ -49,6 +49,18 @@ void PointerGraph::initStaticNodes() {
     UNKNOWN_MEMORY->pointsTo.add(Pointer(UNKNOWN_MEMORY, Offset::UNKNOWN));
 }
 
+void PointerGraph::reservePointerIDs() {
+    // the special nodes are in many points-to sets, give them the first IDs
+    for (auto *nd : {UNKNOWN_MEMORY, NULLPTR, INVALIDATED})
+        _lookupTable->reserve(nd);
+
+    for (auto &nd : nodes) {
+        if (nd && (nd->getType() == PSNodeType::ALLOC ||
+                   nd->getType() == PSNodeType::FUNCTION))
+            _lookupTable->reserve(nd.get());
+    }
+}
+
 void PointerGraph::computeLoops() {
     DBG(pta, "Computing information about loops for the whole graph");
 
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+
 #include "dg/PointerAnalysis/PointerGraphOptimizations.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
 
@@ -130,6 +134,436 @@ void PSEquivalentNodesMerger::merge(PSNode *node1, PSNode *node2) {
     ++merged_nodes_num;
 }
 
+// The dominators in the procedures of the graph. The successors of a call
+// are its return site (the callee is skipped) and the return nodes
+// have no successors. The analysis propagates the changes along
+// the control flow, so a node can be replaced only by a node
+// that dominates it.
+class PSDominators {
+    struct DomInfo {
+        const PSNode *root{nullptr};
+        unsigned pre{0};
+        unsigned post{0};
+    };
+
+    std::unordered_map<const PSNode *, DomInfo> _info;
+
+    static std::vector<PSNode *> successors(PSNode *nd) {
+        std::vector<PSNode *> succs;
+        if (nd->getType() == PSNodeType::RETURN)
+            return succs;
+        if ((nd->getType() == PSNodeType::CALL ||
+             nd->getType() == PSNodeType::CALL_FUNCPTR) &&
+            nd->getPairedNode())
+            succs.push_back(nd->getPairedNode());
+        for (PSNode *succ : nd->successors()) {
+            if (succ->getType() != PSNodeType::ENTRY &&
+                std::find(succs.begin(), succs.end(), succ) == succs.end())
+                succs.push_back(succ);
+        }
+        return succs;
+    }
+
+    void compute(PSNode *root) {
+        // reverse postorder (Cooper, Harvey, Kennedy: A Simple, Fast
+        // Dominance Algorithm)
+        std::unordered_map<PSNode *, unsigned> order;
+        std::vector<PSNode *> postorder;
+        std::unordered_map<PSNode *, std::vector<PSNode *>> preds;
+        std::vector<std::pair<PSNode *, std::vector<PSNode *>>> stack;
+        order[root] = 0;
+        stack.emplace_back(root, successors(root));
+        while (!stack.empty()) {
+            auto &top = stack.back();
+            if (top.second.empty()) {
+                postorder.push_back(top.first);
+                stack.pop_back();
+                continue;
+            }
+            PSNode *succ = top.second.back();
+            top.second.pop_back();
+            preds[succ].push_back(top.first);
+            if (order.emplace(succ, 0).second) {
+                auto succs = successors(succ);
+                stack.emplace_back(succ, std::move(succs));
+            }
+        }
+
+        std::vector<PSNode *> rpo(postorder.rbegin(), postorder.rend());
+        for (unsigned i = 0; i < rpo.size(); ++i)
+            order[rpo[i]] = i;
+
+        std::vector<unsigned> idom(rpo.size(), ~0U);
+        idom[0] = 0;
+        auto intersect = [&](unsigned a, unsigned b) {
+            while (a != b) {
+                while (a > b)
+                    a = idom[a];
+                while (b > a)
+                    b = idom[b];
+            }
+            return a;
+        };
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (unsigned i = 1; i < rpo.size(); ++i) {
+                unsigned newIdom = ~0U;
+                for (PSNode *pred : preds[rpo[i]]) {
+                    unsigned p = order[pred];
+                    if (idom[p] == ~0U)
+                        continue;
+                    newIdom = newIdom == ~0U ? p : intersect(p, newIdom);
+                }
+                if (newIdom != idom[i]) {
+                    idom[i] = newIdom;
+                    changed = true;
+                }
+            }
+        }
+
+        // number the dominator tree, so that the dominance
+        // is a check of intervals
+        std::vector<std::vector<unsigned>> children(rpo.size());
+        for (unsigned i = 1; i < rpo.size(); ++i)
+            children[idom[i]].push_back(i);
+
+        unsigned counter = 0;
+        std::vector<std::pair<unsigned, size_t>> dfs{{0, 0}};
+        _info[root].root = root;
+        _info[root].pre = ++counter;
+        while (!dfs.empty()) {
+            auto &top = dfs.back();
+            if (top.second < children[top.first].size()) {
+                unsigned child = children[top.first][top.second++];
+                auto &info = _info[rpo[child]];
+                info.root = root;
+                info.pre = ++counter;
+                dfs.emplace_back(child, 0);
+            } else {
+                _info[rpo[top.first]].post = ++counter;
+                dfs.pop_back();
+            }
+        }
+    }
+
+  public:
+    PSDominators(PointerGraph *G) {
+        for (const auto &subg : G->getSubgraphs()) {
+            if (subg->root)
+                compute(subg->root);
+        }
+    }
+
+    bool isReachable(const PSNode *nd) const { return _info.count(nd) > 0; }
+
+    bool dominates(const PSNode *a, const PSNode *b) const {
+        auto ait = _info.find(a);
+        auto bit = _info.find(b);
+        if (ait == _info.end() || bit == _info.end())
+            return false;
+        const auto &ai = ait->second;
+        const auto &bi = bit->second;
+        return ai.root == bi.root && ai.pre <= bi.pre && bi.post <= ai.post;
+    }
+
+    // the key for sorting the nodes so that the dominators go first
+    std::pair<const PSNode *, unsigned> key(const PSNode *nd) const {
+        auto it = _info.find(nd);
+        if (it == _info.end())
+            return {nullptr, 0};
+        return {it->second.root, it->second.pre};
+    }
+};
+
+bool PSPointerEquivalenceMerger::isCopy(PSNode *nd) const {
+    switch (nd->getType()) {
+    case PSNodeType::CAST:
+        return true;
+    case PSNodeType::PHI:
+        return nd->getOperandsNum() > 0 && openNodes.count(nd) == 0;
+    default:
+        return false;
+    }
+}
+
+// is the label of the node computed from the labels of its operands?
+bool PSPointerEquivalenceMerger::isLabeledByOperands(PSNode *nd) const {
+    return isCopy(nd) ||
+           (nd->getType() == PSNodeType::GEP && loopGeps.count(nd) == 0);
+}
+
+bool PSPointerEquivalenceMerger::canBeMerged(PSNode *nd) const {
+    if (!isLabeledByOperands(nd) && nd->getType() != PSNodeType::CONSTANT)
+        return false;
+    // the global nodes are processed separately from the others
+    // and the nodes with operands added later must stay
+    if (openNodes.count(nd) > 0 || globals.count(nd) > 0)
+        return false;
+    // keep the joins and branches of the control flow, the flow-sensitive
+    // analyses merge (and check) the memory maps at the joins
+    if (nd->predecessorsNum() != 1 || nd->successorsNum() > 1)
+        return false;
+    // we cannot disconnect a node that is its own successor
+    return std::find(nd->successors().begin(), nd->successors().end(), nd) ==
+           nd->successors().end();
+}
+
+void PSPointerEquivalenceMerger::merge(PSNode *node, PSNode *rep) {
+    // do not remove duplicate operands, e.g., a store
+    // must keep both of its operands
+    node->replaceAllUsesWith(rep, false);
+    node->isolate();
+    node->removeAllOperands();
+
+    mapping.add(node, rep);
+    ++merged_nodes_num;
+}
+
+unsigned PSPointerEquivalenceMerger::run() {
+    // the kinds of expressions that the labels are made of
+    enum : uint64_t { GEP_EXPR = 1, PHI_EXPR, CONSTANT_EXPR };
+
+    struct NodeInfo {
+        unsigned index{0};
+        unsigned lowlink{0};
+        bool onStack{false};
+        unsigned label{0};
+    };
+
+    globals.clear();
+    globals.insert(G->getGlobals().begin(), G->getGlobals().end());
+
+    // the flow-insensitive analysis makes the offsets of GEPs on loops
+    // unknown (see PointerAnalysisFI::preprocessGEPs()), such a GEP
+    // is not equivalent to the same GEP outside of the loop
+    loopGeps.clear();
+    for (const auto &sg : G->getSubgraphs()) {
+        for (const auto &loop : sg->getLoops()) {
+            for (PSNode *nd : loop) {
+                if (nd->getType() == PSNodeType::GEP)
+                    loopGeps.insert(nd);
+            }
+        }
+    }
+
+    std::unordered_map<PSNode *, NodeInfo> info;
+    std::map<std::vector<uint64_t>, unsigned> expressions;
+    unsigned lastLabel = 0;
+
+    auto getLabel = [&](std::vector<uint64_t> expr) {
+        auto it = expressions.emplace(std::move(expr), 0);
+        if (it.second)
+            it.first->second = ++lastLabel;
+        return it.first->second;
+    };
+
+    // the label of the union of the given labels
+    auto getUnionLabel = [&](std::vector<uint64_t> labels) {
+        std::sort(labels.begin(), labels.end());
+        labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+        if (labels.empty())
+            return ++lastLabel;
+        if (labels.size() == 1)
+            return static_cast<unsigned>(labels[0]);
+        labels.insert(labels.begin(), PHI_EXPR);
+        return getLabel(std::move(labels));
+    };
+
+    auto labelOf = [&](PSNode *nd) -> uint64_t {
+        assert(info[nd].label != 0 && "The label is not computed yet");
+        return info[nd].label;
+    };
+
+    auto computeLabel = [&](PSNode *nd) -> unsigned {
+        if (isCopy(nd)) {
+            std::vector<uint64_t> labels;
+            for (PSNode *op : nd->getOperands())
+                labels.push_back(labelOf(op));
+            return getUnionLabel(std::move(labels));
+        }
+
+        switch (nd->getType()) {
+        case PSNodeType::GEP:
+            if (loopGeps.count(nd) > 0)
+                break;
+            return getLabel({GEP_EXPR, labelOf(nd->getOperand(0)),
+                             *PSNodeGep::get(nd)->getOffset()});
+        case PSNodeType::CONSTANT: {
+            auto *C = PSNodeConstant::get(nd);
+            return getLabel({CONSTANT_EXPR,
+                             reinterpret_cast<uintptr_t>(C->getTarget()),
+                             *C->getOffset()});
+        }
+        default:
+            break;
+        }
+
+        return ++lastLabel;
+    };
+
+    // label the strongly connected component of the graph
+    // of operands (the components come in topological order,
+    // so the operands from other components are labeled already)
+    auto labelSCC = [&](const std::vector<PSNode *> &scc) {
+        if (scc.size() == 1 && !scc[0]->hasOperand(scc[0])) {
+            info[scc[0]].label = computeLabel(scc[0]);
+            return;
+        }
+
+        bool onlyCopies = std::all_of(scc.begin(), scc.end(),
+                                      [&](PSNode *nd) { return isCopy(nd); });
+        if (!onlyCopies) {
+            for (PSNode *nd : scc)
+                info[nd].label = ++lastLabel;
+            return;
+        }
+
+        // a cycle of copies, all the nodes have the union
+        // of the pointers that come into the cycle
+        std::vector<uint64_t> labels;
+        for (PSNode *nd : scc) {
+            for (PSNode *op : nd->getOperands()) {
+                if (!info[op].onStack)
+                    labels.push_back(labelOf(op));
+            }
+        }
+        auto label = getUnionLabel(std::move(labels));
+        for (PSNode *nd : scc)
+            info[nd].label = label;
+    };
+
+    // Tarjan's algorithm on the graph where the edges go from the nodes
+    // to their operands (iterative, the graphs may be deep)
+    unsigned index = 0;
+    std::vector<PSNode *> stack;
+    std::vector<std::pair<PSNode *, size_t>> dfs;
+
+    auto visit = [&](PSNode *start) {
+        auto &startInfo = info[start];
+        if (startInfo.index != 0)
+            return;
+        startInfo.index = startInfo.lowlink = ++index;
+        startInfo.onStack = true;
+        stack.push_back(start);
+        dfs.emplace_back(start, 0);
+
+        while (!dfs.empty()) {
+            PSNode *nd = dfs.back().first;
+            size_t &next = dfs.back().second;
+
+            if (isLabeledByOperands(nd) && next < nd->getOperandsNum()) {
+                PSNode *op = nd->getOperand(next++);
+                auto &opInfo = info[op];
+                if (opInfo.index == 0) {
+                    opInfo.index = opInfo.lowlink = ++index;
+                    opInfo.onStack = true;
+                    stack.push_back(op);
+                    dfs.emplace_back(op, 0);
+                } else if (opInfo.onStack) {
+                    auto &ndInfo = info[nd];
+                    ndInfo.lowlink = std::min(ndInfo.lowlink, opInfo.index);
+                }
+                continue;
+            }
+
+            dfs.pop_back();
+            auto &ndInfo = info[nd];
+            if (!dfs.empty()) {
+                auto &parentInfo = info[dfs.back().first];
+                parentInfo.lowlink =
+                        std::min(parentInfo.lowlink, ndInfo.lowlink);
+            }
+
+            if (ndInfo.lowlink != ndInfo.index)
+                continue;
+
+            std::vector<PSNode *> scc;
+            PSNode *member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                scc.push_back(member);
+            } while (member != nd);
+
+            // keep the nodes on the stack while labeling, so that
+            // we know which operands are from this component
+            labelSCC(scc);
+            for (PSNode *sccNode : scc)
+                info[sccNode].onStack = false;
+        }
+    };
+
+    std::vector<PSNode *> nodes{UNKNOWN_MEMORY, NULLPTR, INVALIDATED};
+    for (const auto &nd : G->getNodes()) {
+        if (nd)
+            nodes.push_back(nd.get());
+    }
+    for (PSNode *nd : nodes)
+        visit(nd);
+
+    // the nodes that are processed before all the other nodes
+    // can replace any node
+    std::set<PSNode *> everywhere(globals);
+    everywhere.insert({UNKNOWN_MEMORY, NULLPTR, INVALIDATED});
+
+    PSDominators dominators(G);
+
+    // the nodes with the same label
+    std::map<unsigned, std::vector<PSNode *>> classes;
+    for (PSNode *nd : nodes)
+        classes[info[nd].label].push_back(nd);
+
+    for (auto &it : classes) {
+        auto &members = it.second;
+        if (members.size() < 2)
+            continue;
+
+        // the dominators go before the nodes they dominate
+        std::stable_sort(members.begin(), members.end(),
+                         [&](PSNode *a, PSNode *b) {
+                             return dominators.key(a) < dominators.key(b);
+                         });
+
+        auto universal =
+                std::find_if(members.begin(), members.end(),
+                             [&](PSNode *m) { return everywhere.count(m); });
+
+        // the nodes that stay in the graph
+        std::vector<PSNode *> kept;
+        bool merged = false;
+        for (PSNode *member : members) {
+            if (canBeMerged(member) && dominators.isReachable(member)) {
+                PSNode *rep = nullptr;
+                if (universal != members.end()) {
+                    rep = *universal;
+                } else {
+                    for (PSNode *k : kept) {
+                        if (dominators.dominates(k, member)) {
+                            rep = k;
+                            break;
+                        }
+                    }
+                }
+
+                if (rep) {
+                    merge(member, rep);
+                    merged = true;
+                    continue;
+                }
+            }
+
+            kept.push_back(member);
+        }
+
+        if (merged)
+            ++classes_num;
+    }
+
+    return merged_nodes_num;
+}
+
 unsigned PSNoopRemover::run() {
     unsigned removed = 0;
     for (const auto &nd : G->getNodes()) {
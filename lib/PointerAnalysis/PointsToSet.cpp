@@ -13,13 +13,31 @@ namespace pta {
 std::vector<PSNode *> SeparateOffsetsPointsToSet::idVector;
 std::vector<PSNode *> SmallOffsetsPointsToSet::idVector;
 std::vector<PSNode *> AlignedSmallOffsetsPointsToSet::idVector;
-std::vector<Pointer> AlignedPointerIdPointsToSet::idVector;
 std::map<PSNode *, size_t> SeparateOffsetsPointsToSet::ids;
-dg::PointerIDLookupTable PointerIdPointsToSet::lookupTable;
 std::map<PSNode *, size_t> SmallOffsetsPointsToSet::ids;
 std::map<PSNode *, size_t> AlignedSmallOffsetsPointsToSet::ids;
-std::map<Pointer, size_t> AlignedPointerIdPointsToSet::ids;
 
 } // namespace pta
 
+// the table that is current in this thread (nullptr means the default one)
+static thread_local PointerIDLookupTable *currentLookupTable = nullptr;
+
+PointerIDLookupTable &PointerIDLookupTable::getDefault() {
+    // created on the first use, so that it exists also
+    // for the statically created points-to sets
+    static PointerIDLookupTable table(16);
+    return table;
+}
+
+PointerIDLookupTable *PointerIDLookupTable::getCurrent() {
+    return currentLookupTable ? currentLookupTable : &getDefault();
+}
+
+PointerIDLookupTable::Scope::Scope(PointerIDLookupTable &table)
+        : _prev(currentLookupTable) {
+    currentLookupTable = &table;
+}
+
+PointerIDLookupTable::Scope::~Scope() { currentLookupTable = _prev; }
+
 } // namespace dg
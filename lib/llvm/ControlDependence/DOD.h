@@ -9,6 +9,7 @@
 
 #include "ControlDependence/DOD.h"
 #include "ControlDependence/DODNTSCD.h"
+#include "dg/util/ParallelFor.h"
 
 #include <map>
 #include <set>
@@ -138,14 +139,33 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
         if (F && !F->isDeclaration() && (_getGraph(F) == nullptr)) {
             computeOnDemand(const_cast<llvm::Function *>(F));
         } else {
+            std::vector<const llvm::Function *> funs;
+            funs.reserve(getModule()->size());
             for (const auto &f : *getModule()) {
-                if (!f.isDeclaration() && (_getGraph(&f) == nullptr)) {
-                    computeOnDemand(const_cast<llvm::Function *>(&f));
-                }
+                funs.push_back(&f);
             }
+            computeFunctions(funs);
         }
     }
 
+    void computeFunctions(
+            const std::vector<const llvm::Function *> &funs) override {
+        // the graph builder is shared by all functions,
+        // so build the graphs sequentially...
+        std::vector<Info *> infos;
+        infos.reserve(funs.size());
+        for (const auto *f : funs) {
+            if (!f->isDeclaration() && (_getGraph(f) == nullptr)) {
+                infos.push_back(&buildGraph(f));
+            }
+        }
+
+        // ... but the graphs are independent, so compute
+        // the dependencies in parallel
+        util::parallelFor(infos.size(), getOptions().jobs(),
+                          [&](size_t i) { computeCD(*infos[i]); });
+    }
+
     CDGraph *getGraph(const llvm::Function *f) override { return _getGraph(f); }
     const CDGraph *getGraph(const llvm::Function *f) const override {
         return _getGraph(f);
@@ -177,6 +197,10 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
 
     void computeOnDemand(llvm::Function *F) {
         DBG(cda, "Triggering on-demand computation for " << F->getName().str());
+        computeCD(buildGraph(F));
+    }
+
+    Info &buildGraph(const llvm::Function *F) {
         assert(_getGraph(F) == nullptr && "Already have the graph");
 
         auto tmpgraph =
@@ -184,8 +208,12 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
         // FIXME: we can actually just forget the graph if we do not want to
         // dump it to the user
         auto it = _graphs.emplace(F, std::move(tmpgraph));
+        return it.first->second;
+    }
 
-        auto &info = it.first->second;
+    // compute the dependencies in an already built graph,
+    // this touches only the 'info' object
+    void computeCD(Info &info) const {
 
         if (getOptions().dodRanganathCD()) {
             dg::DODRanganath dod;
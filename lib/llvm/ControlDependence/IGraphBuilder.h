@@ -78,7 +78,14 @@ class ICDGraphBuilder {
 
         // function pointer call
         std::vector<const llvm::Function *> funs;
-        if (_pta) {
+        const auto *frozen = _cg ? _cg->getFrozen() : nullptr;
+        if (frozen && frozen->hasFunction(C->getParent()->getParent())) {
+            for (const auto *fun : frozen->getCalledFunctions(C)) {
+                if (!fun->isDeclaration()) {
+                    funs.push_back(fun);
+                }
+            }
+        } else if (_pta) {
             auto pts = _pta->getLLVMPointsTo(_getCalledValue(C));
             for (const auto &ptr : pts) {
                 if (auto *fun = llvm::dyn_cast<llvm::Function>(ptr.value)) {
@@ -88,11 +95,8 @@ class ICDGraphBuilder {
                 }
             }
         }
-        if (_cg) {
-            // return _cg->getCalledFunctions(C);
-            abort();
-            return {};
-        }
+        // FIXME: use also the lazy call graphs
+        // (they can resolve the calls without PTA)
 
         return funs;
     }
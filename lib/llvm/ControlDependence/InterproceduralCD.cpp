@@ -4,6 +4,7 @@
 #include <llvm/IR/Module.h>
 
 #include "dg/ADT/Queue.h"
+#include "dg/llvm/CallGraph/CallGraph.h"
 #include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
 #include "dg/util/debug.h"
 #include "llvm/ControlDependence/InterproceduralCD.h"
@@ -13,8 +14,25 @@ using namespace std;
 namespace dg {
 namespace llvmdg {
 
+LLVMInterprocCD::LLVMInterprocCD(
+        const llvm::Module *module,
+        const LLVMControlDependenceAnalysisOptions &opts,
+        LLVMPointerAnalysis *pta, CallGraph *cg)
+        : LLVMControlDependenceAnalysisImpl(module, opts), PTA(pta),
+          _cg(cg ? cg->getFrozen() : nullptr) {}
+
 std::vector<const llvm::Function *>
-LLVMInterprocCD::getCalledFunctions(const llvm::Value *v) {
+LLVMInterprocCD::getCalledFunctions(const llvm::CallInst *C) {
+    if (_cg && _cg->hasFunction(C->getParent()->getParent())) {
+        auto funs = _cg->getCalledFunctions(C);
+        return {funs.begin(), funs.end()};
+    }
+
+#if LLVM_VERSION_MAJOR >= 8
+    auto *v = C->getCalledOperand();
+#else
+    auto *v = C->getCalledValue();
+#endif
     if (const auto *F = llvm::dyn_cast<llvm::Function>(v)) {
         return {F};
     }
@@ -36,6 +54,12 @@ void LLVMInterprocCD::computeFuncInfo(const llvm::Function *fun,
     if (fun->isDeclaration() || hasFuncInfo(fun))
         return;
 
+    if (_cg && _cg->hasFunction(fun)) {
+        computeCallGraphFuncInfos();
+        assert(hasFuncInfo(fun) && "Did not compute func info");
+        return;
+    }
+
     DBG_SECTION_BEGIN(cda, "Computing no-return points for function "
                                    << fun->getName().str());
 
@@ -61,12 +85,7 @@ void LLVMInterprocCD::computeFuncInfo(const llvm::Function *fun,
                 continue;
             }
 
-#if LLVM_VERSION_MAJOR >= 8
-            auto *val = C->getCalledOperand();
-#else
-            auto *val = C->getCalledValue();
-#endif
-            for (const auto *calledFun : getCalledFunctions(val)) {
+            for (const auto *calledFun : getCalledFunctions(C)) {
                 if (calledFun->isDeclaration())
                     continue;
 
@@ -94,6 +113,56 @@ void LLVMInterprocCD::computeFuncInfo(const llvm::Function *fun,
                                  << fun->getName().str());
 }
 
+// The same as computeFuncInfo, but we process the functions in the bottom-up
+// order of the call graph, so the callees are processed before their callers
+// and we need no recursion. Calls inside an SCC are recursive calls.
+void LLVMInterprocCD::computeCallGraphFuncInfos() {
+    using namespace llvm;
+
+    assert(_cg && "Do not have the call graph");
+    if (_cgFuncInfosComputed)
+        return;
+    _cgFuncInfosComputed = true;
+
+    DBG_SECTION_BEGIN(cda, "Computing no-return points in the call graph");
+
+    for (auto id : _cg->bottomUp()) {
+        const auto *fun = _cg->getFunction(id);
+        if (fun->isDeclaration() || hasFuncInfo(fun))
+            continue;
+
+        auto &info = _funcInfos[fun];
+        const auto scc = _cg->getSCC(id);
+        for (const auto &B : *fun) {
+            if (hasNoSuccessors(&B) && !isa<ReturnInst>(B.getTerminator())) {
+                info.noret.insert(B.getTerminator());
+            }
+        }
+
+        for (const auto *C : _cg->callSites(id)) {
+            for (const auto *calledFun : _cg->getCalledFunctions(C)) {
+                if (calledFun->isDeclaration())
+                    continue;
+
+                if (_cg->getSCC(_cg->getID(calledFun)) == scc) {
+                    // recursive call
+                    info.noret.insert(C);
+                    break;
+                }
+
+                auto *fi = getFuncInfo(calledFun);
+                assert(fi && "Did not compute func info");
+                if (!fi->noret.empty()) {
+                    info.noret.insert(C);
+                    break;
+                }
+            }
+        }
+    }
+
+    DBG_SECTION_END(cda, "Done computing no-return points in the call graph");
+}
+
 struct BlkInfo {
     // noret points in a block
     std::vector<llvm::Value *> noret;
@@ -117,12 +186,7 @@ void LLVMInterprocCD::computeCD(const llvm::Function *fun) {
             }
 
             bool maynoret = false;
-#if LLVM_VERSION_MAJOR >= 8
-            auto *val = C->getCalledOperand();
-#else
-            auto *val = C->getCalledValue();
-#endif
-            for (const auto *calledFun : getCalledFunctions(val)) {
+            for (const auto *calledFun : getCalledFunctions(C)) {
                 if (calledFun->isDeclaration())
                     continue;
 
@@ -20,10 +20,14 @@ class LLVMPointerAnalysis;
 namespace llvmdg {
 
 class CallGraph;
+class CallGraphCSR;
 
 class LLVMInterprocCD : public LLVMControlDependenceAnalysisImpl {
     LLVMPointerAnalysis *PTA{nullptr};
-    // CallGraph *_cg{nullptr};
+    // if we have a frozen call graph, we compute the function infos
+    // for all functions in the call graph at once in the bottom-up order
+    const CallGraphCSR *_cg{nullptr};
+    bool _cgFuncInfosComputed{false};
 
     struct FuncInfo {
         // points that may abort the program
@@ -58,10 +62,12 @@ class LLVMInterprocCD : public LLVMControlDependenceAnalysisImpl {
     // calls
     void computeFuncInfo(const llvm::Function *fun,
                          std::set<const llvm::Function *> stack = {});
+    // compute function info for the functions from the call graph
+    void computeCallGraphFuncInfos();
     void computeCD(const llvm::Function *fun);
 
     std::vector<const llvm::Function *>
-    getCalledFunctions(const llvm::Value *v);
+    getCalledFunctions(const llvm::CallInst *C);
 
   public:
     using ValVec = LLVMControlDependenceAnalysisImpl::ValVec;
@@ -69,9 +75,7 @@ class LLVMInterprocCD : public LLVMControlDependenceAnalysisImpl {
     LLVMInterprocCD(const llvm::Module *module,
                     const LLVMControlDependenceAnalysisOptions &opts = {},
                     LLVMPointerAnalysis *pta = nullptr,
-                    CallGraph * /* cg */ = nullptr)
-            : LLVMControlDependenceAnalysisImpl(module, opts), PTA(pta)
-    /*, _cg(cg) */ {}
+                    CallGraph *cg = nullptr);
 
     ValVec getNoReturns(const llvm::Function *fun) override {
         ValVec ret;
@@ -8,6 +8,7 @@
 #include "dg/llvm/ControlDependence/ControlDependence.h"
 
 #include "ControlDependence/NTSCD.h"
+#include "dg/util/ParallelFor.h"
 
 #include <map>
 #include <set>
@@ -134,14 +135,33 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
         if (F && !F->isDeclaration() && (_getGraph(F) == nullptr)) {
             computeOnDemand(const_cast<llvm::Function *>(F));
         } else {
+            std::vector<const llvm::Function *> funs;
+            funs.reserve(getModule()->size());
             for (const auto &f : *getModule()) {
-                if (!f.isDeclaration() && (_getGraph(&f) == nullptr)) {
-                    computeOnDemand(const_cast<llvm::Function *>(&f));
-                }
+                funs.push_back(&f);
             }
+            computeFunctions(funs);
         }
     }
 
+    void computeFunctions(
+            const std::vector<const llvm::Function *> &funs) override {
+        // the graph builder is shared by all functions,
+        // so build the graphs sequentially...
+        std::vector<Info *> infos;
+        infos.reserve(funs.size());
+        for (const auto *f : funs) {
+            if (!f->isDeclaration() && (_getGraph(f) == nullptr)) {
+                infos.push_back(&buildGraph(f));
+            }
+        }
+
+        // ... but the graphs are independent, so compute
+        // the dependencies in parallel
+        util::parallelFor(infos.size(), getOptions().jobs(),
+                          [&](size_t i) { computeCD(*infos[i]); });
+    }
+
     CDGraph *getGraph(const llvm::Function *f) override { return _getGraph(f); }
     const CDGraph *getGraph(const llvm::Function *f) const override {
         return _getGraph(f);
@@ -173,6 +193,10 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
 
     void computeOnDemand(llvm::Function *F) {
         DBG(cda, "Triggering on-demand computation for " << F->getName().str());
+        computeCD(buildGraph(F));
+    }
+
+    Info &buildGraph(const llvm::Function *F) {
         assert(_getGraph(F) == nullptr && "Already have the graph");
 
         auto tmpgraph =
@@ -180,9 +204,12 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
         // FIXME: we can actually just forget the graph if we do not want to
         // dump it to the user
         auto it = _graphs.emplace(F, std::move(tmpgraph));
+        return it.first->second;
+    }
 
-        auto &info = it.first->second;
-
+    // compute the dependencies in an already built graph,
+    // this touches only the 'info' object
+    void computeCD(Info &info) const {
         const auto &opts = getOptions();
         if (opts.ntscd2CD()) {
             DBG(cda, "Using the NTSCD 2 algorithm");
@@ -190,6 +217,12 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
             auto result = ntscd.compute(info.graph);
             info.controlDependence = std::move(result.first);
             info.revControlDependence = std::move(result.second);
+        } else if (opts.ntscd3CD()) {
+            DBG(cda, "Using the NTSCD 3 algorithm");
+            dg::NTSCD3 ntscd;
+            auto result = ntscd.compute(info.graph);
+            info.controlDependence = std::move(result.first);
+            info.revControlDependence = std::move(result.second);
         } else if (opts.ntscdRanganathCD() || opts.ntscdRanganathOrigCD()) {
             DBG(cda, "Using the NTSCD Ranganath algorithm");
             dg::NTSCDRanganath ntscd;
@@ -335,6 +368,12 @@ class InterproceduralNTSCD : public LLVMControlDependenceAnalysisImpl {
             auto result = ntscd.compute(graph);
             controlDependence = std::move(result.first);
             revControlDependence = std::move(result.second);
+        } else if (getOptions().ntscd3CD()) {
+            DBG(cda, "Using the NTSCD 3 algorithm");
+            dg::NTSCD3 ntscd;
+            auto result = ntscd.compute(graph);
+            controlDependence = std::move(result.first);
+            revControlDependence = std::move(result.second);
         } else if (getOptions().ntscdRanganathCD()) {
             DBG(cda, "Using the NTSCD Ranganath algorithm");
             dg::NTSCDRanganath ntscd;
@@ -72,7 +72,7 @@ class PostDominanceFrontiers {
     }
 };
 
-void SCD::computePostDominators(llvm::Function &F) {
+void SCD::computePostDominators(llvm::Function &F, Frontiers &result) {
     DBG_SECTION_BEGIN(cda, "Computing post dominators for function "
                                    << F.getName().str());
     using namespace llvm;
@@ -111,8 +111,7 @@ void SCD::computePostDominators(llvm::Function &F) {
 
         // FIXME: reserve the memory
         for (auto *pdf : pdfrontiers) {
-            dependencies[&B].insert(pdf);
-            dependentBlocks[pdf].insert(&B);
+            result.deps.emplace_back(&B, pdf);
         }
     }
 #endif
@@ -124,8 +123,7 @@ void SCD::computePostDominators(llvm::Function &F) {
         assert(pdtreenode && "Do not have a node in post-dom tree");
         auto &pdfrontiers = PDF.calculate(*pdtree, pdtreenode);
         for (auto *pdf : pdfrontiers) {
-            dependencies[&B].insert(pdf);
-            dependentBlocks[pdf].insert(&B);
+            result.deps.emplace_back(&B, pdf);
         }
     }
 
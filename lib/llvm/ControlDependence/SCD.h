@@ -4,11 +4,13 @@
 #include <llvm/IR/Module.h>
 
 #include "dg/llvm/ControlDependence/ControlDependence.h"
+#include "dg/util/ParallelFor.h"
 #include "dg/util/debug.h"
 
 #include <map>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace llvm {
 class Function;
@@ -25,17 +27,34 @@ namespace llvmdg {
 // This class uses purely LLVM, no internal representation
 // like the other classes (we use the post-dominance computation from LLVM).
 class SCD : public LLVMControlDependenceAnalysisImpl {
-    void computePostDominators(llvm::Function &F);
+    using BlocksMapT = std::unordered_map<const llvm::BasicBlock *,
+                                          std::set<llvm::BasicBlock *>>;
 
-    std::unordered_map<const llvm::BasicBlock *, std::set<llvm::BasicBlock *>>
-            dependentBlocks;
-    std::unordered_map<const llvm::BasicBlock *, std::set<llvm::BasicBlock *>>
-            dependencies;
+    // the post-dominance frontiers of one function
+    struct Frontiers {
+        std::vector<std::pair<llvm::BasicBlock *, llvm::BasicBlock *>> deps;
+    };
+
+    // this does not touch the members, so it can run in parallel
+    static void computePostDominators(llvm::Function &F, Frontiers &result);
+
+    BlocksMapT dependentBlocks;
+    BlocksMapT dependencies;
     std::set<const llvm::Function *> _computed;
 
+    void addFrontiers(const Frontiers &frontiers) {
+        for (const auto &dep : frontiers.deps) {
+            dependencies[dep.first].insert(dep.second);
+            dependentBlocks[dep.second].insert(dep.first);
+        }
+    }
+
     void computeOnDemand(const llvm::Function *F) {
         if (_computed.insert(F).second) {
-            computePostDominators(*const_cast<llvm::Function *>(F));
+            Frontiers frontiers;
+            computePostDominators(*const_cast<llvm::Function *>(F),
+                                  frontiers);
+            addFrontiers(frontiers);
         }
     }
 
@@ -74,13 +93,35 @@ class SCD : public LLVMControlDependenceAnalysisImpl {
         if (F && !F->isDeclaration()) {
             computeOnDemand(F);
         } else {
+            std::vector<const llvm::Function *> funs;
+            funs.reserve(getModule()->size());
             for (const auto &f : *getModule()) {
-                if (f.isDeclaration()) {
-                    continue;
-                }
-                computeOnDemand(&f);
+                funs.push_back(&f);
+            }
+            computeFunctions(funs);
+        }
+    }
+
+    void computeFunctions(
+            const std::vector<const llvm::Function *> &funs) override {
+        std::vector<const llvm::Function *> todo;
+        todo.reserve(funs.size());
+        for (const auto *f : funs) {
+            if (!f->isDeclaration() && _computed.insert(f).second) {
+                todo.push_back(f);
             }
         }
+
+        std::vector<Frontiers> frontiers(todo.size());
+        util::parallelFor(todo.size(), getOptions().jobs(), [&](size_t i) {
+            computePostDominators(*const_cast<llvm::Function *>(todo[i]),
+                                  frontiers[i]);
+        });
+
+        // merge the results in the order of the functions
+        for (const auto &fr : frontiers) {
+            addFrontiers(fr);
+        }
     }
 };
 
@@ -11,7 +11,7 @@ namespace dg {
 namespace llvmdg {
 namespace legacy {
 
-int Block::traversalCounter = 0;
+std::atomic<int> Block::traversalCounter{0};
 
 const std::set<Block *> &Block::predecessors() const { return predecessors_; }
 
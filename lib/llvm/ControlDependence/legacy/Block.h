@@ -1,6 +1,7 @@
 #ifndef DG_LEGACY_NTSCD_BLOCK_H
 #define DG_LEGACY_NTSCD_BLOCK_H
 
+#include <atomic>
 #include <iosfwd>
 #include <map>
 #include <set>
@@ -76,7 +77,7 @@ class Block {
     void dumpEdges(std::ostream &ostream) const;
 
   private:
-    static int traversalCounter;
+    static std::atomic<int> traversalCounter;
 
     std::vector<const llvm::Instruction *> llvmInstructions_;
 
@@ -2,6 +2,7 @@
 #define DG_LEGACY_NTSCD_TARJANANALYSIS_H
 
 #include <algorithm>
+#include <atomic>
 #include <queue>
 #include <set>
 #include <stack>
@@ -19,7 +20,7 @@ class TarjanAnalysis {
   public:
     class StronglyConnectedComponent {
       private:
-        static int idCounter;
+        static std::atomic<int> idCounter;
 
       public:
         StronglyConnectedComponent() : id_(++idCounter) {}
@@ -175,7 +176,7 @@ class TarjanAnalysis {
 };
 
 template <typename T>
-int TarjanAnalysis<T>::StronglyConnectedComponent::idCounter = 0;
+std::atomic<int> TarjanAnalysis<T>::StronglyConnectedComponent::idCounter{0};
 
 } // namespace legacy
 } // namespace llvmdg
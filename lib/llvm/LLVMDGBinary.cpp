@@ -0,0 +1,569 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+
+#include "dg/ADT/Queue.h"
+#include "dg/llvm/LLVMDGBinary.h"
+#include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/LLVMNode.h"
+
+namespace dg {
+namespace llvmdg {
+
+const uint32_t ModuleValueNumbering::NONE;
+
+ModuleValueNumbering::ModuleValueNumbering(const llvm::Module &M) {
+    auto add = [this](const llvm::Value *val) {
+        _ids.emplace(val, static_cast<uint32_t>(_values.size()));
+        _values.push_back(val);
+        // FNV-1a of the kinds of values (the kinds of instructions
+        // include their opcodes)
+        _hash = (_hash ^ val->getValueID()) * 16777619U;
+    };
+
+    for (const auto &G : M.globals())
+        add(&G);
+    for (const auto &F : M)
+        add(&F);
+    for (const auto &F : M) {
+        if (F.isDeclaration())
+            continue;
+        for (const auto &A : F.args())
+            add(&A);
+        for (const auto &B : F) {
+            for (const auto &I : B)
+                add(&I);
+        }
+    }
+}
+
+namespace {
+
+using dgbin::EdgeKind;
+using dgbin::NodeKind;
+
+///
+// Numbers the nodes of the graph and collects their edges.
+class Serializer {
+    const ModuleValueNumbering &numbering;
+
+    std::vector<LLVMNode *> nodes;
+    std::vector<dgbin::Node> records;
+    std::unordered_map<const LLVMNode *, uint32_t> ids;
+
+    uint32_t valueID(const llvm::Value *val) const {
+        return val ? numbering.getID(val) : ModuleValueNumbering::NONE;
+    }
+
+    void add(LLVMNode *nd, NodeKind kind, const llvm::Value *val,
+             const llvm::Value *callSite = nullptr) {
+        if (!nd || ids.count(nd) > 0)
+            return;
+
+        ids.emplace(nd, static_cast<uint32_t>(nodes.size()));
+        nodes.push_back(nd);
+        records.push_back({kind, valueID(val), ModuleValueNumbering::NONE,
+                           valueID(callSite)});
+    }
+
+    // add the node with the kind given by its value
+    void add(LLVMNode *nd) {
+        const auto *val = nd->getValue();
+        auto id = valueID(val);
+        if (id == ModuleValueNumbering::NONE)
+            add(nd, NodeKind::ARTIFICIAL, nullptr);
+        else if (llvm::isa<llvm::Instruction>(val))
+            add(nd, NodeKind::INSTRUCTION, val);
+        else if (llvm::isa<llvm::Argument>(val))
+            add(nd, NodeKind::ARGUMENT, val);
+        else
+            add(nd, NodeKind::GLOBAL, val);
+    }
+
+    // add the parameters ordered by the values that they represent
+    void addParameters(LLVMDGParameters *params, NodeKind in, NodeKind out,
+                       NodeKind noret, const llvm::Value *callSite) {
+        if (!params)
+            return;
+
+        std::vector<std::pair<uint32_t, const LLVMDGParameter *>> sorted;
+        for (const auto &it : *params)
+            sorted.emplace_back(valueID(it.first), &it.second);
+        for (auto it = params->global_begin(), et = params->global_end();
+             it != et; ++it)
+            sorted.emplace_back(valueID(it->first), &it->second);
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [](const std::pair<uint32_t, const LLVMDGParameter *>
+                                    &a,
+                            const std::pair<uint32_t, const LLVMDGParameter *>
+                                    &b) { return a.first < b.first; });
+
+        for (const auto &it : sorted) {
+            const auto *val = it.first == ModuleValueNumbering::NONE
+                                      ? nullptr
+                                      : numbering.getValue(it.first);
+            add(it.second->in, in, val, callSite);
+            add(it.second->out, out, val, callSite);
+        }
+        if (auto *vararg = params->getVarArg()) {
+            add(vararg->in, in, nullptr, callSite);
+            add(vararg->out, out, nullptr, callSite);
+        }
+        add(params->getNoReturn(), noret, nullptr, callSite);
+    }
+
+    void addFunction(const llvm::Function &F, LLVMDependenceGraph *dg) {
+        add(dg->getEntry(), NodeKind::FUNCTION_ENTRY, &F);
+        for (const auto &A : F.args()) {
+            auto it = dg->find(const_cast<llvm::Argument *>(&A));
+            if (it != dg->end())
+                add(it->second);
+        }
+        for (const auto &B : F) {
+            for (const auto &I : B) {
+                auto it = dg->find(const_cast<llvm::Instruction *>(&I));
+                if (it != dg->end())
+                    add(it->second);
+            }
+        }
+        add(dg->getExit(), NodeKind::FUNCTION_EXIT, nullptr);
+        // the rest of the local nodes (in no particular order)
+        for (auto &it : *dg)
+            add(it.second);
+    }
+
+    void addParameters(const llvm::Function &F, LLVMDependenceGraph *dg) {
+        addParameters(dg->getParameters(), NodeKind::FORMAL_IN,
+                      NodeKind::FORMAL_OUT, NodeKind::FORMAL_NORETURN,
+                      nullptr);
+        for (const auto &B : F) {
+            for (const auto &I : B) {
+                if (!llvm::isa<llvm::CallInst>(&I))
+                    continue;
+                auto it = dg->find(const_cast<llvm::Instruction *>(&I));
+                if (it == dg->end())
+                    continue;
+                addParameters(it->second->getParameters(), NodeKind::ACTUAL_IN,
+                              NodeKind::ACTUAL_OUT, NodeKind::ACTUAL_NORETURN,
+                              &I);
+            }
+        }
+    }
+
+    template <typename Iter>
+    void addDeps(std::vector<uint32_t> &out, Iter it, Iter et) {
+        for (; it != et; ++it) {
+            out.push_back(getOrAdd(*it));
+        }
+    }
+
+    uint32_t getOrAdd(LLVMNode *nd) {
+        auto it = ids.find(nd);
+        if (it != ids.end())
+            return it->second;
+        add(nd);
+        return ids[nd];
+    }
+
+  public:
+    // dependencies of nodes, indexed by the kind of edges and node ID
+    std::vector<std::vector<uint32_t>> deps[dgbin::EDGE_KINDS_NUM];
+
+    Serializer(const ModuleValueNumbering &numbering)
+            : numbering(numbering) {}
+
+    void run(LLVMDependenceGraph &dg, const llvm::Module &M) {
+        const auto &constructed = dg.getConstructedFunctions();
+
+        // number the nodes that have values in the module first,
+        // in the order of the module, then the parameters
+        if (const auto &globals = dg.getGlobalNodes()) {
+            for (const auto &G : M.globals()) {
+                auto it = globals->find(const_cast<llvm::GlobalVariable *>(&G));
+                if (it != globals->end())
+                    add(it->second);
+            }
+        }
+        for (const auto &F : M) {
+            auto it = constructed.find(const_cast<llvm::Function *>(&F));
+            if (it != constructed.end())
+                addFunction(F, it->second);
+        }
+        for (const auto &F : M) {
+            auto it = constructed.find(const_cast<llvm::Function *>(&F));
+            if (it != constructed.end())
+                addParameters(F, it->second);
+        }
+
+        // collect the edges, the nodes that we did not find yet
+        // are numbered when we find them as targets of edges
+        for (auto &d : deps)
+            d.reserve(nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            auto *nd = nodes[i];
+            for (auto &d : deps)
+                d.emplace_back();
+
+            addDeps(deps[EdgeKind::USE][i], nd->user_begin(), nd->user_end());
+            addDeps(deps[EdgeKind::MEMORY][i], nd->rev_data_begin(),
+                    nd->rev_data_end());
+            addDeps(deps[EdgeKind::CONTROL][i], nd->rev_control_begin(),
+                    nd->rev_control_end());
+            if (auto *B = nd->getBBlock()) {
+                for (auto *CD : B->revControlDependence()) {
+                    if (auto *last = CD->getLastNode())
+                        deps[EdgeKind::CONTROL][i].push_back(getOrAdd(last));
+                }
+            }
+            addDeps(deps[EdgeKind::INTERFERENCE][i], nd->rev_interference_begin(),
+                    nd->rev_interference_end());
+
+            if (auto *ndg = nd->getDG()) {
+                if (auto *entry = ndg->getEntry()) {
+                    // getOrAdd() may grow the records
+                    auto entryID = getOrAdd(entry);
+                    records[i].entry = entryID;
+                }
+            }
+        }
+
+        for (auto &d : deps) {
+            for (auto &targets : d) {
+                std::sort(targets.begin(), targets.end());
+                targets.erase(std::unique(targets.begin(), targets.end()),
+                              targets.end());
+            }
+        }
+    }
+
+    size_t size() const { return nodes.size(); }
+    const std::vector<dgbin::Node> &getRecords() const { return records; }
+};
+
+class Writer {
+    std::ofstream out;
+    uint64_t pos{0};
+
+  public:
+    Writer(const std::string &path)
+            : out(path, std::ios::out | std::ios::binary | std::ios::trunc) {}
+
+    bool good() const { return out.good(); }
+    uint64_t position() const { return pos; }
+
+    void write(const void *data, size_t size) {
+        out.write(static_cast<const char *>(data), size);
+        pos += size;
+    }
+
+    void align() {
+        static const char zeros[8] = {0};
+        if (pos % 8 != 0)
+            write(zeros, 8 - pos % 8);
+    }
+
+    bool rewrite(const dgbin::Header &header) {
+        out.seekp(0);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.flush();
+        return out.good();
+    }
+
+    // write the CSR of the edges
+    void writeSection(const std::vector<std::vector<uint32_t>> &edges) {
+        uint32_t offset = 0;
+        for (const auto &targets : edges) {
+            write(&offset, sizeof(offset));
+            offset += targets.size();
+        }
+        write(&offset, sizeof(offset));
+        for (const auto &targets : edges) {
+            if (!targets.empty())
+                write(targets.data(), targets.size() * sizeof(uint32_t));
+        }
+        align();
+    }
+};
+
+std::vector<std::vector<uint32_t>>
+reverseEdges(const std::vector<std::vector<uint32_t>> &edges) {
+    std::vector<std::vector<uint32_t>> ret(edges.size());
+    for (uint32_t id = 0; id < edges.size(); ++id) {
+        for (auto target : edges[id])
+            ret[target].push_back(id);
+    }
+    return ret;
+}
+
+} // anonymous namespace
+
+bool writeLLVMDependenceGraph(LLVMDependenceGraph &dg, const llvm::Module &M,
+                              const std::string &path, std::string &error) {
+    ModuleValueNumbering numbering(M);
+    Serializer S(numbering);
+    S.run(dg, M);
+
+    Writer W(path);
+    if (!W.good()) {
+        error = "Failed opening " + path;
+        return false;
+    }
+
+    dgbin::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, dgbin::MAGIC, sizeof(header.magic));
+    header.version = dgbin::VERSION;
+    header.byteOrder = dgbin::ORDER_MARK;
+    header.nodesNum = S.size();
+    header.valuesNum = numbering.size();
+    header.moduleHash = numbering.getHash();
+
+    // write the header with the offsets at the end,
+    // when we know them
+    W.write(&header, sizeof(header));
+    W.align();
+    header.nodesOffset = W.position();
+    const auto &records = S.getRecords();
+    W.write(records.data(), records.size() * sizeof(dgbin::Node));
+    W.align();
+
+    for (unsigned kind = 0; kind < dgbin::EDGE_KINDS_NUM; ++kind) {
+        header.edgesOffset[kind][0] = W.position();
+        W.writeSection(S.deps[kind]);
+        header.edgesOffset[kind][1] = W.position();
+        W.writeSection(reverseEdges(S.deps[kind]));
+    }
+    header.fileSize = W.position();
+
+    if (!W.rewrite(header)) {
+        error = "Failed writing " + path;
+        return false;
+    }
+    return true;
+}
+
+MappedLLVMDependenceGraph::~MappedLLVMDependenceGraph() {
+    if (_data)
+        munmap(_data, _size);
+}
+
+// A section ends where the next section starts or at the end of the file
+static uint64_t sectionEnd(const std::vector<uint64_t> &starts,
+                           uint64_t begin, uint64_t size) {
+    auto it = std::upper_bound(starts.begin(), starts.end(), begin);
+    return it == starts.end() ? size : std::min(*it, size);
+}
+
+static bool isSectionStart(uint64_t begin, uint64_t end) {
+    return begin % 8 == 0 && begin >= sizeof(dgbin::Header) && begin <= end;
+}
+
+///
+// Check that the Node records in [begin, end) fit into the section
+// and refer only to the values and nodes that exist.
+static bool checkNodesSection(const dgbin::Header &H, const char *data,
+                              uint64_t begin, uint64_t end) {
+    if (!isSectionStart(begin, end) ||
+        (end - begin) / sizeof(dgbin::Node) < H.nodesNum)
+        return false;
+
+    const auto NONE = ModuleValueNumbering::NONE;
+    const auto *nodes = reinterpret_cast<const dgbin::Node *>(data + begin);
+    for (uint32_t id = 0; id < H.nodesNum; ++id) {
+        const auto &nd = nodes[id];
+        if (nd.kind > dgbin::ARTIFICIAL ||
+            (nd.value != NONE && nd.value >= H.valuesNum) ||
+            (nd.entry != NONE && nd.entry >= H.nodesNum) ||
+            (nd.callSite != NONE && nd.callSite >= H.valuesNum))
+            return false;
+    }
+    return true;
+}
+
+///
+// Check that the offsets of the edges section in [begin, end)
+// do not decrease, the edges fit into the section and their targets
+// are the nodes of the graph.
+static bool checkEdgesSection(const dgbin::Header &H, const char *data,
+                              uint64_t begin, uint64_t end) {
+    const uint64_t offsetsSize =
+            (static_cast<uint64_t>(H.nodesNum) + 1) * sizeof(uint32_t);
+    if (!isSectionStart(begin, end) || end - begin < offsetsSize)
+        return false;
+
+    const auto *offsets = reinterpret_cast<const uint32_t *>(data + begin);
+    const auto *targets = offsets + H.nodesNum + 1;
+    const auto edgesNum = offsets[H.nodesNum];
+    if (edgesNum > (end - begin - offsetsSize) / sizeof(uint32_t))
+        return false;
+
+    for (uint32_t id = 0; id < H.nodesNum; ++id) {
+        if (offsets[id] > offsets[id + 1])
+            return false;
+    }
+    for (uint32_t i = 0; i < edgesNum; ++i) {
+        if (targets[i] >= H.nodesNum)
+            return false;
+    }
+    return true;
+}
+
+std::unique_ptr<MappedLLVMDependenceGraph>
+MappedLLVMDependenceGraph::open(const std::string &path, std::string &error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "Failed opening " + path + ": " + std::strerror(errno);
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        error = "Failed reading " + path + ": " + std::strerror(errno);
+        close(fd);
+        return nullptr;
+    }
+
+    std::unique_ptr<MappedLLVMDependenceGraph> G(
+            new MappedLLVMDependenceGraph());
+    G->_size = st.st_size;
+    if (G->_size < sizeof(dgbin::Header)) {
+        error = path + " is not a dependence graph";
+        close(fd);
+        return nullptr;
+    }
+
+    void *data = mmap(nullptr, G->_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        error = "Failed mapping " + path + ": " + std::strerror(errno);
+        return nullptr;
+    }
+    G->_data = data;
+    G->_header = static_cast<const dgbin::Header *>(data);
+
+    // check the header and then all the sections in one pass, so that
+    // the graph read from a corrupted file never accesses memory
+    // out of the mapped file
+    const auto &H = *G->_header;
+    if (std::memcmp(H.magic, dgbin::MAGIC, sizeof(H.magic)) != 0) {
+        error = path + " is not a dependence graph";
+        return nullptr;
+    }
+    if (H.byteOrder != dgbin::ORDER_MARK) {
+        error = path + " has a different byte order";
+        return nullptr;
+    }
+    if (H.version != dgbin::VERSION) {
+        error = path + " has unsupported version " +
+                std::to_string(H.version);
+        return nullptr;
+    }
+    if (H.fileSize != G->_size) {
+        error = path + " is truncated";
+        return nullptr;
+    }
+
+    const char *bytes = static_cast<const char *>(data);
+    std::vector<uint64_t> starts{H.nodesOffset};
+    for (const auto &offsets : H.edgesOffset)
+        starts.insert(starts.end(), std::begin(offsets), std::end(offsets));
+    std::sort(starts.begin(), starts.end());
+
+    if (!checkNodesSection(H, bytes, H.nodesOffset,
+                           sectionEnd(starts, H.nodesOffset, G->_size))) {
+        error = path + " is corrupted";
+        return nullptr;
+    }
+    for (const auto &offsets : H.edgesOffset) {
+        for (auto offset : offsets) {
+            if (!checkEdgesSection(H, bytes, offset,
+                                   sectionEnd(starts, offset, G->_size))) {
+                error = path + " is corrupted";
+                return nullptr;
+            }
+        }
+    }
+
+    G->_nodes = reinterpret_cast<const dgbin::Node *>(
+            static_cast<const char *>(data) + H.nodesOffset);
+    return G;
+}
+
+bool MappedLLVMDependenceGraph::attach(const llvm::Module &M) {
+    std::unique_ptr<ModuleValueNumbering> numbering(
+            new ModuleValueNumbering(M));
+    if (numbering->size() != _header->valuesNum ||
+        numbering->getHash() != _header->moduleHash)
+        return false;
+
+    _valueNodes.clear();
+    for (NodeID id = 0; id < size(); ++id) {
+        const auto &nd = _nodes[id];
+        if (nd.value == ModuleValueNumbering::NONE)
+            continue;
+        switch (nd.kind) {
+        case dgbin::INSTRUCTION:
+        case dgbin::ARGUMENT:
+        case dgbin::GLOBAL:
+        case dgbin::FUNCTION_ENTRY:
+            _valueNodes.emplace(numbering->getValue(nd.value), id);
+            break;
+        default:
+            break;
+        }
+    }
+
+    _numbering = std::move(numbering);
+    return true;
+}
+
+const llvm::Value *MappedLLVMDependenceGraph::getValue(NodeID id) const {
+    assert(_numbering && "The graph is not attached to a module");
+    const auto value = getNode(id).value;
+    return value == ModuleValueNumbering::NONE ? nullptr
+                                               : _numbering->getValue(value);
+}
+
+std::vector<bool>
+MappedLLVMDependenceGraph::backwardSlice(const std::vector<NodeID> &start) const {
+    std::vector<bool> inSlice(size(), false);
+    ADT::QueueLIFO<NodeID> queue;
+
+    auto enqueue = [&](NodeID id) {
+        if (id != ModuleValueNumbering::NONE && !inSlice[id]) {
+            inSlice[id] = true;
+            queue.push(id);
+        }
+    };
+
+    for (auto id : start)
+        enqueue(id);
+
+    while (!queue.empty()) {
+        auto id = queue.pop();
+        for (unsigned kind = 0; kind < dgbin::EDGE_KINDS_NUM; ++kind) {
+            for (auto dep : dependencies(id, static_cast<dgbin::EdgeKind>(kind)))
+                enqueue(dep);
+        }
+        for (auto dep : dependent(id, dgbin::INTERFERENCE))
+            enqueue(dep);
+        enqueue(getNode(id).entry);
+    }
+
+    return inSlice;
+}
+
+} // namespace llvmdg
+} // namespace dg
@@ -0,0 +1,476 @@
+#include <algorithm>
+#include <cassert>
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#if LLVM_VERSION_MAJOR >= 4
+#include <llvm/IR/ModuleSlotTracker.h>
+#endif
+#include <llvm/Support/raw_ostream.h>
+
+#include "dg/llvm/LLVMDGBinary.h"
+#include "dg/llvm/LLVMDGDotWriter.h"
+#include "dg/util/ParallelFor.h"
+
+namespace dg {
+namespace debug {
+
+using llvmdg::ModuleValueNumbering;
+
+namespace {
+
+const char *dd_color = "cyan4";
+const char *use_color = "black";
+const char *cd_color = "blue";
+const char *cfg_color = "gray";
+
+#if LLVM_VERSION_MAJOR >= 4
+using SlotTracker = llvm::ModuleSlotTracker;
+#else
+struct SlotTracker {
+    SlotTracker(const llvm::Module * /*unused*/, bool /*unused*/) {}
+    void incorporateFunction(const llvm::Function & /*unused*/) {}
+};
+#endif
+
+// print the label of the value, escaped and shortened in the same way
+// as LLVMDG2Dot does it
+void printLabel(llvm::raw_ostream &os, const llvm::Value *val,
+                SlotTracker &MST) {
+    if (!val) {
+        os << "(null)";
+        return;
+    }
+
+    std::string str;
+    llvm::raw_string_ostream ro(str);
+    if (llvm::isa<llvm::Function>(val)) {
+        ro << "FUNC " << val->getName();
+    } else {
+        // printing a value without the tracker numbers
+        // the whole function every time
+#if LLVM_VERSION_MAJOR >= 4
+        val->print(ro, MST);
+#else
+        (void) MST;
+        ro << *val;
+#endif
+    }
+    ro.flush();
+
+    // instructions are indented
+    str.erase(0, str.find_first_not_of(' '));
+    if (str.length() > 100) {
+        str.resize(40);
+    }
+
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            os << '\\';
+        os << c;
+    }
+}
+
+} // anonymous namespace
+
+bool LLVMDGDotWriter::isShown(LLVMNode *nd) const {
+    if (options.onlySlice && nd->getSlice() == 0)
+        return false;
+    return !options.nodeFilter || options.nodeFilter(nd);
+}
+
+void LLVMDGDotWriter::addNode(LLVMNode *nd, const char *prefix) {
+    if (!nd || ids.count(nd) > 0 || !isShown(nd))
+        return;
+
+    ids.emplace(nd, nodes.size());
+    nodes.push_back({nd, prefix});
+}
+
+void LLVMDGDotWriter::addParameters(LLVMDGParameters *params, bool formal,
+                                    const ModuleValueNumbering &numbering) {
+    if (!params)
+        return;
+
+    // order the parameters by the values that they represent
+    std::vector<std::pair<uint32_t, const LLVMDGParameter *>> sorted;
+    std::vector<std::pair<uint32_t, const LLVMDGParameter *>> globals;
+    for (const auto &it : *params)
+        sorted.emplace_back(numbering.getID(it.first), &it.second);
+    for (auto it = params->global_begin(), et = params->global_end();
+         it != et; ++it)
+        globals.emplace_back(numbering.getID(it->first), &it->second);
+
+    auto cmp = [](const std::pair<uint32_t, const LLVMDGParameter *> &a,
+                  const std::pair<uint32_t, const LLVMDGParameter *> &b) {
+        return a.first < b.first;
+    };
+    std::stable_sort(sorted.begin(), sorted.end(), cmp);
+    std::stable_sort(globals.begin(), globals.end(), cmp);
+
+    for (const auto &it : sorted) {
+        addNode(it.second->in, formal ? "[f] IN ARG" : "IN ARG");
+        addNode(it.second->out, formal ? "[f] OUT ARG" : "OUT ARG");
+    }
+    for (const auto &it : globals) {
+        addNode(it.second->in, formal ? "[f] GLOB IN" : "GLOB IN");
+        addNode(it.second->out, formal ? "[f] GLOB OUT" : "GLOB OUT");
+    }
+    if (auto *vararg = params->getVarArg()) {
+        addNode(vararg->in, "[va] IN ARG");
+        addNode(vararg->out, "[va] OUT ARG");
+    }
+    addNode(params->getNoReturn(), "[noret]");
+}
+
+void LLVMDGDotWriter::addFunction(const llvm::Function &F,
+                                  LLVMDependenceGraph *graph,
+                                  const ModuleValueNumbering &numbering) {
+    addNode(graph->getEntry());
+    for (const auto &A : F.args()) {
+        auto it = graph->find(const_cast<llvm::Argument *>(&A));
+        if (it != graph->end())
+            addNode(it->second);
+    }
+    for (const auto &B : F) {
+        for (const auto &I : B) {
+            auto it = graph->find(const_cast<llvm::Instruction *>(&I));
+            if (it != graph->end())
+                addNode(it->second);
+        }
+    }
+    addNode(graph->getExit());
+
+    addParameters(graph->getParameters(), true, numbering);
+    for (const auto &B : F) {
+        for (const auto &I : B) {
+            if (!llvm::isa<llvm::CallInst>(&I))
+                continue;
+            auto it = graph->find(const_cast<llvm::Instruction *>(&I));
+            if (it != graph->end())
+                addParameters(it->second->getParameters(), false, numbering);
+        }
+    }
+
+    // the local nodes that do not belong to any instruction
+    for (auto &it : *graph)
+        addNode(it.second);
+}
+
+void LLVMDGDotWriter::numberNodes() {
+    nodes.clear();
+    ids.clear();
+    chunks.clear();
+
+    const llvm::Module &M = *dg->getModule();
+    ModuleValueNumbering numbering(M);
+
+    size_t begin = 0;
+    if (const auto &globals = dg->getGlobalNodes()) {
+        for (const auto &G : M.globals()) {
+            auto it = globals->find(const_cast<llvm::GlobalVariable *>(&G));
+            if (it != globals->end())
+                addNode(it->second, "GL");
+        }
+    }
+    if (nodes.size() > begin)
+        chunks.push_back({nullptr, nullptr, begin, nodes.size()});
+
+    const auto &constructed = dg->getConstructedFunctions();
+    for (const auto &F : M) {
+        if (!options.functions.empty() &&
+            options.functions.count(F.getName().str()) == 0)
+            continue;
+
+        auto it = constructed.find(const_cast<llvm::Function *>(&F));
+        if (it == constructed.end())
+            continue;
+
+        begin = nodes.size();
+        addFunction(F, it->second, numbering);
+        if (nodes.size() > begin)
+            chunks.push_back({&F, it->second, begin, nodes.size()});
+    }
+}
+
+void LLVMDGDotWriter::labelNodes(size_t first, size_t num) {
+    labels.clear();
+    labelsBegin = chunks[first].begin;
+    labels.reserve(chunks[first + num - 1].end - labelsBegin);
+
+    for (size_t idx = first; idx < first + num; ++idx) {
+        const Chunk &chunk = chunks[idx];
+        SlotTracker MST(dg->getModule(), false);
+        if (chunk.fun)
+            MST.incorporateFunction(*chunk.fun);
+
+        for (size_t id = chunk.begin; id < chunk.end; ++id) {
+            std::string str;
+            llvm::raw_string_ostream out(str);
+            if (nodes[id].prefix)
+                out << nodes[id].prefix << " ";
+            printLabel(out, nodes[id].node->getKey(), MST);
+            out.flush();
+            labels.push_back(std::move(str));
+        }
+    }
+}
+
+std::string LLVMDGDotWriter::generateChunk(size_t idx) const {
+    const Chunk &chunk = chunks[idx];
+    const auto edges = options.edges;
+
+    std::string str;
+    llvm::raw_string_ostream out(str);
+
+    auto inChunk = [&chunk, this](const LLVMNode *nd) {
+        auto it = ids.find(nd);
+        return it != ids.end() && it->second >= chunk.begin &&
+               it->second < chunk.end;
+    };
+
+    auto dumpNode = [&](size_t id, const char *ind) {
+        const auto &info = nodes[id];
+        auto *nd = info.node;
+        out << ind << "NODE" << id << " [shape=rect label=\"";
+        assert(id >= labelsBegin && id - labelsBegin < labels.size());
+        out << labels[id - labelsBegin];
+        if (nd->getSlice() != 0)
+            out << "\\nslice: " << nd->getSlice();
+        out << "\" style=filled fillcolor=";
+        if (criteria.count(nd) > 0)
+            out << "orange";
+        else if (nd->getSlice() != 0)
+            out << "greenyellow";
+        else
+            out << "white";
+        out << "]\n";
+    };
+
+    if (chunk.fun) {
+        out << "\t/* function " << chunk.fun->getName() << " */\n";
+        out << "\tsubgraph cluster_f" << idx << " {\n";
+        out << "\t\tstyle=\"filled, rounded\" fillcolor=gray95\n";
+        out << "\t\tlabel=\"" << chunk.fun->getName() << "\\nhas "
+            << chunk.end - chunk.begin << " nodes\"\n";
+    } else {
+        out << "\t/* global nodes */\n";
+    }
+
+    // the printed blocks, their indices and the first and the last
+    // printed node of every block
+    std::vector<const LLVMBBlock *> blocksOrder;
+    std::vector<std::pair<size_t, size_t>> blockNodes;
+    std::unordered_map<const LLVMBBlock *, size_t> blockIdx;
+    std::vector<bool> dumped(chunk.end - chunk.begin);
+
+    if (chunk.fun && (edges & PRINT_CFG)) {
+        const auto &graphBlocks = chunk.graph->getBlocks();
+        for (const auto &B : *chunk.fun) {
+            auto it = graphBlocks.find(const_cast<llvm::BasicBlock *>(&B));
+            if (it == graphBlocks.end())
+                continue;
+
+            LLVMBBlock *BB = it->second;
+            size_t bidx = blocksOrder.size();
+            for (auto *nd : BB->getNodes()) {
+                if (!inChunk(nd))
+                    continue;
+                auto id = ids.find(nd)->second;
+                if (blocksOrder.size() == bidx) {
+                    blocksOrder.push_back(BB);
+                    blockNodes.emplace_back(id, id);
+                    blockIdx.emplace(BB, bidx);
+                    out << "\t\tsubgraph cluster_bb_" << idx << "_" << bidx
+                        << " {\n";
+                    out << "\t\t\tstyle=filled fillcolor=white\n";
+                    out << "\t\t\tlabel=\"";
+                    if (B.hasName())
+                        out << "label " << B.getName();
+                    else
+                        out << "bblock #" << bidx;
+                    if (BB->getSlice() != 0)
+                        out << "\\nslice: " << BB->getSlice();
+                    out << "\"\n";
+                }
+                blockNodes[bidx].second = id;
+                dumped[id - chunk.begin] = true;
+                dumpNode(id, "\t\t\t");
+            }
+            if (blocksOrder.size() > bidx)
+                out << "\t\t}\n";
+        }
+    }
+
+    // the nodes that are not in blocks (or all nodes if we do not print
+    // the blocks)
+    for (size_t id = chunk.begin; id < chunk.end; ++id) {
+        if (!dumped[id - chunk.begin])
+            dumpNode(id, chunk.fun ? "\t\t" : "\t");
+    }
+
+    if (chunk.fun)
+        out << "\t}\n";
+
+    ///
+    // edges from the nodes of this chunk (the edges are sorted by pointers,
+    // so sort them by the names of the targets)
+    std::vector<size_t> targets;
+    auto dumpEdges = [&](size_t id, LLVMNode::data_iterator it,
+                         LLVMNode::data_iterator et, const char *attrs) {
+        targets.clear();
+        for (; it != et; ++it) {
+            auto tit = ids.find(*it);
+            if (tit != ids.end())
+                targets.push_back(tit->second);
+        }
+        std::sort(targets.begin(), targets.end());
+        for (auto target : targets)
+            out << "\tNODE" << id << " -> NODE" << target << " [" << attrs
+                << "]\n";
+    };
+
+    std::string dd = std::string("color=\"") + dd_color + "\"";
+    std::string use = std::string("color=\"") + use_color + "\"";
+    std::string cd = std::string("color=\"") + cd_color + "\"";
+    for (size_t id = chunk.begin; id < chunk.end; ++id) {
+        auto *n = nodes[id].node;
+
+        if (edges & PRINT_DD)
+            dumpEdges(id, n->data_begin(), n->data_end(),
+                      (dd + " rank=max").c_str());
+        if (edges & PRINT_REV_DD)
+            dumpEdges(id, n->rev_data_begin(), n->rev_data_end(),
+                      (dd + " style=\"dashed\" constraint=false").c_str());
+        if (edges & PRINT_USE)
+            dumpEdges(id, n->use_begin(), n->use_end(),
+                      (use + " rank=max style=\"dashed\"").c_str());
+        if (edges & PRINT_USER)
+            dumpEdges(id, n->user_begin(), n->user_end(),
+                      (use + " style=\"dashed\" constraint=false").c_str());
+        if (edges & PRINT_CD)
+            dumpEdges(id, n->control_begin(), n->control_end(), cd.c_str());
+        if (edges & PRINT_REV_CD)
+            dumpEdges(id, n->rev_control_begin(), n->rev_control_end(),
+                      (cd + " style=\"dashed\" constraint=false").c_str());
+        if (edges & PRINT_ID)
+            dumpEdges(id, n->interference_begin(), n->interference_end(),
+                      "color=\"red\" constraint=false");
+        if (edges & PRINT_REV_ID)
+            dumpEdges(id, n->rev_interference_begin(),
+                      n->rev_interference_end(),
+                      "color=\"orange\" constraint=false");
+
+        if ((edges & PRINT_CALL) && n->hasSubgraphs()) {
+            targets.clear();
+            for (auto *sub : n->getSubgraphs()) {
+                auto tit = ids.find(sub->getEntry());
+                if (tit != ids.end())
+                    targets.push_back(tit->second);
+            }
+            std::sort(targets.begin(), targets.end());
+            for (auto target : targets)
+                out << "\tNODE" << id << " -> NODE" << target
+                    << " [label=\"call\" penwidth=3 style=dashed]\n";
+        }
+    }
+
+    ///
+    // edges between the printed blocks (in the order of the blocks)
+    auto dumpBlockEdge = [&](size_t from, size_t to, const std::string &attrs) {
+        out << "\tNODE" << blockNodes[from].second << " -> NODE"
+            << blockNodes[to].first << " [" << attrs << " ltail=cluster_bb_"
+            << idx << "_" << from << " lhead=cluster_bb_" << idx << "_" << to
+            << "]\n";
+    };
+
+    std::vector<std::pair<size_t, int>> blockTargets;
+    auto dumpBlockEdges = [&](size_t from, const std::string &attrs,
+                              bool withLabel) {
+        std::sort(blockTargets.begin(), blockTargets.end());
+        for (const auto &target : blockTargets) {
+            if (withLabel)
+                dumpBlockEdge(from, target.first,
+                              attrs + " label=\"" +
+                                      std::to_string(target.second) + "\"");
+            else
+                dumpBlockEdge(from, target.first, attrs);
+        }
+        blockTargets.clear();
+    };
+    auto addBlockTarget = [&](const LLVMBBlock *B, int label) {
+        auto it = blockIdx.find(B);
+        if (it != blockIdx.end())
+            blockTargets.emplace_back(it->second, label);
+    };
+
+    std::string cfg = std::string("penwidth=2 color=\"") + cfg_color + "\"";
+    for (size_t from = 0; from < blocksOrder.size(); ++from) {
+        const LLVMBBlock *BB = blocksOrder[from];
+
+        for (const auto &S : BB->successors())
+            addBlockTarget(S.target, static_cast<int>(S.label));
+        dumpBlockEdges(from, cfg, true);
+
+        if (edges & PRINT_REV_CFG) {
+            for (const auto *P : BB->predecessors())
+                addBlockTarget(P, 0);
+            dumpBlockEdges(from, cfg + " style=dashed constraint=false",
+                           false);
+        }
+        if (edges & PRINT_CD) {
+            for (const auto *C : BB->controlDependence())
+                addBlockTarget(C, 0);
+            dumpBlockEdges(from, "penwidth=2 color=blue", false);
+        }
+        if (edges & PRINT_POSTDOM) {
+            auto it = blockIdx.find(BB->getIPostDom());
+            if (it != blockIdx.end())
+                dumpBlockEdge(it->second, from,
+                              "penwidth=3 color=purple constraint=false");
+        }
+    }
+
+    out.flush();
+    return str;
+}
+
+void LLVMDGDotWriter::write(llvm::raw_ostream &out) {
+    numberNodes();
+
+    out << "digraph \"DependenceGraph\" {\n";
+    out << "\tcompound=true label=\"Graph has " << nodes.size()
+        << " nodes\\n"
+        << "dd edges color: " << dd_color << "\\n"
+        << "use edges color: " << use_color << ", dashed\\n"
+        << "cd edges color: " << cd_color << "\\n"
+        << "cfg edges color: " << cfg_color << "\"\n\n";
+
+    unsigned threads = std::max(options.threads, 1U);
+    size_t window = options.window > 0 ? options.window : 4 * threads;
+    std::vector<std::string> texts;
+    for (size_t first = 0; first < chunks.size(); first += window) {
+        size_t num = std::min(window, chunks.size() - first);
+        texts.assign(num, std::string());
+
+        // LLVM does not promise that printing values from several threads
+        // is safe, so print them here and let the workers only put
+        // the text together
+        labelNodes(first, num);
+
+        // every chunk has its own place in 'texts', so the order is kept
+        util::parallelFor(num, threads, [&](size_t i) {
+            texts[i] = generateChunk(first + i);
+        });
+
+        for (const auto &text : texts)
+            out << text;
+    }
+
+    out << "}\n";
+    out.flush();
+}
+
+} // namespace debug
+} // namespace dg
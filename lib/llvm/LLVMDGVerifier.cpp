@@ -27,8 +27,7 @@ void LLVMDGVerifier::fault(const char *fmt, ...) {
 bool LLVMDGVerifier::verify() {
     checkMainProc();
 
-    extern std::map<llvm::Value *, LLVMDependenceGraph *> constructedFunctions;
-    for (auto &it : constructedFunctions)
+    for (const auto &it : dg->getConstructedFunctions())
         checkGraph(llvm::cast<llvm::Function>(it.first), it.second);
 
     fflush(stderr);
@@ -41,7 +40,7 @@ void LLVMDGVerifier::checkMainProc() {
 
     // all the subgraphs must have the same global nodes
 
-    for (const auto &it : getConstructedFunctions()) {
+    for (const auto &it : dg->getConstructedFunctions()) {
         if (it.second->global_nodes != dg->global_nodes)
             fault("subgraph has different global nodes than main proc");
     }
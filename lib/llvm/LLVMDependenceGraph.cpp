@@ -41,18 +41,31 @@ using std::make_pair;
 
 namespace dg {
 
-/// ------------------------------------------------------------------
-//  -- LLVMDependenceGraph
-/// ------------------------------------------------------------------
+unsigned LLVMConstructedFunctions::_position(llvm::Value *fun) {
+    if (_positions.empty()) {
+        const auto *M = llvm::cast<llvm::Function>(fun)->getParent();
+        for (const auto &F : *M)
+            _positions.emplace(&F, _positions.size());
+    }
 
-// map of all constructed functions
-std::map<llvm::Value *, LLVMDependenceGraph *> constructedFunctions;
+    // a function that was added to the module later goes to the end
+    return _positions.emplace(fun, _positions.size()).first->second;
+}
+
+LLVMDependenceGraph *&LLVMConstructedFunctions::operator[](llvm::Value *fun) {
+    auto it = _index.find(fun);
+    if (it != _index.end())
+        return it->second->second.second;
 
-const std::map<llvm::Value *, LLVMDependenceGraph *> &
-getConstructedFunctions() {
-    return constructedFunctions;
+    auto git = _graphs.emplace(_position(fun), value_type(fun, nullptr)).first;
+    _index.emplace(fun, git);
+    return git->second.second;
 }
 
+/// ------------------------------------------------------------------
+//  -- LLVMDependenceGraph
+/// ------------------------------------------------------------------
+
 LLVMDependenceGraph::~LLVMDependenceGraph() {
     // delete nodes
     for (auto &I : *this) {
@@ -238,14 +251,15 @@ LLVMDependenceGraph::buildSubgraph(LLVMNode *node, llvm::Function *callFunc,
 
     // if we don't have this subgraph constructed, construct it
     // else just add call edge
-    LLVMDependenceGraph *&subgraph = constructedFunctions[callFunc];
+    LLVMDependenceGraph *&subgraph = (*constructedFunctions)[callFunc];
     if (!subgraph) {
         // since we have reference the the pointer in
         // constructedFunctions, we can assing to it
         subgraph = new LLVMDependenceGraph();
-        // set global nodes to this one, so that
-        // we'll share them
+        // set global nodes and constructed functions to this one,
+        // so that we'll share them
         subgraph->setGlobalNodes(getGlobalNodes());
+        subgraph->constructedFunctions = constructedFunctions;
         subgraph->module = module;
         subgraph->PTA = PTA;
         subgraph->threads = this->threads;
@@ -646,7 +660,7 @@ bool LLVMDependenceGraph::build(llvm::Function *func) {
     if (func->empty())
         return false;
 
-    constructedFunctions.insert(make_pair(func, this));
+    constructedFunctions->insert(make_pair(func, this));
 
     // create entry node
     LLVMNode *entry = new LLVMNode(func);
@@ -869,7 +883,7 @@ bool LLVMDependenceGraph::getCallSites(const char *name,
 
 bool LLVMDependenceGraph::getCallSites(const char *names[],
                                        std::set<LLVMNode *> *callsites) {
-    for (auto &F : constructedFunctions) {
+    for (auto &F : getConstructedFunctions()) {
         for (auto &I : F.second->getBlocks()) {
             LLVMBBlock *BB = I.second;
             for (LLVMNode *n : BB->getNodes()) {
@@ -886,7 +900,7 @@ bool LLVMDependenceGraph::getCallSites(const char *names[],
 
 bool LLVMDependenceGraph::getCallSites(const std::vector<std::string> &names,
                                        std::set<LLVMNode *> *callsites) {
-    for (const auto &F : constructedFunctions) {
+    for (const auto &F : getConstructedFunctions()) {
         for (const auto &I : F.second->getBlocks()) {
             LLVMBBlock *BB = I.second;
             for (LLVMNode *n : BB->getNodes()) {
@@ -905,7 +919,20 @@ void LLVMDependenceGraph::computeNTSCD(
         const LLVMControlDependenceAnalysisOptions &opts) {
     DBG_SECTION_BEGIN(llvmdg, "Filling in CDA edges (NTSCD)");
     dg::LLVMControlDependenceAnalysis ntscd(this->module, opts);
-    assert(opts.ntscdCD() || opts.ntscd2CD());
+    assert(opts.ntscdCD() || opts.ntscd2CD() || opts.ntscd3CD());
+
+    if (opts.jobs() != 1) {
+        // compute the dependencies for all the functions in parallel
+        // instead of on demand in the loop below
+        const auto &constructed = getConstructedFunctions();
+        std::vector<const llvm::Function *> funs;
+        funs.reserve(constructed.size());
+        for (auto &F : *module) {
+            if (constructed.count(&F) > 0)
+                funs.push_back(&F);
+        }
+        ntscd.computeFunctions(funs);
+    }
 
     for (const auto &it : getConstructedFunctions()) {
         auto &blocks = it.second->getBlocks();
@@ -938,6 +965,8 @@ void LLVMDependenceGraph::computeNonTerminationControlDependencies() {
     llvmdg::legacy::NTSCD ntscdAnalysis(this->module, {}, PTA);
     ntscdAnalysis.computeDependencies();
     const auto &dependencies = ntscdAnalysis.controlDependencies();
+    // report every missing instruction only once
+    std::set<std::pair<LLVMNode *, LLVMNode *>> reported;
 
     for (const auto &dep : dependencies) {
         if (dep.first->isArtificial()) {
@@ -956,7 +985,6 @@ void LLVMDependenceGraph::computeNonTerminationControlDependencies() {
                 if (lastInstruction && dgInstruction) {
                     lastInstruction->addControlDependence(dgInstruction);
                 } else {
-                    static std::set<std::pair<LLVMNode *, LLVMNode *>> reported;
                     if (reported.insert({lastInstruction, dgInstruction})
                                 .second) {
                         llvm::errs() << "[CD] error: CD could not be set up, "
@@ -1027,10 +1055,10 @@ void LLVMDependenceGraph::computeForkJoinDependencies(
     auto joins = controlFlowGraph->getJoins();
     for (const auto &join : joins) {
         auto *joinNode = findInstruction(castToLLVMInstruction(join),
-                                         constructedFunctions);
+                                         getConstructedFunctions());
         for (const auto &fork : controlFlowGraph->getCorrespondingForks(join)) {
             auto *forkNode = findInstruction(castToLLVMInstruction(fork),
-                                             constructedFunctions);
+                                             getConstructedFunctions());
             joinNode->addControlDependence(forkNode);
         }
     }
@@ -1041,12 +1069,14 @@ void LLVMDependenceGraph::computeCriticalSections(
     auto locks = controlFlowGraph->getLocks();
     for (const auto *lock : locks) {
         auto *callLockInst = castToLLVMInstruction(lock);
-        auto *lockNode = findInstruction(callLockInst, constructedFunctions);
+        auto *lockNode =
+                findInstruction(callLockInst, getConstructedFunctions());
         auto correspondingNodes =
                 controlFlowGraph->getCorrespondingCriticalSection(lock);
         for (const auto *correspondingNode : correspondingNodes) {
             auto *node = castToLLVMInstruction(correspondingNode);
-            auto *dependentNode = findInstruction(node, constructedFunctions);
+            auto *dependentNode =
+                    findInstruction(node, getConstructedFunctions());
             if (dependentNode) {
                 lockNode->addControlDependence(dependentNode);
             } else {
@@ -1061,7 +1091,8 @@ void LLVMDependenceGraph::computeCriticalSections(
                 controlFlowGraph->getCorrespongingUnlocks(lock);
         for (const auto *unlock : correspondingUnlocks) {
             auto *node = castToLLVMInstruction(unlock);
-            auto *unlockNode = findInstruction(node, constructedFunctions);
+            auto *unlockNode =
+                    findInstruction(node, getConstructedFunctions());
             if (unlockNode) {
                 unlockNode->addControlDependence(lockNode);
             }
@@ -1074,9 +1105,9 @@ void LLVMDependenceGraph::computeInterferenceDependentEdges(
         const std::set<const llvm::Instruction *> &stores) {
     for (const auto &load : loads) {
         auto *loadInst = const_cast<llvm::Instruction *>(load);
-        auto loadFunction = constructedFunctions.find(
+        auto loadFunction = constructedFunctions->find(
                 const_cast<llvm::Function *>(load->getParent()->getParent()));
-        if (loadFunction == constructedFunctions.end())
+        if (loadFunction == constructedFunctions->end())
             continue;
         auto *loadNode = loadFunction->second->findNode(loadInst);
         if (!loadNode)
@@ -1085,9 +1116,9 @@ void LLVMDependenceGraph::computeInterferenceDependentEdges(
         for (const auto &store : stores) {
             auto *storeInst = const_cast<llvm::Instruction *>(store);
             auto storeFunction =
-                    constructedFunctions.find(const_cast<llvm::Function *>(
+                    constructedFunctions->find(const_cast<llvm::Function *>(
                             store->getParent()->getParent()));
-            if (storeFunction == constructedFunctions.end())
+            if (storeFunction == constructedFunctions->end())
                 continue;
             auto *storeNode = storeFunction->second->findNode(storeInst);
             if (!storeNode)
@@ -1139,7 +1170,8 @@ std::set<const llvm::Instruction *> LLVMDependenceGraph::getInstructionsOfType(
     return instructions;
 }
 void LLVMDependenceGraph::computeControlDependencies(
-        const LLVMControlDependenceAnalysisOptions &opts) {
+        const LLVMControlDependenceAnalysisOptions &opts,
+        llvmdg::CallGraph *cg) {
     if (opts.standardCD()) {
         computePostDominators(true);
     } else if (opts.ntscdLegacyCD()) {
@@ -1151,13 +1183,14 @@ void LLVMDependenceGraph::computeControlDependencies(
         tmpopts.algorithm =
                 ControlDependenceAnalysisOptions::CDAlgorithm::NTSCD2;
         computeNTSCD(tmpopts);
-    } else if (opts.ntscdCD() || opts.ntscd2CD() || opts.ntscdRanganathCD()) {
+    } else if (opts.ntscdCD() || opts.ntscd2CD() || opts.ntscd3CD() ||
+               opts.ntscdRanganathCD()) {
         computeNTSCD(opts);
     } else
         abort();
 
     if (opts.interproceduralCD())
-        addNoreturnDependencies(opts);
+        addNoreturnDependencies(opts, cg);
 }
 
 void LLVMDependenceGraph::addNoreturnDependencies(LLVMNode *noret,
@@ -1186,9 +1219,11 @@ void LLVMDependenceGraph::addNoreturnDependencies(LLVMNode *noret,
 }
 
 void LLVMDependenceGraph::addNoreturnDependencies(
-        const LLVMControlDependenceAnalysisOptions &opts) {
-    if (opts.ntscdCD() || opts.ntscd2CD() || opts.ntscdLegacyCD()) {
-        llvmdg::LLVMInterprocCD interprocCD(this->module);
+        const LLVMControlDependenceAnalysisOptions &opts,
+        llvmdg::CallGraph *cg) {
+    if (opts.ntscdCD() || opts.ntscd2CD() || opts.ntscd3CD() ||
+        opts.ntscdLegacyCD()) {
+        llvmdg::LLVMInterprocCD interprocCD(this->module, opts, nullptr, cg);
         for (const auto &F : getConstructedFunctions()) {
             auto *dg = F.second;
             auto *fun = llvm::cast<llvm::Function>(F.first);
@@ -1279,7 +1314,7 @@ void LLVMDependenceGraph::addDefUseEdges(bool preserveDbg) {
 }
 
 LLVMNode *findInstruction(llvm::Instruction *instruction,
-                          const std::map<llvm::Value *, LLVMDependenceGraph *>
+                          const LLVMDependenceGraph::ConstructedFunctionsT
                                   &constructedFunctions) {
     auto valueKey =
             constructedFunctions.find(instruction->getParent()->getParent());
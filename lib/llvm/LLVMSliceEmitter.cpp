@@ -0,0 +1,375 @@
+#include <vector>
+
+#include <llvm/Config/llvm-config.h>
+#if ((LLVM_VERSION_MAJOR == 3) && (LLVM_VERSION_MINOR < 5))
+#include <llvm/Support/CFG.h>
+#else
+#include <llvm/IR/CFG.h>
+#endif
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ValueMapper.h>
+
+#include "dg/llvm/LLVMSliceEmitter.h"
+#include "dg/llvm/LLVMSlicer.h"
+
+namespace dg {
+namespace llvmdg {
+
+///
+// The same as BBlock::isolate(), but on our copy of the CFG
+void LLVMSliceEmitter::FunctionCFG::isolate(LLVMBBlock *B) {
+    auto &succs = successors[B];
+    for (LLVMBBlock *pred : predecessors[B]) {
+        std::set<EdgeT> new_edges;
+        auto &predSuccs = successors[pred];
+        for (auto I = predSuccs.begin(), E = predSuccs.end(); I != E;) {
+            auto cur = I++;
+            if (cur->target == B) {
+                for (const EdgeT &succ : succs) {
+                    if (succ.target != B)
+                        new_edges.insert(EdgeT(succ.target, cur->label));
+                }
+                predSuccs.erase(cur);
+            }
+        }
+
+        for (const EdgeT &edge : new_edges)
+            addSuccessor(pred, edge);
+    }
+
+    removeSuccessors(B);
+    predecessors[B].clear();
+}
+
+bool LLVMSliceEmitter::FunctionCFG::successorsAreSame(LLVMBBlock *B) {
+    const auto &succs = successors[B];
+    if (succs.size() < 2)
+        return true;
+
+    auto *target = succs.begin()->target;
+    for (const auto &succ : succs)
+        if (succ.target != target)
+            return false;
+    return true;
+}
+
+bool LLVMSliceEmitter::FunctionCFG::hasSuccessor(LLVMBBlock *B,
+                                                 LLVMBBlock *target) {
+    for (const auto &succ : successors[B])
+        if (succ.target == target)
+            return true;
+    return false;
+}
+
+void LLVMSliceEmitter::FunctionCFG::removeSuccessorsTarget(LLVMBBlock *B,
+                                                           LLVMBBlock *target) {
+    auto &succs = successors[B];
+    for (auto I = succs.begin(), E = succs.end(); I != E;) {
+        if (I->target == target)
+            I = succs.erase(I);
+        else
+            ++I;
+    }
+}
+
+std::unique_ptr<llvm::Module> LLVMSliceEmitter::emit(uint32_t sl_id) {
+    using namespace llvm;
+
+    statistics = SlicerStatistics();
+    newValues.clear();
+
+    const auto &constructed = dg->getConstructedFunctions();
+    Module *M = dg->getModule();
+
+    // clone only the bodies of the functions that we may need,
+    // i.e., the constructed functions and the untouched functions
+    ValueToValueMapTy VMap;
+    auto shouldClone = [&](const GlobalValue *GV) {
+        const auto *F = dyn_cast<Function>(GV);
+        if (!F)
+            return true;
+        if (dontTouch(F->getName()))
+            return true;
+        return constructed.count(const_cast<Function *>(F)) > 0;
+    };
+
+#if LLVM_VERSION_MAJOR >= 7
+    std::unique_ptr<Module> NM = CloneModule(*M, VMap, shouldClone);
+#else
+    std::unique_ptr<Module> NM = CloneModule(M, VMap, shouldClone);
+#endif
+
+    for (auto it : VMap)
+        newValues[it.first] = it.second;
+
+    std::vector<Function *> to_erase;
+    for (auto &F : *M) {
+        auto *NF = cast<Function>(newValues[&F]);
+        if (dontTouch(F.getName()))
+            continue;
+
+        auto it = constructed.find(&F);
+        if (it == constructed.end()) {
+            // remove (defined) functions that we didn't even constructed,
+            // those are irrelevant in the slice
+            if (!F.isDeclaration())
+                to_erase.push_back(NF);
+            continue;
+        }
+
+        sliceFunction(it->second, NF, sl_id);
+    }
+
+    for (auto *F : to_erase) {
+        F->replaceAllUsesWith(UndefValue::get(F->getType()));
+        F->deleteBody();
+        F->eraseFromParent();
+    }
+
+    return NM;
+}
+
+void LLVMSliceEmitter::sliceFunction(LLVMDependenceGraph *graph,
+                                     llvm::Function *F, uint32_t sl_id) {
+    using namespace llvm;
+
+    FunctionCFG cfg;
+    for (auto &it : graph->getBlocks()) {
+        LLVMBBlock *BB = it.second;
+        cfg.blocks[BB] = cast<BasicBlock>(newValues[it.first]);
+        for (const auto &succ : BB->successors())
+            cfg.addSuccessor(BB, succ);
+    }
+
+    // first slice away blocks that should go away
+    // (the same as Slicer::sliceBBlocks and LLVMSlicer::removeBlock)
+    std::set<LLVMBBlock *> removed;
+    for (auto &it : graph->getBlocks()) {
+        if (it.second->getSlice() != sl_id)
+            removed.insert(it.second);
+    }
+
+    for (LLVMBBlock *block : removed) {
+        statistics.nodesRemoved += block->size();
+        statistics.nodesTotal += block->size();
+        ++statistics.blocksRemoved;
+
+        BasicBlock *blk = cfg.blocks[block];
+        for (const auto &succ : cfg.successors[block]) {
+            if (succ.label == LLVMBBlock::ARTIFICIAL_BBLOCK_LABEL ||
+                succ.target == block)
+                continue;
+
+            auto succIt = cfg.blocks.find(succ.target);
+            if (succIt != cfg.blocks.end())
+                LLVMSlicer::adjustPhiNodes(succIt->second, blk);
+        }
+
+        dropAllUses(blk);
+        for (Instruction &Inst : *blk)
+            dropAllUses(&Inst);
+
+        cfg.isolate(block);
+        cfg.blocks.erase(block);
+        blk->eraseFromParent();
+    }
+
+    // make the CFG complete
+    adjustBBlocksSucessors(graph, cfg, F, sl_id);
+
+    // now slice away instructions from the blocks that are left
+    for (auto &it : *graph) {
+        LLVMNode *n = it.second;
+        if (n == graph->getExit())
+            continue;
+
+        auto *I = dyn_cast<Instruction>(it.first);
+        if (!I || removed.count(n->getBBlock()) > 0)
+            continue;
+
+        ++statistics.nodesTotal;
+
+        if (!LLVMSlicer::shouldSliceInst(I))
+            continue;
+
+        if (n->getSlice() != sl_id) {
+            auto *NI = cast<Instruction>(newValues[I]);
+            NI->replaceAllUsesWith(UndefValue::get(NI->getType()));
+            NI->eraseFromParent();
+            ++statistics.nodesRemoved;
+        }
+    }
+
+    // create new CFG edges between blocks after slicing
+    for (auto &it : cfg.blocks)
+        reconnectBBlock(cfg, it.first, it.second);
+
+    ensureEntryBlock(F);
+}
+
+LLVMBBlock *LLVMSliceEmitter::createNewExitBB(FunctionCFG &cfg,
+                                              llvm::Function *F) {
+    using namespace llvm;
+
+    LLVMContext &Ctx = F->getContext();
+    BasicBlock *block = BasicBlock::Create(Ctx, "safe_return", F);
+
+    if (F->getReturnType()->isVoidTy())
+        ReturnInst::Create(Ctx, block);
+    else if (F->getName().equals("main"))
+        ReturnInst::Create(Ctx, ConstantInt::get(Type::getInt32Ty(Ctx), 0),
+                           block);
+    else
+        ReturnInst::Create(Ctx, UndefValue::get(F->getReturnType()), block);
+
+    cfg.newBlocks.emplace_back(new LLVMBBlock());
+    LLVMBBlock *exitBB = cfg.newBlocks.back().get();
+    exitBB->setKey(block);
+    cfg.blocks[exitBB] = block;
+    return exitBB;
+}
+
+///
+// This is LLVMSlicer::adjustBBlocksSucessors working on our copy of the CFG
+void LLVMSliceEmitter::adjustBBlocksSucessors(LLVMDependenceGraph *graph,
+                                              FunctionCFG &cfg,
+                                              llvm::Function *F,
+                                              uint32_t sl_id) {
+    LLVMBBlock *oldExitBB = graph->getExitBB();
+    assert(oldExitBB && "Don't have exit BB");
+
+    LLVMBBlock *newExitBB = nullptr;
+
+    for (auto &it : graph->getBlocks()) {
+        LLVMBBlock *BB = it.second;
+        if (cfg.blocks.count(BB) == 0) // sliced away
+            continue;
+
+        const auto *tinst =
+                llvm::cast<llvm::BasicBlock>(it.first)->getTerminator();
+        auto &succs = cfg.successors[BB];
+        const bool termSliced = BB->getLastNode()->getSlice() != sl_id;
+
+        if (succs.empty())
+            continue;
+
+        // a conditional self-loop whose branch is sliced away
+        // becomes an unconditional jump to the other successor
+        if (succs.size() == 2 && termSliced && !cfg.successorsAreSame(BB) &&
+            cfg.hasSuccessor(BB, BB)) {
+            cfg.removeSuccessorsTarget(BB, BB);
+            assert(succs.size() == 1 && "Should have only one successor");
+        }
+
+        // the terminator is sliced away, this is going
+        // to be an unconditional jump
+        if (succs.size() == 1 && termSliced) {
+            auto edge = *succs.begin();
+            edge.label = 0;
+            if (edge.target == oldExitBB) {
+                if (!newExitBB)
+                    newExitBB = createNewExitBB(cfg, F);
+                edge.target = newExitBB;
+            }
+
+            cfg.removeSuccessors(BB);
+            cfg.addSuccessor(BB, edge);
+            continue;
+        }
+
+        // jump to the safe exit under the labels that we sliced away
+        std::set<uint8_t> labels;
+        for (const auto &succ : succs) {
+            if (succ.label == LLVMBBlock::ARTIFICIAL_BBLOCK_LABEL ||
+                succ.target == oldExitBB)
+                continue;
+            labels.insert(succ.label);
+        }
+
+        for (unsigned i = 0; i < tinst->getNumSuccessors(); ++i) {
+            if (labels.count(i) == 0) {
+                if (!newExitBB)
+                    newExitBB = createNewExitBB(cfg, F);
+                cfg.addSuccessor(BB, EdgeT(newExitBB, i));
+            }
+        }
+
+        if (newExitBB)
+            cfg.removeSuccessorsTarget(BB, oldExitBB);
+
+        if (succs.size() > 1 && cfg.successorsAreSame(BB)) {
+            LLVMBBlock *succ = succs.begin()->target;
+            cfg.removeSuccessors(BB);
+            cfg.addSuccessor(BB, EdgeT(succ, 0));
+        }
+    }
+}
+
+///
+// This is LLVMSlicer::reconnectBBlock working on our copy of the CFG
+void LLVMSliceEmitter::reconnectBBlock(FunctionCFG &cfg, LLVMBBlock *BB,
+                                       llvm::BasicBlock *llvmBB) {
+    using namespace llvm;
+
+    const auto &succs = cfg.successors[BB];
+    auto *tinst = llvmBB->getTerminator();
+    if (!tinst) {
+        LLVMContext &Ctx = llvmBB->getContext();
+        Function *F = llvmBB->getParent();
+
+        if (succs.size() == 1) {
+            const auto &edge = *succs.begin();
+            if (edge.label != LLVMBBlock::ARTIFICIAL_BBLOCK_LABEL) {
+                BranchInst::Create(cfg.blocks[edge.target], llvmBB);
+                return;
+            }
+        }
+
+        if (succs.size() > 1) {
+            assert(false && "Creating return to BBlock that has successors");
+            abort();
+        }
+
+        if (F->getReturnType()->isVoidTy())
+            ReturnInst::Create(Ctx, llvmBB);
+        else if (F->getName().equals("main"))
+            ReturnInst::Create(Ctx, ConstantInt::get(Type::getInt32Ty(Ctx), 0),
+                               llvmBB);
+        else
+            ReturnInst::Create(Ctx, UndefValue::get(F->getReturnType()),
+                               llvmBB);
+        return;
+    }
+
+    for (const auto &succ : succs) {
+        if (succ.label == LLVMBBlock::ARTIFICIAL_BBLOCK_LABEL)
+            continue;
+
+        auto it = cfg.blocks.find(succ.target);
+        assert(it != cfg.blocks.end() && "Successor was sliced away");
+        tinst->setSuccessor(succ.label, it->second);
+    }
+}
+
+void LLVMSliceEmitter::ensureEntryBlock(llvm::Function *F) {
+    using namespace llvm;
+
+    if (F->begin() == F->end())
+        return;
+
+    BasicBlock *entryBlock = &F->getEntryBlock();
+    if (pred_begin(entryBlock) == pred_end(entryBlock))
+        return;
+
+    BasicBlock *block = BasicBlock::Create(F->getContext(), "single_entry");
+    BranchInst::Create(entryBlock, block);
+    F->getBasicBlockList().push_front(block);
+}
+
+} // namespace llvmdg
+} // namespace dg
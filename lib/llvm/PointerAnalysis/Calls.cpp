@@ -27,6 +27,16 @@ LLVMPointerGraphBuilder::createCall(const llvm::Instruction *Inst) {
         if (func->isDeclaration()) {
             return addNode(CInst, createUndefFunctionCall(CInst, func));
         }
+        // in the lazy mode, create the same nodes as for a call via
+        // pointer -- the subgraph of the function is built once the
+        // analysis reaches the call
+        if (_options.lazyBuilding &&
+            llvmutils::callIsCompatible(func, CInst)) {
+            auto &seq = createFuncptrCall(CInst, func);
+            _funcInfo[CInst->getParent()->getParent()].lazyCalls.push_back(
+                    seq.getFirst());
+            return seq;
+        }
         return createCallToFunction(CInst, func);
     } // this is a function pointer call
     return createFuncptrCall(CInst, calledVal);
@@ -56,11 +56,15 @@ PSNode *LLVMPointerGraphBuilder::getConstant(const llvm::Value *val) {
 
 // try get operand, return null if no such value has been constructed
 PSNode *LLVMPointerGraphBuilder::tryGetOperand(const llvm::Value *val) {
-    auto it = nodes_map.find(val);
-    PSNode *op = nullptr;
+    // the node of the value may have been merged into another node
+    // (see composeMapping()), use the node that is in the graph
+    PSNode *op = mapping.get(val);
 
-    if (it != nodes_map.end())
-        op = it->second.getRepresentant();
+    if (!op) {
+        auto it = nodes_map.find(val);
+        if (it != nodes_map.end())
+            op = it->second.getRepresentant();
+    }
 
     // if we don't have the operand, then it is a ConstantExpr
     // or some operand of intToPtr instruction (or related to that)
@@ -660,7 +664,8 @@ PointerGraph *LLVMPointerGraphBuilder::buildLLVMPointerGraph() {
         assert(subg->root && "No root in a subgraph");
     }
 
-    LLVMPointerGraphValidator validator(&PS);
+    // with lazy building, the code after calls is not connected yet
+    LLVMPointerGraphValidator validator(&PS, _options.lazyBuilding);
     if (validator.validate()) {
         llvm::errs() << validator.getWarnings();
 
@@ -711,5 +716,19 @@ LLVMPointerGraphBuilder::getFunctionNodes(const llvm::Function *F) const {
     return ret;
 }
 
+std::vector<PSNode *> LLVMPointerGraphBuilder::getOpenNodes() {
+    std::vector<PSNode *> ret;
+    for (auto &it : nodes_map) {
+        if (llvm::isa<llvm::Argument>(it.first))
+            ret.push_back(it.second.getRepresentant());
+    }
+    for (const auto &it : subgraphs_map) {
+        if (it.second->vararg)
+            ret.push_back(it.second->vararg);
+    }
+
+    return ret;
+}
+
 } // namespace pta
 } // namespace dg
@@ -98,6 +98,15 @@ void LLVMPointerGraphBuilder::addProgramStructure(const llvm::Function *F,
 
     addCFGEdges(F, finfo, lastNode);
 
+    // the lazily built calls have no CFG edge to the return from the call.
+    // The analysis gets there via the called function once it is built,
+    // so it does not search (and build) the code after calls that do not
+    // return. It is the same as with resolved calls via pointers.
+    for (auto *call : finfo.lazyCalls) {
+        assert(call->getSingleSuccessor() == call->getPairedNode());
+        call->removeSingleSuccessor();
+    }
+
     DBG(pta, "Added CFG structure to function '" << F->getName().str() << "'");
 
     finfo.has_structure = true;
@@ -14,10 +14,10 @@ namespace dg {
 //  -- LLVMDependenceGraph -- summary edges
 /// ------------------------------------------------------------------
 
-extern std::map<llvm::Value *, LLVMDependenceGraph *> constructedFunctions;
 class SummaryEdgesComputation {
     using NodeT = LLVMNode;
     using Edge = std::pair<NodeT *, NodeT *>;
+    LLVMDependenceGraph *graph;
     ADT::QueueLIFO<Edge> workList;
     // FIXME: optimize this: we can store only a subset of these edges
     // and we can store only a set of nodes (beginnings of the paths)
@@ -38,7 +38,7 @@ class SummaryEdgesComputation {
     void initialize() {
         // collect all actual out and formal in vertices,
         // as we need to check whether a node is of this type
-        for (auto &it : getConstructedFunctions()) {
+        for (const auto &it : graph->getConstructedFunctions()) {
             LLVMDependenceGraph *dg = it.second;
             assert(dg && "null as dg");
 
@@ -134,6 +134,8 @@ class SummaryEdgesComputation {
     }
 
   public:
+    SummaryEdgesComputation(LLVMDependenceGraph *graph) : graph(graph) {}
+
     void computeSummaryEdges() {
         initialize();
 
@@ -152,7 +154,7 @@ class SummaryEdgesComputation {
 };
 
 void LLVMDependenceGraph::computeSummaryEdges() {
-    SummaryEdgesComputation C;
+    SummaryEdgesComputation C(this);
     C.computeSummaryEdges();
 }
 } // namespace dg
@@ -9,7 +9,7 @@
 using namespace std;
 using namespace llvm;
 
-int Node::lastId = 0;
+std::atomic<int> Node::lastId{0};
 
 Node::Node(NodeType type, const Instruction *instruction,
            const CallInst *callInst)
@@ -1,6 +1,7 @@
 #ifndef NODE_H
 #define NODE_H
 
+#include <atomic>
 #include <iosfwd>
 #include <set>
 #include <string>
@@ -59,7 +60,8 @@ class Node {
     std::set<Node *> predecessors_;
     std::set<Node *> successors_;
 
-    static int lastId;
+    // shared by all graphs, atomic so that graphs can be built in parallel
+    static std::atomic<int> lastId;
 
   public:
     Node(NodeType type, const llvm::Instruction *instruction = nullptr,
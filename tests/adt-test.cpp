@@ -2,6 +2,7 @@
 
 #include "dg/ADT/Bitvector.h"
 #include "dg/ADT/Queue.h"
+#include "dg/ADT/SmallFlatSet.h"
 #include "dg/ReadWriteGraph/DefSite.h"
 
 using namespace dg::ADT;
@@ -163,6 +164,41 @@ void hashCollisionTest() {
     }
 }
 
+TEST_CASE("SmallFlatSet basic manimp", "SmallFlatSet") {
+    SmallFlatSet<int, 2> S;
+    REQUIRE(S.empty());
+
+    REQUIRE(S.insert(3).second);
+    REQUIRE(S.insert(1).second);
+    REQUIRE(!S.insert(3).second);
+    REQUIRE(S.size() == 2);
+
+    // spill to the heap
+    for (int i = 10; i > 3; --i)
+        REQUIRE(S.insert(i).second);
+    REQUIRE(S.size() == 9);
+    REQUIRE(std::is_sorted(S.begin(), S.end()));
+    REQUIRE(S.count(7) == 1);
+    REQUIRE(S.count(2) == 0);
+
+    REQUIRE(S.erase(7) == 1);
+    REQUIRE(S.erase(7) == 0);
+    REQUIRE(S.count(7) == 0);
+    REQUIRE(S.size() == 8);
+
+    SmallFlatSet<int, 2> C(S);
+    SmallFlatSet<int, 2> T;
+    T.insert(42);
+    T.swap(S);
+    REQUIRE(T.size() == 8);
+    REQUIRE(S.size() == 1);
+    REQUIRE(*S.begin() == 42);
+    REQUIRE(std::equal(C.begin(), C.end(), T.begin()));
+
+    T.clear();
+    REQUIRE(T.empty());
+}
+
 TEST_CASE("STL hashmap test", "HashMap") {
     hashMapTest<dg::STLHashMap<int, int>>();
 }
@@ -205,3 +205,26 @@ TEST_CASE("Merge random bitvectors (union)", "SparseBitvector") {
     //    B2.merge(B1);
     //    REQUIRE(B1 == B2);
 }
+
+TEST_CASE("Unset and query ranges", "SparseBitvector") {
+    SparseBitvector B;
+    for (uint64_t i : {1, 5, 63, 64, 100, 127, 128, 500})
+        B.set(i);
+
+    REQUIRE(B.any(0, 2));
+    REQUIRE(!B.any(2, 5));
+    REQUIRE(B.any(60, 64));
+    REQUIRE(!B.any(129, 500));
+    REQUIRE(B.any(129, 501));
+
+    // a range over several words
+    REQUIRE(B.unset(5, 128));
+    REQUIRE(!B.any(5, 128));
+    REQUIRE(B.get(1));
+    REQUIRE(B.get(128));
+    REQUIRE(B.size() == 3);
+    REQUIRE(!B.unset(5, 128));
+
+    REQUIRE(B.unset(0, 1000));
+    REQUIRE(B.empty());
+}
@@ -0,0 +1,251 @@
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <set>
+
+#include "dg/util/debug.h"
+
+#include "ControlDependence/CDGraph.h"
+#include "ControlDependence/CDGraphGenerators.h"
+#include "ControlDependence/DOD.h"
+#include "ControlDependence/DODNTSCD.h"
+#include "ControlDependence/NTSCD.h"
+
+using namespace dg;
+
+using CDMapT = std::map<CDNode *, std::set<CDNode *>>;
+
+// NTSCD does not report that a predicate on a cycle depends on itself
+static CDMapT withoutSelfDependencies(const CDMapT &CD) {
+    CDMapT ret;
+    for (const auto &it : CD) {
+        for (auto *p : it.second) {
+            if (p != it.first)
+                ret[it.first].insert(p);
+        }
+    }
+    return ret;
+}
+
+static void checkNTSCD3(CDGraph &G) {
+    auto ntscd = NTSCD().compute(G);
+    auto ntscd2 = NTSCD2().compute(G);
+    auto ntscd3 = NTSCD3().compute(G);
+
+    REQUIRE(ntscd3.first == ntscd2.first);
+    REQUIRE(ntscd3.second == ntscd2.second);
+    REQUIRE(withoutSelfDependencies(ntscd3.first) ==
+            withoutSelfDependencies(ntscd.first));
+}
+
+TEST_CASE("NTSCD3 on an if-then-else", "[NTSCD3]") {
+    CDGraph G("ite");
+    auto &p = G.createNode();
+    auto &t = G.createNode();
+    auto &e = G.createNode();
+    auto &join = G.createNode();
+    G.addNodeSuccessor(p, t);
+    G.addNodeSuccessor(p, e);
+    G.addNodeSuccessor(t, join);
+    G.addNodeSuccessor(e, join);
+
+    checkNTSCD3(G);
+
+    auto CD = NTSCD3().compute(G).first;
+    REQUIRE(CD[&t] == std::set<CDNode *>{&p});
+    REQUIRE(CD[&e] == std::set<CDNode *>{&p});
+    REQUIRE(CD[&join].empty());
+}
+
+TEST_CASE("NTSCD3 on loops", "[NTSCD3]") {
+    SECTION("loop with an exit") {
+        CDGraph G("loop");
+        auto &entry = G.createNode();
+        auto &head = G.createNode();
+        auto &body = G.createNode();
+        auto &exit = G.createNode();
+        G.addNodeSuccessor(entry, head);
+        G.addNodeSuccessor(head, body);
+        G.addNodeSuccessor(body, head);
+        G.addNodeSuccessor(head, exit);
+
+        checkNTSCD3(G);
+
+        // the exit is not reached on the infinite path through the loop
+        auto CD = NTSCD3().compute(G).first;
+        REQUIRE(CD[&exit] == std::set<CDNode *>{&head});
+        REQUIRE(CD[&body] == std::set<CDNode *>{&head});
+        REQUIRE(CD[&head] == std::set<CDNode *>{&head});
+    }
+
+    SECTION("self-loop") {
+        CDGraph G("self-loop");
+        auto &a = G.createNode();
+        auto &b = G.createNode();
+        G.addNodeSuccessor(a, a);
+        G.addNodeSuccessor(a, b);
+
+        checkNTSCD3(G);
+    }
+
+    SECTION("loop without an exit") {
+        CDGraph G("sink-loop");
+        auto &p = G.createNode();
+        auto &a = G.createNode();
+        auto &b = G.createNode();
+        auto &c = G.createNode();
+        auto &exit = G.createNode();
+        G.addNodeSuccessor(p, a);
+        G.addNodeSuccessor(p, exit);
+        G.addNodeSuccessor(a, b);
+        G.addNodeSuccessor(b, c);
+        G.addNodeSuccessor(c, a);
+
+        checkNTSCD3(G);
+
+        auto CD = NTSCD3().compute(G).first;
+        REQUIRE(CD[&a] == std::set<CDNode *>{&p});
+        REQUIRE(CD[&c] == std::set<CDNode *>{&p});
+    }
+
+    SECTION("loop with two entries") {
+        CDGraph G("irreducible");
+        auto &p = G.createNode();
+        auto &a = G.createNode();
+        auto &b = G.createNode();
+        auto &exit = G.createNode();
+        G.addNodeSuccessor(p, a);
+        G.addNodeSuccessor(p, b);
+        G.addNodeSuccessor(a, b);
+        G.addNodeSuccessor(b, a);
+        G.addNodeSuccessor(b, exit);
+
+        checkNTSCD3(G);
+    }
+}
+
+TEST_CASE("NTSCD3 on random graphs", "[NTSCD3]") {
+    for (unsigned seed = 0; seed < 500; ++seed) {
+        CDGraph G("random");
+        generateRandomGraph(G, 5 + seed % 40, 0, seed);
+        INFO("seed " << seed);
+        checkNTSCD3(G);
+    }
+
+    for (unsigned seed = 0; seed < 50; ++seed) {
+        CDGraph G("random");
+        generateRandomGraph(G, 100, 150, seed);
+        INFO("seed " << seed);
+        checkNTSCD3(G);
+    }
+}
+
+TEST_CASE("NTSCD3 on irreducible graphs", "[NTSCD3]") {
+    for (unsigned seed = 0; seed < 50; ++seed) {
+        CDGraph G("irreducible");
+        generateIrreducibleGraph(G, 100, seed);
+        INFO("seed " << seed);
+        checkNTSCD3(G);
+    }
+}
+
+static CDMapT unite(const CDMapT &A, const CDMapT &B) {
+    auto ret = A;
+    for (const auto &it : B)
+        ret[it.first].insert(it.second.begin(), it.second.end());
+    return ret;
+}
+
+// drop the nodes without dependencies, so that the maps can be compared
+static CDMapT nonempty(const CDMapT &CD) {
+    CDMapT ret;
+    for (const auto &it : CD) {
+        if (!it.second.empty())
+            ret.insert(it);
+    }
+    return ret;
+}
+
+// DOD must agree with Ranganath's algorithm (the reverse dependencies
+// included) and DOD+NTSCD must be the union of DOD and NTSCD
+static void checkDOD(CDGraph &G) {
+    auto dod = DOD().compute(G);
+    auto ranganath = DODRanganath().compute(G);
+    auto dodntscd = DODNTSCD().compute(G);
+    auto ntscd = NTSCD2().compute(G);
+
+    REQUIRE(nonempty(dod.first) == nonempty(ranganath.first));
+    REQUIRE(nonempty(dod.second) == nonempty(ranganath.second));
+    REQUIRE(nonempty(dodntscd.first) ==
+            nonempty(unite(dod.first, ntscd.first)));
+}
+
+TEST_CASE("DOD on loops with two entries", "[DOD]") {
+    SECTION("loop without an exit") {
+        CDGraph G("dod");
+        auto &p = G.createNode();
+        auto &a = G.createNode();
+        auto &b = G.createNode();
+        G.addNodeSuccessor(p, a);
+        G.addNodeSuccessor(p, b);
+        G.addNodeSuccessor(a, b);
+        G.addNodeSuccessor(b, a);
+
+        checkDOD(G);
+
+        // the order in which a and b are executed depends on p
+        auto CD = DOD().compute(G).first;
+        REQUIRE(CD[&a] == std::set<CDNode *>{&p});
+        REQUIRE(CD[&b] == std::set<CDNode *>{&p});
+    }
+
+    SECTION("loop with an exit") {
+        CDGraph G("dod-exit");
+        auto &p = G.createNode();
+        auto &a = G.createNode();
+        auto &b = G.createNode();
+        auto &exit = G.createNode();
+        G.addNodeSuccessor(p, a);
+        G.addNodeSuccessor(p, b);
+        G.addNodeSuccessor(a, b);
+        G.addNodeSuccessor(b, a);
+        G.addNodeSuccessor(b, exit);
+
+        checkDOD(G);
+    }
+
+    SECTION("nested loops") {
+        CDGraph G("dod-nested");
+        auto &p = G.createNode();
+        auto &a = G.createNode();
+        auto &b = G.createNode();
+        auto &c = G.createNode();
+        G.addNodeSuccessor(p, a);
+        G.addNodeSuccessor(p, b);
+        G.addNodeSuccessor(a, b);
+        G.addNodeSuccessor(b, c);
+        G.addNodeSuccessor(b, a);
+        G.addNodeSuccessor(c, a);
+        G.addNodeSuccessor(c, c);
+
+        checkDOD(G);
+    }
+}
+
+TEST_CASE("DOD on irreducible graphs", "[DOD]") {
+    for (unsigned seed = 0; seed < 50; ++seed) {
+        CDGraph G("irreducible");
+        generateIrreducibleGraph(G, 100, seed);
+        INFO("seed " << seed);
+        checkDOD(G);
+    }
+}
+
+TEST_CASE("DOD on random graphs", "[DOD]") {
+    for (unsigned seed = 0; seed < 500; ++seed) {
+        CDGraph G("random");
+        generateRandomGraph(G, 5 + seed % 40, 0, seed);
+        INFO("seed " << seed);
+        checkDOD(G);
+    }
+}
@@ -0,0 +1,136 @@
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dg/ADT/DGContainer.h"
+#include "dg/ADT/Queue.h"
+#include "dg/util/TimeMeasure.h"
+
+// count the allocated memory, so that we can compare
+// the memory footprint of the containers
+static size_t allocated = 0;
+
+void *operator new(size_t size) {
+    allocated += size;
+    if (void *mem = std::malloc(size))
+        return mem;
+    std::abort();
+}
+
+void operator delete(void *mem) noexcept { std::free(mem); }
+void operator delete(void *mem, size_t /*unused*/) noexcept { std::free(mem); }
+
+// A node of the graph that has the edges of the legacy dependence graph
+// (control, data and use edges and the reverse edges).
+template <unsigned int EXPECTED_EDGES_NUM>
+struct BenchNode {
+    using EdgesT = dg::DGContainer<BenchNode *, EXPECTED_EDGES_NUM>;
+
+    EdgesT controlDepEdges;
+    EdgesT dataDepEdges;
+    EdgesT useEdges;
+    EdgesT revControlDepEdges;
+    EdgesT revDataDepEdges;
+    EdgesT userEdges;
+
+    unsigned slice_id{0};
+};
+
+std::default_random_engine generator;
+
+// the graph is generated in the same way for all containers,
+// most of the nodes have 1-4 edges of every kind
+static unsigned numNodes = 200000;
+static unsigned numSlices = 20;
+
+static unsigned edgesNum() {
+    static std::discrete_distribution<unsigned> dist{5, 40, 30, 15, 7, 2, 1};
+    unsigned n = dist(generator);
+    // a few nodes have a lot of edges (e.g., the entry nodes)
+    if (n == 6)
+        return 64;
+    return n;
+}
+
+template <typename NodeT>
+static void addEdges(std::vector<NodeT> &nodes,
+                     typename NodeT::EdgesT NodeT::*edges,
+                     typename NodeT::EdgesT NodeT::*revEdges) {
+    std::uniform_int_distribution<unsigned> dist(0, nodes.size() - 1);
+    for (auto &nd : nodes) {
+        for (unsigned i = edgesNum(); i > 0; --i) {
+            auto &target = nodes[dist(generator)];
+            (nd.*edges).insert(&target);
+            (target.*revEdges).insert(&nd);
+        }
+    }
+}
+
+// mark the backward slice, the same as WalkAndMark does
+template <typename NodeT>
+static size_t markSlice(NodeT *start, unsigned slice_id) {
+    dg::ADT::QueueFIFO<NodeT *> queue;
+    size_t size = 0;
+
+    start->slice_id = slice_id;
+    queue.push(start);
+    while (!queue.empty()) {
+        NodeT *cur = queue.pop();
+        ++size;
+
+        for (auto *edges : {&cur->revControlDepEdges, &cur->revDataDepEdges,
+                            &cur->userEdges}) {
+            for (NodeT *nd : *edges) {
+                if (nd->slice_id != slice_id) {
+                    nd->slice_id = slice_id;
+                    queue.push(nd);
+                }
+            }
+        }
+    }
+
+    return size;
+}
+
+template <unsigned int EXPECTED_EDGES_NUM>
+static void run(const std::string &name) {
+    using NodeT = BenchNode<EXPECTED_EDGES_NUM>;
+
+    std::cout << "Running " << name << "\n";
+    generator.seed(0);
+
+    dg::debug::TimeMeasure tm;
+    size_t before = allocated;
+
+    tm.start();
+    std::vector<NodeT> nodes(numNodes);
+    addEdges(nodes, &NodeT::controlDepEdges, &NodeT::revControlDepEdges);
+    addEdges(nodes, &NodeT::dataDepEdges, &NodeT::revDataDepEdges);
+    addEdges(nodes, &NodeT::useEdges, &NodeT::userEdges);
+    tm.stop();
+    tm.report(" -- building the graph took");
+    std::cout << " -- the graph takes " << (allocated - before) / 1024
+              << " kB\n";
+
+    std::uniform_int_distribution<unsigned> dist(0, nodes.size() - 1);
+    size_t total = 0;
+    tm.start();
+    for (unsigned i = 1; i <= numSlices; ++i)
+        total += markSlice(&nodes[dist(generator)], i);
+    tm.stop();
+    tm.report(" -- marking " + std::to_string(numSlices) + " slices took");
+    std::cout << " -- (" << total << " nodes in slices)\n";
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1)
+        numNodes = std::stoul(argv[1]);
+    if (argc > 2)
+        numSlices = std::stoul(argv[2]);
+
+    run<0>("std::set");
+    run<4>("sorted array with 4 inline elements");
+    run<8>("sorted array with 8 inline elements");
+}
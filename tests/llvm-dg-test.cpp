@@ -1,7 +1,34 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+
 #include "dg/DFS.h"
+#include "dg/Slicing.h"
+#include "dg/llvm/CallGraph/CallGraph.h"
+#include "dg/llvm/LLVMDGBinary.h"
+#include "dg/llvm/LLVMDGDotWriter.h"
 #include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/LLVMDependenceGraphBuilder.h"
+#include "dg/llvm/LLVMSlicer.h"
+#include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
 
 TEST_CASE("reference counting test", "LLVM DG") {
     using namespace dg;
@@ -43,3 +70,774 @@ TEST_CASE("reference counting test", "LLVM DG") {
     delete entryBB1;
     delete entryBB2;
 }
+
+TEST_CASE("batch marking test", "LLVM DG") {
+    using namespace dg;
+
+    // n1 -> n2 -> n3 (data dependencies), n4 -> n3 (control dependence)
+    // and n5 is standalone
+    LLVMNode n1(nullptr), n2(nullptr), n3(nullptr), n4(nullptr), n5(nullptr);
+    n1.addDataDependence(&n2);
+    n2.addDataDependence(&n3);
+    n4.addControlDependence(&n3);
+
+    BatchWalkAndMark<LLVMNode> wm;
+    wm.mark({{&n3}, {&n2}, {&n5}});
+
+    REQUIRE(wm.inSlice(&n1, 0));
+    REQUIRE(wm.inSlice(&n2, 0));
+    REQUIRE(wm.inSlice(&n3, 0));
+    REQUIRE(wm.inSlice(&n4, 0));
+    REQUIRE(!wm.inSlice(&n5, 0));
+    REQUIRE(wm.getSliceSize(0) == 4);
+
+    REQUIRE(wm.inSlice(&n1, 1));
+    REQUIRE(wm.inSlice(&n2, 1));
+    REQUIRE(!wm.inSlice(&n3, 1));
+    REQUIRE(!wm.inSlice(&n4, 1));
+    REQUIRE(wm.getSliceSize(1) == 2);
+
+    REQUIRE(wm.getMask(&n5).count() == 1);
+    REQUIRE(wm.inSlice(&n5, 2));
+
+    wm.setSlice(1, 42);
+    REQUIRE(n1.getSlice() == 42);
+    REQUIRE(n2.getSlice() == 42);
+    REQUIRE(n3.getSlice() == 0);
+}
+
+TEST_CASE("slice overlaps test", "LLVM DG") {
+    using namespace dg;
+
+    // n1 -> n2 -> n3 (data dependencies), n4 -> n3 (control dependence)
+    // and n5 is standalone
+    LLVMNode n1(nullptr), n2(nullptr), n3(nullptr), n4(nullptr), n5(nullptr);
+    n1.addDataDependence(&n2);
+    n2.addDataDependence(&n3);
+    n4.addControlDependence(&n3);
+
+    BatchWalkAndMark<LLVMNode> wm1, wm2;
+    wm1.mark({{&n3}, {&n2}});
+    wm2.mark({{&n5}, {&n3}, {}});
+
+    auto sizes = wm1.getSliceSizes(2);
+    REQUIRE(sizes.size() == 2);
+    REQUIRE(sizes[0].nodes == 4);
+    REQUIRE(sizes[1].nodes == 2);
+    // the nodes are in no graph
+    REQUIRE(sizes[0].graphs == 0);
+
+    SliceOverlaps<LLVMNode> overlaps;
+    overlaps.add(wm1, 2);
+    overlaps.add(wm2, 3);
+    REQUIRE(overlaps.size() == 5);
+    REQUIRE(overlaps.getSliceSize(3) == 4);
+    REQUIRE(overlaps.getSliceSize(4) == 0);
+
+    // the slices of the same criterion from different markers
+    REQUIRE(overlaps.getOverlap(0, 3) == 4);
+    REQUIRE(overlaps.getSimilarity(0, 3) == 1.0);
+    REQUIRE(overlaps.getOverlap(0, 1) == 2);
+    REQUIRE(overlaps.getSimilarity(0, 1) == 0.5);
+    REQUIRE(overlaps.getOverlap(1, 2) == 0);
+
+    using GroupsT = std::vector<std::vector<size_t>>;
+    const GroupsT strict = {{0, 3}, {1}, {2}, {4}};
+    REQUIRE(overlaps.group(0.9) == strict);
+    // the empty slice is never grouped
+    const GroupsT loose = {{0, 1, 3}, {2}, {4}};
+    REQUIRE(overlaps.group(0.5) == loose);
+}
+
+using AllPointsToT = std::map<const llvm::Value *,
+                             std::set<std::pair<llvm::Value *, uint64_t>>>;
+
+// the points-to sets of all instructions and arguments of the module
+static AllPointsToT getAllPointsTo(const llvm::Module &M,
+                                   dg::LLVMPointerAnalysisOptions opts,
+                                   size_t *merged = nullptr) {
+    dg::DGLLVMPointerAnalysis PTA(&M, opts);
+    PTA.run();
+    if (merged)
+        *merged = PTA.getNumOfMergedNodes();
+
+    AllPointsToT ret;
+    auto add = [&](const llvm::Value *val) {
+        auto &S = ret[val];
+        for (const auto &ptr : PTA.getLLVMPointsTo(val))
+            S.emplace(ptr.value, *ptr.offset);
+    };
+    for (const auto &F : M) {
+        for (const auto &A : F.args())
+            add(&A);
+        for (const auto &B : F)
+            for (const auto &I : B)
+                add(&I);
+    }
+    return ret;
+}
+
+TEST_CASE("points-to equivalence merging test", "LLVM DG") {
+    using namespace dg;
+
+    // the cast %c is merged into the malloc and it is an argument
+    // of a call via a function pointer (resolved during the analysis),
+    // %l1 is an equal GEP on a loop and %z a GEP with zero offset
+    const char *code = "declare i8* @malloc(i64)\n"
+                       "define void @f(i32** %p) {\n"
+                       "  %q = load i32*, i32** %p\n"
+                       "  store i32 1, i32* %q\n"
+                       "  ret void\n"
+                       "}\n"
+                       "define i32 @main() {\n"
+                       "entry:\n"
+                       "  %x = alloca i32\n"
+                       "  %fp = alloca void (i32**)*\n"
+                       "  store void (i32**)* @f, void (i32**)** %fp\n"
+                       "  %m = call i8* @malloc(i64 16)\n"
+                       "  %c = bitcast i8* %m to i32**\n"
+                       "  %g = getelementptr i32*, i32** %c, i64 1\n"
+                       "  %z = getelementptr i32*, i32** %g, i64 0\n"
+                       "  store i32* %x, i32** %c\n"
+                       "  %f = load void (i32**)*, void (i32**)** %fp\n"
+                       "  call void %f(i32** %c)\n"
+                       "  br label %loop\n"
+                       "loop:\n"
+                       "  %i = phi i32 [0, %entry], [%n, %loop]\n"
+                       "  %l1 = getelementptr i32*, i32** %c, i64 1\n"
+                       "  %v = load i32*, i32** %l1\n"
+                       "  store i32* %v, i32** %z\n"
+                       "  %n = add i32 %i, 1\n"
+                       "  %cmp = icmp slt i32 %n, 4\n"
+                       "  br i1 %cmp, label %loop, label %exit\n"
+                       "exit:\n"
+                       "  ret i32 0\n"
+                       "}\n";
+
+    llvm::LLVMContext ctx;
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "m"), err, ctx);
+    REQUIRE(M);
+
+    LLVMPointerAnalysisOptions opts;
+    auto plain = getAllPointsTo(*M, opts);
+
+    opts.mergeEquivalentNodes = true;
+    size_t merged = 0;
+    auto hvn = getAllPointsTo(*M, opts, &merged);
+    REQUIRE(merged > 0);
+
+    // the argument of @f got the (merged) cast as its operand
+    const auto *arg = M->getFunction("f")->arg_begin();
+    const llvm::Value *m = nullptr;
+    for (const auto &I : M->getFunction("main")->getEntryBlock())
+        if (I.getName() == "m")
+            m = &I;
+    REQUIRE(hvn[arg].count({const_cast<llvm::Value *>(m), 0}) == 1);
+
+    REQUIRE(plain == hvn);
+}
+
+TEST_CASE("lazy building of pointer graph test", "LLVM DG") {
+    using namespace dg;
+
+    // @late is called only after @stop that never returns
+    const char *code = "@g = global i32* null\n"
+                       "define i32* @id(i32* %p) {\n"
+                       "  ret i32* %p\n"
+                       "}\n"
+                       "define void @stop() {\n"
+                       "entry:\n"
+                       "  br label %loop\n"
+                       "loop:\n"
+                       "  br label %loop\n"
+                       "}\n"
+                       "define void @late(i32* %p) {\n"
+                       "  %q = load i32*, i32** @g\n"
+                       "  store i32 1, i32* %q\n"
+                       "  ret void\n"
+                       "}\n"
+                       "define i32 @main() {\n"
+                       "  %x = alloca i32\n"
+                       "  %y = alloca i32\n"
+                       "  %a = call i32* @id(i32* %x)\n"
+                       "  store i32* %a, i32** @g\n"
+                       "  %l = load i32*, i32** @g\n"
+                       "  %b = call i32* @id(i32* %y)\n"
+                       "  call void @stop()\n"
+                       "  call void @late(i32* %b)\n"
+                       "  ret i32 0\n"
+                       "}\n";
+
+    llvm::LLVMContext ctx;
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "m"), err, ctx);
+    REQUIRE(M);
+
+    const auto *late = M->getFunction("late");
+    const auto *lateLoad = &*late->begin()->begin();
+
+    for (auto type : {LLVMPointerAnalysisOptions::AnalysisType::fi,
+                      LLVMPointerAnalysisOptions::AnalysisType::fs}) {
+        LLVMPointerAnalysisOptions opts;
+        opts.analysisType = type;
+        DGLLVMPointerAnalysis eager(M.get(), opts);
+        eager.run();
+        REQUIRE(eager.getPointsToNode(lateLoad) != nullptr);
+
+        opts.lazyBuilding = true;
+        DGLLVMPointerAnalysis lazy(M.get(), opts);
+        lazy.run();
+        REQUIRE(lazy.getPointsToNode(late->arg_begin()) == nullptr);
+        REQUIRE(lazy.getPointsToNode(lateLoad) == nullptr);
+
+        // the code that was built has the same points-to sets
+        auto pointsTo = [](DGLLVMPointerAnalysis &PTA,
+                           const llvm::Value *val) {
+            std::set<std::pair<llvm::Value *, uint64_t>> S;
+            for (const auto &ptr : PTA.getLLVMPointsTo(val))
+                S.emplace(ptr.value, *ptr.offset);
+            return S;
+        };
+        size_t compared = 0;
+        for (const auto &F : *M) {
+            for (const auto &I : llvm::instructions(F)) {
+                if (!lazy.getPointsToNode(&I))
+                    continue;
+                REQUIRE(&F != late);
+                REQUIRE(pointsTo(lazy, &I) == pointsTo(eager, &I));
+                ++compared;
+            }
+        }
+        REQUIRE(compared > 0);
+    }
+}
+
+TEST_CASE("independent graphs test", "LLVM DG") {
+    using namespace dg;
+
+    const char *code1 = "define void @foo() {\n"
+                        "  ret void\n"
+                        "}\n"
+                        "define i32 @main() {\n"
+                        "  call void @foo()\n"
+                        "  ret i32 0\n"
+                        "}\n";
+    const char *code2 = "define i32 @main() {\n"
+                        "  ret i32 0\n"
+                        "}\n";
+
+    llvm::LLVMContext ctx;
+    llvm::SMDiagnostic err;
+    auto M1 = llvm::parseIR(llvm::MemoryBufferRef(code1, "m1"), err, ctx);
+    auto M2 = llvm::parseIR(llvm::MemoryBufferRef(code2, "m2"), err, ctx);
+    REQUIRE(M1);
+    REQUIRE(M2);
+
+    LLVMDependenceGraph dg1, dg2;
+    REQUIRE(dg1.build(M1.get(), M1->getFunction("main")));
+    REQUIRE(dg2.build(M2.get(), M2->getFunction("main")));
+
+    // every graph knows only the functions of its module
+    const auto &CF1 = dg1.getConstructedFunctions();
+    const auto &CF2 = dg2.getConstructedFunctions();
+    REQUIRE(CF1.size() == 2);
+    REQUIRE(CF2.size() == 1);
+    REQUIRE(CF1.count(M1->getFunction("foo")) == 1);
+    REQUIRE(CF2.count(M2->getFunction("main")) == 1);
+
+    // subgraphs share the map with the graph of the entry function
+    auto *foo = CF1.find(M1->getFunction("foo"))->second;
+    REQUIRE(&foo->getConstructedFunctions() == &CF1);
+
+    // the graphs are iterated in the order of the functions in the module
+    std::vector<const llvm::Value *> order;
+    for (const auto &it : CF1)
+        order.push_back(it.first);
+    REQUIRE(order == std::vector<const llvm::Value *>{
+                             M1->getFunction("foo"), M1->getFunction("main")});
+}
+
+// build the dependence graph of the module in 'code', slice it w.r.t.
+// the first call of @crit in main and return the number of instructions
+// that are left in the module
+static size_t buildAndSlice(const char *code) {
+    using namespace dg;
+
+    llvm::LLVMContext ctx;
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "m"), err, ctx);
+    if (!M)
+        return 0;
+
+    llvmdg::LLVMDependenceGraphBuilder builder(M.get());
+    auto dg = builder.build();
+
+    const llvm::Instruction *crit = nullptr;
+    for (const auto &I : llvm::instructions(M->getFunction("main"))) {
+        const auto *C = llvm::dyn_cast<llvm::CallInst>(&I);
+        if (C && C->getCalledFunction() &&
+            C->getCalledFunction()->getName() == "crit") {
+            crit = C;
+            break;
+        }
+    }
+    auto *node = dg->getNode(const_cast<llvm::Instruction *>(crit));
+    if (!node)
+        return 0;
+
+    llvmdg::LLVMSlicer slicer;
+    auto id = slicer.mark(node);
+    slicer.slice(dg.get(), nullptr, id);
+
+    size_t insts = 0;
+    for (const auto &F : *M)
+        insts += F.getInstructionCount();
+    return insts;
+}
+
+TEST_CASE("parallel building and slicing test", "LLVM DG") {
+    const char *code1 = "declare void @crit(i32)\n"
+                        "define void @set(i32* %p, i32 %v) {\n"
+                        "  store i32 %v, i32* %p\n"
+                        "  ret void\n"
+                        "}\n"
+                        "define i32 @main() {\n"
+                        "  %x = alloca i32\n"
+                        "  %y = alloca i32\n"
+                        "  call void @set(i32* %x, i32 1)\n"
+                        "  call void @set(i32* %y, i32 2)\n"
+                        "  %l = load i32, i32* %x\n"
+                        "  call void @crit(i32 %l)\n"
+                        "  ret i32 0\n"
+                        "}\n";
+    const char *code2 = "declare void @crit(i32)\n"
+                        "@g = global i32 0\n"
+                        "define i32 @get(i32 %n) {\n"
+                        "entry:\n"
+                        "  %c = icmp sgt i32 %n, 0\n"
+                        "  br i1 %c, label %then, label %exit\n"
+                        "then:\n"
+                        "  store i32 %n, i32* @g\n"
+                        "  br label %exit\n"
+                        "exit:\n"
+                        "  %v = load i32, i32* @g\n"
+                        "  ret i32 %v\n"
+                        "}\n"
+                        "define i32 @main() {\n"
+                        "  %a = alloca i32\n"
+                        "  store i32 3, i32* %a\n"
+                        "  %r = call i32 @get(i32 5)\n"
+                        "  call void @crit(i32 %r)\n"
+                        "  %b = load i32, i32* %a\n"
+                        "  ret i32 %b\n"
+                        "}\n";
+
+    const size_t expected1 = buildAndSlice(code1);
+    const size_t expected2 = buildAndSlice(code2);
+    REQUIRE(expected1 > 0);
+    REQUIRE(expected2 > 0);
+
+    // build and slice the modules several times concurrently,
+    // the graphs must not affect each other
+    for (unsigned i = 0; i < 8; ++i) {
+        size_t res1 = 0, res2 = 0;
+        std::thread t1([&]() { res1 = buildAndSlice(code1); });
+        std::thread t2([&]() { res2 = buildAndSlice(code2); });
+        t1.join();
+        t2.join();
+        REQUIRE(res1 == expected1);
+        REQUIRE(res2 == expected2);
+    }
+}
+
+TEST_CASE("frozen call graph test", "LLVM DG") {
+    using namespace dg;
+
+    const char *code = "@fp = global void ()* @c\n"
+                       "@fp2 = global void (i32)* @d\n"
+                       "define void @a() {\n"
+                       "  call void @b()\n"
+                       "  ret void\n"
+                       "}\n"
+                       "define void @b() {\n"
+                       "  call void @a()\n"
+                       "  call void @c()\n"
+                       "  ret void\n"
+                       "}\n"
+                       "define void @c() {\n"
+                       "  ret void\n"
+                       "}\n"
+                       "define void @d(i32 %x) {\n"
+                       "  ret void\n"
+                       "}\n"
+                       "define i32 @main() {\n"
+                       "  call void @a()\n"
+                       "  %f = load void ()*, void ()** @fp\n"
+                       "  call void %f()\n"
+                       "  ret i32 0\n"
+                       "}\n";
+
+    llvm::LLVMContext ctx;
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "m"), err, ctx);
+    REQUIRE(M);
+
+    auto CG = llvmdg::CallGraph::frozen(M.get());
+    const auto *csr = CG.getFrozen();
+    REQUIRE(csr);
+    REQUIRE(csr->size() == 5);
+
+    auto id = [&](const char *name) {
+        return csr->getID(M->getFunction(name));
+    };
+
+    // the call via the pointer may call only the compatible function
+    REQUIRE(CG.calls(M->getFunction("main"), M->getFunction("c")));
+    REQUIRE(!CG.calls(M->getFunction("main"), M->getFunction("d")));
+    REQUIRE(csr->callers(id("c")).size() == 2);
+    REQUIRE(csr->getCallsOf(id("c")).size() == 2);
+    REQUIRE(csr->callSites(id("main")).size() == 2);
+
+    // 'a' and 'b' are mutually recursive
+    REQUIRE(csr->sccsNum() == 4);
+    REQUIRE(csr->getSCC(id("a")) == csr->getSCC(id("b")));
+    REQUIRE(csr->isRecursive(csr->getSCC(id("a"))));
+    REQUIRE(!csr->isRecursive(csr->getSCC(id("main"))));
+
+    // callees precede their callers in the bottom-up order
+    for (auto f : csr->bottomUp()) {
+        for (auto callee : csr->callees(f)) {
+            REQUIRE(csr->getSCC(callee) <= csr->getSCC(f));
+        }
+    }
+    REQUIRE(csr->topDown().front() == id("main"));
+    REQUIRE(csr->bottomUp().back() == id("main"));
+}
+
+// is the instruction after the first call in 'fun' control dependent
+// on the no-return node of the call?
+static bool dependsOnNoreturn(dg::LLVMDependenceGraph &dg,
+                              const llvm::Function *fun) {
+    auto it = dg.getConstructedFunctions().find(fun);
+    REQUIRE(it != dg.getConstructedFunctions().end());
+    auto *fdg = it->second;
+
+    const llvm::Instruction *I = &fun->front().front();
+    while (!llvm::isa<llvm::CallInst>(I))
+        I = I->getNextNode();
+    auto *call = fdg->getNode(const_cast<llvm::Instruction *>(I));
+    auto *next = fdg->getNode(
+            const_cast<llvm::Instruction *>(I->getNextNode()));
+    REQUIRE(call);
+    REQUIRE(next);
+
+    auto *params = call->getParameters();
+    if (!params || !params->getNoReturn())
+        return false;
+    auto *noret = params->getNoReturn();
+    return std::find(noret->control_begin(), noret->control_end(), next) !=
+           noret->control_end();
+}
+
+TEST_CASE("no-return callee via function pointer test", "LLVM DG") {
+    using namespace dg;
+
+    // 'mid' may not return, because it calls 'die' via a pointer
+    const char *code = "@fp = global void ()* @die\n"
+                       "declare void @exit(i32)\n"
+                       "define void @die() {\n"
+                       "  call void @exit(i32 1)\n"
+                       "  unreachable\n"
+                       "}\n"
+                       "define void @mid() {\n"
+                       "  %f = load void ()*, void ()** @fp\n"
+                       "  call void %f()\n"
+                       "  ret void\n"
+                       "}\n"
+                       "define i32 @main() {\n"
+                       "  call void @mid()\n"
+                       "  ret i32 0\n"
+                       "}\n";
+
+    llvm::LLVMContext ctx;
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "m"), err, ctx);
+    REQUIRE(M);
+
+    llvmdg::LLVMDependenceGraphOptions opts;
+    opts.CDAOptions.algorithm =
+            ControlDependenceAnalysisOptions::CDAlgorithm::NTSCD;
+    REQUIRE(opts.CDAOptions.interproceduralCD());
+
+    SECTION("the standard CD does not build the call graph") {
+        llvmdg::LLVMDependenceGraphBuilder builder(M.get());
+        auto dg = builder.build();
+        REQUIRE(dg);
+        REQUIRE(builder.getCallGraph() == nullptr);
+    }
+
+    SECTION("without the call graph, the call of 'mid' returns") {
+        // this is what the no-return analysis computed before it used
+        // the call graph: without PTA it does not resolve the pointer
+        llvmdg::LLVMDependenceGraphBuilder builder(M.get(), opts);
+        auto dg = builder.constructCFGOnly();
+        REQUIRE(dg);
+        dg->computeControlDependencies(opts.CDAOptions, nullptr);
+        REQUIRE(dependsOnNoreturn(*dg, M->getFunction("mid")));
+        REQUIRE(!dependsOnNoreturn(*dg, M->getFunction("main")));
+    }
+
+    SECTION("with the call graph, the call of 'mid' may not return") {
+        llvmdg::LLVMDependenceGraphBuilder builder(M.get(), opts);
+        auto dg = builder.build();
+        REQUIRE(dg);
+        REQUIRE(builder.getCallGraph() != nullptr);
+        REQUIRE(dependsOnNoreturn(*dg, M->getFunction("mid")));
+        REQUIRE(dependsOnNoreturn(*dg, M->getFunction("main")));
+    }
+}
+
+// a temporary file that is removed when the test finishes
+// (even when it fails)
+class TemporaryFile {
+    llvm::SmallString<128> _path;
+
+  public:
+    TemporaryFile(const char *prefix) {
+        auto ec = llvm::sys::fs::createTemporaryFile(prefix, "dg", _path);
+        REQUIRE(!ec);
+    }
+    ~TemporaryFile() { llvm::sys::fs::remove(_path); }
+
+    TemporaryFile(const TemporaryFile &) = delete;
+    TemporaryFile &operator=(const TemporaryFile &) = delete;
+
+    std::string path() const { return _path.str().str(); }
+};
+
+TEST_CASE("binary dependence graph test", "LLVM DG") {
+    using namespace dg;
+
+    const char *code = "declare void @crit(i32)\n"
+                       "define void @set(i32* %p, i32 %v) {\n"
+                       "  store i32 %v, i32* %p\n"
+                       "  ret void\n"
+                       "}\n"
+                       "define i32 @main() {\n"
+                       "  %x = alloca i32\n"
+                       "  %y = alloca i32\n"
+                       "  call void @set(i32* %x, i32 1)\n"
+                       "  store i32 2, i32* %y\n"
+                       "  %l = load i32, i32* %x\n"
+                       "  call void @crit(i32 %l)\n"
+                       "  ret i32 0\n"
+                       "}\n";
+    const char *other = "define i32 @main() {\n"
+                        "  ret i32 0\n"
+                        "}\n";
+
+    llvm::LLVMContext ctx;
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "m"), err, ctx);
+    auto M2 = llvm::parseIR(llvm::MemoryBufferRef(other, "m2"), err, ctx);
+    REQUIRE(M);
+    REQUIRE(M2);
+
+    llvmdg::LLVMDependenceGraphBuilder builder(M.get());
+    auto dg = builder.build();
+    REQUIRE(dg);
+
+    TemporaryFile file("llvm-dg-test");
+    const auto path = file.path();
+    std::string error;
+    REQUIRE(llvmdg::writeLLVMDependenceGraph(*dg, *M, path, error));
+
+    auto G = llvmdg::MappedLLVMDependenceGraph::open(path, error);
+    REQUIRE(G);
+    REQUIRE(!G->attach(*M2));
+    REQUIRE(G->attach(*M));
+    REQUIRE(G->edgesNum(llvmdg::dgbin::SUMMARY) == 0);
+
+    // find the instructions of the module in the mapped graph
+    auto inst = [&](const char *fun, unsigned idx) {
+        auto it = M->getFunction(fun)->begin()->begin();
+        while (idx-- > 0)
+            ++it;
+        auto id = G->getNodeID(&*it);
+        REQUIRE(id != llvmdg::ModuleValueNumbering::NONE);
+        REQUIRE(G->getValue(id) == &*it);
+        return id;
+    };
+
+    // the loaded value depends on the store in 'set'
+    // (via the memory and parameters), but not on the store to 'y'
+    auto inSlice = G->backwardSlice({inst("main", 5)});
+    REQUIRE(inSlice[inst("main", 4)]);
+    REQUIRE(inSlice[inst("main", 2)]);
+    REQUIRE(inSlice[inst("main", 0)]);
+    REQUIRE(inSlice[inst("set", 0)]);
+    REQUIRE(!inSlice[inst("main", 3)]);
+}
+
+TEST_CASE("corrupted binary dependence graph test", "LLVM DG") {
+    using namespace dg;
+    using llvmdg::dgbin::Header;
+    using llvmdg::dgbin::Node;
+
+    const char *code = "define void @set(i32* %p, i32 %v) {\n"
+                       "  store i32 %v, i32* %p\n"
+                       "  ret void\n"
+                       "}\n"
+                       "define i32 @main() {\n"
+                       "  %x = alloca i32\n"
+                       "  call void @set(i32* %x, i32 1)\n"
+                       "  %l = load i32, i32* %x\n"
+                       "  ret i32 %l\n"
+                       "}\n";
+
+    llvm::LLVMContext ctx;
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "m"), err, ctx);
+    REQUIRE(M);
+
+    llvmdg::LLVMDependenceGraphBuilder builder(M.get());
+    auto dg = builder.build();
+    REQUIRE(dg);
+
+    TemporaryFile file("llvm-dg-test-corrupted");
+    const auto path = file.path();
+    std::string error;
+    REQUIRE(llvmdg::writeLLVMDependenceGraph(*dg, *M, path, error));
+
+    std::string data;
+    {
+        std::ifstream in(path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+    }
+    REQUIRE(data.size() >= sizeof(Header));
+    Header H;
+    std::memcpy(&H, data.data(), sizeof(H));
+    REQUIRE(H.nodesNum > 0);
+
+    // store the modified file and try opening it
+    auto opens = [&](const std::string &modified) {
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(modified.data(), modified.size());
+        }
+        error.clear();
+        auto G = llvmdg::MappedLLVMDependenceGraph::open(path, error);
+        if (!G)
+            REQUIRE(!error.empty());
+        return G != nullptr;
+    };
+    auto set32 = [](std::string &str, uint64_t pos, uint32_t val) {
+        REQUIRE(pos + sizeof(val) <= str.size());
+        std::memcpy(&str[pos], &val, sizeof(val));
+    };
+
+    REQUIRE(opens(data));
+
+    // the value and the entry of a node out of range
+    auto node = H.nodesOffset;
+    auto corrupted = data;
+    set32(corrupted, node + offsetof(Node, value), H.valuesNum);
+    REQUIRE(!opens(corrupted));
+    corrupted = data;
+    set32(corrupted, node + offsetof(Node, entry), H.nodesNum);
+    REQUIRE(!opens(corrupted));
+
+    // the edges of the USE section that do not fit into the file
+    auto section = H.edgesOffset[llvmdg::dgbin::USE][0];
+    auto last = section + H.nodesNum * sizeof(uint32_t);
+    corrupted = data;
+    set32(corrupted, last, ~static_cast<uint32_t>(0) / 2);
+    REQUIRE(!opens(corrupted));
+
+    // an edge to a node that does not exist
+    uint32_t edges;
+    std::memcpy(&edges, &data[last], sizeof(edges));
+    REQUIRE(edges > 0);
+    corrupted = data;
+    set32(corrupted, last + sizeof(uint32_t), H.nodesNum);
+    REQUIRE(!opens(corrupted));
+
+    // truncated file
+    REQUIRE(!opens(data.substr(0, data.size() - 8)));
+}
+
+TEST_CASE("streaming dot writer test", "LLVM DG") {
+    using namespace dg;
+    using debug::LLVMDGDotWriter;
+
+    const char *code = "@g = global i32 0\n"
+                       "define void @set(i32* %p, i32 %v) {\n"
+                       "  store i32 %v, i32* %p\n"
+                       "  ret void\n"
+                       "}\n"
+                       "define i32 @get() {\n"
+                       "  %v = load i32, i32* @g\n"
+                       "  ret i32 %v\n"
+                       "}\n"
+                       "define i32 @main() {\n"
+                       "  %x = alloca i32\n"
+                       "  call void @set(i32* %x, i32 1)\n"
+                       "  call void @set(i32* @g, i32 2)\n"
+                       "  %l = load i32, i32* %x\n"
+                       "  %r = call i32 @get()\n"
+                       "  %a = add i32 %l, %r\n"
+                       "  ret i32 %a\n"
+                       "}\n";
+
+    llvm::LLVMContext ctx;
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(code, "m"), err, ctx);
+    REQUIRE(M);
+
+    llvmdg::LLVMDependenceGraphBuilder builder(M.get());
+    auto dg = builder.build();
+    REQUIRE(dg);
+
+    auto write = [&dg](const LLVMDGDotWriter::Options &opts) {
+        std::string str;
+        llvm::raw_string_ostream out(str);
+        LLVMDGDotWriter writer(dg.get(), opts);
+        writer.write(out);
+        return out.str();
+    };
+
+    LLVMDGDotWriter::Options opts;
+    opts.edges |= debug::PRINT_CALL;
+    auto whole = write(opts);
+    REQUIRE(whole.find("function set") != std::string::npos);
+    REQUIRE(whole.find("function main") != std::string::npos);
+    REQUIRE(whole.find("label=\"call\"") != std::string::npos);
+
+    // the chunks are concatenated in the same way for any number
+    // of threads and any size of the window
+    opts.threads = 3;
+    opts.window = 1;
+    REQUIRE(write(opts) == whole);
+    opts.window = 2;
+    REQUIRE(write(opts) == whole);
+
+    opts.functions = {"get"};
+    auto get = write(opts);
+    REQUIRE(get.find("function get") != std::string::npos);
+    REQUIRE(get.find("function main") == std::string::npos);
+
+    // nothing is in the slice
+    opts.functions.clear();
+    opts.onlySlice = true;
+    REQUIRE(write(opts).find("NODE") == std::string::npos);
+
+    opts.onlySlice = false;
+    opts.nodeFilter = [](const LLVMNode *nd) {
+        return llvm::isa<llvm::LoadInst>(nd->getValue());
+    };
+    auto loads = write(opts);
+    REQUIRE(loads.find("load i32, i32* %x") != std::string::npos);
+    REQUIRE(loads.find("store") == std::string::npos);
+}
@@ -1,5 +1,8 @@
 #include <catch2/catch.hpp>
 
+#include <thread>
+#include <vector>
+
 #include "dg/PointerAnalysis/PSNode.h"
 #include "dg/PointerAnalysis/Pointer.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
@@ -245,6 +248,44 @@ void testSmallOverflowBehavior() { // only works for SmallOffsetsPTSet
     REQUIRE(S.overflowSetSize() == 0);
 }
 
+template <typename PTSetT>
+void mergeSetsFromDifferentGraphs() {
+    PointerGraph PS1;
+    PointerGraph PS2;
+    PSNode *A = PS1.create<PSNodeType::ALLOC>();
+    PSNode *B = PS2.create<PSNodeType::ALLOC>();
+
+    // B is the first pointer in the second table, but not in the first one
+    PS1.getLookupTable().getOrCreate(Pointer(A, 8));
+    PTSetT S1;
+    PTSetT S2;
+    {
+        dg::PointerIDLookupTable::Scope scope(PS1.getLookupTable());
+        PTSetT tmp;
+        tmp.add(Pointer(A, 0));
+        S1.swap(tmp);
+    }
+    {
+        dg::PointerIDLookupTable::Scope scope(PS2.getLookupTable());
+        PTSetT tmp;
+        tmp.add(Pointer(B, 0));
+        S2.swap(tmp);
+    }
+
+    REQUIRE(S1.add(S2) == true);
+    REQUIRE(S1.size() == 2);
+    REQUIRE(S1.has(Pointer(A, 0)));
+    REQUIRE(S1.has(Pointer(B, 0)));
+    REQUIRE(S1.add(S2) == false);
+    REQUIRE(!S2.has(Pointer(A, 0)));
+
+    // the empty set just takes the IDs of the other set
+    PTSetT S3;
+    REQUIRE(S3.add(S1) == true);
+    REQUIRE(S3.size() == 2);
+    REQUIRE(S3.has(Pointer(B, 0)));
+}
+
 TEST_CASE("Querying empty set", "PointsToSet") {
     queryingEmptySet<OffsetsSetPointsToSet>();
     queryingEmptySet<SimplePointsToSet>();
@@ -346,3 +387,130 @@ TEST_CASE("Test aligned overflow set behavior", "PointsToSet") {
     testAlignedOverflowBehavior<AlignedSmallOffsetsPointsToSet>();
     testAlignedOverflowBehavior<AlignedPointerIdPointsToSet>();
 }
+
+TEST_CASE("Merge points-to sets from different graphs", "PointsToSet") {
+    mergeSetsFromDifferentGraphs<PointerIdPointsToSet>();
+    mergeSetsFromDifferentGraphs<AlignedPointerIdPointsToSet>();
+}
+
+TEST_CASE("Pointer IDs of graphs are independent", "PointsToSet") {
+    PointerGraph PS1;
+    PointerGraph PS2;
+    PSNode *A = PS1.create<PSNodeType::ALLOC>();
+    PSNode *B = PS2.create<PSNodeType::ALLOC>();
+
+    auto &T1 = PS1.getLookupTable();
+    auto &T2 = PS2.getLookupTable();
+    REQUIRE(T1.getOrCreate(Pointer(A, 0)) == 1);
+    REQUIRE(T1.getOrCreate(Pointer(A, 4)) == 2);
+    REQUIRE(T2.getOrCreate(Pointer(B, 0)) == 1);
+    REQUIRE(T2.get(Pointer(A, 0)) == 0);
+    REQUIRE(T1.get(2) == Pointer(A, 4));
+    REQUIRE(T2.size() == 1);
+
+    // the nodes of a graph put their pointers into its table
+    A->addPointsTo(Pointer(A, 8));
+    REQUIRE(T1.get(Pointer(A, 8)) == 3);
+}
+
+TEST_CASE("Concurrent lookup table", "PointsToSet") {
+    dg::PointerIDLookupTable table(8);
+    REQUIRE(table.isConcurrent());
+
+    const unsigned threadsNum = 4;
+    const unsigned pointersNum = 2000;
+    std::vector<PSNode *> targets;
+    for (uintptr_t i = 1; i <= 10; ++i)
+        targets.push_back(reinterpret_cast<PSNode *>(i << 4));
+
+    // all threads create IDs of the same pointers
+    std::vector<std::vector<size_t>> ids(threadsNum);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadsNum; ++t) {
+        threads.emplace_back([&, t]() {
+            for (unsigned i = 0; i < pointersNum; ++i) {
+                Pointer ptr(targets[i % targets.size()], i);
+                ids[t].push_back(table.getOrCreate(ptr));
+            }
+        });
+    }
+    for (auto &thr : threads)
+        thr.join();
+
+    REQUIRE(table.size() == pointersNum);
+    for (unsigned t = 1; t < threadsNum; ++t)
+        REQUIRE(ids[t] == ids[0]);
+    for (unsigned i = 0; i < pointersNum; ++i) {
+        Pointer ptr(targets[i % targets.size()], i);
+        REQUIRE(table.get(ids[0][i]) == ptr);
+    }
+}
+
+TEST_CASE("Pointers to one target have neighbouring IDs", "PointsToSet") {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    auto &T = PS.getLookupTable();
+    T.setReserveBlocks(true);
+
+    // B is seen first, but A is reserved first
+    T.reserve(A);
+    auto b0 = T.getOrCreate(Pointer(B, 0));
+    auto a0 = T.getOrCreate(Pointer(A, 0));
+    REQUIRE(a0 < b0);
+    for (uint64_t off = 8; off < 200; off += 8)
+        T.getOrCreate(Pointer(B, off));
+    REQUIRE(T.getOrCreate(Pointer(B, 8)) == b0 + 1);
+
+    size_t num = 0;
+    T.forEachIDRange(B, [&](size_t first, size_t last) {
+        REQUIRE(first < last);
+        num += last - first;
+    });
+    REQUIRE(num >= 25);
+
+    PointerIdPointsToSet S;
+    S.swap(B->pointsTo);
+    for (uint64_t off = 0; off < 200; off += 8)
+        S.add(Pointer(B, off));
+    S.add(Pointer(A, 0));
+    REQUIRE(S.pointsToTarget(B));
+    REQUIRE(S.removeAny(B));
+    REQUIRE(!S.pointsToTarget(B));
+    REQUIRE(S.size() == 1);
+    REQUIRE(!S.removeAny(B));
+}
+
+TEST_CASE("Pointer IDs are dense by default", "PointsToSet") {
+    PointerGraph PS;
+    auto &T = PS.getLookupTable();
+    REQUIRE(!T.reservesBlocks());
+
+    // an allocation points to itself, so it gets (A, 0) right away
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    REQUIRE(T.get(Pointer(A, 0)) == 1);
+    REQUIRE(T.getOrCreate(Pointer(A, 8)) == 2);
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    REQUIRE(T.get(Pointer(B, 0)) == 3);
+    // reserving does nothing without blocks
+    T.reserve(A);
+    REQUIRE(T.getOrCreate(Pointer(A, 16)) == 4);
+    REQUIRE(T.size() == 4);
+    REQUIRE(T.reserved() == 4);
+
+    // the consecutive IDs of a target form one range
+    std::vector<std::pair<size_t, size_t>> ranges;
+    T.forEachIDRange(A, [&](size_t first, size_t last) {
+        ranges.emplace_back(first, last);
+    });
+    REQUIRE(ranges == std::vector<std::pair<size_t, size_t>>{{1, 3}, {4, 5}});
+
+    dg::PointerIDLookupTable::Scope scope(T);
+    PointerIdPointsToSet S;
+    S.add(Pointer(A, 8));
+    S.add(Pointer(B, 0));
+    REQUIRE(S.pointsToTarget(A));
+    REQUIRE(S.removeAny(A));
+    REQUIRE(!S.pointsToTarget(A));
+    REQUIRE(S.size() == 1);
+}
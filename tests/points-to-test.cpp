@@ -3,6 +3,7 @@
 #include "dg/PointerAnalysis/PointerAnalysisFI.h"
 #include "dg/PointerAnalysis/PointerAnalysisFS.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
+#include "dg/PointerAnalysis/PointerGraphOptimizations.h"
 
 using namespace dg::pta;
 using dg::Offset;
@@ -936,3 +937,80 @@ TEST_CASE("PSNode test", "PSNode") {
     REQUIRE(N2->pointsTo.size() == 1);
     REQUIRE(N2->addPointsTo(N1, 3) == false);
 }
+
+TEST_CASE("Merge equivalent nodes", "HVN") {
+    using namespace dg::pta;
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *C = PS.create<PSNodeType::CAST>(A);
+    PSNode *G1 = PS.create<PSNodeType::GEP>(A, 4);
+    PSNode *G2 = PS.create<PSNodeType::GEP>(C, 4);
+    PSNode *S = PS.create<PSNodeType::STORE>(B, G2);
+    PSNode *L = PS.create<PSNodeType::LOAD>(G1);
+    // GEP with zero offset is not a copy (the offsets out of the object
+    // become unknown), so it is not merged with its operand
+    PSNode *Z = PS.create<PSNodeType::GEP>(A, 0);
+    A->setSize(8);
+
+    A->addSuccessor(B);
+    B->addSuccessor(C);
+    C->addSuccessor(G1);
+    G1->addSuccessor(G2);
+    G2->addSuccessor(S);
+    S->addSuccessor(L);
+    L->addSuccessor(Z);
+
+    auto *subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+
+    PSPointerEquivalenceMerger merger(&PS);
+    REQUIRE(merger.run() == 2);
+    REQUIRE(merger.getMapping().get(C) == A);
+    REQUIRE(merger.getMapping().get(G2) == G1);
+    REQUIRE(S->getOperand(1) == G1);
+    REQUIRE(C->successorsNum() == 0);
+    REQUIRE(merger.getMapping().get(Z) == nullptr);
+
+    PointerAnalysisFS PA(&PS);
+    PA.run();
+
+    REQUIRE(G1->doesPointsTo(A, 4));
+    REQUIRE(L->doesPointsTo(B));
+}
+
+TEST_CASE("Field-sensitivity budget", "FSBudget") {
+    using namespace dg::pta;
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *G1 = PS.create<PSNodeType::GEP>(A, 4);
+    PSNode *G2 = PS.create<PSNodeType::GEP>(A, 8);
+    PSNode *G3 = PS.create<PSNodeType::GEP>(A, 12);
+    PSNode *G4 = PS.create<PSNodeType::GEP>(B, 12);
+    A->setSize(16);
+    B->setSize(16);
+
+    A->addSuccessor(B);
+    B->addSuccessor(G1);
+    G1->addSuccessor(G2);
+    G2->addSuccessor(G3);
+    G3->addSuccessor(G4);
+
+    auto *subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+
+    dg::PointerAnalysisOptions opts;
+    opts.setFieldSensitivityBudget(2);
+    PointerAnalysisFI PA(&PS, opts);
+    PA.run();
+
+    REQUIRE(G1->doesPointsTo(A, 4));
+    REQUIRE(G2->doesPointsTo(A, 8));
+    // the third offset is over the budget
+    REQUIRE(G3->doesPointsTo(A, Offset::UNKNOWN));
+    REQUIRE(G4->doesPointsTo(B, 12));
+    REQUIRE(PA.isCollapsed(A));
+    REQUIRE(!PA.isCollapsed(B));
+    REQUIRE(PA.getNumOfCollapsedObjects() == 1);
+}
@@ -1,103 +1,380 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
 #include <random>
+#include <set>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "dg/PointerAnalysis/PointerGraph.h"
 #include "dg/PointerAnalysis/PointsToSet.h"
 #include "dg/util/TimeMeasure.h"
 
 using namespace dg::pta;
+using dg::Offset;
+using dg::PointerIDLookupTable;
 
-std::default_random_engine generator;
-std::uniform_int_distribution<uint64_t> distribution(0,
-                                                     ~static_cast<uint64_t>(0));
-
-#define run(func, msg)                                                         \
-    do {                                                                       \
-        std::cout << "Running " << (msg) << "\n";                              \
-        dg::debug::TimeMeasure tm;                                             \
-        tm.start();                                                            \
-        for (int i = 0; i < times; ++i)                                        \
-            func<PointsToSetT>();                                              \
-        tm.stop();                                                             \
-        tm.report(" -- PointsToSet bitvector took");                           \
-        tm.start();                                                            \
-        for (int i = 0; i < times; ++i)                                        \
-            func<SimplePointsToSet>();                                         \
-        tm.stop();                                                             \
-        tm.report(" -- PointsToSet std::set took");                            \
-    } while (0);
+// count the memory that is currently allocated, so that we can compare
+// the memory footprint of the sets (the size of every block is stored
+// in front of the block)
+static size_t allocated = 0;
+static const size_t HEADER_SIZE = sizeof(std::max_align_t);
 
-template <typename PTSetT>
-void test1() {
-    PTSetT S;
-    PSNode *x = reinterpret_cast<PSNode *>(0x1);
-    PSNode *y = reinterpret_cast<PSNode *>(0x2);
-    PSNode *z = reinterpret_cast<PSNode *>(0x3);
-
-    S.add({x, 0});
-    S.add({y, 0});
-    S.add({z, 0});
+void *operator new(size_t size) {
+    auto *mem = static_cast<char *>(std::malloc(size + HEADER_SIZE));
+    if (!mem)
+        std::abort();
+    *reinterpret_cast<size_t *>(mem) = size;
+    allocated += size;
+    return mem + HEADER_SIZE;
 }
 
-template <typename PTSetT>
-void test2() {
-    PTSetT S;
-    PSNode *x = reinterpret_cast<PSNode *>(0x1);
+void operator delete(void *mem) noexcept {
+    if (!mem)
+        return;
+    auto *block = static_cast<char *>(mem) - HEADER_SIZE;
+    allocated -= *reinterpret_cast<size_t *>(block);
+    std::free(block);
+}
 
-    S.add({x, 0});
+void operator delete(void *mem, size_t /*unused*/) noexcept {
+    operator delete(mem);
 }
 
-template <typename PTSetT>
-void test3() {
-    std::set<size_t> numbers;
-
-    PTSetT S;
-    PSNode *pointers[]{
-            reinterpret_cast<PSNode *>(0x1), reinterpret_cast<PSNode *>(0x2),
-            reinterpret_cast<PSNode *>(0x3), reinterpret_cast<PSNode *>(0x4),
-            reinterpret_cast<PSNode *>(0x5), reinterpret_cast<PSNode *>(0x6),
-            reinterpret_cast<PSNode *>(0x7)};
-
-    for (int i = 0; i < 1000; ++i) {
-        auto x = distribution(generator);
-        S.add(pointers[x % (sizeof(pointers) / sizeof(*pointers))], x);
+///
+// A workload for the sets: the contents of the sets and the unions
+// of the sets. The unions are replayed until a fixpoint is reached,
+// the same way the analysis propagates the sets over copies.
+// A workload is either generated or read from a trace written by
+// 'llvm-pta-dump -ptset-trace=FILE'.
+struct Workload {
+    struct Ptr {
+        unsigned target;
+        Offset offset;
+    };
+
+    std::string name;
+    unsigned targets{0};
+    std::vector<std::vector<Ptr>> sets;
+    std::vector<std::pair<unsigned, unsigned>> unions; // (to, from)
+
+    size_t pointersNum() const {
+        size_t num = 0;
+        for (const auto &S : sets)
+            num += S.size();
+        return num;
     }
+};
+
+struct Result {
+    double addNs{0};
+    double unionNs{0};
+    double queryNs{0};
+    double iterateNs{0};
+    double bytesPerElem{0};
+    // the used IDs per reserved ID (for the sets of pointer IDs)
+    double density{0};
+};
+
+static double nsPerOp(dg::debug::TimeMeasure &tm, size_t ops) {
+    if (ops == 0)
+        return 0;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      tm.duration())
+                      .count();
+    return static_cast<double>(ns) / ops;
 }
 
+static volatile size_t sink;
+
 template <typename PTSetT>
-void test4() {
-    std::set<size_t> numbers;
+static Result run(const Workload &W, const std::vector<PSNode *> &targets,
+                  bool reserveBlocks = false) {
+    // the IDs of pointers are not shared among the runs
+    PointerIDLookupTable table;
+    PointerIDLookupTable::Scope scope(table);
+    if (reserveBlocks) {
+        // as PointerGraph::reservePointerIDs() does
+        table.setReserveBlocks(true);
+        for (auto *target : targets)
+            table.reserve(target);
+    }
+
+    dg::debug::TimeMeasure tm;
+    Result res;
+
+    const size_t before = allocated;
+    std::vector<PTSetT> sets(W.sets.size());
 
-    PTSetT S;
-    for (int i = 0; i < 1000; ++i) {
-        S.add(reinterpret_cast<PSNode *>(1), i);
+    size_t ops = 0;
+    tm.start();
+    for (size_t i = 0; i < W.sets.size(); ++i) {
+        auto &S = sets[i];
+        for (const auto &ptr : W.sets[i])
+            S.add(targets[ptr.target], ptr.offset);
+        ops += W.sets[i].size();
     }
+    tm.stop();
+    res.addNs = nsPerOp(tm, ops);
+    if (ops > 0)
+        res.bytesPerElem = static_cast<double>(allocated - before) / ops;
+
+    if (!W.unions.empty()) {
+        for (const auto &U : W.unions)
+            sets[U.first].clear();
+
+        ops = 0;
+        bool changed;
+        tm.start();
+        do {
+            changed = false;
+            for (const auto &U : W.unions)
+                changed |= sets[U.first].add(sets[U.second]);
+            ops += W.unions.size();
+        } while (changed);
+        tm.stop();
+        res.unionNs = nsPerOp(tm, ops);
+    }
+
+    ops = 0;
+    size_t found = 0;
+    tm.start();
+    for (size_t i = 0; i < W.sets.size(); ++i) {
+        auto &S = sets[i];
+        for (const auto &ptr : W.sets[i]) {
+            found += S.has({targets[ptr.target], ptr.offset});
+            found += S.pointsToTarget(targets[ptr.target]);
+        }
+        ops += 2 * W.sets[i].size();
+    }
+    tm.stop();
+    res.queryNs = nsPerOp(tm, ops);
+
+    ops = 0;
+    Offset::type sum = 0;
+    tm.start();
+    for (const auto &S : sets) {
+        for (const auto &ptr : S) {
+            sum += *ptr.offset;
+            ++ops;
+        }
+    }
+    tm.stop();
+    res.iterateNs = nsPerOp(tm, ops);
+
+    // do not let the compiler throw the queries away
+    sink = found + sum;
+
+    if (table.reserved() > 0)
+        res.density = static_cast<double>(table.size()) / table.reserved();
+
+
+    return res;
 }
 
-template <typename PTSetT>
-void test5() {
-    std::set<size_t> numbers;
+static void report(const char *backend, const Result &res) {
+    printf("  %-38s %9.1f %9.1f %9.1f %9.1f %9.1f", backend, res.addNs,
+           res.unionNs, res.queryNs, res.iterateNs, res.bytesPerElem);
+    if (res.density > 0)
+        printf(" %9.2f", res.density);
+    printf("\n");
+}
+
+static void runAll(const Workload &W) {
+    printf("%s: %zu sets, %zu pointers to %u targets, %zu unions\n",
+           W.name.c_str(), W.sets.size(), W.pointersNum(), W.targets,
+           W.unions.size());
+    printf("  %-38s %9s %9s %9s %9s %9s %9s\n", "backend", "add", "union",
+           "query", "iterate", "B/elem", "density");
+
+    PointerGraph G;
+    std::vector<PSNode *> targets;
+    targets.reserve(W.targets);
+    for (unsigned i = 0; i < W.targets; ++i)
+        targets.push_back(G.create<PSNodeType::ALLOC>());
+
+    report("PointerIdPointsToSet", run<PointerIdPointsToSet>(W, targets));
+    report("PointerIdPointsToSet (blocks)",
+           run<PointerIdPointsToSet>(W, targets, true));
+    report("AlignedPointerIdPointsToSet",
+           run<AlignedPointerIdPointsToSet>(W, targets));
+    report("AlignedPointerIdPointsToSet (blocks)",
+           run<AlignedPointerIdPointsToSet>(W, targets, true));
+    report("SmallOffsetsPointsToSet",
+           run<SmallOffsetsPointsToSet>(W, targets));
+    report("AlignedSmallOffsetsPointsToSet",
+           run<AlignedSmallOffsetsPointsToSet>(W, targets));
+    // this set over-approximates (it keeps the targets and the offsets
+    // separately), so the union and iteration do more work
+    report("SeparateOffsetsPointsToSet",
+           run<SeparateOffsetsPointsToSet>(W, targets));
+    report("OffsetsSetPointsToSet", run<OffsetsSetPointsToSet>(W, targets));
+    report("SimplePointsToSet", run<SimplePointsToSet>(W, targets));
+    printf("\n");
+}
+
+std::default_random_engine generator;
 
-    PTSetT S;
-    for (int i = 0; i < 1000; ++i) {
-        S.add(reinterpret_cast<PSNode *>(i), i);
+// Generate 'setsNum' sets with the number of pointers given by 'size'
+// and the pointers given by 'pointer'. Every set in the second half
+// gets the union of 'unionsPerSet' random sets (as a phi node does).
+template <typename SizeT, typename PointerT>
+static Workload generate(const std::string &name, unsigned targets,
+                         unsigned setsNum, SizeT size, PointerT pointer,
+                         unsigned unionsPerSet) {
+    Workload W;
+    W.name = name;
+    W.targets = targets;
+    W.sets.resize(setsNum);
+    for (auto &S : W.sets) {
+        std::set<std::pair<unsigned, Offset::type>> ptrs;
+        for (unsigned n = size(); ptrs.size() < n;)
+            ptrs.insert(pointer());
+        for (const auto &ptr : ptrs)
+            S.push_back({ptr.first, ptr.second});
     }
+
+    std::uniform_int_distribution<unsigned> set(0, setsNum - 1);
+    for (unsigned i = setsNum / 2; i < setsNum; ++i) {
+        for (unsigned j = 0; j < unionsPerSet; ++j)
+            W.unions.emplace_back(i, set(generator));
+    }
+
+    return W;
 }
 
-int main() {
-    int times;
-    times = 100000;
-    run(test1, "Adding three elements");
+static std::vector<Workload> generateWorkloads() {
+    std::vector<Workload> workloads;
+    generator.seed(0);
+
+    // most of the points-to sets in programs are singletons
+    // or have a few pointers to the beginning of objects
+    std::discrete_distribution<unsigned> smallSize{0, 70, 20, 10};
+    std::uniform_int_distribution<unsigned> target(0, 9999);
+    workloads.push_back(generate(
+            "small sets", 10000, 20000, [&] { return smallSize(generator); },
+            [&] { return std::make_pair(target(generator), Offset::type{0}); },
+            2));
+
+    // pointers to the fields of structures
+    std::uniform_int_distribution<unsigned> structure(0, 49);
+    std::uniform_int_distribution<unsigned> field(0, 31);
+    std::uniform_int_distribution<unsigned> fieldsNum(1, 16);
+    workloads.push_back(generate(
+            "struct fields", 50, 5000, [&] { return fieldsNum(generator); },
+            [&] {
+                return std::make_pair(structure(generator),
+                                      Offset::type{8} * field(generator));
+            },
+            2));
+
+    // a few objects accessed on arbitrary offsets
+    std::uniform_int_distribution<unsigned> object(0, 6);
+    std::uniform_int_distribution<Offset::type> offset(0, 1 << 20);
+    workloads.push_back(generate(
+            "random offsets", 7, 1000, [] { return 64; },
+            [&] {
+                return std::make_pair(object(generator), offset(generator));
+            },
+            2));
 
-    times = 100000;
-    run(test2, "Adding same element");
+    // big sets, e.g., the sets of pointers to unknown functions
+    std::uniform_int_distribution<unsigned> anyTarget(0, 1999);
+    workloads.push_back(generate(
+            "large sets", 2000, 200, [] { return 500; },
+            [&] {
+                return std::make_pair(anyTarget(generator), Offset::type{0});
+            },
+            4));
 
-    times = 10000;
-    run(test3, "Adding 1000 times 7 pointers with random offsets");
+    return workloads;
+}
+
+// read the trace written by 'llvm-pta-dump -ptset-trace=FILE'
+static bool readTrace(const std::string &path, Workload &W) {
+    std::ifstream in(path);
+    if (!in.is_open())
+        return false;
+
+    W.name = path;
+    std::map<unsigned, unsigned> setIdx;
+    auto getSet = [&](unsigned id) {
+        auto it = setIdx.find(id);
+        if (it != setIdx.end())
+            return it->second;
+        setIdx.emplace(id, W.sets.size());
+        W.sets.emplace_back();
+        return static_cast<unsigned>(W.sets.size() - 1);
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        std::string kind;
+        ss >> kind;
+        if (kind == "S") {
+            unsigned id, num;
+            ss >> id >> num;
+            auto &S = W.sets[getSet(id)];
+            for (unsigned i = 0; i < num; ++i) {
+                std::string ptr;
+                ss >> ptr;
+                auto colon = ptr.find(':');
+                if (colon == std::string::npos)
+                    return false;
+                unsigned target = std::stoul(ptr.substr(0, colon));
+                auto off = ptr.substr(colon + 1);
+                S.push_back({target, off == "?" ? Offset::UNKNOWN
+                                                : Offset(std::stoull(off))});
+                if (target >= W.targets)
+                    W.targets = target + 1;
+            }
+        } else if (kind == "U") {
+            unsigned to, from;
+            ss >> to >> from;
+            // getSet() may add a set, so get the indices one by one
+            auto toIdx = getSet(to);
+            W.unions.emplace_back(toIdx, getSet(from));
+        } else if (!kind.empty() && kind[0] != '#') {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && argv[1][0] == '-') {
+        std::cerr << "Usage: " << argv[0] << " [trace ...]\n"
+                  << "Runs the generated workloads and the workloads from\n"
+                  << "the given traces (see llvm-pta-dump -ptset-trace)\n"
+                  << "on all implementations of points-to sets.\n"
+                  << "The times are in nanoseconds per operation.\n";
+        return 1;
+    }
+
+    printf("Nanoseconds per adding a pointer, per union of two sets, "
+           "per query\n(has() or pointsToTarget()) and per element "
+           "in iteration, the allocated bytes\nper added pointer and "
+           "the used pointer IDs per reserved ID.\n\n");
+
+    auto workloads = generateWorkloads();
+    for (int i = 1; i < argc; ++i) {
+        Workload W;
+        if (!readTrace(argv[i], W)) {
+            std::cerr << "Failed reading the trace " << argv[i] << "\n";
+            return 1;
+        }
+        workloads.push_back(std::move(W));
+    }
 
-    times = 10000;
-    run(test4, "Adding 1000 offsets to a pointer");
+    for (const auto &W : workloads)
+        runAll(W);
 
-    times = 10000;
-    run(test5, "Adding 1000 different pointers");
+    return 0;
 }
@@ -0,0 +1,495 @@
+#!/usr/bin/env python3
+"""
+Benchmark llvm-slicer on the slicing tests and on generated programs
+(C programs generated by this script and modules from llvm-synthetic-gen).
+
+Every program is sliced (w.r.t. calls of test_assert) in every configuration
+of the analyses and the profile of the run (see llvm-slicer -profile-json)
+is stored into a JSON file. The results can be saved as a baseline and later
+runs are compared against the baseline: the run fails if a phase takes more
+time or memory than in the baseline (plus the tolerance) or if the counters
+of the analyses (e.g., the number of iterations of the pointer analysis)
+grow over the tolerance.
+
+The times depend on the machine, so the baseline should be created on
+the machine where the benchmarks are run (make slicing-benchmark-baseline).
+The counters do not depend on the machine.
+"""
+
+import json
+import re
+from argparse import ArgumentParser
+from os import environ, makedirs
+from os.path import abspath, basename, dirname, exists, join
+from shutil import rmtree
+from subprocess import DEVNULL, PIPE, Popen
+from sys import exit, stderr, stdout
+
+from tests import tests
+
+FORMAT_VERSION = 1
+
+configs = {
+    '-pta': ['fi', 'fs', 'inv'],
+    '-dda': ['ssa'],
+    '-cda': ['standard', 'ntscd', 'ntscd2', 'ntscd3'],
+}
+
+# the differences under these limits are considered to be noise
+TIME_NOISE = 0.05      # seconds
+MEMORY_NOISE = 4096    # kB
+
+TEST_SOURCES_DIR = abspath(join(dirname(__file__), 'sources'))
+TEST_ASSERT_H = abspath(join(dirname(__file__), 'test_assert.h'))
+
+verbose = False
+
+
+def error(msg):
+    print(msg, file=stderr)
+    exit(1)
+
+
+def warn(msg):
+    print('WARNING: ' + msg, file=stderr, flush=True)
+
+
+def command(cmd):
+    if verbose:
+        print("> " + "  ".join(cmd), flush=True)
+    try:
+        p = Popen(cmd, stdout=DEVNULL, stderr=PIPE, env=environ)
+    except OSError as e:
+        warn('Failed executing {0}: {1}'.format(cmd[0], e.strerror))
+        return 127
+    _, err = p.communicate()
+    if p.returncode != 0 and verbose:
+        print(err.decode(), file=stderr)
+    return p.returncode
+
+
+def parse_cmake_cache(builddir):
+    """ Get the directories with the tools from the CMake cache """
+    dirs = {'dg_BINARY_DIR': builddir, 'LLVM_TOOLS_DIR': ''}
+    try:
+        with open(join(builddir, 'CMakeCache.txt'), 'r') as f:
+            for line in f:
+                for key in dirs:
+                    if line.startswith(key + ':'):
+                        dirs[key] = line.split('=', 1)[1].strip()
+    except IOError:
+        pass
+    return join(dirs['dg_BINARY_DIR'], 'tools'), dirs['LLVM_TOOLS_DIR']
+
+
+def get_variations(rem=list(configs), result=[]):
+    """ Get all possible variations of the parameters """
+    if not rem:
+        return result
+
+    if result == []:
+        result = [["{0}={1}".format(rem[0], c)] for c in configs[rem[0]]]
+    else:
+        tmp = result
+        result = []
+        for c in configs[rem[0]]:
+            result += [x + ["{0}={1}".format(rem[0], c)] for x in tmp]
+
+    return get_variations(rem[1:], result)
+
+
+##
+# Synthetic programs. They are generated as C sources, so that they are
+# compiled the same way as the tests. 'n' scales the size of the program.
+##
+def gen_call_chain(n):
+    """ A deep chain of calls that pass pointers to each other """
+    out = ['#include <stdlib.h>', 'int g;']
+    out += ['void f{0}(int *p, int *q, int d);'.format(i) for i in range(n)]
+    for i in range(n):
+        callee = 'f{0}(q, p, d + 1)'.format(i + 1) if i + 1 < n else 'g += d'
+        out.append('void f{0}(int *p, int *q, int d) {{\n'
+                   '  *p += {0}; if (d % 3 == 0) *q = *p;\n'
+                   '  {1};\n'
+                   '  if (d % 5 == 0) g += *q;\n}}'.format(i, callee))
+    out.append('int main(void) {\n'
+               '  int a = 0, b = 1;\n'
+               '  f0(&a, &b, 0);\n'
+               '  test_assert(a + b + g > 0);\n'
+               '  return 0;\n}')
+    return '\n'.join(out)
+
+
+def gen_state_machine(n):
+    """ A loop with a big switch over states that update a few variables """
+    out = ['int x, y;',
+           'int step(int state, int *acc) {',
+           '  switch (state) {']
+    for i in range(n):
+        out.append('  case {0}: *acc += {1}; x = *acc ^ {0};'
+                   ' return {2};'.format(i, i % 7, (i * 7 + 3) % n))
+    out += ['  default: y = *acc; return 0;',
+            '  }', '}',
+            'int main(void) {',
+            '  int acc = 0, state = 0;',
+            '  for (int i = 0; i < {0}; ++i) {{'.format(4 * n),
+            '    state = step(state, &acc);',
+            '    if (x % 11 == 0) y += state;',
+            '  }',
+            '  test_assert(acc >= 0 || y != 0);',
+            '  return 0;', '}']
+    return '\n'.join(out)
+
+
+def gen_data_structures(n):
+    """ Lists and trees on the heap and pointers to their fields """
+    out = ['#include <stdlib.h>',
+           'struct node { int val; int *ref; struct node *next, *left; };',
+           'struct node *nodes[{0}];'.format(n),
+           'static struct node *mk(int v, struct node *next) {',
+           '  struct node *nd = malloc(sizeof *nd);',
+           '  nd->val = v; nd->ref = &nd->val; nd->next = next;',
+           '  nd->left = next ? next->next : 0;',
+           '  return nd;', '}']
+    for i in range(n):
+        prev = 'nodes[{0}]'.format(i - 1) if i > 0 else '0'
+        out.append('static void build{0}(void) {{\n'
+                   '  nodes[{0}] = mk({0}, {1});\n'
+                   '  if (nodes[{0}]->left) nodes[{0}]->left->ref = '
+                   'nodes[{0}]->ref;\n}}'.format(i, prev))
+    out += ['static int sum(struct node *nd) {',
+            '  int s = 0;',
+            '  for (; nd; nd = nd->next) s += *nd->ref;',
+            '  return s;', '}',
+            'int main(void) {']
+    out += ['  build{0}();'.format(i) for i in range(n)]
+    out += ['  test_assert(sum(nodes[{0}]) >= 0);'.format(n - 1),
+            '  return 0;', '}']
+    return '\n'.join(out)
+
+
+generators = {
+    'synthetic-call-chain': gen_call_chain,
+    'synthetic-state-machine': gen_state_machine,
+    'synthetic-data-structures': gen_data_structures,
+}
+
+# The modules generated by llvm-synthetic-gen (the arguments of the generator
+# and additional parameters of the slicer). These do not need clang.
+generated_modules = {
+    'generated-calls': (['-functions', '200', '-depth', '20',
+                         '-heap', 'none'], []),
+    'generated-indirect-calls': (['-functions', '100', '-depth', '10',
+                                  '-indirect', '30', '-heap', 'none'], []),
+    'generated-list': (['-functions', '30', '-depth', '10'], []),
+    'generated-tree': (['-functions', '30', '-depth', '10',
+                        '-heap', 'tree'], []),
+    'generated-loops': (['-functions', '50', '-depth', '10',
+                         '-loop-depth', '3', '-heap', 'none'], []),
+    'generated-threads': (['-functions', '50', '-depth', '10',
+                           '-threads', '4', '-heap', 'none'],
+                          ['-consider-threads']),
+}
+
+
+class Program:
+    def __init__(self, name, bccode=None, test=None, source=None,
+                 genargs=None, params=[], criteria='test_assert'):
+        self.name = name
+        self.bccode = bccode    # already compiled
+        self.test = test        # a slicing test
+        self.source = source    # a generated C source
+        self.genargs = genargs  # the arguments of llvm-synthetic-gen
+        self.params = params    # additional parameters of the slicer
+        self.criteria = criteria
+
+
+class Benchmark:
+    def __init__(self, tools_dir, llvm_tools_dir, workdir):
+        self.slicer = join(tools_dir, 'llvm-slicer')
+        self.generator = join(tools_dir, 'llvm-synthetic-gen')
+        self.llvm_tools_dir = llvm_tools_dir
+        self.workdir = workdir
+
+    def _llvm_tool(self, name):
+        return join(self.llvm_tools_dir, name)
+
+    def _compile(self, source, output, params=[]):
+        cmd = [self._llvm_tool('clang'), '-include', TEST_ASSERT_H,
+               '-emit-llvm', '-std=c11', '-fno-strict-aliasing', '-c',
+               source, '-o', output] + params
+        return command(cmd) == 0
+
+    def prepare(self, prog):
+        """ Get the bitcode of the program, None on failure """
+        if prog.bccode:
+            return prog.bccode
+
+        out = join(self.workdir, prog.name + '.bc')
+        if prog.genargs is not None:
+            ret = command([self.generator, '-o', out] + prog.genargs)
+            return out if ret == 0 else None
+        if prog.source is not None:
+            src = join(self.workdir, prog.name + '.c')
+            with open(src, 'w') as f:
+                f.write(prog.source)
+            return out if self._compile(src, out) else None
+
+        t = prog.test
+        if not self._compile(join(TEST_SOURCES_DIR, t.source), out,
+                             t.compilerparams):
+            return None
+        if t.optbefore:
+            opt = out + '.opt'
+            if command([self._llvm_tool('opt'), out, '-o', opt]
+                       + t.optbefore) != 0:
+                return None
+            out = opt
+        if t.linkbefore:
+            codes = []
+            for l in t.linkbefore:
+                bc = join(self.workdir, prog.name + '-' + basename(l) + '.bc')
+                if not self._compile(join(TEST_SOURCES_DIR, l), bc,
+                                     t.compilerparams):
+                    return None
+                codes.append(bc)
+            linked = out + '.linked'
+            if command([self._llvm_tool('llvm-link'), out, '-o', linked]
+                       + codes) != 0:
+                return None
+            out = linked
+        return out
+
+    def run(self, prog, bccode, setup, repeat):
+        """ Slice the program 'repeat' times, return the best measurement """
+        profile = join(self.workdir, prog.name + '.profile.json')
+        params = prog.params + (prog.test.addparams if prog.test else [])
+        cmd = [self.slicer, '-c', prog.criteria] + setup + params + \
+              ['-profile-json', profile, bccode,
+               '-o', join(self.workdir, prog.name + '.sliced')]
+
+        best = None
+        for _ in range(repeat):
+            if command(cmd) != 0:
+                return None
+            with open(profile, 'r') as f:
+                best = merge_min(best, flatten(json.load(f)))
+        return best
+
+
+def flatten(profile):
+    """
+    Turn the profile into a flat map of metrics, the names of metrics
+    of nested phases are the paths of phases separated by '/'.
+    """
+    res = {'time': profile['wall_time'],
+           'cpu_time': profile['cpu_time'],
+           'peak_rss_kb': profile['peak_rss_kb']}
+    if 'allocations' in profile:
+        res['allocations'] = profile['allocations']
+
+    def walk(phase, prefix):
+        path = prefix + phase['name']
+        res[path + ':time'] = phase['wall_time']
+        res[path + ':rss_growth_kb'] = phase['peak_rss_growth_kb']
+        if 'allocations' in phase:
+            res[path + ':allocations'] = phase['allocations']
+        for counter, val in phase['counters'].items():
+            res[path + ':#' + counter] = val
+        for child in phase['phases']:
+            walk(child, path + '/')
+
+    for phase in profile['phases']:
+        walk(phase, '')
+    return res
+
+
+def merge_min(old, new):
+    if old is None:
+        return new
+    return {k: min(v, old.get(k, v)) for k, v in new.items()}
+
+
+def metric_kind(name):
+    if name.endswith('time'):
+        return 'time'
+    if name.endswith('_kb'):
+        return 'memory'
+    return 'count'
+
+
+def compare(baseline, results, tolerance):
+    """ Return the list of regressions of 'results' against 'baseline' """
+    noise = {'time': TIME_NOISE, 'memory': MEMORY_NOISE, 'count': 0}
+    regressions = []
+    for prog, setups in sorted(results.items()):
+        for setup, metrics in sorted(setups.items()):
+            base = baseline.get(prog, {}).get(setup)
+            if base is None:
+                continue
+            for name, val in sorted(metrics.items()):
+                old = base.get(name)
+                if old is None:
+                    continue
+                if val - old > max(old * tolerance,
+                                   noise[metric_kind(name)]):
+                    regressions.append((prog, setup, name, old, val))
+    return regressions
+
+
+def get_programs(args):
+    progs = []
+    if not args.no_corpus:
+        for name in sorted(tests):
+            progs.append(Program(name, test=tests[name]))
+    if not args.no_synthetic:
+        for name, gen in sorted(generators.items()):
+            for scale in args.scale:
+                progs.append(Program('{0}-{1}'.format(name, scale),
+                                     source=gen(scale)))
+        for name, (genargs, params) in sorted(generated_modules.items()):
+            progs.append(Program(name, genargs=genargs, params=params))
+    for path in args.input:
+        progs.append(Program(basename(path), bccode=abspath(path),
+                             criteria=args.criteria))
+
+    if args.filter:
+        r = re.compile(args.filter)
+        progs = [p for p in progs if r.search(p.name)]
+    return progs
+
+
+def main():
+    parser = ArgumentParser(description=__doc__.strip().split('\n')[0])
+    parser.add_argument('--build-dir', default='.',
+                        help='the build directory of DG')
+    parser.add_argument('--tools-dir',
+                        help='the directory with llvm-slicer')
+    parser.add_argument('--llvm-tools-dir',
+                        help='the directory with clang, opt and llvm-link')
+    parser.add_argument('--baseline',
+                        help='compare the results with this baseline')
+    parser.add_argument('--update-baseline', action='store_true',
+                        help='save the results as the baseline')
+    parser.add_argument('--output', default='slicing-benchmark.json',
+                        help='save the results into this file')
+    parser.add_argument('--tolerance', type=float, default=0.25,
+                        help='allowed relative growth (default 0.25)')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='run every configuration N times and take '
+                             'the best values (default 3)')
+    parser.add_argument('--filter', help='benchmark only the programs '
+                                         'whose name matches the regex')
+    parser.add_argument('--setup', action='append', default=[],
+                        help='run only one setup with this option of '
+                             'the slicer (e.g., --setup=-pta=fs), can be '
+                             'given multiple times')
+    parser.add_argument('--scale', type=int, action='append',
+                        help='the size of the synthetic programs, can be '
+                             'given multiple times (default 100 and 1000)')
+    parser.add_argument('--input', action='append', default=[],
+                        help='benchmark also this bitcode file')
+    parser.add_argument('--criteria', default='test_assert',
+                        help='the slicing criteria for the --input files')
+    parser.add_argument('--no-corpus', action='store_true',
+                        help='do not benchmark the slicing tests')
+    parser.add_argument('--no-synthetic', action='store_true',
+                        help='do not benchmark the synthetic programs')
+    parser.add_argument('--keep', action='store_true',
+                        help='keep the working directory')
+    parser.add_argument('-v', '--verbose', action='store_true')
+    args = parser.parse_args()
+
+    global verbose
+    verbose = args.verbose
+    if args.scale is None:
+        args.scale = [100, 1000]
+    if args.update_baseline and not args.baseline:
+        error('--update-baseline needs --baseline')
+
+    tools_dir, llvm_tools_dir = parse_cmake_cache(abspath(args.build_dir))
+    if args.tools_dir:
+        tools_dir = args.tools_dir
+    if args.llvm_tools_dir is not None:
+        llvm_tools_dir = args.llvm_tools_dir
+    if not exists(join(tools_dir, 'llvm-slicer')):
+        error('Did not find llvm-slicer in ' + tools_dir)
+
+    workdir = abspath('slicing-benchmark.tmp')
+    rmtree(workdir, ignore_errors=True)
+    makedirs(workdir)
+    bench = Benchmark(tools_dir, llvm_tools_dir, workdir)
+
+    setups = [args.setup] if args.setup else get_variations()
+    results = {}
+    failed = []
+    for prog in get_programs(args):
+        stdout.write('{0} ... '.format(prog.name))
+        stdout.flush()
+        bccode = bench.prepare(prog)
+        if bccode is None:
+            print('failed compiling')
+            failed.append(prog.name)
+            continue
+
+        for setup in setups:
+            if prog.test and \
+               any(p not in setup for p in prog.test.requiredparams):
+                continue
+            metrics = bench.run(prog, bccode, setup, args.repeat)
+            if metrics is None:
+                failed.append('{0} {1}'.format(prog.name, ' '.join(setup)))
+                continue
+            results.setdefault(prog.name, {})[' '.join(setup)] = metrics
+        setups_time = sum(m['time'] for m in results.get(prog.name,
+                                                          {}).values())
+        print('{0:.2f} s'.format(setups_time))
+
+    if not args.keep:
+        rmtree(workdir)
+
+    out = {'version': FORMAT_VERSION, 'results': results}
+    with open(args.output, 'w') as f:
+        json.dump(out, f, indent=1, sort_keys=True)
+
+    if failed:
+        print('\nFailed runs:')
+        for f in failed:
+            print('  ' + f)
+
+    if args.update_baseline:
+        # keep the results of the programs that were not run now
+        base = {}
+        if exists(args.baseline):
+            with open(args.baseline, 'r') as f:
+                base = json.load(f).get('results', {})
+        for prog, res in results.items():
+            base.setdefault(prog, {}).update(res)
+        with open(args.baseline, 'w') as f:
+            json.dump({'version': FORMAT_VERSION, 'results': base}, f,
+                      indent=1, sort_keys=True)
+        print('\nSaved the baseline to ' + args.baseline)
+    elif args.baseline:
+        if not exists(args.baseline):
+            error('No baseline in {0}, create it with --update-baseline'
+                  .format(args.baseline))
+        with open(args.baseline, 'r') as f:
+            base = json.load(f)
+        if base.get('version') != FORMAT_VERSION:
+            error('The baseline has a different format, re-create it')
+
+        regressions = compare(base['results'], results, args.tolerance)
+        if regressions:
+            print('\nRegressions (more than {0:.0f}% over the baseline):'
+                  .format(100 * args.tolerance))
+            for prog, setup, name, old, val in regressions:
+                print('  {0} [{1}] {2}: {3:g} -> {4:g}'.format(
+                      prog, setup, name, old, val))
+            exit(1)
+        print('\nNo regressions against the baseline')
+
+    exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
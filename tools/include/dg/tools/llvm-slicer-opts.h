@@ -1,6 +1,7 @@
 #ifndef DG_TOOLS_LLVM_SLICER_OPTS_H_
 #define DG_TOOLS_LLVM_SLICER_OPTS_H_
 
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -59,11 +60,40 @@ getSlicingCriteriaValues(llvm::Module &M, const std::string &slicingCriteria,
                          const std::string &legacySecondaryCriteria,
                          bool criteria_are_next_instr = false);
 
+///
+// An index of the instructions of a dependence graph for matching
+// the slicing criteria. Searching many criteria in the same graph
+// (e.g., the requests in the server mode) can share one index,
+// but the index must not outlive the graph.
+class CriteriaIndex;
+struct CriteriaIndexDeleter {
+    void operator()(CriteriaIndex *index) const;
+};
+using CriteriaIndexPtr = std::unique_ptr<CriteriaIndex, CriteriaIndexDeleter>;
+
+CriteriaIndexPtr createCriteriaIndex(dg::LLVMDependenceGraph &dg);
+
+///
+// Get the nodes of the slicing criteria. If 'index' is null,
+// a temporary index of the graph is built for this search.
 bool getSlicingCriteriaNodes(dg::LLVMDependenceGraph &dg,
                              const std::string &slicingCriteria,
                              const std::string &legacySlicingCriteria,
                              const std::string &legacySecondarySlicingCriteria,
                              std::set<dg::LLVMNode *> &criteria_nodes,
-                             bool criteria_are_next_instr = false);
+                             bool criteria_are_next_instr = false,
+                             const CriteriaIndex *index = nullptr);
+
+///
+// Get the nodes of every ';'-separated slicing criterion separately,
+// the i-th set in 'criteria_nodes' belongs to the i-th criterion
+// (it is empty if the criterion was not found). The entries of the form
+// '|X' are attached to all the criteria and do not count.
+// Only the new format of slicing criteria is supported.
+bool getSlicingCriteriaNodesList(
+        dg::LLVMDependenceGraph &dg, const std::string &slicingCriteria,
+        std::vector<std::set<dg::LLVMNode *>> &criteria_nodes,
+        bool criteria_are_next_instr = false,
+        const CriteriaIndex *index = nullptr);
 
 #endif // DG_TOOLS_LLVM_SLICER_OPTS_H_
@@ -1,8 +1,11 @@
 #ifndef DG_TOOL_LLVM_SLICER_H_
 #define DG_TOOL_LLVM_SLICER_H_
 
+#include <algorithm>
 #include <ctime>
 #include <fstream>
+#include <memory>
+#include <vector>
 
 #include <llvm/IR/Module.h>
 #include <llvm/Support/raw_os_ostream.h>
@@ -16,11 +19,14 @@
 
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/llvm/LLVMDependenceGraphBuilder.h"
+#include "dg/llvm/LLVMSliceEmitter.h"
 #include "dg/llvm/LLVMSlicer.h"
 
 #include "dg/llvm/LLVMDG2Dot.h"
 #include "dg/llvm/LLVMDGAssemblyAnnotationWriter.h"
 
+#include "dg/util/ParallelFor.h"
+#include "dg/util/Profiler.h"
 #include "dg/util/TimeMeasure.h"
 
 #include "llvm-slicer-opts.h"
@@ -52,6 +58,8 @@
 //
 /// --------------------------------------------------------------------
 class Slicer {
+    using BatchMarkerT = dg::BatchWalkAndMark<dg::LLVMNode>;
+
     llvm::Module *M{};
     const SlicerOptions &_options;
 
@@ -61,8 +69,17 @@ class Slicer {
     dg::llvmdg::LLVMSlicer slicer;
     uint32_t slice_id = 0;
     const uint32_t _default_slice_id = 0xdead;
+    // the last slice id used by selectBatchedSlice()
+    uint32_t _batch_slice_id = _default_slice_id;
     bool _computed_deps{false};
 
+    // markers used by markBatch(), every one holds
+    // _batch_size criteria
+    std::vector<std::unique_ptr<BatchMarkerT>> _batches;
+    size_t _batch_size{BatchMarkerT::maxCriteria()};
+    // criteria nodes of the batched criteria (for removeSlicingCriteria)
+    std::vector<std::set<dg::LLVMNode *>> _batchedCriteria;
+
   public:
     Slicer(llvm::Module *mod, const SlicerOptions &opts)
             : M(mod), _options(opts), _builder(mod, _options.dgOptions) {
@@ -74,6 +91,8 @@ class Slicer {
 
     const SlicerOptions &getOptions() const { return _options; }
 
+    bool hasComputedDependencies() const { return _computed_deps; }
+
     // Mirror LLVM to nodes of dependence graph,
     // No dependence edges are added here unless the
     // 'compute_deps' parameter is set to true.
@@ -95,8 +114,8 @@ class Slicer {
 
     // Explicitely compute dependencies after building the graph.
     // This method can be used to compute dependencies without
-    // calling mark() afterwards (mark() calls this function).
-    // It must not be called before calling mark() in the future.
+    // calling mark() afterwards (mark() calls this function
+    // if the dependencies have not been computed yet).
     void computeDependencies() {
         assert(!_computed_deps && "Already called computeDependencies()");
         // must call buildDG() before this function
@@ -125,7 +144,8 @@ class Slicer {
         dg::debug::TimeMeasure tm;
 
         // compute dependece edges
-        computeDependencies();
+        if (!_computed_deps)
+            computeDependencies();
 
         // unmark this set of nodes after marking the relevant ones.
         // Used to mimic the Weissers algorithm
@@ -141,6 +161,8 @@ class Slicer {
 
         slice_id = _default_slice_id;
 
+        dg::debug::Profiler::Scope phase("marking");
+        dg::debug::Profiler::count("criteria", criteria_nodes.size());
         tm.start();
         for (dg::LLVMNode *start : criteria_nodes)
             slice_id = slicer.mark(start, slice_id, _options.forwardSlicing);
@@ -157,11 +179,145 @@ class Slicer {
         return true;
     }
 
+    ///
+    // Mark the slices of several criteria at once. Every set in
+    // 'criteria' is one slicing criterion and gets its own slice.
+    // The criteria are marked in batches of (at most)
+    // BatchMarkerT::maxCriteria() using one traversal of the graph
+    // per batch. The batches are marked in 'jobs' threads; the marking
+    // only reads the graph (the slices are kept in the batch markers
+    // and get their slice ids in selectBatchedSlice()), so the threads
+    // do not need any synchronization. With more threads, the criteria
+    // are spread into more (smaller) batches so that every thread
+    // has some work.
+    // Use selectBatchedSlice() to pick the slice for slice().
+    // Forward slicing is not supported in this mode.
+    bool markBatch(const std::vector<std::set<dg::LLVMNode *>> &criteria,
+                   unsigned jobs = 1) {
+        assert(_dg && "markBatch() called without the dependence graph built");
+        assert(!criteria.empty() && "Do not have slicing criteria");
+
+        if (_options.forwardSlicing) {
+            llvm::errs() << "[llvm-slicer] Forward slicing is not supported "
+                            "with batched criteria\n";
+            return false;
+        }
+
+        dg::debug::TimeMeasure tm;
+
+        if (!_computed_deps)
+            computeDependencies();
+
+        std::set<dg::LLVMNode *> additional;
+        _dg->getCallSites(_options.additionalSlicingCriteria, &additional);
+
+        for (const auto &funcName : _options.preservedFunctions)
+            slicer.keepFunctionUntouched(funcName.c_str());
+
+        // markBatch() may be called repeatedly on the same graph,
+        // forget the previous batches
+        _batches.clear();
+        _batchedCriteria = criteria;
+
+        dg::debug::Profiler::Scope phase("batched marking");
+        dg::debug::Profiler::count("criteria", criteria.size());
+        tm.start();
+
+        jobs = std::max(jobs, 1U);
+        _batch_size = BatchMarkerT::maxCriteria();
+        if (jobs > 1) {
+            _batch_size = std::min(_batch_size,
+                                   (criteria.size() + jobs - 1) / jobs);
+        }
+
+        std::vector<std::vector<std::set<dg::LLVMNode *>>> batches;
+        for (size_t start = 0; start < criteria.size();
+             start += _batch_size) {
+            auto end = std::min(criteria.size(), start + _batch_size);
+            batches.emplace_back(criteria.begin() + start,
+                                 criteria.begin() + end);
+            for (auto &crit : batches.back())
+                crit.insert(additional.begin(), additional.end());
+
+            _batches.emplace_back(new BatchMarkerT());
+        }
+        dg::debug::Profiler::count("batches", batches.size());
+
+        dg::util::parallelFor(batches.size(), jobs, [&](size_t i) {
+            _batches[i]->mark(batches[i]);
+        });
+        tm.stop();
+        tm.report("[llvm-slicer] Finding dependent nodes (batched) took");
+
+        return true;
+    }
+
+    size_t getBatchedCriteriaNum() const { return _batchedCriteria.size(); }
+
+    // the number of criteria in the b-th batch
+    size_t batchCriteriaNum(size_t b) const {
+        assert(b < _batches.size());
+        return std::min(_batch_size, _batchedCriteria.size() - b * _batch_size);
+    }
+
+    // number of nodes in the slice of the idx-th batched criterion
+    size_t getBatchedSliceSize(size_t idx) const {
+        assert(idx < _batchedCriteria.size());
+        return _batches[idx / _batch_size]->getSliceSize(idx % _batch_size);
+    }
+
+    ///
+    // Estimate the slices marked by markBatch() without slicing anything:
+    // the number of nodes, blocks and functions in the slice of every
+    // batched criterion. Neither the graph nor the module is modified.
+    std::vector<dg::SliceSize> estimateBatchedSlices() const {
+        std::vector<dg::SliceSize> sizes;
+        sizes.reserve(_batchedCriteria.size());
+        for (size_t b = 0; b < _batches.size(); ++b) {
+            auto bsizes = _batches[b]->getSliceSizes(batchCriteriaNum(b));
+            sizes.insert(sizes.end(), bsizes.begin(), bsizes.end());
+        }
+        return sizes;
+    }
+
+    ///
+    // Group the batched criteria whose slices overlap heavily, that is,
+    // the Jaccard similarity of the nodes of the slices is at least
+    // 'threshold' (see dg::SliceOverlaps::group()). The criteria
+    // of a group can be sliced together as one criterion.
+    std::vector<std::vector<size_t>>
+    groupBatchedCriteria(double threshold) const {
+        dg::debug::Profiler::Scope phase("grouping criteria");
+        dg::SliceOverlaps<dg::LLVMNode> overlaps;
+        for (size_t b = 0; b < _batches.size(); ++b)
+            overlaps.add(*_batches[b], batchCriteriaNum(b));
+        return overlaps.group(threshold);
+    }
+
+    ///
+    // Set the slice of the idx-th criterion marked by markBatch()
+    // as the slice that is going to be sliced by slice() or emitSlice().
+    // Every call uses a fresh slice id, so that the marks of previously
+    // selected slices do not leak into this one. Since slice() modifies
+    // the graph and the module, use emitSlice() to get more slices.
+    void selectBatchedSlice(size_t idx) {
+        assert(idx < _batchedCriteria.size());
+
+        slice_id = ++_batch_slice_id;
+        _batches[idx / _batch_size]->setSlice(idx % _batch_size, slice_id);
+
+        if (_options.removeSlicingCriteria) {
+            for (dg::LLVMNode *nd : _batchedCriteria[idx])
+                nd->setSlice(0);
+        }
+    }
+
     bool slice() {
         assert(_dg && "Must run buildDG() and computeDependencies()");
         assert(slice_id != 0 && "Must run mark() method before slice()");
 
         dg::debug::TimeMeasure tm;
+        dg::debug::Profiler::Scope phase("slicing");
 
         tm.start();
         slicer.slice(_dg.get(), nullptr, slice_id);
@@ -170,17 +326,52 @@ class Slicer {
         tm.report("[llvm-slicer] Slicing dependence graph took");
 
         dg::SlicerStatistics &st = slicer.getStatistics();
+        dg::debug::Profiler::count("nodes", st.nodesTotal);
+        dg::debug::Profiler::count("removed nodes", st.nodesRemoved);
         llvm::errs() << "[llvm-slicer] Sliced away " << st.nodesRemoved
                      << " from " << st.nodesTotal << " nodes in DG\n";
 
         return true;
     }
 
+    ///
+    // Create a new module with the marked slice. Unlike slice(),
+    // this does not modify the module or the dependence graph,
+    // so it can be used repeatedly (e.g., with selectBatchedSlice()).
+    std::unique_ptr<llvm::Module> emitSlice() {
+        assert(_dg && "Must run buildDG() and computeDependencies()");
+        assert(slice_id != 0 && "Must run mark() method before emitSlice()");
+
+        dg::debug::TimeMeasure tm;
+        dg::llvmdg::LLVMSliceEmitter emitter(_dg.get());
+        for (const auto &funcName : _options.preservedFunctions)
+            emitter.keepFunctionUntouched(funcName);
+
+        dg::debug::Profiler::Scope phase("emitting slice");
+        tm.start();
+        auto sliced = emitter.emit(slice_id);
+        tm.stop();
+        tm.report("[llvm-slicer] Emitting the slice took");
+
+        const dg::SlicerStatistics &st = emitter.getStatistics();
+        dg::debug::Profiler::count("nodes", st.nodesTotal);
+        dg::debug::Profiler::count("removed nodes", st.nodesRemoved);
+        llvm::errs() << "[llvm-slicer] Sliced away " << st.nodesRemoved
+                     << " from " << st.nodesTotal << " nodes in DG\n";
+
+        return sliced;
+    }
+
     ///
     // Create new empty main in the module. If 'call_entry' is set to true,
     // then call the entry function from the new main (if entry is not main),
     // otherwise the main is going to be empty
     bool createEmptyMain(bool call_entry = false) {
+        return createEmptyMain(M, call_entry);
+    }
+
+    // the same as above, but in the given module (e.g., a copy of M)
+    bool createEmptyMain(llvm::Module *M, bool call_entry = false) {
         llvm::LLVMContext &ctx = M->getContext();
         llvm::Function *main_func = M->getFunction("main");
         if (!main_func) {
@@ -284,6 +475,8 @@ class ModuleWriter {
 
   private:
     bool writeModule() {
+        dg::debug::Profiler::Scope phase("writing module");
+
         // compose name if not given
         std::string fl;
         if (!options.outputFile.empty()) {
@@ -532,7 +725,7 @@ class ModuleAnnotator {
         llvm::errs() << "[llvm-slicer] Saving IR with annotations to " << fl
                      << "\n";
         auto *annot = new dg::debug::LLVMDGAssemblyAnnotationWriter(
-                annotationOptions, dg->getPTA(), dg->getDDA(), criteria);
+                dg, annotationOptions, dg->getPTA(), dg->getDDA(), criteria);
         annot->emitModuleComment(std::move(module_comment));
         llvm::Module *M = dg->getModule();
         M->print(outputstream, annot);
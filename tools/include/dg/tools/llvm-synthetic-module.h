@@ -0,0 +1,52 @@
+#ifndef LLVM_SYNTHETIC_MODULE_H_
+#define LLVM_SYNTHETIC_MODULE_H_
+
+#include <memory>
+#include <string>
+
+namespace llvm {
+class LLVMContext;
+class Module;
+} // namespace llvm
+
+namespace dg {
+namespace llvmdg {
+
+///
+// The shape of a generated module. The functions are split into 'depth'
+// levels of the call graph and every function calls 'fanout' functions
+// from the next level (every function is called at least once), so
+// the call graph is 'depth' calls deep. 'indirectCalls' percent of the
+// calls go via tables of function pointers. Every function works with
+// the globals, its arguments and a data structure on the heap that the
+// functions extend (allocate new nodes and link them) and traverse.
+// 'loopDepth' is the nesting of loops in every function and 'threads'
+// is the number of threads that main spawns (and joins), every thread
+// runs some functions from the first levels.
+//
+// The same options (including the seed) give always the same module.
+struct SyntheticModuleOptions {
+    enum class HeapShape { NONE, LIST, TREE };
+
+    unsigned functions{100};
+    unsigned depth{10};
+    unsigned fanout{2};
+    unsigned indirectCalls{0}; // in percent
+    HeapShape heap{HeapShape::LIST};
+    unsigned loopDepth{1};
+    unsigned threads{0};
+    unsigned globals{10};
+    unsigned seed{0};
+    // main calls 'void criterion(i32)' at the end, so that the module
+    // can be sliced right away (e.g., w.r.t. test_assert like the tests)
+    std::string criterion{"test_assert"};
+};
+
+std::unique_ptr<llvm::Module>
+generateSyntheticModule(llvm::LLVMContext &ctx,
+                        const SyntheticModuleOptions &options);
+
+} // namespace llvmdg
+} // namespace dg
+
+#endif
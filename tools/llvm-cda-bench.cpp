@@ -1,6 +1,7 @@
 #include <cassert>
 #include <ctime>
 #include <iostream>
+#include <random>
 
 #include "dg/tools/llvm-slicer-opts.h"
 #include "dg/tools/llvm-slicer-utils.h"
@@ -25,9 +26,14 @@
 #include "dg/llvm/ControlDependence/ControlDependence.h"
 #include "dg/llvm/PointerAnalysis/DGPointerAnalysis.h"
 #include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+#include "dg/util/TimeMeasure.h"
 #include "dg/util/debug.h"
 
 #include "ControlDependence/CDGraph.h"
+#include "ControlDependence/CDGraphGenerators.h"
+#include "ControlDependence/DOD.h"
+#include "ControlDependence/DODNTSCD.h"
+#include "ControlDependence/NTSCD.h"
 #include "llvm/ControlDependence/DOD.h"
 #include "llvm/ControlDependence/NTSCD.h"
 
@@ -69,6 +75,10 @@ llvm::cl::opt<bool> ntscd2("ntscd2",
                            llvm::cl::desc("Benchmark NTSCD 2 (default=false)."),
                            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<bool> ntscd3("ntscd3",
+                           llvm::cl::desc("Benchmark NTSCD 3 (default=false)."),
+                           llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
 llvm::cl::opt<bool> ntscd_ranganath(
         "ntscd-ranganath",
         llvm::cl::desc(
@@ -110,6 +120,23 @@ llvm::cl::opt<bool> compare(
                 "Compare the resulting control dependencies (default=false)."),
         llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<bool> irreducible_bench(
+        "irreducible-bench",
+        llvm::cl::desc("Do not load any module, but run the analyses on "
+                       "generated irreducible CFGs (default=false)."),
+        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<unsigned> irreducible_nodes(
+        "irreducible-nodes",
+        llvm::cl::desc("The number of nodes of the generated CFGs "
+                       "(default=1000)."),
+        llvm::cl::init(1000), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<unsigned> irreducible_graphs(
+        "irreducible-graphs",
+        llvm::cl::desc("The number of generated CFGs (default=10)."),
+        llvm::cl::init(10), llvm::cl::cat(SlicingOpts));
+
 void compareResults(
         const std::set<std::pair<const llvm::Value *, const llvm::Value *>> &R1,
         const std::set<std::pair<const llvm::Value *, const llvm::Value *>> &R2,
@@ -139,6 +166,8 @@ void compareResults(
     }
 }
 
+using CDGraphResultT = std::map<CDNode *, std::set<CDNode *>>;
+
 static inline bool hasSuccessors(const llvm::BasicBlock *B) {
     return succ_begin(B) != succ_end(B);
 }
@@ -250,6 +279,99 @@ static void dumpFunStats(const llvm::Function &F) {
     std::cout << "  DFS max depth: " << maxdepth << "\n";
 }
 
+template <typename Analysis>
+static void runOnGraph(CDGraph &G, std::tuple<std::string, size_t,
+                                              CDGraphResultT> &it) {
+    Analysis analysis;
+    clock_t start = clock();
+    auto result = analysis.compute(G);
+    std::get<1>(it) += clock() - start;
+
+    // some analyses keep also the nodes without dependencies
+    auto &CD = std::get<2>(it) = std::move(result.first);
+    for (auto cit = CD.begin(); cit != CD.end();) {
+        if (cit->second.empty())
+            cit = CD.erase(cit);
+        else
+            ++cit;
+    }
+}
+
+static int runIrreducibleBench() {
+    using ResultT = std::tuple<std::string, size_t, CDGraphResultT>;
+    std::vector<ResultT> analyses;
+    if (ntscd)
+        analyses.emplace_back("ntscd", 0, CDGraphResultT{});
+    if (ntscd2)
+        analyses.emplace_back("ntscd2", 0, CDGraphResultT{});
+    if (ntscd3)
+        analyses.emplace_back("ntscd3", 0, CDGraphResultT{});
+    if (ntscd_ranganath)
+        analyses.emplace_back("ntscd-ranganath", 0, CDGraphResultT{});
+    if (dod)
+        analyses.emplace_back("dod", 0, CDGraphResultT{});
+    if (dod_ranganath)
+        analyses.emplace_back("dod-ranganath", 0, CDGraphResultT{});
+    if (dod_ntscd)
+        analyses.emplace_back("dod+ntscd", 0, CDGraphResultT{});
+
+    if (analyses.empty()) {
+        std::cerr << "No analysis to run specified\n";
+        return 1;
+    }
+
+    size_t differences = 0;
+    for (unsigned i = 0; i < irreducible_graphs; ++i) {
+        CDGraph G("irreducible" + std::to_string(i));
+        generateIrreducibleGraph(G, irreducible_nodes, i);
+
+        for (auto &it : analyses) {
+            const auto &name = std::get<0>(it);
+            if (name == "ntscd")
+                runOnGraph<dg::NTSCD>(G, it);
+            else if (name == "ntscd2")
+                runOnGraph<dg::NTSCD2>(G, it);
+            else if (name == "ntscd3")
+                runOnGraph<dg::NTSCD3>(G, it);
+            else if (name == "ntscd-ranganath")
+                runOnGraph<dg::NTSCDRanganath>(G, it);
+            else if (name == "dod")
+                runOnGraph<dg::DOD>(G, it);
+            else if (name == "dod-ranganath")
+                runOnGraph<dg::DODRanganath>(G, it);
+            else if (name == "dod+ntscd")
+                runOnGraph<dg::DODNTSCD>(G, it);
+        }
+
+        if (!compare)
+            continue;
+
+        // DOD and the (fixed) Ranganath's algorithm must agree,
+        // this is the regression check of the fast DOD algorithm
+        const CDGraphResultT *dodres = nullptr, *ranganathres = nullptr;
+        for (auto &it : analyses) {
+            if (std::get<0>(it) == "dod")
+                dodres = &std::get<2>(it);
+            else if (std::get<0>(it) == "dod-ranganath")
+                ranganathres = &std::get<2>(it);
+        }
+        if (dodres && ranganathres && *dodres != *ranganathres) {
+            std::cout << "Graph " << i << ": dod and dod-ranganath differ\n";
+            ++differences;
+        }
+    }
+
+    std::cout << "Total elapsed time (" << irreducible_graphs
+              << " graphs with " << irreducible_nodes << " nodes):\n";
+    for (auto &it : analyses) {
+        std::cout << "  " << std::get<0>(it) << ": "
+                  << static_cast<float>(std::get<1>(it)) / CLOCKS_PER_SEC
+                  << " s (" << std::get<1>(it) << " ticks)" << std::endl;
+    }
+
+    return differences > 0 ? 1 : 0;
+}
+
 static inline std::unique_ptr<LLVMControlDependenceAnalysis>
 createAnalysis(llvm::Module *M,
                const LLVMControlDependenceAnalysisOptions &opts) {
@@ -259,12 +381,23 @@ createAnalysis(llvm::Module *M,
 
 int main(int argc, char *argv[]) {
     setupStackTraceOnError(argc, argv);
-    SlicerOptions options = parseSlicerOptions(argc, argv);
+    SlicerOptions options = parseSlicerOptions(argc, argv,
+                                               /* requireCrit = */ false,
+                                               /* inputFileRequired = */ false);
 
     if (enable_debug) {
         DBG_ENABLE();
     }
 
+    if (irreducible_bench) {
+        return runIrreducibleBench();
+    }
+
+    if (options.inputFile.empty()) {
+        llvm::errs() << "No input file specified\n";
+        return 1;
+    }
+
     if (total_only) {
         quiet = true;
     }
@@ -308,6 +441,11 @@ int main(int argc, char *argv[]) {
                 dg::ControlDependenceAnalysisOptions::CDAlgorithm::NTSCD2;
         analyses.emplace_back("ntscd2", createAnalysis(M.get(), opts), 0);
     }
+    if (ntscd3) {
+        opts.algorithm =
+                dg::ControlDependenceAnalysisOptions::CDAlgorithm::NTSCD3;
+        analyses.emplace_back("ntscd3", createAnalysis(M.get(), opts), 0);
+    }
     if (ntscd_ranganath) {
         opts.algorithm = dg::ControlDependenceAnalysisOptions::CDAlgorithm::
                 NTSCD_RANGANATH;
@@ -351,31 +489,48 @@ int main(int argc, char *argv[]) {
                      "dumping just info about funs\n";
     }
 
-    for (auto &F : *M) {
-        if (F.isDeclaration()) {
-            continue;
+    if (opts.jobs() != 1) {
+        // the functions are computed in parallel, so we can measure only
+        // the wall time of the computation for the whole module
+        // (converted to clock ticks, so that the totals below make sense)
+        dg::debug::TimeMeasure tm;
+        for (auto &it : analyses) {
+            tm.start();
+            std::get<1>(it)->compute();
+            tm.stop();
+            std::get<2>(it) = std::chrono::duration_cast<
+                                      std::chrono::duration<double>>(
+                                      tm.duration())
+                                      .count() *
+                              CLOCKS_PER_SEC;
         }
+    } else {
+        for (auto &F : *M) {
+            if (F.isDeclaration()) {
+                continue;
+            }
 
-        if (!quiet) {
-            dumpFunStats(F);
-            std::cout << "Elapsed time: \n";
-        }
+            if (!quiet) {
+                dumpFunStats(F);
+                std::cout << "Elapsed time: \n";
+            }
 
-        for (auto &it : analyses) {
-            start = clock();
-            std::get<1>(it)->compute(&F); // compute all the information
-            end = clock();
-            elapsed = end - start;
-            std::get<2>(it) += elapsed;
+            for (auto &it : analyses) {
+                start = clock();
+                std::get<1>(it)->compute(&F); // compute all the information
+                end = clock();
+                elapsed = end - start;
+                std::get<2>(it) += elapsed;
+                if (!quiet) {
+                    std::cout << "  " << std::get<0>(it) << ": "
+                              << static_cast<float>(elapsed) / CLOCKS_PER_SEC
+                              << " s (" << elapsed << " ticks)\n";
+                }
+            }
             if (!quiet) {
-                std::cout << "  " << std::get<0>(it) << ": "
-                          << static_cast<float>(elapsed) / CLOCKS_PER_SEC
-                          << " s (" << elapsed << " ticks)\n";
+                std::cout << "-----" << std::endl;
             }
         }
-        if (!quiet) {
-            std::cout << "-----" << std::endl;
-        }
     }
 
     if (!quiet || total_only) {
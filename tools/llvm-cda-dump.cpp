@@ -316,6 +316,7 @@ static void dumpIr(LLVMControlDependenceAnalysis &cda) {
         dump_graph(graph);
 
         if (cda.getOptions().ntscdCD() || cda.getOptions().ntscd2CD() ||
+            cda.getOptions().ntscd3CD() ||
             cda.getOptions().ntscdRanganathCD()) {
             auto *ntscd = static_cast<dg::llvmdg::NTSCD *>(impl);
             const auto *info = ntscd->_getFunInfo(&f);
@@ -10,6 +10,7 @@
 #include "dg/util/debug.h"
 
 #include "ControlDependence/CDGraph.h"
+#include "ControlDependence/CDGraphGenerators.h"
 #include "ControlDependence/DOD.h"
 #include "ControlDependence/DODNTSCD.h"
 #include "ControlDependence/NTSCD.h"
@@ -52,6 +53,10 @@ llvm::cl::opt<bool> ntscd2("ntscd2",
                            llvm::cl::desc("Benchmark NTSCD 2 (default=false)."),
                            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<bool> ntscd3("ntscd3",
+                           llvm::cl::desc("Benchmark NTSCD 3 (default=false)."),
+                           llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
 llvm::cl::opt<bool> ntscd_ranganath(
         "ntscd-ranganath",
         llvm::cl::desc(
@@ -95,35 +100,6 @@ llvm::cl::opt<unsigned>
         En("edges", llvm::cl::desc("The number of edges (default=1.5*nodes)."),
            llvm::cl::init(0), llvm::cl::cat(SlicingOpts));
 
-void generateRandomGraph(CDGraph &G, unsigned Vnum = 100, unsigned Enum = 0) {
-    if (Enum == 0 || Enum > 2 * Vnum)
-        Enum = Vnum;
-
-    std::vector<CDNode *> nodes;
-    nodes.push_back(nullptr);
-    nodes.reserve(Vnum + 1);
-    for (unsigned i = 0; i < Vnum; ++i) {
-        auto &nd = G.createNode();
-        nodes.push_back(&nd);
-        assert(nodes.size() - 1 == nd.getID());
-    }
-    // create random edges
-    std::random_device dev;
-    std::mt19937 rng(dev());
-    std::uniform_int_distribution<std::mt19937::result_type> ids(1, Vnum);
-
-    unsigned n = 0;
-    while (Enum > 0 && ++n < 10 * Enum) {
-        auto id1 = ids(rng);
-        if (nodes[id1]->successors().size() > 1)
-            continue;
-        auto id2 = ids(rng);
-        G.addNodeSuccessor(*nodes[id1], *nodes[id2]);
-        // std::cout << id1 << " -> " << id2 << "\n";
-        --Enum;
-    }
-}
-
 int main(int argc, char *argv[]) {
     setupStackTraceOnError(argc, argv);
     SlicerOptions options = parseSlicerOptions(argc, argv,
@@ -136,7 +112,7 @@ int main(int argc, char *argv[]) {
     CDGraph G;
     if (En == 0)
         En = (unsigned) 1.5 * Vn;
-    generateRandomGraph(G, Vn, En);
+    generateRandomGraph(G, Vn, En, std::random_device()());
 
     clock_t start, end, elapsed;
 
@@ -160,6 +136,16 @@ int main(int argc, char *argv[]) {
         std::cout << "ntscd: " << static_cast<float>(elapsed) / CLOCKS_PER_SEC
                   << " s (" << elapsed << " ticks)\n";
     }
+    if (ntscd3) {
+        dg::NTSCD3 ntscd;
+        start = clock();
+        ntscd.compute(G);
+        end = clock();
+        elapsed = end - start;
+
+        std::cout << "ntscd3: " << static_cast<float>(elapsed) / CLOCKS_PER_SEC
+                  << " s (" << elapsed << " ticks)\n";
+    }
     if (ntscd_ranganath) {
         dg::NTSCDRanganath ntscd;
         start = clock();
@@ -45,6 +45,11 @@ llvm::cl::opt<bool> lazy("lazy-cg",
                          llvm::cl::desc("Use the LazyLLVMCallGraph."),
                          llvm::cl::init(true), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<bool> frozen("frozen-cg",
+                           llvm::cl::desc("Use the frozen call graph "
+                                          "(CallGraphCSR)."),
+                           llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
 static void dumpCallGraph(llvmdg::CallGraph &CG) {
     std::cout << "digraph CallGraph {\n";
 
@@ -85,7 +90,8 @@ int main(int argc, char *argv[]) {
             SVFPointerAnalysis PTA(M.get(), ptaopts);
             PTA.run();
 
-            llvmdg::CallGraph CG(M.get(), &PTA, lazy);
+            auto CG = frozen ? llvmdg::CallGraph::frozen(M.get(), &PTA)
+                             : llvmdg::CallGraph(M.get(), &PTA, lazy);
             dumpCallGraph(CG);
         } else
 #endif // HAVE_SVF
@@ -93,7 +99,10 @@ int main(int argc, char *argv[]) {
             DGLLVMPointerAnalysis PTA(M.get(), ptaopts);
             PTA.run();
 
-            if (lazy) {
+            if (frozen) {
+                auto CG = llvmdg::CallGraph::frozen(M.get(), &PTA);
+                dumpCallGraph(CG);
+            } else if (lazy) {
                 llvmdg::CallGraph CG(M.get(), &PTA, lazy);
                 CG.build();
                 dumpCallGraph(CG);
@@ -103,6 +112,9 @@ int main(int argc, char *argv[]) {
                 dumpCallGraph(CG);
             }
         }
+    } else if (frozen) {
+        auto CG = llvmdg::CallGraph::frozen(M.get());
+        dumpCallGraph(CG);
     } else {
         if (!lazy) {
             llvm::errs() << "Can build CG without PTA only with -lazy option\n";
@@ -29,6 +29,7 @@
 #include "dg/tools/llvm-slicer-opts.h"
 #include "dg/tools/llvm-slicer-utils.h"
 
+#include "dg/util/Profiler.h"
 #include "dg/util/TimeMeasure.h"
 #include "dg/util/debug.h"
 
@@ -684,12 +685,20 @@ int main(int argc, char *argv[]) {
 
     DGLLVMPointerAnalysis PTA(M.get(), options.dgOptions.PTAOptions);
 
-    tm.start();
-    PTA.run();
-
-    tm.stop();
-    tm.report("INFO: Pointer analysis took");
+    {
+        debug::Profiler::Scope phase("pointer analysis");
+        tm.start();
+        PTA.run();
+
+        tm.stop();
+        tm.report("INFO: Pointer analysis took");
+        debug::Profiler::count("iterations",
+                               PTA.getPTA()->getNumOfIterations());
+        debug::Profiler::count("processed nodes",
+                               PTA.getPTA()->getNumOfProcessedNodes());
+    }
 
+    debug::Profiler::get().startPhase("data dependence analysis");
     tm.start();
     LLVMDataDependenceAnalysis DDA(M.get(), &PTA, options.dgOptions.DDAOptions);
     if (graph_only) {
@@ -699,6 +708,8 @@ int main(int argc, char *argv[]) {
     }
     tm.stop();
     tm.report("INFO: Data dependence analysis took");
+    debug::Profiler::count("phis", DDA.getNumOfPhis());
+    debug::Profiler::get().endPhase();
 
     if (dump_c_lines) {
 #if (LLVM_VERSION_MAJOR == 3 && LLVM_VERSION_MINOR < 7)
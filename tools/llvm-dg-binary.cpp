@@ -0,0 +1,148 @@
+// Store the dependence graph in the binary format or slice
+// a stored graph without running the analyses again:
+//
+//   llvm-dg-binary -save code.dg [slicer options] code.bc
+//   llvm-dg-binary -load code.dg -sc 'crit()' code.bc
+//
+// The second command prints the instructions of the slice.
+
+#include <string>
+#include <vector>
+
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "dg/llvm/LLVMDGBinary.h"
+#include "dg/llvm/LLVMDependenceGraph.h"
+#include "dg/llvm/LLVMDependenceGraphBuilder.h"
+
+#include "dg/tools/llvm-slicer-opts.h"
+#include "dg/tools/llvm-slicer-utils.h"
+
+#include "dg/util/TimeMeasure.h"
+
+using namespace dg;
+using dg::llvmdg::MappedLLVMDependenceGraph;
+using llvm::errs;
+
+llvm::cl::opt<std::string> saveFile("save",
+                                    llvm::cl::desc("Build the dependence graph "
+                                                   "and save it to FILE."),
+                                    llvm::cl::value_desc("FILE"),
+                                    llvm::cl::init(""),
+                                    llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<std::string> loadFile("load",
+                                    llvm::cl::desc("Load the dependence graph "
+                                                   "from FILE and print the "
+                                                   "slice."),
+                                    llvm::cl::value_desc("FILE"),
+                                    llvm::cl::init(""),
+                                    llvm::cl::cat(SlicingOpts));
+
+static int save(llvm::Module *M, const SlicerOptions &options) {
+    debug::TimeMeasure tm;
+    tm.start();
+    llvmdg::LLVMDependenceGraphBuilder builder(M, options.dgOptions);
+    auto dg = builder.build();
+    if (!dg) {
+        errs() << "Building the dependence graph failed\n";
+        return 1;
+    }
+    tm.stop();
+    tm.report("[llvm-dg-binary] Building the dependence graph took");
+
+    tm.start();
+    std::string error;
+    if (!llvmdg::writeLLVMDependenceGraph(*dg, *M, saveFile, error)) {
+        errs() << error << "\n";
+        return 1;
+    }
+    tm.stop();
+    tm.report("[llvm-dg-binary] Saving the dependence graph took");
+    return 0;
+}
+
+static int load(llvm::Module *M, const SlicerOptions &options) {
+    debug::TimeMeasure tm;
+    tm.start();
+    std::string error;
+    auto G = MappedLLVMDependenceGraph::open(loadFile, error);
+    if (!G) {
+        errs() << error << "\n";
+        return 1;
+    }
+    if (!G->attach(*M)) {
+        errs() << "The dependence graph in " << loadFile
+               << " was not built for " << options.inputFile << "\n";
+        return 1;
+    }
+    tm.stop();
+    tm.report("[llvm-dg-binary] Loading the dependence graph took");
+
+    auto criteria = getSlicingCriteriaValues(
+            *M, options.slicingCriteria, options.legacySlicingCriteria,
+            options.legacySecondarySlicingCriteria,
+            options.criteriaAreNextInstr);
+    std::vector<MappedLLVMDependenceGraph::NodeID> start;
+    for (const auto *val : criteria) {
+        auto id = G->getNodeID(val);
+        if (id != llvmdg::ModuleValueNumbering::NONE)
+            start.push_back(id);
+    }
+    if (start.empty()) {
+        errs() << "Did not find slicing criteria in the graph\n";
+        return 1;
+    }
+
+    tm.start();
+    auto inSlice = G->backwardSlice(start);
+    tm.stop();
+    tm.report("[llvm-dg-binary] Slicing took");
+
+    size_t nodes = 0;
+    for (bool b : inSlice)
+        nodes += b;
+    errs() << "[llvm-dg-binary] " << nodes << " from " << G->size()
+           << " nodes are in the slice\n";
+
+    for (const auto &F : *M) {
+        bool printedName = false;
+        for (const auto &B : F) {
+            for (const auto &I : B) {
+                auto id = G->getNodeID(&I);
+                if (id == llvmdg::ModuleValueNumbering::NONE || !inSlice[id])
+                    continue;
+                if (!printedName) {
+                    llvm::outs() << F.getName() << ":\n";
+                    printedName = true;
+                }
+                llvm::outs() << I << "\n";
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    setupStackTraceOnError(argc, argv);
+    SlicerOptions options = parseSlicerOptions(argc, argv);
+
+    if (saveFile.empty() == loadFile.empty()) {
+        errs() << "Exactly one of -save and -load must be given\n";
+        return 1;
+    }
+
+    llvm::LLVMContext context;
+    std::unique_ptr<llvm::Module> M =
+            parseModule("llvm-dg-binary", context, options);
+    if (!M)
+        return 1;
+
+    if (!saveFile.empty())
+        return save(M.get(), options);
+    return load(M.get(), options);
+}
@@ -24,6 +24,7 @@
 #include "dg/PointerAnalysis/PointerAnalysisFSInv.h"
 #include "dg/llvm/DataDependence/DataDependence.h"
 #include "dg/llvm/LLVMDG2Dot.h"
+#include "dg/llvm/LLVMDGDotWriter.h"
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/llvm/LLVMDependenceGraphBuilder.h"
 #include "dg/llvm/LLVMSlicer.h"
@@ -55,10 +56,31 @@ llvm::cl::opt<bool> mark_only(
         llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
 llvm::cl::opt<std::string>
-        dump_func_only("func", llvm::cl::desc("Only dump a given function."),
+        dump_func_only("func", llvm::cl::desc("Only dump a given function "
+                                              "(a comma-separated list of "
+                                              "functions with -stream)."),
                        llvm::cl::value_desc("string"), llvm::cl::init(""),
                        llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<bool> stream(
+        "stream",
+        llvm::cl::desc("Write the graph function by function, with bounded "
+                       "memory (default=false)."),
+        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<bool> only_slice(
+        "only-slice",
+        llvm::cl::desc("With -stream, dump only the nodes that are in the "
+                       "slice (default=false)."),
+        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<unsigned> jobs(
+        "jobs",
+        llvm::cl::desc("With -stream, generate the functions in N threads "
+                       "(default=1)."),
+        llvm::cl::value_desc("N"), llvm::cl::init(1),
+        llvm::cl::cat(SlicingOpts));
+
 // TODO: This machinery can be replaced with llvm::cl::callback setting
 // the desired flags directly when we drop support for LLVM 9 and older.
 enum PrintingOpts {
@@ -185,6 +207,22 @@ int main(int argc, char *argv[]) {
 #endif
         }
     }
+    if (stream) {
+        LLVMDGDotWriter::Options writerOpts;
+        writerOpts.edges = opts;
+        writerOpts.onlySlice = only_slice;
+        writerOpts.threads = jobs;
+        if (!dump_func_only.empty()) {
+            for (auto &fun : splitList(dump_func_only))
+                writerOpts.functions.insert(fun);
+        }
+
+        LLVMDGDotWriter writer(dg.get(), writerOpts);
+        writer.setSlicingCriteria(callsites);
+        writer.write(llvm::outs());
+        return 0;
+    }
+
     const char *only_func = nullptr;
     if (!dump_func_only.empty())
         only_func = dump_func_only.c_str();
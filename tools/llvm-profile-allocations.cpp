@@ -0,0 +1,155 @@
+// Count the allocations for the profiler (-profile-json).
+// The tools that are linked with this file report the number
+// of allocations done in every profiled phase. All the replaceable
+// forms of operator new (single object and array, nothrow and, if
+// the compiler supports them, aligned) are counted and all the forms
+// of operator delete are replaced to match them.
+
+#include <cstdlib>
+#include <new>
+
+#include "dg/util/Profiler.h"
+
+using dg::debug::Profiler;
+
+static struct CountAllocations {
+    CountAllocations() { Profiler::countsAllocations() = true; }
+} countAllocations;
+
+static void countAllocation() {
+    // do not pay for the atomic increment if we are not profiling
+    if (Profiler::get().isEnabled())
+        Profiler::allocations().fetch_add(1, std::memory_order_relaxed);
+}
+
+// allocate 'size' bytes, returns nullptr only if 'nothrow' is set
+static void *allocate(std::size_t size, bool nothrow) {
+    countAllocation();
+
+    if (size == 0)
+        size = 1;
+
+    while (true) {
+        if (void *mem = std::malloc(size))
+            return mem;
+
+        // the tools are built without exceptions,
+        // so we cannot throw std::bad_alloc
+        auto *handler = std::get_new_handler();
+        if (!handler) {
+            if (nothrow)
+                return nullptr;
+            std::abort();
+        }
+        handler();
+    }
+}
+
+void *operator new(std::size_t size) { return allocate(size, false); }
+
+void *operator new[](std::size_t size) { return allocate(size, false); }
+
+void *operator new(std::size_t size,
+                   const std::nothrow_t & /*unused*/) noexcept {
+    return allocate(size, true);
+}
+
+void *operator new[](std::size_t size,
+                     const std::nothrow_t & /*unused*/) noexcept {
+    return allocate(size, true);
+}
+
+void operator delete(void *mem) noexcept { std::free(mem); }
+
+void operator delete[](void *mem) noexcept { std::free(mem); }
+
+void operator delete(void *mem, std::size_t /*unused*/) noexcept {
+    std::free(mem);
+}
+
+void operator delete[](void *mem, std::size_t /*unused*/) noexcept {
+    std::free(mem);
+}
+
+void operator delete(void *mem, const std::nothrow_t & /*unused*/) noexcept {
+    std::free(mem);
+}
+
+void operator delete[](void *mem, const std::nothrow_t & /*unused*/) noexcept {
+    std::free(mem);
+}
+
+#ifdef __cpp_aligned_new
+// the aligned forms exist only since C++17
+static void *allocateAligned(std::size_t size, std::align_val_t align,
+                             bool nothrow) {
+    countAllocation();
+
+    if (size == 0)
+        size = 1;
+
+    auto alignment = static_cast<std::size_t>(align);
+    if (alignment < sizeof(void *))
+        alignment = sizeof(void *);
+
+    while (true) {
+        void *mem = nullptr;
+        if (posix_memalign(&mem, alignment, size) == 0)
+            return mem;
+
+        auto *handler = std::get_new_handler();
+        if (!handler) {
+            if (nothrow)
+                return nullptr;
+            std::abort();
+        }
+        handler();
+    }
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+    return allocateAligned(size, align, false);
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) {
+    return allocateAligned(size, align, false);
+}
+
+void *operator new(std::size_t size, std::align_val_t align,
+                   const std::nothrow_t & /*unused*/) noexcept {
+    return allocateAligned(size, align, true);
+}
+
+void *operator new[](std::size_t size, std::align_val_t align,
+                     const std::nothrow_t & /*unused*/) noexcept {
+    return allocateAligned(size, align, true);
+}
+
+void operator delete(void *mem, std::align_val_t /*unused*/) noexcept {
+    std::free(mem);
+}
+
+void operator delete[](void *mem, std::align_val_t /*unused*/) noexcept {
+    std::free(mem);
+}
+
+void operator delete(void *mem, std::size_t /*unused*/,
+                     std::align_val_t /*unused*/) noexcept {
+    std::free(mem);
+}
+
+void operator delete[](void *mem, std::size_t /*unused*/,
+                       std::align_val_t /*unused*/) noexcept {
+    std::free(mem);
+}
+
+void operator delete(void *mem, std::align_val_t /*unused*/,
+                     const std::nothrow_t & /*unused*/) noexcept {
+    std::free(mem);
+}
+
+void operator delete[](void *mem, std::align_val_t /*unused*/,
+                       const std::nothrow_t & /*unused*/) noexcept {
+    std::free(mem);
+}
+#endif // __cpp_aligned_new
@@ -27,6 +27,7 @@
 #include "dg/tools/llvm-slicer-opts.h"
 #include "dg/tools/llvm-slicer-utils.h"
 
+#include "dg/util/Profiler.h"
 #include "dg/util/TimeMeasure.h"
 
 using namespace dg;
@@ -116,6 +117,14 @@ llvm::cl::opt<bool> dump_c_lines(
                        "Requires metadata in the bitcode (default=false)."),
         llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<std::string> ptset_trace(
+        "ptset-trace",
+        llvm::cl::desc("Write the points-to sets and the unions of the sets "
+                       "to the given file\n"
+                       "(the input for ptset-benchmark)."),
+        llvm::cl::value_desc("FILE"), llvm::cl::init(""),
+        llvm::cl::cat(SlicingOpts));
+
 using VariablesMapTy = std::map<const llvm::Value *, CVariableDecl>;
 VariablesMapTy allocasToVars(const llvm::Module &M);
 VariablesMapTy valuesToVars;
@@ -371,7 +380,12 @@ static void dumpPointerGraphData(PSNode *n, PTType type, bool dot = false) {
     }
 }
 
-static void dumpPSNode(PSNode *n, PTType type) {
+// 'ptsNode' is the node that holds the points-to set of 'n'
+// (a different node if 'n' was merged into it)
+static void dumpPSNode(PSNode *n, PTType type, PSNode *ptsNode = nullptr) {
+    if (!ptsNode)
+        ptsNode = n;
+
     printf("NODE %3u: ", n->getID());
     printName(n);
 
@@ -381,9 +395,9 @@ static void dumpPSNode(PSNode *n, PTType type) {
         printf(" [size: %zu, heap: %u, zeroed: %u]", alloc->getSize(),
                alloc->isHeap(), alloc->isZeroInitialized());
 
-    printf(" (points-to size: %zu)\n", n->pointsTo.size());
+    printf(" (points-to size: %zu)\n", ptsNode->pointsTo.size());
 
-    for (const Pointer &ptr : n->pointsTo) {
+    for (const Pointer &ptr : ptsNode->pointsTo) {
         printf("    -> ");
         printName(ptr.target, false);
         if (ptr.offset.isUnknown())
@@ -599,14 +613,71 @@ static void dumpPointerGraph(DGLLVMPointerAnalysis *pta, PTType type) {
         const auto &nodes = pta->getNodes();
         for (const auto &node : nodes) {
             if (node) // node id 0 is nullptr
-                dumpPSNode(node.get(), type);
+                dumpPSNode(node.get(), type,
+                           pta->getMergedInto(node.get()));
         }
     }
 }
 
+///
+// Write the points-to sets of all nodes and the unions of the sets
+// that the analysis does for copying nodes, one per line:
+//   S <node> <number of pointers> <target>:<offset> ...
+//   U <node> <operand>
+// The targets are numbered from 0 and the unknown offset is '?'.
+static bool dumpPointsToSetsTrace(DGLLVMPointerAnalysis *pta,
+                                  const std::string &path) {
+    std::ofstream out(path);
+    if (!out.is_open())
+        return false;
+
+    std::map<const PSNode *, unsigned> targets;
+    out << "# points-to sets of " << pta->getNodes().size() - 1 << " nodes\n";
+    for (const auto &node : pta->getNodes()) {
+        if (!node || node->pointsTo.empty())
+            continue;
+
+        out << "S " << node->getID() << " " << node->pointsTo.size();
+        for (const auto &ptr : node->pointsTo) {
+            auto it = targets.emplace(ptr.target, targets.size()).first;
+            out << " " << it->second << ":";
+            if (ptr.offset.isUnknown())
+                out << "?";
+            else
+                out << *ptr.offset;
+        }
+        out << "\n";
+    }
+
+    for (const auto &node : pta->getNodes()) {
+        if (!node)
+            continue;
+        switch (node->getType()) {
+        case PSNodeType::PHI:
+        case PSNodeType::CAST:
+        case PSNodeType::CALL_RETURN:
+            break;
+        default:
+            continue;
+        }
+
+        for (auto *op : node->getOperands()) {
+            if (!op->pointsTo.empty())
+                out << "U " << node->getID() << " " << op->getID() << "\n";
+        }
+    }
+
+    return true;
+}
+
 static void dumpStats(DGLLVMPointerAnalysis *pta) {
     const auto &nodes = pta->getNodes();
     printf("Pointer subgraph size: %zu\n", nodes.size() - 1);
+    if (pta->getNumOfMergedNodes() > 0)
+        printf("Merged %zu nodes in %u classes\n", pta->getNumOfMergedNodes(),
+               pta->getNumOfMergedClasses());
+    if (auto collapsed = pta->getPTA()->getNumOfCollapsedObjects())
+        printf("Objects over the field-sensitivity budget: %zu\n", collapsed);
 
     size_t nonempty_size = 0; // number of nodes with non-empty pt-set
     size_t maximum = 0;       // maximum pt-set size
@@ -766,6 +837,12 @@ static void dumpStats(DGLLVMPointerAnalysis *pta) {
     printf("Maximum pt-set size: %zu\n", maximum);
 }
 
+static void countIterations(const dg::pta::PointerAnalysis *PA) {
+    dg::debug::Profiler::count("iterations", PA->getNumOfIterations());
+    dg::debug::Profiler::count("processed nodes",
+                               PA->getNumOfProcessedNodes());
+}
+
 int main(int argc, char *argv[]) {
     setupStackTraceOnError(argc, argv);
     SlicerOptions options = parseSlicerOptions(argc, argv);
@@ -820,10 +897,29 @@ int main(int argc, char *argv[]) {
 #endif
             llvmpta.reset(new DGLLVMPointerAnalysis(M.get(), opts));
 
-        tm.start();
-        llvmpta->run();
-        tm.stop();
-        tm.report("INFO: Pointer analysis took");
+        {
+            dg::debug::Profiler::Scope phase("pointer analysis");
+            tm.start();
+            llvmpta->run();
+            tm.stop();
+            tm.report("INFO: Pointer analysis took");
+            if (!opts.isSVF())
+                countIterations(static_cast<DGLLVMPointerAnalysis *>(
+                                        llvmpta.get())
+                                        ->getPTA());
+        }
+
+        if (!ptset_trace.empty()) {
+            if (opts.isSVF()) {
+                llvm::errs() << "SVF analysis does not support -ptset-trace\n";
+            } else if (!dumpPointsToSetsTrace(
+                               static_cast<DGLLVMPointerAnalysis *>(
+                                       llvmpta.get()),
+                               ptset_trace)) {
+                llvm::errs() << "Failed writing " << ptset_trace << "\n";
+                return 1;
+            }
+        }
 
         if (_stats) {
             if (opts.isSVF()) {
@@ -901,12 +997,15 @@ int main(int argc, char *argv[]) {
     // Dumping the IR of pointer analysis
     //
     DGLLVMPointerAnalysis PTA(M.get(), opts);
+    auto &profiler = dg::debug::Profiler::get();
+    profiler.startPhase("pointer analysis");
 
     tm.start();
 
     PTA.initialize();
 
     if (dump_graph_only) {
+        profiler.endPhase();
         tm.stop();
         tm.report("INFO: Pointer analysis (building graph) took");
         dumpPointerGraph(&PTA, opts.analysisType);
@@ -934,6 +1033,8 @@ int main(int argc, char *argv[]) {
 
     tm.stop();
     tm.report("INFO: Pointer analysis took");
+    countIterations(PA);
+    profiler.endPhase();
 
     if (_stats) {
         dumpStats(&PTA);
@@ -1,6 +1,10 @@
+#include <algorithm>
 #include <cassert>
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <llvm/IR/CFG.h>
@@ -18,11 +22,13 @@
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/llvm/LLVMNode.h"
 #include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
+#include "dg/tools/llvm-slicer-opts.h"
 #include "dg/tools/llvm-slicer-utils.h"
 
 using namespace dg;
 
 using llvm::errs;
+using ConstructedFunctionsT = LLVMDependenceGraph::ConstructedFunctionsT;
 
 // mapping of AllocaInst to the names of C variables
 static std::map<const llvm::Value *, std::string> valuesToVariables;
@@ -85,6 +91,27 @@ static llvm::Value *constExprVar(const llvm::ConstantExpr *CE) {
     return var;
 }
 
+// the variable accessed by the instruction if we can tell it without PTA
+static const llvm::Value *accessedVariable(const llvm::Instruction &I) {
+    using namespace llvm;
+    const Value *A = nullptr;
+    if (auto *S = dyn_cast<StoreInst>(&I)) {
+        A = S->getPointerOperand()->stripPointerCasts();
+    } else if (auto *L = dyn_cast<LoadInst>(&I)) {
+        A = L->getPointerOperand()->stripPointerCasts();
+    } else {
+        return nullptr;
+    }
+
+    if (auto *C = dyn_cast<ConstantExpr>(A)) {
+        return constExprVar(C);
+    }
+    if ((isa<AllocaInst>(A) || isa<GlobalVariable>(A))) {
+        return A;
+    }
+    return nullptr;
+}
+
 static bool usesTheVariable(const llvm::Instruction &I, const std::string &var,
                             bool isglobal = false,
                             LLVMPointerAnalysis *pta = nullptr) {
@@ -93,24 +120,7 @@ static bool usesTheVariable(const llvm::Instruction &I, const std::string &var,
 
     if (!pta) {
         // try basic cases that we can decide without PTA
-        using namespace llvm;
-        const Value *operand = nullptr;
-        if (auto *S = dyn_cast<StoreInst>(&I)) {
-            auto *A = S->getPointerOperand()->stripPointerCasts();
-            if (auto *C = dyn_cast<ConstantExpr>(A)) {
-                operand = constExprVar(C);
-            } else if ((isa<AllocaInst>(A) || isa<GlobalVariable>(A))) {
-                operand = A;
-            }
-        } else if (auto *L = dyn_cast<LoadInst>(&I)) {
-            auto *A = L->getPointerOperand()->stripPointerCasts();
-            if (auto *C = dyn_cast<ConstantExpr>(A)) {
-                operand = constExprVar(C);
-            } else if ((isa<AllocaInst>(A) || isa<GlobalVariable>(A))) {
-                operand = A;
-            }
-        }
-
+        const auto *operand = accessedVariable(I);
         if (operand && !mayBeTheVar(operand, var)) {
             return false;
         }
@@ -249,11 +259,50 @@ static bool fileMatch(const std::string &file, const llvm::GlobalVariable &G) {
 #endif
 }
 
+///
+// The object part of a slicing criterion: a function ("foo()"),
+// a variable ("&x", or "&@x" for a global variable) or either of them ("x")
+struct CriterionObj {
+    std::string name;
+    bool isvar{false};
+    bool isglobal{false};
+    bool isfunc{false};
+
+    CriterionObj(const std::string &obj) {
+        if (obj.empty())
+            return;
+
+        // TODO: allow speficy namespaces, not only global/non-global
+        isvar = obj[0] == '&';
+        name = isvar ? obj.substr(1) : obj;
+
+        isglobal = !name.empty() && name[0] == '@';
+        if (isglobal) {
+            name = name.substr(1);
+        }
+
+        auto len = name.length();
+        isfunc = len > 2 && name.compare(len - 2, 2, "()") == 0;
+        if (isfunc) {
+            name = name.substr(0, len - 2);
+        }
+
+        if (isvar && isfunc) {
+            llvm::errs() << "ERROR: ignoring invalid criterion (var and func "
+                            "at the same time: "
+                         << obj << "\n";
+        }
+    }
+
+    bool empty() const { return name.empty(); }
+    bool valid() const { return !(isvar && isfunc); }
+};
+
 static bool instMatchesCrit(const llvm::Instruction &I, const std::string &fun,
-                            unsigned line, const std::string &obj,
+                            unsigned line, const CriterionObj &obj,
                             LLVMPointerAnalysis *pta = nullptr) {
     // function match?
-    if (!fun.empty() && I.getParent()->getParent()->getName().str() != fun)
+    if (!fun.empty() && I.getParent()->getParent()->getName() != fun)
         return false;
 
     // line match?
@@ -274,42 +323,16 @@ static bool instMatchesCrit(const llvm::Instruction &I, const std::string &fun,
         return true;
     }
 
-    // TODO: allow speficy namespaces, not only global/non-global
-    bool isvar = obj[0] == '&';
-    std::string objname;
-    if (isvar) {
-        objname = obj.substr(1);
-    } else {
-        objname = obj;
-    }
-
-    bool isglobal = objname[0] == '@';
-    if (isglobal) {
-        objname = obj.substr(1);
-    }
-
-    auto len = objname.length();
-    bool isfunc = len > 2 && objname.compare(len - 2, 2, "()") == 0;
-    if (isfunc) {
-        objname = objname.substr(0, len - 2);
-    }
-
-    if (isvar && isfunc) {
-        static std::set<std::string> reported;
-        if (reported.insert(obj).second) {
-            llvm::errs() << "ERROR: ignoring invalid criterion (var and func "
-                            "at the same time: "
-                         << obj << "\n";
-        }
+    if (!obj.valid()) {
         return false;
     }
 
     // obj match?
-    if (!isvar && instIsCallOf(I, objname, pta)) {
+    if (!obj.isvar && instIsCallOf(I, obj.name, pta)) {
         return true;
     } // else fall through to check the vars
 
-    if (!isfunc && usesTheVariable(I, objname, isglobal, pta)) {
+    if (!obj.isfunc && usesTheVariable(I, obj.name, obj.isglobal, pta)) {
         return true;
     }
 
@@ -397,10 +420,158 @@ static std::string parseObj(const std::vector<std::string> &parts) {
     return parts[parts.size() - 1];
 }
 
-static void getCriteriaInstructions(llvm::Module &M, LLVMPointerAnalysis *pta,
+///
+// An index of instructions for matching the slicing criteria. It is built
+// in one pass over the searched functions and then every criterion
+// is matched only against the instructions on its line, in its function,
+// or the calls and memory accesses that may match its object,
+// instead of against all instructions.
+class CriteriaIndex {
+    using InstsT = std::vector<const llvm::Instruction *>;
+
+    LLVMPointerAnalysis *_pta;
+
+    std::unordered_map<unsigned, InstsT> _lines;
+    std::map<llvm::StringRef, InstsT> _functionInsts;
+    // direct calls by the name of the called function
+    std::map<llvm::StringRef, InstsT> _calls;
+    InstsT _indirectCalls;
+    // the memory accesses by the name of the accessed variable,
+    // filled only if we have no PTA
+    std::map<std::string, InstsT> _accesses;
+    // the memory accesses that may access any variable
+    InstsT _anyAccesses;
+
+    static const InstsT &_get(const std::map<llvm::StringRef, InstsT> &M,
+                              llvm::StringRef key) {
+        static const InstsT empty;
+        auto it = M.find(key);
+        return it == M.end() ? empty : it->second;
+    }
+
+    void _add(const llvm::Instruction &I) {
+        const auto &Loc = I.getDebugLoc();
+#if (LLVM_VERSION_MAJOR == 3 && LLVM_VERSION_MINOR < 7)
+        if (Loc.getLine() > 0)
+#else
+        if (Loc)
+#endif
+            _lines[Loc.getLine()].push_back(&I);
+
+        if (const auto *C = llvm::dyn_cast<llvm::CallInst>(&I)) {
+            if (const auto *fun = C->getCalledFunction())
+                _calls[fun->getName()].push_back(&I);
+            else
+                _indirectCalls.push_back(&I);
+        }
+
+        if (!I.mayReadOrWriteMemory())
+            return;
+
+        if (!_pta) {
+            // the same as the matching in usesTheVariable()
+            const auto *var = accessedVariable(I);
+            if (var) {
+                if (const auto *G = llvm::dyn_cast<llvm::GlobalVariable>(var)) {
+                    _accesses[G->getName().str()].push_back(&I);
+                    return;
+                }
+                auto it = valuesToVariables.find(var);
+                if (it != valuesToVariables.end()) {
+                    _accesses[it->second].push_back(&I);
+                    return;
+                }
+            }
+        }
+        _anyAccesses.push_back(&I);
+    }
+
+    void _addFunction(const llvm::Function &F) {
+        auto &insts = _functionInsts[F.getName()];
+        for (const auto &I : llvm::instructions(F)) {
+            insts.push_back(&I);
+            _add(I);
+        }
+    }
+
+  public:
+    ///
+    // Index the instructions of the given (DG's constructed) functions,
+    // or of all functions in M if 'constructed' is null.
+    CriteriaIndex(llvm::Module &M, LLVMPointerAnalysis *pta,
+                  const ConstructedFunctionsT *constructed)
+            : _pta(pta) {
+        if (constructed) {
+            for (const auto &it : *constructed)
+                _addFunction(*llvm::cast<llvm::Function>(it.first));
+        } else {
+            for (const auto &F : M)
+                _addFunction(F);
+        }
+    }
+
+    LLVMPointerAnalysis *getPTA() const { return _pta; }
+
+    ///
+    // Call fun(I) for the instructions that may match the criterion
+    // (a superset of the matching instructions)
+    template <typename FunT>
+    void forEachCandidate(const std::string &fun, unsigned line,
+                          const CriterionObj &obj, FunT F) const {
+        if (line > 0) {
+            auto it = _lines.find(line);
+            if (it != _lines.end()) {
+                for (const auto *I : it->second)
+                    F(*I);
+            }
+            return;
+        }
+
+        if (!fun.empty()) {
+            for (const auto *I : _get(_functionInsts, fun))
+                F(*I);
+            return;
+        }
+
+        if (obj.empty()) {
+            for (const auto &it : _functionInsts)
+                for (const auto *I : it.second)
+                    F(*I);
+            return;
+        }
+
+        if (!obj.valid())
+            return;
+
+        // an instruction may be a call and a memory access,
+        // do not visit it twice
+        InstsT candidates;
+        if (!obj.isvar) {
+            const auto &calls = _get(_calls, obj.name);
+            candidates.insert(candidates.end(), calls.begin(), calls.end());
+            candidates.insert(candidates.end(), _indirectCalls.begin(),
+                              _indirectCalls.end());
+        }
+        if (!obj.isfunc) {
+            auto it = _accesses.find(obj.name);
+            if (it != _accesses.end())
+                candidates.insert(candidates.end(), it->second.begin(),
+                                  it->second.end());
+            candidates.insert(candidates.end(), _anyAccesses.begin(),
+                              _anyAccesses.end());
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                         candidates.end());
+        for (const auto *I : candidates)
+            F(*I);
+    }
+};
+
+static void getCriteriaInstructions(llvm::Module &M,
+                                    const CriteriaIndex &index,
                                     const std::string &criterion,
-                                    std::set<const llvm::Value *> &result,
-                                    bool constructed_only = false) {
+                                    std::set<const llvm::Value *> &result) {
     assert(!criterion.empty() && "No criteria given");
 
     auto parts = splitList(criterion, '#');
@@ -437,35 +608,17 @@ static void getCriteriaInstructions(llvm::Module &M, LLVMPointerAnalysis *pta,
         }
     }
 
-    if (constructed_only) {
-        DBG(llvm - slicer,
-            "Checking constructed functions for slicing criteria");
-
-        for (auto &it : getConstructedFunctions()) {
-            for (auto &I :
-                 llvm::instructions(*llvm::cast<llvm::Function>(it.first))) {
-                if (!file.empty() && !fileMatch(file, I))
-                    continue;
-
-                if (instMatchesCrit(I, fun, line, obj, pta)) {
-                    result.insert(&I);
-                }
-            }
-        }
-    } else {
-        DBG(llvm - slicer, "Checking all instructions for slicing criteria");
-
-        for (auto &F : M) {
-            for (auto &I : llvm::instructions(F)) {
-                if (file != "" && !fileMatch(file, I))
-                    continue;
-
-                if (instMatchesCrit(I, fun, line, obj, pta)) {
-                    result.insert(&I);
-                }
-            }
-        }
-    }
+    DBG(llvm - slicer, "Checking indexed instructions for slicing criteria");
+    CriterionObj parsedObj(obj);
+    index.forEachCandidate(fun, line, parsedObj,
+                           [&](const llvm::Instruction &I) {
+                               if (!file.empty() && !fileMatch(file, I))
+                                   return;
+                               if (instMatchesCrit(I, fun, line, parsedObj,
+                                                   index.getPTA())) {
+                                   result.insert(&I);
+                               }
+                           });
 }
 
 struct SlicingCriteriaSet {
@@ -509,7 +662,7 @@ static void initDebugInfo(LLVMDependenceGraph &dg) {
                     "not work well\n";
 #endif
     // create the mapping from LLVM values to C variable names
-    for (const auto &it : getConstructedFunctions()) {
+    for (const auto &it : dg.getConstructedFunctions()) {
         for (auto &I :
              llvm::instructions(*llvm::cast<llvm::Function>(it.first))) {
             if (const llvm::DbgDeclareInst *DD =
@@ -539,13 +692,9 @@ static void initDebugInfo(LLVMDependenceGraph &dg) {
 #endif // LLVM > 3.6
 }
 
-///
-/// constructed_only  Search the criteria in DG's constructed functions
-///
 static std::vector<SlicingCriteriaSet> getSlicingCriteriaInstructions(
         llvm::Module &M, const std::string &slicingCriteria,
-        bool criteria_are_next_instr, LLVMPointerAnalysis *pta = nullptr,
-        bool constructed_only = false) {
+        bool criteria_are_next_instr, const CriteriaIndex &index) {
     std::vector<std::string> criteria = splitList(slicingCriteria, ';');
     assert(!criteria.empty() && "Did not get slicing criteria");
 
@@ -571,8 +720,7 @@ static std::vector<SlicingCriteriaSet> getSlicingCriteriaInstructions(
         // be added to every primary SC
         bool ssctoall = primsec[0].empty() && primsec.size() > 1;
         if (!primsec[0].empty()) {
-            getCriteriaInstructions(M, pta, primsec[0], SC.primary,
-                                    constructed_only);
+            getCriteriaInstructions(M, index, primsec[0], SC.primary);
         }
 
         if (!SC.primary.empty()) {
@@ -609,8 +757,7 @@ static std::vector<SlicingCriteriaSet> getSlicingCriteriaInstructions(
         }
 
         if ((!SC.primary.empty() || ssctoall) && primsec.size() > 1) {
-            getCriteriaInstructions(M, pta, primsec[1], SC.secondary,
-                                    constructed_only);
+            getCriteriaInstructions(M, index, primsec[1], SC.secondary);
 
             if (!SC.secondary.empty()) {
                 size_t n = 0;
@@ -629,6 +776,9 @@ static std::vector<SlicingCriteriaSet> getSlicingCriteriaInstructions(
 
             if (ssctoall) {
                 secondaryToAll.insert(SC.secondary.begin(), SC.secondary.end());
+                // the entry is attached to the primary criteria,
+                // it is not a criterion on its own
+                result.pop_back();
             }
         }
     }
@@ -644,10 +794,19 @@ static std::vector<SlicingCriteriaSet> getSlicingCriteriaInstructions(
     return result;
 }
 
+void CriteriaIndexDeleter::operator()(CriteriaIndex *index) const {
+    delete index;
+}
+
+CriteriaIndexPtr createCriteriaIndex(LLVMDependenceGraph &dg) {
+    return CriteriaIndexPtr(new CriteriaIndex(*dg.getModule(), dg.getPTA(),
+                                              &dg.getConstructedFunctions()));
+}
+
 void mapInstrsToNodes(LLVMDependenceGraph &dg,
                       const std::set<const llvm::Value *> &vals,
                       std::set<LLVMNode *> &result) {
-    const auto &funs = getConstructedFunctions();
+    const auto &funs = dg.getConstructedFunctions();
     for (const auto *val : vals) {
         if (llvm::isa<llvm::GlobalVariable>(val)) {
             auto *G = dg.getGlobalNode(const_cast<llvm::Value *>(val));
@@ -756,13 +915,18 @@ findSecondarySlicingCriteria(LLVMDependenceGraph &dg,
 bool getSlicingCriteriaNodes(LLVMDependenceGraph &dg,
                              const std::string &slicingCriteria,
                              std::set<LLVMNode *> &criteria_nodes,
-                             bool criteria_are_next_instr) {
+                             bool criteria_are_next_instr,
+                             const CriteriaIndex *index) {
     initDebugInfo(dg);
 
-    auto crits =
-            getSlicingCriteriaInstructions(*dg.getModule(), slicingCriteria,
-                                           criteria_are_next_instr, dg.getPTA(),
-                                           /* constructed only */ true);
+    CriteriaIndexPtr tmpIndex;
+    if (!index) {
+        tmpIndex = createCriteriaIndex(dg);
+        index = tmpIndex.get();
+    }
+
+    auto crits = getSlicingCriteriaInstructions(
+            *dg.getModule(), slicingCriteria, criteria_are_next_instr, *index);
     if (crits.empty()) {
         return true; // no criteria found
     }
@@ -784,6 +948,38 @@ bool getSlicingCriteriaNodes(LLVMDependenceGraph &dg,
     return true;
 }
 
+bool getSlicingCriteriaNodesList(
+        LLVMDependenceGraph &dg, const std::string &slicingCriteria,
+        std::vector<std::set<LLVMNode *>> &criteria_nodes,
+        bool criteria_are_next_instr, const CriteriaIndex *index) {
+    initDebugInfo(dg);
+
+    CriteriaIndexPtr tmpIndex;
+    if (!index) {
+        tmpIndex = createCriteriaIndex(dg);
+        index = tmpIndex.get();
+    }
+
+    auto crits = getSlicingCriteriaInstructions(
+            *dg.getModule(), slicingCriteria, criteria_are_next_instr, *index);
+    for (auto &SC : crits) {
+        criteria_nodes.emplace_back();
+        if (SC.primary.empty()) {
+            continue;
+        }
+
+        mapInstrsToNodes(dg, SC.primary, criteria_nodes.back());
+
+        if (SC.secondary.empty()) {
+            continue;
+        }
+        auto ssc = findSecondarySlicingCriteria(dg, SC.primary, SC.secondary);
+        mapInstrsToNodes(dg, ssc, criteria_nodes.back());
+    }
+
+    return true;
+}
+
 namespace legacy {
 
 static bool
@@ -880,7 +1076,7 @@ static void getLineCriteriaNodes(LLVMDependenceGraph &dg,
     }
 
     // map line criteria to nodes
-    for (const auto &it : getConstructedFunctions()) {
+    for (const auto &it : dg.getConstructedFunctions()) {
         for (auto &I :
              llvm::instructions(*llvm::cast<llvm::Function>(it.first))) {
             if (instMatchesCrit(dg, I, parsedCrit)) {
@@ -1144,7 +1340,8 @@ bool getSlicingCriteriaNodes(LLVMDependenceGraph &dg,
                              const std::string &legacySlicingCriteria,
                              const std::string &secondarySlicingCriteria,
                              std::set<LLVMNode *> &criteria_nodes,
-                             bool criteria_are_next_instr) {
+                             bool criteria_are_next_instr,
+                             const CriteriaIndex *index) {
     if (!legacySlicingCriteria.empty()) {
         if (!::legacy::getSlicingCriteriaNodes(
                     dg, legacySlicingCriteria, secondarySlicingCriteria,
@@ -1154,7 +1351,7 @@ bool getSlicingCriteriaNodes(LLVMDependenceGraph &dg,
 
     if (!slicingCriteria.empty()) {
         if (!getSlicingCriteriaNodes(dg, slicingCriteria, criteria_nodes,
-                                     criteria_are_next_instr))
+                                     criteria_are_next_instr, index))
             return false;
     }
 
@@ -1190,9 +1387,10 @@ getSlicingCriteriaValues(llvm::Module &M, const std::string &slicingCriteria,
     }
 
     std::vector<const llvm::Value *> ret;
-    auto C = getSlicingCriteriaInstructions(
-            M, criteria, criteria_are_next_instr,
-            /*pta = */ nullptr, /* constructed only */ false);
+    // the module is not sliced yet, search the criteria in all functions
+    CriteriaIndex index(M, /* pta = */ nullptr, /* constructed = */ nullptr);
+    auto C = getSlicingCriteriaInstructions(M, criteria,
+                                            criteria_are_next_instr, index);
     for (auto &critset : C) {
         ret.insert(ret.end(), critset.primary.begin(), critset.primary.end());
         ret.insert(ret.end(), critset.secondary.begin(),
@@ -1,3 +1,6 @@
+#include <cstdlib>
+#include <fstream>
+
 #include "dg/tools/llvm-slicer-opts.h"
 
 #include "dg/Offset.h"
@@ -6,6 +9,7 @@
 #include "dg/llvm/LLVMDependenceGraph.h"
 #include "dg/llvm/LLVMDependenceGraphBuilder.h"
 #include "dg/llvm/PointerAnalysis/LLVMPointerAnalysisOptions.h"
+#include "dg/util/Profiler.h"
 
 #include "dg/tools/llvm-slicer-utils.h"
 #include "dg/tools/llvm-slicer.h"
@@ -46,6 +50,19 @@ static void addAllocationFuns(dg::llvmdg::LLVMDependenceGraphOptions &dgOptions,
     }
 }
 
+// the file for the profile given by -profile-json
+static std::string profileJSONFile;
+
+static void dumpProfile() {
+    std::ofstream out(profileJSONFile);
+    if (!out.is_open()) {
+        llvm::errs() << "ERROR: Failed opening the profile file: "
+                     << profileJSONFile << "\n";
+        return;
+    }
+    dg::debug::Profiler::get().dumpJSON(out);
+}
+
 llvm::cl::OptionCategory SlicingOpts("Slicer options", "");
 
 // Use LLVM's CommandLine library to parse
@@ -151,6 +168,14 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
                     "a separate analysis.\n"),
             llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<unsigned> cdaJobs(
+            "cda-jobs",
+            llvm::cl::desc("Compute control dependencies of functions\n"
+                           "in parallel on the given number of threads\n"
+                           "(0 = the number of hardware threads). Default: 1 "
+                           "(compute on demand).\n"),
+            llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<uint64_t> ptaFieldSensitivity(
             "pta-field-sensitive",
             llvm::cl::desc("Make PTA field sensitive/insensitive. The offset "
@@ -162,6 +187,41 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
             llvm::cl::value_desc("N"), llvm::cl::init(dg::Offset::UNKNOWN),
             llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<unsigned> ptaFieldBudget(
+            "pta-field-budget",
+            llvm::cl::desc("Track at most N different offsets of pointers "
+                           "to one object.\n"
+                           "An object with more offsets is collapsed and "
+                           "the new pointers\n"
+                           "to it get Offset::UNKNOWN. Default is no budget "
+                           "(N = 0).\n"),
+            llvm::cl::value_desc("N"), llvm::cl::init(0),
+            llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaLazyBuilding(
+            "pta-lazy-build",
+            llvm::cl::desc("Build the pointer graph of a function only when "
+                           "the analysis\n"
+                           "reaches a call of the function (default=false).\n"),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaMergeEquivalent(
+            "pta-hvn",
+            llvm::cl::desc("Merge the nodes of the pointer graph that must "
+                           "have\n"
+                           "the same points-to sets before running the "
+                           "analysis.\n"
+                           "Used only with -pta=fi (default=false).\n"),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaIDBlocks(
+            "pta-id-blocks",
+            llvm::cl::desc("Reserve blocks of pointer IDs for objects, so "
+                           "that the pointers\n"
+                           "to one object are close in the points-to sets "
+                           "(default=false).\n"),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<dg::dda::UndefinedFunsBehavior> undefinedFunsBehavior(
             "undefined-funs",
             llvm::cl::desc("Set the behavior of undefined functions\n"),
@@ -288,6 +348,12 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
                                        "Non-termination sensitive control "
                                        "dependencies algorithm (a different "
                                        "implementation)"),
+                            clEnumValN(dg::ControlDependenceAnalysisOptions::
+                                               CDAlgorithm::NTSCD3,
+                                       "ntscd3",
+                                       "Non-termination sensitive control "
+                                       "dependencies algorithm (searches "
+                                       "only the relevant part of the CFG)"),
                             clEnumValN(dg::ControlDependenceAnalysisOptions::
                                                CDAlgorithm::NTSCD_RANGANATH,
                                        "ntscd-ranganath",
@@ -364,6 +430,17 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
                     "'crit'.\n"),
             llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<std::string> profileJSON(
+            "profile-json",
+            llvm::cl::desc("Measure the phases of the run (wall and CPU time, "
+                           "the growth\n"
+                           "of the peak memory, allocations and counters of "
+                           "the analyses)\n"
+                           "and save them as JSON into the given file on "
+                           "exit.\n"),
+            llvm::cl::value_desc("file"), llvm::cl::init(""),
+            llvm::cl::cat(SlicingOpts));
+
     ////////////////////////////////////
     // ===-- End of the options --=== //
     ////////////////////////////////////
@@ -386,6 +463,14 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
         }
     }
 
+    if (!profileJSON.empty()) {
+        // get the profiler before registering the dump, so that it is
+        // destroyed only after the dump
+        dg::debug::Profiler::get().enable();
+        profileJSONFile = profileJSON;
+        std::atexit(dumpProfile);
+    }
+
     /// Fill the structure
     SlicerOptions options;
 
@@ -413,6 +498,7 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
     CDAOptions.interprocedural = interprocCd;
     CDAOptions._icfg = icfgCD;
     CDAOptions.setNodePerInstruction(cdaPerInstr);
+    CDAOptions.setJobs(cdaJobs);
 
     addAllocationFuns(dgOptions, allocationFuns);
 
@@ -420,6 +506,10 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
     PTAOptions.fieldSensitivity = dg::Offset(ptaFieldSensitivity);
     PTAOptions.analysisType = ptaType;
     PTAOptions.threads = threads;
+    PTAOptions.fieldSensitivityBudget = ptaFieldBudget;
+    PTAOptions.lazyBuilding = ptaLazyBuilding;
+    PTAOptions.mergeEquivalentNodes = ptaMergeEquivalent;
+    PTAOptions.reservePointerIDBlocks = ptaIDBlocks;
 
     DDAOptions.threads = threads;
     DDAOptions.entryFunction = entryFunction;
@@ -4,8 +4,9 @@
 #include <llvm/IR/Module.h>
 #include <llvm/Support/raw_os_ostream.h>
 
-#include <set>
-#include <stack>
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
 #include <vector>
 
 #include "dg/llvm/CallGraph/CallGraph.h"
@@ -16,16 +17,148 @@ using namespace llvm;
 namespace dg {
 namespace llvmdg {
 
-template <typename C>
-inline bool hasRelevantPredecessor(llvm::BasicBlock *B, const C &relevant) {
-    for (auto *p : llvm::predecessors(B)) {
-        if (relevant.count(p) > 0)
-            return true;
+namespace {
+
+///
+// Dense numbering of the basic blocks and functions of the module
+// with per-function summaries (the return blocks and the blocks that
+// call the function) and the functions called from every block.
+// It is built in one pass over the module, so the search on the
+// interprocedural CFG visits every function body only once and works
+// with plain vectors indexed by the IDs.
+class ICFGBlocks {
+    std::vector<BasicBlock *> _blocks;
+    std::unordered_map<const BasicBlock *, unsigned> _blockIDs;
+    std::unordered_map<const Function *, unsigned> _funIDs;
+
+    // indexed by the ID of a function
+    std::vector<std::vector<unsigned>> _returns;
+    std::vector<std::vector<unsigned>> _callers;
+    // indexed by the ID of a block
+    std::vector<std::vector<unsigned>> _callees;
+
+    unsigned _getFunID(const Function *F) {
+        auto it = _funIDs.emplace(F, _returns.size());
+        if (it.second) {
+            _returns.emplace_back();
+            _callers.emplace_back();
+        }
+        return it.first->second;
+    }
+
+  public:
+    ICFGBlocks(Module &M, const CallGraphCSR &CG) {
+        for (auto &F : M) {
+            auto fid = _getFunID(&F);
+            for (auto &B : F) {
+                auto id = static_cast<unsigned>(_blocks.size());
+                _blocks.push_back(&B);
+                _blockIDs.emplace(&B, id);
+                _callees.emplace_back();
+
+                if (isa<ReturnInst>(B.getTerminator()))
+                    _returns[fid].push_back(id);
+
+                for (auto &I : B) {
+                    auto *C = dyn_cast<CallInst>(&I);
+                    if (!C)
+                        continue;
+                    for (const auto *fun : CG.getCalledFunctions(C)) {
+                        auto calleeID = _getFunID(fun);
+                        _callees[id].push_back(calleeID);
+                        _callers[calleeID].push_back(id);
+                    }
+                }
+            }
+        }
+    }
+
+    size_t size() const { return _blocks.size(); }
+    size_t functionsNum() const { return _returns.size(); }
+
+    unsigned getID(const BasicBlock *B) const {
+        auto it = _blockIDs.find(B);
+        assert(it != _blockIDs.end() && "Unknown block");
+        return it->second;
+    }
+
+    bool hasID(const BasicBlock *B) const { return _blockIDs.count(B) > 0; }
+
+    unsigned getFunctionID(const Function *F) const {
+        auto it = _funIDs.find(F);
+        assert(it != _funIDs.end() && "Unknown function");
+        return it->second;
+    }
+
+    BasicBlock *getBlock(unsigned id) const { return _blocks[id]; }
+
+    // the blocks that return from the function
+    const std::vector<unsigned> &returns(unsigned fun) const {
+        return _returns[fun];
+    }
+    // the blocks that (may) call the function
+    const std::vector<unsigned> &callers(unsigned fun) const {
+        return _callers[fun];
+    }
+    // the functions (may be) called from the block
+    const std::vector<unsigned> &callees(unsigned blk) const {
+        return _callees[blk];
     }
-    return false;
+};
+
+// get all backward reachable blocks in the ICFG from the given blocks,
+// only those blocks can be relevant in the slice
+std::vector<bool> getRelevantBlocks(const ICFGBlocks &blocks,
+                                    const std::vector<unsigned> &start) {
+    std::vector<bool> relevant(blocks.size(), false);
+    // the functions whose return blocks or callers were queued already
+    std::vector<bool> returnsQueued(blocks.functionsNum(), false);
+    std::vector<bool> callersQueued(blocks.functionsNum(), false);
+    std::vector<unsigned> queue;
+
+    auto push = [&](unsigned id) {
+        if (!relevant[id]) {
+            relevant[id] = true;
+            queue.push_back(id);
+        }
+    };
+
+    for (auto id : start)
+        push(id);
+
+    while (!queue.empty()) {
+        auto cur = queue.back();
+        queue.pop_back();
+
+        // queue the return blocks of functions called in this block
+        for (auto fun : blocks.callees(cur)) {
+            if (returnsQueued[fun])
+                continue;
+            returnsQueued[fun] = true;
+            for (auto id : blocks.returns(fun))
+                push(id);
+        }
+
+        auto *B = blocks.getBlock(cur);
+        if (pred_begin(B) == pred_end(B)) {
+            // pop-up from call
+            auto fun = blocks.getFunctionID(B->getParent());
+            if (callersQueued[fun])
+                continue;
+            callersQueued[fun] = true;
+            for (auto id : blocks.callers(fun))
+                push(id);
+        } else {
+            for (auto *pred : predecessors(B))
+                push(blocks.getID(pred));
+        }
+    }
+
+    return relevant;
 }
 
-// FIXME: refactor
+} // anonymous namespace
+
 // FIXME: configurable entry
 bool cutoffDivergingBranches(Module &M, const std::string &entry,
                              const std::vector<const llvm::Value *> &criteria) {
@@ -34,10 +167,6 @@ bool cutoffDivergingBranches(Module &M, const std::string &entry,
         return false;
     }
 
-    llvmdg::LazyLLVMCallGraph CG(&M);
-    std::set<BasicBlock *> relevant;
-    std::set<BasicBlock *> visited;
-    std::stack<BasicBlock *> queue; // not efficient...
     auto &Ctx = M.getContext();
     auto *entryFun = M.getFunction(entry);
 
@@ -46,81 +175,22 @@ bool cutoffDivergingBranches(Module &M, const std::string &entry,
         return false;
     }
 
-    // initialize the queue with blocks of slicing criteria
-    for (auto *c : criteria) {
-        auto *I = llvm::dyn_cast<Instruction>(const_cast<llvm::Value *>(c));
-        if (!I) {
-            continue;
-        }
-        auto *blk = I->getParent();
-        // add the block of slicing criteria
-        if (visited.insert(blk).second) {
-            queue.push(blk);
-        }
+    llvmdg::CallGraphCSR CG(&M);
+    ICFGBlocks blocks(M, CG);
 
-        // add the callers of calls that reach this SC in this block
-        for (auto &blkI : *blk) {
-            if (&blkI == I)
-                break;
-            auto *blkCall = llvm::dyn_cast<llvm::CallInst>(&blkI);
-            if (!blkCall)
-                continue;
-            for (auto *fun : CG.getCalledFunctions(blkCall)) {
-                for (auto &funBlk : *fun) {
-                    if (llvm::isa<llvm::ReturnInst>(funBlk.getTerminator())) {
-                        if (visited.insert(const_cast<llvm::BasicBlock *>(
-                                                   &funBlk))
-                                    .second) {
-                            queue.push(const_cast<llvm::BasicBlock *>(&funBlk));
-                        }
-                    }
-                }
-            }
-        }
+    // start from the blocks of slicing criteria (the calls in these blocks
+    // are searched from the blocks, so also the calls that precede
+    // the criteria)
+    std::vector<unsigned> start;
+    for (const auto *c : criteria) {
+        if (const auto *I = llvm::dyn_cast<Instruction>(c))
+            start.push_back(blocks.getID(I->getParent()));
     }
 
-    // get all backward reachable blocks in the ICFG, only those blocks
-    // can be relevant in the slice
-    while (!queue.empty()) {
-        auto *cur = queue.top();
-        queue.pop();
-
-        // paths from this block go to the slicing criteria
-        relevant.insert(cur);
-
-        // queue the blocks from calls in current block
-        for (auto &blkI : *cur) {
-            auto *blkCall = llvm::dyn_cast<llvm::CallInst>(&blkI);
-            if (!blkCall)
-                continue;
-            for (auto *fun : CG.getCalledFunctions(blkCall)) {
-                for (auto &funBlk : *fun) {
-                    if (llvm::isa<llvm::ReturnInst>(funBlk.getTerminator())) {
-                        if (visited.insert(const_cast<llvm::BasicBlock *>(
-                                                   &funBlk))
-                                    .second) {
-                            queue.push(const_cast<llvm::BasicBlock *>(&funBlk));
-                        }
-                    }
-                }
-            }
-        }
-
-        if ((pred_begin(cur) == pred_end(cur))) {
-            // pop-up from call
-            for (auto *C : CG.getCallsOf(cast<Function>(cur->getParent()))) {
-                if (visited.insert(const_cast<llvm::BasicBlock *>(
-                                           C->getParent()))
-                            .second)
-                    queue.push(const_cast<llvm::BasicBlock *>(C->getParent()));
-            }
-        } else {
-            for (auto *pred : predecessors(cur)) {
-                if (visited.insert(pred).second)
-                    queue.push(pred);
-            }
-        }
-    }
+    auto relevant = getRelevantBlocks(blocks, start);
+    auto isRelevant = [&](const BasicBlock *B) {
+        return blocks.hasID(B) && relevant[blocks.getID(B)];
+    };
 
     // Now kill the irrelevant blocks (those from which the execution will
     // never reach the slicing criterion
@@ -147,14 +217,14 @@ bool cutoffDivergingBranches(Module &M, const std::string &entry,
     for (auto &F : M) {
         std::vector<llvm::BasicBlock *> irrelevant;
         for (auto &B : F) {
-            if (relevant.count(&B) == 0) {
+            if (!isRelevant(&B)) {
                 irrelevant.push_back(&B);
             }
         }
         for (auto *B : irrelevant) {
             // if this irrelevant block has predecessors in relevant,
             // replace it with abort/exit
-            if (hasRelevantPredecessor(B, relevant)) {
+            if (std::any_of(pred_begin(B), pred_end(B), isRelevant)) {
                 auto *newB = BasicBlock::Create(Ctx, "diverge", &F);
                 CallInst::Create(exitF, {ConstantInt::get(argTy, 0)}, "", newB);
                 // CloneMetadata(point, new_CI);
@@ -1,6 +1,7 @@
 #include "dg/tools/llvm-slicer-utils.h"
 
 #include "dg/tools/llvm-slicer-opts.h"
+#include "dg/util/Profiler.h"
 
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
@@ -67,6 +68,7 @@ std::unique_ptr<llvm::Module> parseModule(const char *tool,
                                           llvm::LLVMContext &context,
                                           const SlicerOptions &options) {
     llvm::SMDiagnostic smd;
+    dg::debug::Profiler::Scope phase("parsing module");
 
 #if LLVM_VERSION_MAJOR == 3 && LLVM_VERSION_MINOR <= 5
     auto _m = llvm::parseIRFile(options.inputFile, smd, context);
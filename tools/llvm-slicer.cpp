@@ -1,10 +1,18 @@
 #include <cassert>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <set>
 #include <string>
 #include <vector>
 
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
 #include "dg/tools/llvm-slicer-opts.h"
 #include "dg/tools/llvm-slicer-preprocess.h"
 #include "dg/tools/llvm-slicer-utils.h"
@@ -14,9 +22,13 @@
 #include <llvm/IR/InstIterator.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/LLVMContext.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
 #include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
 #include "dg/ADT/Queue.h"
+#include "dg/util/Profiler.h"
 #include "dg/util/debug.h"
 
 using namespace dg;
@@ -63,6 +75,70 @@ llvm::cl::opt<bool> dump_bb_only(
                        " (default=false)."),
         llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<bool> batch_criteria(
+        "batch-criteria",
+        llvm::cl::desc("Slice w.r.t. every ';'-separated slicing criterion\n"
+                       "separately and save one module per criterion.\n"
+                       "The dependence graph is built only once and the\n"
+                       "slices are marked in one traversal (default=false)."),
+        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<unsigned> batch_jobs(
+        "batch-jobs",
+        llvm::cl::desc("Mark the slices of -batch-criteria in N threads\n"
+                       "(default=1)."),
+        llvm::cl::value_desc("N"), llvm::cl::init(1),
+        llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<std::string> criteria_file(
+        "criteria-file",
+        llvm::cl::desc("Read slicing criteria from FILE, one criterion\n"
+                       "(in the format of -sc) per line. Empty lines and\n"
+                       "lines starting with '#' are ignored.\n"
+                       "Implies -batch-criteria."),
+        llvm::cl::value_desc("FILE"), llvm::cl::init(""),
+        llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<bool> estimate_slices(
+        "estimate-slices",
+        llvm::cl::desc("Only mark the slices of -batch-criteria and print\n"
+                       "the number of nodes, blocks and functions in every\n"
+                       "slice, do not slice the module. Implies\n"
+                       "-batch-criteria (default=false)."),
+        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<double> group_slices(
+        "group-slices",
+        llvm::cl::desc("Group the criteria of -batch-criteria whose slices\n"
+                       "have the Jaccard similarity at least X (0 < X <= 1)\n"
+                       "and slice every group as one criterion\n"
+                       "(one module per group, numbered by the first\n"
+                       "criterion of the group). With -estimate-slices,\n"
+                       "only print the groups (default=0, no grouping)."),
+        llvm::cl::value_desc("X"), llvm::cl::init(0.0),
+        llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<bool> server(
+        "server",
+        llvm::cl::desc("Build the dependence graph once and then answer\n"
+                       "slicing requests read from stdin (default=false)."),
+        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<std::string> server_socket(
+        "server-socket",
+        llvm::cl::desc("Like -server, but read the requests from clients\n"
+                       "of the local socket FILE."),
+        llvm::cl::value_desc("FILE"), llvm::cl::init(""),
+        llvm::cl::cat(SlicingOpts));
+
+llvm::cl::opt<std::string> server_output_dir(
+        "server-output-dir",
+        llvm::cl::desc("In the server mode, save the slices only into\n"
+                       "the directory DIR (relative output files are\n"
+                       "taken relative to DIR, default=no restriction)."),
+        llvm::cl::value_desc("DIR"), llvm::cl::init(""),
+        llvm::cl::cat(SlicingOpts));
+
 llvm::cl::opt<std::string> annotationOpts(
         "annotate",
         llvm::cl::desc(
@@ -109,6 +185,433 @@ static void maybe_print_statistics(llvm::Module *M,
            << bnum << " " << inum << "\n";
 }
 
+// compose the name of the output file for the idx-th batched criterion
+static std::string batchOutputFile(const SlicerOptions &options, size_t idx) {
+    std::string fl;
+    if (!options.outputFile.empty()) {
+        fl = options.outputFile;
+        replace_suffix(fl, "." + std::to_string(idx) + ".bc");
+    } else {
+        fl = options.inputFile;
+        replace_suffix(fl, "." + std::to_string(idx) + ".sliced");
+    }
+    return fl;
+}
+
+///
+// Append the criteria from the file (one per line) to the ';'-separated
+// list of criteria 'criteria'. Returns false if the file cannot be read.
+static bool readCriteriaFile(const std::string &path, std::string &criteria) {
+    std::ifstream in(path);
+    if (!in.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        auto start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+        auto end = line.find_last_not_of(" \t\r");
+
+        if (!criteria.empty())
+            criteria += ";";
+        criteria += line.substr(start, end - start + 1);
+    }
+
+    return !in.bad();
+}
+
+///
+// Report the empty criteria in the ';'-separated list of criteria
+// for -batch-criteria. Skipping them would shift the indices
+// of the following criteria (and the names of the output files).
+// Returns false if there are any.
+static bool checkBatchedCriteria(const std::string &criteria) {
+    bool ok = true;
+    auto entries = splitList(criteria, ';');
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].find_first_not_of(" \t") == std::string::npos) {
+            llvm::errs() << "ERROR: the entry " << i
+                         << " of the slicing criteria is empty\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+///
+// Create the slice of the idx-th criterion marked by Slicer::markBatch()
+// and save it to 'output'. The slice is emitted into a new module,
+// so the analysed module and the dependence graph stay intact
+// and can be used for the other criteria.
+static bool saveBatchedSlice(llvm::Module *M, ::Slicer &slicer,
+                             const SlicerOptions &options, size_t idx,
+                             bool empty_slice, const std::string &output) {
+    std::unique_ptr<llvm::Module> sliced;
+    if (empty_slice) {
+        sliced = CloneModule(*M);
+        if (!slicer.createEmptyMain(sliced.get())) {
+            llvm::errs() << "ERROR: failed creating an empty main\n";
+            return false;
+        }
+    } else {
+        slicer.selectBatchedSlice(idx);
+        sliced = slicer.emitSlice();
+    }
+
+    maybe_print_statistics(sliced.get(), "Statistics after ");
+
+    SlicerOptions opts = options;
+    opts.outputFile = output;
+    ModuleWriter writer(opts, sliced.get());
+    return writer.cleanAndSaveModule(should_verify_module) == 0;
+}
+
+///
+// Report the size of the slice of the idx-th criterion marked
+// by Slicer::markBatch() and save the slice to 'output' (an empty main
+// if the criterion is not reachable). 'name' names the criterion
+// in the messages.
+static bool reportAndSaveBatchedSlice(llvm::Module *M, ::Slicer &slicer,
+                                      const SlicerOptions &options,
+                                      size_t idx, bool empty_slice,
+                                      const std::string &name,
+                                      const std::string &output) {
+    if (empty_slice) {
+        llvm::errs() << "[llvm-slicer] criterion " << name
+                     << " is not reachable\n";
+    } else {
+        llvm::errs() << "[llvm-slicer] criterion " << name << ": "
+                     << slicer.getBatchedSliceSize(idx)
+                     << " nodes in the slice\n";
+    }
+
+    if (!saveBatchedSlice(M, slicer, options, idx, empty_slice, output)) {
+        llvm::errs() << "ERROR: slicing w.r.t. criterion " << name
+                     << " failed\n";
+        return false;
+    }
+    return true;
+}
+
+///
+// Slice the module w.r.t. every criterion from 'criteria' separately.
+// The slices are marked at once and then saved one by one.
+// The slice of the i-th criterion is reported and saved under
+// the number ids[i] (under i if 'ids' is empty).
+static int sliceBatched(llvm::Module *M, ::Slicer &slicer,
+                        SlicerOptions &options,
+                        const std::vector<std::set<LLVMNode *>> &criteria,
+                        const std::vector<size_t> &ids = {}) {
+    assert(ids.empty() || ids.size() == criteria.size());
+    if (!slicer.markBatch(criteria, batch_jobs)) {
+        llvm::errs() << "Finding dependent nodes failed\n";
+        return 1;
+    }
+
+    int ret = 0;
+    for (size_t i = 0; i < criteria.size(); ++i) {
+        const size_t id = ids.empty() ? i : ids[i];
+        if (!reportAndSaveBatchedSlice(M, slicer, options, i,
+                                       criteria[i].empty(), std::to_string(id),
+                                       batchOutputFile(options, id)))
+            ret = 1;
+    }
+
+    return ret;
+}
+
+///
+// Print the sizes of the slices of 'criteria' (and the groups
+// of the criteria if -group-slices is given) without slicing.
+static int estimateBatched(::Slicer &slicer,
+                           const std::vector<std::set<LLVMNode *>> &criteria) {
+    if (!slicer.markBatch(criteria, batch_jobs)) {
+        llvm::errs() << "Finding dependent nodes failed\n";
+        return 1;
+    }
+
+    auto sizes = slicer.estimateBatchedSlices();
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        llvm::outs() << "criterion " << i << ": " << sizes[i].nodes
+                     << " nodes, " << sizes[i].blocks << " blocks, "
+                     << sizes[i].graphs << " functions\n";
+    }
+
+    if (group_slices > 0) {
+        auto groups = slicer.groupBatchedCriteria(group_slices);
+        for (size_t g = 0; g < groups.size(); ++g) {
+            llvm::outs() << "group " << groups[g].front() << ":";
+            for (size_t idx : groups[g])
+                llvm::outs() << " " << idx;
+            llvm::outs() << "\n";
+        }
+    }
+
+    return 0;
+}
+
+///
+// Slice the module w.r.t. groups of criteria whose slices overlap
+// heavily (see -group-slices), every group is sliced as one criterion.
+// The slice of a group is saved under the number of its first criterion,
+// so the files of the criteria are the same as without grouping
+// (only the files of the other criteria of the group are missing).
+static int sliceGrouped(llvm::Module *M, ::Slicer &slicer,
+                        SlicerOptions &options,
+                        const std::vector<std::set<LLVMNode *>> &criteria) {
+    if (!slicer.markBatch(criteria, batch_jobs)) {
+        llvm::errs() << "Finding dependent nodes failed\n";
+        return 1;
+    }
+
+    auto groups = slicer.groupBatchedCriteria(group_slices);
+    std::vector<std::set<LLVMNode *>> merged(groups.size());
+    std::vector<size_t> ids(groups.size());
+    for (size_t g = 0; g < groups.size(); ++g) {
+        // the indices in a group are sorted
+        ids[g] = groups[g].front();
+        llvm::errs() << "[llvm-slicer] group " << ids[g] << ": criteria";
+        for (size_t idx : groups[g]) {
+            llvm::errs() << " " << idx;
+            merged[g].insert(criteria[idx].begin(), criteria[idx].end());
+        }
+        llvm::errs() << "\n";
+    }
+
+    return sliceBatched(M, slicer, options, merged, ids);
+}
+
+// Return the next word of 'str' that starts at or after 'pos' (words are
+// separated by runs of spaces and tabs) and move 'pos' after the word.
+// Returns an empty string if there are no more words.
+static std::string nextWord(const std::string &str, size_t &pos) {
+    auto start = str.find_first_not_of(" \t", pos);
+    if (start == std::string::npos) {
+        pos = str.size();
+        return "";
+    }
+
+    pos = str.find_first_of(" \t", start);
+    if (pos == std::string::npos)
+        pos = str.size();
+    return str.substr(start, pos - start);
+}
+
+///
+// Get the path to which the server saves the slice requested to 'file'.
+// With -server-output-dir, relative files are taken relative to that
+// directory and the resolved path (without symbolic links and '..')
+// must lie inside it. Returns false if the file is not allowed.
+static bool getServerOutputPath(const std::string &file, std::string &path) {
+    if (server_output_dir.empty()) {
+        path = file;
+        return true;
+    }
+
+    llvm::SmallString<256> root;
+    if (llvm::sys::fs::real_path(server_output_dir, root))
+        return false;
+
+    llvm::SmallString<256> full;
+    if (llvm::sys::path::is_absolute(file)) {
+        full = file;
+    } else {
+        full = root;
+        llvm::sys::path::append(full, file);
+    }
+
+    // the file itself may not exist yet (but if it does,
+    // it may be a symbolic link), so resolve its directory
+    llvm::SmallString<256> resolved;
+    if (llvm::sys::fs::exists(full)) {
+        if (llvm::sys::fs::real_path(full, resolved))
+            return false;
+    } else {
+        if (llvm::sys::fs::real_path(llvm::sys::path::parent_path(full),
+                                     resolved))
+            return false;
+        llvm::sys::path::append(resolved, llvm::sys::path::filename(full));
+    }
+
+    llvm::StringRef dir = root.str();
+    llvm::StringRef res = resolved.str();
+    if (res.size() <= dir.size() + 1 || !res.startswith(dir) ||
+        !llvm::sys::path::is_separator(res[dir.size()]))
+        return false;
+
+    path = res.str();
+    return true;
+}
+
+///
+// Serve slicing requests from 'in' and write replies to 'out'.
+// Every request is one line, the recognized requests are:
+//
+//   slice FILE CRIT   slice w.r.t. CRIT (in the format of -sc) and
+//                     save the sliced module to FILE
+//   quit              stop the server
+//
+// The replies are 'ok FILE N' (N is the number of nodes in the slice,
+// 0 if the criterion is not reachable and FILE contains just an empty
+// main, the same as in -batch-criteria) or 'error MESSAGE'.
+// The criteria are matched using 'index' (built for the slicer's
+// graph). Returns false if the server should stop.
+static bool serveRequests(llvm::Module *M, ::Slicer &slicer,
+                          SlicerOptions &options, const CriteriaIndex &index,
+                          FILE *in, FILE *out) {
+    char *line = nullptr;
+    size_t len = 0;
+    ssize_t r;
+    bool cont = true;
+
+    while ((r = getline(&line, &len, in)) != -1) {
+        std::string req(line, r);
+        while (!req.empty() && (req.back() == '\n' || req.back() == '\r'))
+            req.pop_back();
+
+        size_t pos = 0;
+        std::string cmd = nextWord(req, pos);
+        if (cmd.empty())
+            continue;
+
+        if (cmd == "quit" || cmd == "exit") {
+            cont = false;
+            break;
+        }
+
+        std::string output = nextWord(req, pos);
+        // the criterion may contain spaces, take the rest of the line
+        std::string crit;
+        auto start = req.find_first_not_of(" \t", pos);
+        if (start != std::string::npos)
+            crit = req.substr(start, req.find_last_not_of(" \t") + 1 - start);
+
+        if (cmd != "slice" || output.empty() || crit.empty()) {
+            fprintf(out, "error invalid request\n");
+            fflush(out);
+            continue;
+        }
+
+        if (!getServerOutputPath(output, output)) {
+            fprintf(out, "error output file not allowed\n");
+            fflush(out);
+            continue;
+        }
+
+        std::set<LLVMNode *> criteria_nodes;
+        if (!getSlicingCriteriaNodes(slicer.getDG(), crit, "", "",
+                                     criteria_nodes,
+                                     options.criteriaAreNextInstr, &index)) {
+            fprintf(out, "error failed finding slicing criteria\n");
+            fflush(out);
+            continue;
+        }
+
+        if (!slicer.markBatch({criteria_nodes})) {
+            fprintf(out, "error marking the slice failed\n");
+            fflush(out);
+            continue;
+        }
+
+        const bool empty_slice = criteria_nodes.empty();
+        size_t nodes = empty_slice ? 0 : slicer.getBatchedSliceSize(0);
+        if (reportAndSaveBatchedSlice(M, slicer, options, 0, empty_slice,
+                                      "'" + crit + "'", output)) {
+            fprintf(out, "ok %s %zu\n", output.c_str(), nodes);
+        } else {
+            fprintf(out, "error slicing failed\n");
+        }
+        fflush(out);
+    }
+
+    free(line);
+    return cont;
+}
+
+///
+// Run the slicer as a server. The module is loaded and the dependence
+// graph is built and computed only once, then the server answers
+// slicing requests (see serveRequests()) from stdin or, if 'socket_path'
+// is not empty, from the clients of a local (UNIX) socket.
+static int runServer(llvm::Module *M, ::Slicer &slicer,
+                     SlicerOptions &options, const std::string &socket_path) {
+    if (!slicer.hasComputedDependencies())
+        slicer.computeDependencies();
+
+    // the graph does not change between the requests,
+    // so index its instructions only once
+    auto index = createCriteriaIndex(slicer.getDG());
+
+    if (socket_path.empty()) {
+        serveRequests(M, slicer, options, *index, stdin, stdout);
+        return 0;
+    }
+
+    struct sockaddr_un addr {};
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        llvm::errs() << "ERROR: socket path is too long: " << socket_path
+                     << "\n";
+        return 1;
+    }
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        llvm::errs() << "ERROR: failed creating a socket\n";
+        return 1;
+    }
+
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(socket_path.c_str());
+    if (bind(sock, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) <
+                0 ||
+        listen(sock, 1) < 0) {
+        llvm::errs() << "ERROR: failed listening on " << socket_path << "\n";
+        close(sock);
+        return 1;
+    }
+
+    llvm::errs() << "[llvm-slicer] listening on " << socket_path << "\n";
+
+    // a client that disconnects before reading the replies
+    // must not kill the server, writing to it just fails
+    signal(SIGPIPE, SIG_IGN);
+
+    int ret = 0;
+    bool cont = true;
+    while (cont) {
+        int conn = accept(sock, nullptr, nullptr);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            llvm::errs() << "ERROR: failed accepting a connection: "
+                         << strerror(errno) << "\n";
+            ret = 1;
+            break;
+        }
+
+        FILE *in = fdopen(conn, "r");
+        FILE *out = fdopen(dup(conn), "w");
+        if (!in || !out) {
+            llvm::errs() << "ERROR: failed opening the connection\n";
+            if (in)
+                fclose(in);
+            else
+                close(conn);
+            continue;
+        }
+
+        cont = serveRequests(M, slicer, options, *index, in, out);
+        fclose(in);
+        fclose(out);
+    }
+
+    close(sock);
+    unlink(socket_path.c_str());
+    return ret;
+}
+
 static AnnotationOptsT parseAnnotationOptions(const std::string &annot) {
     if (annot.empty())
         return {};
@@ -145,7 +648,55 @@ int main(int argc, char *argv[]) {
 #endif
 
     SlicerOptions options = parseSlicerOptions(argc, argv,
-                                               /* requireCrit = */ true);
+                                               /* requireCrit = */ false);
+
+    if (!criteria_file.empty()) {
+        if (!readCriteriaFile(criteria_file, options.slicingCriteria)) {
+            llvm::errs() << "ERROR: failed reading slicing criteria from "
+                         << criteria_file << "\n";
+            return 1;
+        }
+        batch_criteria = true;
+    }
+
+    if (estimate_slices)
+        batch_criteria = true;
+
+    // check it before we spend time on the analyses
+    if (batch_criteria && !options.legacySlicingCriteria.empty()) {
+        llvm::errs() << "ERROR: -batch-criteria supports only -sc "
+                        "slicing criteria\n";
+        return 1;
+    }
+
+    if (batch_criteria && !checkBatchedCriteria(options.slicingCriteria))
+        return 1;
+
+    if (batch_criteria &&
+        (dump_dg || dump_dg_only || !annotationOpts.empty())) {
+        llvm::errs() << "ERROR: -batch-criteria cannot be used with -dump-dg "
+                        "or -annotate\n";
+        return 1;
+    }
+
+    if (group_slices < 0 || group_slices > 1) {
+        llvm::errs() << "ERROR: -group-slices must be in (0, 1]\n";
+        return 1;
+    }
+
+    const bool server_mode = server || !server_socket.empty();
+    if (!server_mode && options.slicingCriteria.empty() &&
+        options.legacySlicingCriteria.empty()) {
+        llvm::errs() << "No slicing criteria specified (-sc or -c option)\n";
+        return 1;
+    }
+
+    if (!server_output_dir.empty() &&
+        !llvm::sys::fs::is_directory(server_output_dir)) {
+        llvm::errs() << "ERROR: -server-output-dir is not a directory: "
+                     << server_output_dir << "\n";
+        return 1;
+    }
 
     if (enable_debug) {
         DBG_ENABLE();
@@ -183,6 +734,13 @@ int main(int argc, char *argv[]) {
     /// ---------------
     // slice the code
     /// ---------------
+    if (options.cutoffDiverging && server_mode) {
+        // the module must stay the same for all the requests
+        llvm::errs() << "[llvm-slicer] running as a server, not cutting off "
+                        "diverging\n";
+        options.cutoffDiverging = false;
+    }
+
     if (options.cutoffDiverging && options.dgOptions.threads) {
         llvm::errs() << "[llvm-slicer] threads are enabled, not cutting off "
                         "diverging\n";
@@ -190,6 +748,7 @@ int main(int argc, char *argv[]) {
     }
 
     if (options.cutoffDiverging) {
+        dg::debug::Profiler::Scope phase("cutoff diverging");
         DBG(llvm - slicer, "Searching for slicing criteria values");
         auto csvalues = getSlicingCriteriaValues(
                 *M, options.slicingCriteria, options.legacySlicingCriteria,
@@ -225,15 +784,46 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    if (server_mode)
+        return runServer(M.get(), slicer, options, server_socket);
+
     ModuleAnnotator annotator(options, &slicer.getDG(),
                               parseAnnotationOptions(annotationOpts));
 
+    if (batch_criteria) {
+        std::vector<std::set<LLVMNode *>> criteria;
+        bool found;
+        {
+            dg::debug::Profiler::Scope phase("slicing criteria");
+            found = getSlicingCriteriaNodesList(slicer.getDG(),
+                                                options.slicingCriteria,
+                                                criteria,
+                                                options.criteriaAreNextInstr);
+        }
+        if (!found || criteria.empty()) {
+            llvm::errs() << "ERROR: Failed finding slicing criteria: '"
+                         << options.slicingCriteria << "'\n";
+            return 1;
+        }
+
+        if (estimate_slices)
+            return estimateBatched(slicer, criteria);
+        if (group_slices > 0)
+            return sliceGrouped(M.get(), slicer, options, criteria);
+        return sliceBatched(M.get(), slicer, options, criteria);
+    }
+
     std::set<LLVMNode *> criteria_nodes;
-    if (!getSlicingCriteriaNodes(slicer.getDG(), options.slicingCriteria,
-                                 options.legacySlicingCriteria,
-                                 options.legacySecondarySlicingCriteria,
-                                 criteria_nodes,
-                                 options.criteriaAreNextInstr)) {
+    bool found;
+    {
+        dg::debug::Profiler::Scope phase("slicing criteria");
+        found = getSlicingCriteriaNodes(slicer.getDG(), options.slicingCriteria,
+                                        options.legacySlicingCriteria,
+                                        options.legacySecondarySlicingCriteria,
+                                        criteria_nodes,
+                                        options.criteriaAreNextInstr);
+    }
+    if (!found) {
         llvm::errs() << "ERROR: Failed finding slicing criteria: '"
                      << options.slicingCriteria << "'\n";
 
@@ -0,0 +1,147 @@
+// Generate LLVM modules of a given size and shape for stress-testing
+// and benchmarking the analyses, e.g.:
+//
+//   llvm-synthetic-gen -functions 10000 -depth 50 -indirect 20 -o big.bc
+//   llvm-slicer -c test_assert big.bc
+
+#include <fstream>
+#include <iostream>
+
+#include <llvm/Config/llvm-config.h>
+
+#if LLVM_VERSION_MAJOR >= 4
+#include <llvm/Bitcode/BitcodeWriter.h>
+#else
+#include <llvm/Bitcode/ReaderWriter.h>
+#endif
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/raw_os_ostream.h>
+
+#include "dg/tools/llvm-synthetic-module.h"
+
+using dg::llvmdg::SyntheticModuleOptions;
+
+llvm::cl::opt<std::string> outputFile("o",
+                                      llvm::cl::desc("Save the module to FILE "
+                                                     "(default=synthetic.bc)."),
+                                      llvm::cl::value_desc("FILE"),
+                                      llvm::cl::init("synthetic.bc"));
+
+llvm::cl::opt<bool> textual("S",
+                            llvm::cl::desc("Write textual IR instead of "
+                                           "bitcode (default=false)."),
+                            llvm::cl::init(false));
+
+llvm::cl::opt<unsigned>
+        functions("functions",
+                  llvm::cl::desc("The number of functions (default=100)."),
+                  llvm::cl::init(100));
+
+llvm::cl::opt<unsigned>
+        depth("depth",
+              llvm::cl::desc("The depth of the call graph (default=10)."),
+              llvm::cl::init(10));
+
+llvm::cl::opt<unsigned> fanout(
+        "fanout",
+        llvm::cl::desc("The number of calls in every function (default=2)."),
+        llvm::cl::init(2));
+
+llvm::cl::opt<unsigned>
+        indirect("indirect",
+                 llvm::cl::desc("The percentage of calls via function "
+                                "pointers (default=0)."),
+                 llvm::cl::init(0));
+
+llvm::cl::opt<SyntheticModuleOptions::HeapShape> heap(
+        "heap", llvm::cl::desc("The data structure on the heap:"),
+        llvm::cl::values(clEnumValN(SyntheticModuleOptions::HeapShape::NONE,
+                                    "none", "No heap"),
+                         clEnumValN(SyntheticModuleOptions::HeapShape::LIST,
+                                    "list", "Linked list (default)"),
+                         clEnumValN(SyntheticModuleOptions::HeapShape::TREE,
+                                    "tree", "Binary tree")
+#if LLVM_VERSION_MAJOR < 4
+                                 ,
+                         nullptr
+#endif
+                         ),
+        llvm::cl::init(SyntheticModuleOptions::HeapShape::LIST));
+
+llvm::cl::opt<unsigned> loopDepth(
+        "loop-depth",
+        llvm::cl::desc("The nesting of loops in functions (default=1)."),
+        llvm::cl::init(1));
+
+llvm::cl::opt<unsigned>
+        threads("threads",
+                llvm::cl::desc("The number of spawned threads (default=0)."),
+                llvm::cl::init(0));
+
+llvm::cl::opt<unsigned>
+        globals("globals",
+                llvm::cl::desc("The number of global variables (default=10)."),
+                llvm::cl::init(10));
+
+llvm::cl::opt<unsigned> seed("seed",
+                             llvm::cl::desc("The seed of the generator "
+                                            "(default=0)."),
+                             llvm::cl::init(0));
+
+llvm::cl::opt<std::string> criterion(
+        "criterion",
+        llvm::cl::desc("The function that main calls at the end, "
+                       "empty for none (default=test_assert)."),
+        llvm::cl::init("test_assert"));
+
+int main(int argc, char *argv[]) {
+    llvm::cl::ParseCommandLineOptions(
+            argc, argv, "Generate LLVM modules for stress-testing DG\n");
+
+    if (functions == 0 || depth == 0) {
+        llvm::errs() << "The number of functions and the depth of the call "
+                        "graph must be positive\n";
+        return 1;
+    }
+    if (indirect > 100) {
+        llvm::errs() << "The percentage of indirect calls must be at most "
+                        "100\n";
+        return 1;
+    }
+
+    SyntheticModuleOptions options;
+    options.functions = functions;
+    options.depth = depth;
+    options.fanout = fanout;
+    options.indirectCalls = indirect;
+    options.heap = heap;
+    options.loopDepth = loopDepth;
+    options.threads = threads;
+    options.globals = globals;
+    options.seed = seed;
+    options.criterion = criterion;
+
+    llvm::LLVMContext context;
+    auto M = dg::llvmdg::generateSyntheticModule(context, options);
+
+    std::ofstream ofs(outputFile);
+    if (!ofs.is_open()) {
+        llvm::errs() << "Failed opening " << outputFile << "\n";
+        return 1;
+    }
+    llvm::raw_os_ostream ostream(ofs);
+    if (textual) {
+        M->print(ostream, nullptr);
+    } else {
+#if (LLVM_VERSION_MAJOR > 6)
+        llvm::WriteBitcodeToFile(*M, ostream);
+#else
+        llvm::WriteBitcodeToFile(M.get(), ostream);
+#endif
+    }
+
+    return 0;
+}
@@ -0,0 +1,430 @@
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "dg/tools/llvm-synthetic-module.h"
+
+using namespace llvm;
+
+namespace dg {
+namespace llvmdg {
+
+namespace {
+
+class SyntheticModuleGenerator {
+    using HeapShape = SyntheticModuleOptions::HeapShape;
+
+    // the maximal number of functions in a table of function pointers
+    static const unsigned TABLE_SIZE = 8;
+
+    // the fields of nodes on the heap
+    enum NodeField { VAL = 0, REF = 1, NEXT = 2, LEFT = 3 };
+
+    const SyntheticModuleOptions &_opts;
+    LLVMContext &_ctx;
+    std::unique_ptr<Module> _M;
+    // mt19937 gives the same numbers everywhere (unlike the distributions
+    // of the standard library), so the modules are reproducible
+    std::mt19937 _rng;
+
+    IntegerType *_i32;
+    IntegerType *_i64;
+    PointerType *_i8ptr;
+    PointerType *_i32ptr;
+    StructType *_nodeTy;
+    PointerType *_nodePtr;
+    // i32 f(i32 *, node *)
+    FunctionType *_funTy;
+    PointerType *_funPtr;
+
+    Function *_malloc{nullptr};
+    Function *_pthreadCreate{nullptr};
+    Function *_pthreadJoin{nullptr};
+
+    std::vector<GlobalVariable *> _globals;
+    std::vector<Function *> _functions;
+    std::vector<unsigned> _levelOf;
+    std::vector<std::vector<unsigned>> _levels;
+    // the tables of function pointers to the functions of every level
+    std::vector<GlobalVariable *> _tables;
+    std::vector<std::vector<unsigned>> _callees;
+
+    unsigned _rand(unsigned n) { return n == 0 ? 0 : _rng() % n; }
+    bool _percent(unsigned p) { return _rand(100) < p; }
+
+    template <typename T>
+    const T &_pick(const std::vector<T> &vec) {
+        assert(!vec.empty());
+        return vec[_rand(vec.size())];
+    }
+
+    static Value *_load(IRBuilder<> &B, Type *Ty, Value *ptr) {
+#if LLVM_VERSION_MAJOR >= 8
+        return B.CreateLoad(Ty, ptr);
+#else
+        (void) Ty;
+        return B.CreateLoad(ptr);
+#endif
+    }
+
+    static Value *_call(IRBuilder<> &B, FunctionType *FTy, Value *callee,
+                        ArrayRef<Value *> args) {
+#if LLVM_VERSION_MAJOR >= 8
+        return B.CreateCall(FTy, callee, args);
+#else
+        (void) FTy;
+        return B.CreateCall(callee, args);
+#endif
+    }
+
+    Value *_field(IRBuilder<> &B, Value *node, NodeField field) {
+        return B.CreateStructGEP(_nodeTy, node, field);
+    }
+
+    Function *_declare(const std::string &name, FunctionType *FTy) {
+        if (auto *F = _M->getFunction(name))
+            return F;
+        return Function::Create(FTy, GlobalValue::ExternalLinkage, name,
+                                _M.get());
+    }
+
+    void _createTypes() {
+        _i32 = Type::getInt32Ty(_ctx);
+        _i64 = Type::getInt64Ty(_ctx);
+        _i8ptr = PointerType::get(Type::getInt8Ty(_ctx), 0);
+        _i32ptr = PointerType::get(_i32, 0);
+
+        // struct node { int val; int *ref; struct node *next, *left; }
+        _nodeTy = StructType::create(_ctx, "struct.node");
+        _nodePtr = PointerType::get(_nodeTy, 0);
+        _nodeTy->setBody({_i32, _i32ptr, _nodePtr, _nodePtr});
+
+        _funTy = FunctionType::get(_i32, {_i32ptr, _nodePtr}, false);
+        _funPtr = PointerType::get(_funTy, 0);
+    }
+
+    void _createDeclarations() {
+        _malloc = _declare("malloc", FunctionType::get(_i8ptr, {_i64}, false));
+        if (_opts.threads > 0) {
+            auto *threadTy = FunctionType::get(_i8ptr, {_i8ptr}, false);
+            _pthreadCreate = _declare(
+                    "pthread_create",
+                    FunctionType::get(_i32,
+                                      {PointerType::get(_i64, 0), _i8ptr,
+                                       PointerType::get(threadTy, 0), _i8ptr},
+                                      false));
+            _pthreadJoin = _declare(
+                    "pthread_join",
+                    FunctionType::get(
+                            _i32, {_i64, PointerType::get(_i8ptr, 0)}, false));
+        }
+    }
+
+    void _createGlobals() {
+        for (unsigned i = 0; i < std::max(_opts.globals, 1U); ++i) {
+            _globals.push_back(new GlobalVariable(
+                    *_M, _i32, false, GlobalValue::InternalLinkage,
+                    ConstantInt::get(_i32, 0), "g" + std::to_string(i)));
+        }
+    }
+
+    void _createCallGraph() {
+        const unsigned n = std::max(_opts.functions, 1U);
+        const unsigned depth = std::min(std::max(_opts.depth, 1U), n);
+
+        _levels.resize(depth);
+        for (unsigned i = 0; i < n; ++i) {
+            _functions.push_back(Function::Create(_funTy,
+                                                  GlobalValue::InternalLinkage,
+                                                  "f" + std::to_string(i),
+                                                  _M.get()));
+            _levelOf.push_back(i * depth / n);
+            _levels[_levelOf.back()].push_back(i);
+        }
+
+        // every function is called from the previous level at least once
+        // and calls at least 'fanout' functions from the next level
+        _callees.resize(n);
+        for (unsigned l = 0; l + 1 < depth; ++l) {
+            for (auto callee : _levels[l + 1])
+                _callees[_pick(_levels[l])].push_back(callee);
+            for (auto caller : _levels[l]) {
+                while (_callees[caller].size() < _opts.fanout)
+                    _callees[caller].push_back(_pick(_levels[l + 1]));
+            }
+        }
+
+        _tables.resize(depth, nullptr);
+        if (_opts.indirectCalls == 0)
+            return;
+        for (unsigned l = 1; l < depth; ++l) {
+            std::vector<Constant *> entries;
+            const auto size = std::min<size_t>(TABLE_SIZE, _levels[l].size());
+            for (size_t i = 0; i < size; ++i)
+                entries.push_back(_functions[_pick(_levels[l])]);
+            auto *Ty = ArrayType::get(_funPtr, size);
+            _tables[l] = new GlobalVariable(
+                    *_M, Ty, true, GlobalValue::InternalLinkage,
+                    ConstantArray::get(Ty, entries),
+                    "ftable" + std::to_string(l));
+        }
+    }
+
+    ///
+    // Create 'depth' nested loops with a few iterations at the insertion
+    // point of B and generate the innermost body with 'body'.
+    // B is left at the end of the loops.
+    void _createLoops(IRBuilder<> &B, unsigned depth,
+                      const std::function<void()> &body) {
+        if (depth == 0) {
+            body();
+            return;
+        }
+
+        auto *F = B.GetInsertBlock()->getParent();
+        IRBuilder<> entry(&F->getEntryBlock(), F->getEntryBlock().begin());
+        auto *counter = entry.CreateAlloca(_i32);
+        B.CreateStore(ConstantInt::get(_i32, 0), counter);
+
+        auto *header = BasicBlock::Create(_ctx, "loop", F);
+        auto *loopBody = BasicBlock::Create(_ctx, "loop.body", F);
+        // inserted to the function after the nested loops
+        auto *exit = BasicBlock::Create(_ctx, "loop.exit");
+        B.CreateBr(header);
+
+        B.SetInsertPoint(header);
+        auto *cond = B.CreateICmpSLT(_load(B, _i32, counter),
+                                     ConstantInt::get(_i32, 2 + _rand(3)));
+        B.CreateCondBr(cond, loopBody, exit);
+
+        B.SetInsertPoint(loopBody);
+        _createLoops(B, depth - 1, body);
+        B.CreateStore(B.CreateAdd(_load(B, _i32, counter),
+                                  ConstantInt::get(_i32, 1)),
+                      counter);
+        B.CreateBr(header);
+
+        exit->insertInto(F);
+        B.SetInsertPoint(exit);
+    }
+
+    // allocate a new node that contains the value 'val'
+    Value *_createNode(IRBuilder<> &B, Value *val) {
+        auto *mem = B.CreateCall(
+                _malloc, {ConstantInt::get(_i64, _M->getDataLayout()
+                                                         .getTypeAllocSize(
+                                                                 _nodeTy))});
+        auto *node = B.CreateBitCast(mem, _nodePtr);
+        auto *valPtr = _field(B, node, VAL);
+        B.CreateStore(val, valPtr);
+        B.CreateStore(valPtr, _field(B, node, REF));
+        B.CreateStore(ConstantPointerNull::get(_nodePtr), _field(B, node, NEXT));
+        B.CreateStore(ConstantPointerNull::get(_nodePtr), _field(B, node, LEFT));
+        return node;
+    }
+
+    ///
+    // Take a step in the data structure from 'node' and possibly extend
+    // the data structure. Return the node that is passed to the callees.
+    Value *_updateHeap(IRBuilder<> &B, Value *node, Value *ptr, unsigned idx) {
+        if (_opts.heap == HeapShape::NONE)
+            return node;
+
+        // go to the next node (if there is any)
+        auto field = _opts.heap == HeapShape::TREE && _rand(2) ? LEFT : NEXT;
+        auto *next = _load(B, _nodePtr, _field(B, node, field));
+        auto *isNull =
+                B.CreateICmpEQ(next, ConstantPointerNull::get(_nodePtr));
+        auto *cur = B.CreateSelect(isNull, node, next);
+
+        // the pointer from the argument flows to the heap
+        if (_rand(2))
+            B.CreateStore(ptr, _field(B, cur, REF));
+
+        if (_rand(2) == 0)
+            return cur;
+
+        // extend the data structure
+        auto *newNode = _createNode(B, ConstantInt::get(_i32, idx));
+        field = _opts.heap == HeapShape::TREE && _rand(2) ? LEFT : NEXT;
+        B.CreateStore(newNode, _field(B, cur, field));
+        return newNode;
+    }
+
+    // the pointer that is passed to a callee
+    Value *_pickPointer(Value *arg, Value *local) {
+        switch (_rand(3)) {
+        case 0:
+            return arg;
+        case 1:
+            return local;
+        default:
+            return _pick(_globals);
+        }
+    }
+
+    void _createBody(unsigned idx) {
+        auto *F = _functions[idx];
+        auto argIt = F->arg_begin();
+        Value *ptr = &*argIt;
+        Value *node = &*(++argIt);
+
+        auto *entry = BasicBlock::Create(_ctx, "entry", F);
+        IRBuilder<> B(entry);
+        auto *local = B.CreateAlloca(_i32);
+        B.CreateStore(B.CreateAdd(_load(B, _i32, ptr),
+                                  ConstantInt::get(_i32, idx)),
+                      local);
+
+        auto *cur = _updateHeap(B, node, ptr, idx);
+
+        // work with the memory in loops
+        auto *glob = _pick(_globals);
+        _createLoops(B, _opts.loopDepth, [&]() {
+            auto *val = _load(B, _i32, ptr);
+            B.CreateStore(B.CreateAdd(val, _load(B, _i32, glob)), glob);
+            B.CreateStore(B.CreateAdd(_load(B, _i32, local), val), local);
+            if (_opts.heap != HeapShape::NONE) {
+                auto *ref = _load(B, _i32ptr, _field(B, cur, REF));
+                B.CreateStore(_load(B, _i32, ref), _field(B, cur, VAL));
+            }
+        });
+
+        // call the functions from the next level, every call is
+        // under a condition
+        for (auto callee : _callees[idx]) {
+            auto *call = BasicBlock::Create(_ctx, "call", F);
+            auto *cont = BasicBlock::Create(_ctx, "cont", F);
+            auto *rem = B.CreateURem(_load(B, _i32, local),
+                                     ConstantInt::get(_i32, 2 + _rand(3)));
+            B.CreateCondBr(B.CreateICmpNE(rem, ConstantInt::get(_i32, 0)),
+                           call, cont);
+
+            B.SetInsertPoint(call);
+            Value *fun = _functions[callee];
+            auto *table = _tables[_levelOf[callee]];
+            if (table && _percent(_opts.indirectCalls)) {
+                auto size = cast<ArrayType>(table->getValueType())
+                                    ->getNumElements();
+                auto *i = B.CreateURem(_load(B, _i32, local),
+                                       ConstantInt::get(_i32, size));
+                auto *entryPtr = B.CreateInBoundsGEP(
+                        table->getValueType(), table,
+                        {ConstantInt::get(_i32, 0), i});
+                fun = _load(B, _funPtr, entryPtr);
+            }
+            auto *ret = _call(B, _funTy, fun,
+                              {_pickPointer(ptr, local), cur});
+            B.CreateStore(B.CreateAdd(_load(B, _i32, local), ret), local);
+            B.CreateBr(cont);
+
+            B.SetInsertPoint(cont);
+        }
+
+        B.CreateRet(_load(B, _i32, local));
+    }
+
+    // a thread that runs one of the functions from the first levels
+    Function *_createThread(unsigned idx) {
+        auto *FTy = FunctionType::get(_i8ptr, {_i8ptr}, false);
+        auto *F = Function::Create(FTy, GlobalValue::InternalLinkage,
+                                   "thread" + std::to_string(idx), _M.get());
+        IRBuilder<> B(BasicBlock::Create(_ctx, "entry", F));
+        auto *node = B.CreateBitCast(&*F->arg_begin(), _nodePtr);
+        const auto &level = _levels[_rand(std::min<size_t>(2, _levels.size()))];
+        _call(B, _funTy, _functions[_pick(level)], {_pick(_globals), node});
+        B.CreateRet(ConstantPointerNull::get(_i8ptr));
+        return F;
+    }
+
+    void _createMain() {
+        auto *F = Function::Create(FunctionType::get(_i32, false),
+                                   GlobalValue::ExternalLinkage, "main",
+                                   _M.get());
+        IRBuilder<> B(BasicBlock::Create(_ctx, "entry", F));
+        auto *x = B.CreateAlloca(_i32);
+        B.CreateStore(ConstantInt::get(_i32, 1), x);
+
+        Value *root = ConstantPointerNull::get(_nodePtr);
+        if (_opts.heap != HeapShape::NONE)
+            root = _createNode(B, ConstantInt::get(_i32, 0));
+
+        Value *threads = nullptr;
+        auto *threadsTy = ArrayType::get(_i64, _opts.threads);
+        if (_opts.threads > 0) {
+            threads = B.CreateAlloca(threadsTy);
+            auto *arg = B.CreateBitCast(root, _i8ptr);
+            for (unsigned i = 0; i < _opts.threads; ++i) {
+                auto *thread = _createThread(i);
+                auto *tid = B.CreateInBoundsGEP(threadsTy, threads,
+                                                {ConstantInt::get(_i32, 0),
+                                                 ConstantInt::get(_i32, i)});
+                B.CreateCall(_pthreadCreate,
+                             {tid, ConstantPointerNull::get(_i8ptr), thread,
+                              arg});
+            }
+        }
+
+        for (auto idx : _levels[0])
+            _call(B, _funTy, _functions[idx], {x, root});
+
+        for (unsigned i = 0; i < _opts.threads; ++i) {
+            auto *tid = B.CreateInBoundsGEP(threadsTy, threads,
+                                            {ConstantInt::get(_i32, 0),
+                                             ConstantInt::get(_i32, i)});
+            B.CreateCall(_pthreadJoin,
+                         {_load(B, _i64, tid),
+                          ConstantPointerNull::get(PointerType::get(_i8ptr,
+                                                                    0))});
+        }
+
+        if (!_opts.criterion.empty()) {
+            auto *crit = _declare(
+                    _opts.criterion,
+                    FunctionType::get(Type::getVoidTy(_ctx), {_i32}, false));
+            B.CreateCall(crit, {B.CreateAdd(_load(B, _i32, x),
+                                            _load(B, _i32, _globals[0]))});
+        }
+        B.CreateRet(ConstantInt::get(_i32, 0));
+    }
+
+  public:
+    SyntheticModuleGenerator(LLVMContext &ctx,
+                             const SyntheticModuleOptions &opts)
+            : _opts(opts), _ctx(ctx),
+              _M(new Module("synthetic", ctx)), _rng(opts.seed) {}
+
+    std::unique_ptr<Module> generate() {
+        _createTypes();
+        _createDeclarations();
+        _createGlobals();
+        _createCallGraph();
+        for (unsigned i = 0; i < _functions.size(); ++i)
+            _createBody(i);
+        _createMain();
+
+        assert(!verifyModule(*_M, &errs()) && "Generated an invalid module");
+        return std::move(_M);
+    }
+};
+
+} // anonymous namespace
+
+std::unique_ptr<Module>
+generateSyntheticModule(LLVMContext &ctx,
+                        const SyntheticModuleOptions &options) {
+    return SyntheticModuleGenerator(ctx, options).generate();
+}
+
+} // namespace llvmdg
+} // namespace dg